@@ -0,0 +1,84 @@
+/*
+    === affine.h ===
+
+    Operations on affine matrices stored as glv_mat3x4.
+
+    A glv_mat3x4 holds the top three rows of a glv_mat4 whose bottom
+    row is 0,0,0,1: a 3x3 linear part in columns 0-2 and a translation
+    in column 3. It takes 48 bytes instead of 64, and the product of
+    two of them needs 36 multiplies instead of 64.
+
+    Conversion to and from glv_mat4 is lossless for affine matrices;
+    glv_mat3x4_from_mat4 ignores the bottom row.
+
+    Example:
+        glv_mat4 model = glv_translate(&identity, &position);
+        glv_mat3x4 a = glv_mat3x4_from_mat4(&model);
+        glv_mat3x4 mv = glv_mat3x4_multiply(&view, &a);
+        glv_vec3 p = glv_mat3x4_transform_point(&mv, &vertex);
+*/
+
+#ifndef GLV_AFFINE_H
+#define GLV_AFFINE_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+
+
+/* ----- Creation and conversion ----- */
+
+/* Returns the identity transform */
+GLV_API glv_mat3x4 glv_mat3x4_identity(void);
+
+/* Drops the bottom row of a mat4 */
+GLV_API glv_mat3x4 glv_mat3x4_from_mat4(const glv_mat4* m);
+
+/* Adds the bottom row 0,0,0,1 */
+GLV_API glv_mat4 glv_mat3x4_to_mat4(const glv_mat3x4* m);
+
+/* Same as above over arrays */
+GLV_API void glv_mat3x4_from_mat4_batch(const glv_mat4* in, glv_mat3x4* out, size_t n);
+GLV_API void glv_mat3x4_to_mat4_batch(const glv_mat3x4* in, glv_mat4* out, size_t n);
+
+
+/* ----- Operations ----- */
+
+/* Product of two affine transforms, as glv_mat4_multiply on their mat4 forms */
+GLV_API glv_mat3x4 glv_mat3x4_multiply(const glv_mat3x4* a, const glv_mat3x4* b);
+
+/* Inverse transform. Singular matrices give a zero matrix */
+GLV_API glv_mat3x4 glv_mat3x4_inverse(const glv_mat3x4* m);
+
+/* Transforms a point (w = 1) or a direction (w = 0, translation ignored) */
+GLV_API glv_vec3 glv_mat3x4_transform_point(const glv_mat3x4* m, const glv_vec3* p);
+GLV_API glv_vec3 glv_mat3x4_transform_dir(const glv_mat3x4* m, const glv_vec3* d);
+
+
+/* ----- Batch operations ----- */
+
+/*
+    Multiplies every matrix of an array from the left, out[i] = m * in[i].
+    out may equal in. Each result is identical to glv_mat3x4_multiply.
+*/
+GLV_API void glv_mat3x4_multiply_array(const glv_mat3x4* m, const glv_mat3x4* in, glv_mat3x4* out, size_t n);
+
+/*
+    Inverts n matrices, out may be the same array as in.
+    status[i] is set to 0 for singular matrices and 1 otherwise (may be NULL).
+    Returns the number of singular matrices.
+*/
+GLV_API size_t glv_mat3x4_inverse_batch(const glv_mat3x4* in, glv_mat3x4* out, size_t n, unsigned char* status);
+
+/*
+    Transforms count points or directions, with strides as in
+    glv_transform_batch_vec3. Runs the same SIMD kernel, so results
+    match glv_transform_batch_vec3 with the mat4 form of m.
+*/
+GLV_API void glv_mat3x4_transform_points(const glv_vec3* in, size_t in_stride,
+    glv_vec3* out, size_t out_stride, size_t count, const glv_mat3x4* m);
+GLV_API void glv_mat3x4_transform_dirs(const glv_vec3* in, size_t in_stride,
+    glv_vec3* out, size_t out_stride, size_t count, const glv_mat3x4* m);
+
+#endif /* GLV_AFFINE_H */
@@ -0,0 +1,73 @@
+/*
+    === arena.h ===
+
+    Bump allocator for transient batches of vectors and matrices, e.g.
+    the transformed points or skinning palettes of one frame.
+
+    The arena hands out pieces of a buffer the caller owns, a static
+    array or one allocation made at startup, so the library itself still
+    never touches the heap. Allocating moves a cursor forward; nothing
+    is freed on its own. glv_arena_reset empties the arena at the start
+    of each frame, and glv_arena_mark / glv_arena_release give back
+    everything allocated after a mark, for scratch memory inside a frame.
+
+    The typed allocators align to GLV_ARENA_ALIGN (a cache line), so the
+    arrays suit aligned SIMD loads and never share a line with other data.
+    Allocations that do not fit return NULL and leave the arena as it was.
+    An arena must only be used by one thread at a time.
+
+    Example:
+        static unsigned char frame_memory[1 << 20] GLV_ALIGNED(64);
+        glv_arena frame;
+        glv_arena_init(&frame, frame_memory, sizeof(frame_memory));
+
+        // each frame
+        glv_arena_reset(&frame);
+        glv_vec3a* points = glv_arena_vec3a(&frame, count);
+        glv_transform_batch_vec3a(mesh_points, points, count, &mvp);
+        glv_mat4a64* palette = glv_arena_mat4(&frame, bone_count);
+        glv_mat4_multiply_pairs_a64(world, inverse_bind, palette, bone_count);
+*/
+
+#ifndef GLV_ARENA_H
+#define GLV_ARENA_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+
+/* Alignment of the typed allocations in bytes */
+#define GLV_ARENA_ALIGN 64
+
+typedef struct {
+    unsigned char* base;
+    size_t size;
+    size_t used;                /* bytes from base to the cursor */
+    size_t peak;                /* highest used since init, to size the buffer */
+} glv_arena;
+
+
+/* Uses size bytes at buffer, which must outlive the arena */
+GLV_API void glv_arena_init(glv_arena* a, void* buffer, size_t size);
+
+/*
+    Returns bytes of memory aligned to align, or NULL if they do not fit.
+    align is a power of two, 0 meaning 1; other values give NULL.
+*/
+GLV_API void* glv_arena_alloc(glv_arena* a, size_t bytes, size_t align);
+
+/* Uninitialized arrays of count elements, aligned to GLV_ARENA_ALIGN, or NULL */
+GLV_API glv_mat4a64* glv_arena_mat4(glv_arena* a, size_t count);
+GLV_API glv_vec4* glv_arena_vec4(glv_arena* a, size_t count);
+GLV_API glv_vec3a* glv_arena_vec3a(glv_arena* a, size_t count);
+GLV_API float* glv_arena_float(glv_arena* a, size_t count);
+
+/* Current position, to give back later allocations with glv_arena_release */
+GLV_API size_t glv_arena_mark(const glv_arena* a);
+GLV_API void glv_arena_release(glv_arena* a, size_t mark);
+
+/* Frees everything, e.g. once per frame */
+GLV_API void glv_arena_reset(glv_arena* a);
+
+#endif /* GLV_ARENA_H */
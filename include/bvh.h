@@ -0,0 +1,129 @@
+/*
+    === bvh.h ===
+
+    Bounding volume hierarchy over axis-aligned boxes, for picking,
+    overlap and proximity queries over many objects.
+
+    The caller owns every array: the primitive boxes as streams (ray.h),
+    GLV_BVH_NODES(count) nodes and count indices. glv_bvh_build splits
+    the primitives with the surface area heuristic, evaluated at up to
+    GLV_BVH_BINS bins on each axis, and stores the tree as a flat array in depth-first
+    order. The left child of an inner node is the next node and the
+    right child is at its index, so a subtree is a contiguous block.
+    Leaves hold a run of the index array.
+
+    When objects move but the tree is still a good fit, glv_bvh_refit
+    recomputes the node bounds from the current boxes in one backward
+    pass, without touching the structure. Rebuild when objects have
+    moved far from where the tree was built, as refitted nodes grow
+    and overlap more.
+
+    Queries read the tree only and may run from several threads at once.
+    Lists of primitives are written to a caller array of given capacity
+    and the total found is returned, so a second call with a larger
+    array gets the rest.
+
+    glv_bvh_build_parallel (pool.h) builds the same tree on the pool.
+
+    Example:
+        glv_aabbs_transform(&local_bounds, world, count, &bounds);
+        glv_bvh bvh = {bounds, count, nodes, indices, 0};
+        glv_bvh_build(&bvh, 4);
+
+        // each frame, after updating world
+        glv_aabbs_transform(&local_bounds, world, count, &bounds);
+        glv_bvh_refit(&bvh);
+        uint32_t picked = glv_bvh_ray_nearest(&bvh, &ray, INFINITY, &t);
+*/
+
+#ifndef GLV_BVH_H
+#define GLV_BVH_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+#include "ray.h"
+
+/* Nodes needed for n primitives */
+#define GLV_BVH_NODES(n) (2 * (n))
+
+/* Deepest level of the tree, and the stack size of the queries */
+#define GLV_BVH_MAX_DEPTH 64
+
+/* Most bins per axis of the build, smaller nodes use one per primitive */
+#define GLV_BVH_BINS 16
+
+typedef struct {
+    float min[3];
+    uint32_t index;             /* leaves: first entry in indices; inner nodes: right child */
+    float max[3];
+    uint32_t count;             /* primitives of a leaf, 0 for inner nodes */
+} glv_bvh_node;
+
+typedef struct {
+    glv_aabb_soa boxes;         /* primitive bounds, read by build and refit */
+    size_t count;               /* number of primitives */
+    glv_bvh_node* nodes;        /* GLV_BVH_NODES(count), root first */
+    uint32_t* indices;          /* count, primitives in leaf order */
+    size_t node_count;          /* nodes in use, set by the build */
+} glv_bvh;
+
+
+/* ----- Bounds ----- */
+
+/*
+    Bounds of n boxes each moved by its own matrix, e.g. object bounds
+    by world matrices. The result encloses the transformed box tightly
+    for affine matrices. out may be the same streams as local.
+*/
+GLV_API void glv_aabbs_transform(const glv_aabb_soa* local, const glv_mat4* m, size_t n, const glv_aabb_soa* out);
+
+
+/* ----- Build and refit ----- */
+
+/*
+    Builds the tree over b->count boxes, with at most leaf_size
+    primitives per leaf unless the SAH or the depth limit says
+    otherwise. Returns the number of nodes used.
+*/
+GLV_API size_t glv_bvh_build(glv_bvh* b, unsigned int leaf_size);
+
+/* Recomputes every node's bounds from the current boxes */
+GLV_API void glv_bvh_refit(const glv_bvh* b);
+
+
+/* ----- Queries ----- */
+
+/*
+    Lists the primitives whose boxes the ray enters before t_max,
+    writing at most capacity indices to out. Returns the number found.
+*/
+GLV_API size_t glv_bvh_ray(const glv_bvh* b, const glv_ray* r, float t_max, uint32_t* out, size_t capacity);
+
+/* Primitive whose box the ray enters first before t_max, written to *t, or GLV_RAY_MISS */
+GLV_API uint32_t glv_bvh_ray_nearest(const glv_bvh* b, const glv_ray* r, float t_max, float* t);
+
+/*
+    Nearest hit among triangles, where primitive i is triangle i of tris
+    and its box encloses it. Same result as glv_ray_triangles_nearest.
+*/
+GLV_API int glv_bvh_ray_triangles(const glv_bvh* b, const glv_ray* r, const glv_triangle_soa* tris,
+    float t_max, glv_ray_hit* hit);
+
+/* Lists the primitives whose boxes overlap the box (min, max), touching included */
+GLV_API size_t glv_bvh_overlap(const glv_bvh* b, const glv_vec3* min, const glv_vec3* max,
+    uint32_t* out, size_t capacity);
+
+/* Lists the primitives whose boxes come within radius of centre */
+GLV_API size_t glv_bvh_sphere(const glv_bvh* b, const glv_vec3* centre, float radius,
+    uint32_t* out, size_t capacity);
+
+/*
+    Primitive whose box is nearest to p and closer than max_distance,
+    or GLV_RAY_MISS. The distance, 0 for boxes containing p, goes to *distance.
+*/
+GLV_API uint32_t glv_bvh_nearest(const glv_bvh* b, const glv_vec3* p, float max_distance, float* distance);
+
+#endif /* GLV_BVH_H */
@@ -0,0 +1,97 @@
+/*
+    === camera.h ===
+
+    Perspective camera that keeps its derived matrices between frames.
+
+    The camera holds the inputs of glv_lookat (eye, target, up) and of
+    glv_perspective (fovy, aspect, near, far), and caches the view and
+    projection matrices, their product, the three inverses and the
+    frustum planes (cull.h). Setters mark the results that depend on
+    what they change as stale, and only if a value actually differs.
+    Getters rebuild a stale result on first use. A still camera costs
+    nothing per frame, and moving it leaves the projection and its
+    inverse alone.
+
+    The inverse view is the affine inverse, the inverse projection is
+    written from the perspective terms, and the inverse view-projection
+    is their product, which is cheaper than a general inverse.
+
+    Inputs must only be changed through the setters. Getters update the
+    cache, so a camera must not be shared between threads without a lock.
+
+    Example:
+        glv_camera cam;
+        glv_camera_init(&cam, &eye, &target, &up, 0.8f, 16.0f / 9.0f, 0.1f, 500.0f);
+
+        // each frame
+        glv_camera_set_view(&cam, &eye, &target, &up);
+        const glv_mat4* vp = glv_camera_view_projection(&cam);
+        size_t n = glv_frustum_cull_spheres_indices(glv_camera_frustum(&cam), &centres, radii, count, visible);
+*/
+
+#ifndef GLV_CAMERA_H
+#define GLV_CAMERA_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+#include "cull.h"
+
+/* Cached results, bits of glv_camera.stale */
+enum {
+    GLV_CAMERA_VIEW = 1 << 0,
+    GLV_CAMERA_PROJECTION = 1 << 1,
+    GLV_CAMERA_VIEW_PROJECTION = 1 << 2,
+    GLV_CAMERA_INVERSE_VIEW = 1 << 3,
+    GLV_CAMERA_INVERSE_PROJECTION = 1 << 4,
+    GLV_CAMERA_INVERSE_VIEW_PROJECTION = 1 << 5,
+    GLV_CAMERA_FRUSTUM = 1 << 6,
+    GLV_CAMERA_ALL = (1 << 7) - 1
+};
+
+typedef struct {
+    /* Inputs, read-only outside the setters */
+    glv_vec3 eye, target, up;
+    float fovy, aspect, near, far;
+    /* Cached results, read through the getters */
+    glv_mat4 view, projection, view_projection;
+    glv_mat4 inverse_view, inverse_projection, inverse_view_projection;
+    glv_frustum_planes frustum;
+    unsigned int stale;             /* GLV_CAMERA_* bits of results out of date */
+} glv_camera;
+
+
+/* ----- Inputs ----- */
+
+GLV_API void glv_camera_init(glv_camera* c, const glv_vec3* eye, const glv_vec3* target, const glv_vec3* up,
+    float fovy, float aspect, float near, float far);
+
+/* Each only invalidates the results that depend on the values it changes */
+GLV_API void glv_camera_set_view(glv_camera* c, const glv_vec3* eye, const glv_vec3* target, const glv_vec3* up);
+GLV_API void glv_camera_set_projection(glv_camera* c, float fovy, float aspect, float near, float far);
+GLV_API void glv_camera_set_aspect(glv_camera* c, float aspect);
+
+
+/* ----- Cached results, rebuilt if stale ----- */
+
+GLV_API const glv_mat4* glv_camera_view(glv_camera* c);
+GLV_API const glv_mat4* glv_camera_projection(glv_camera* c);
+GLV_API const glv_mat4* glv_camera_view_projection(glv_camera* c);
+GLV_API const glv_mat4* glv_camera_inverse_view(glv_camera* c);
+GLV_API const glv_mat4* glv_camera_inverse_projection(glv_camera* c);
+GLV_API const glv_mat4* glv_camera_inverse_view_projection(glv_camera* c);
+GLV_API const glv_frustum_planes* glv_camera_frustum(glv_camera* c);
+
+
+/* ----- Unprojection ----- */
+
+/*
+    Maps count window points (x, y in pixels, z the depth in [0,1]) to
+    world space. viewport is (x, y, width, height) in pixels, with y up
+    as in glViewport. out may be the same array as in.
+*/
+GLV_API void glv_camera_unproject(glv_camera* c, const glv_vec4* viewport,
+    const glv_vec3* in, glv_vec3* out, size_t count);
+
+#endif /* GLV_CAMERA_H */
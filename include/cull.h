@@ -0,0 +1,97 @@
+/*
+    === cull.h ===
+
+    View frustum culling of bounding spheres and boxes.
+
+    The six planes of a frustum are extracted from a view-projection
+    matrix (e.g. glv_perspective times glv_lookat), in the same [-1,1]
+    clip space as the builders in transform.h. Each plane is stored as
+    a glv_vec4 (nx, ny, nz, d) with a unit normal pointing inwards, so
+    that nx*x + ny*y + nz*z + d is the signed distance of a point.
+
+    Tests are conservative: a bound is reported visible unless it lies
+    entirely outside one of the planes. Bounds near a frustum corner
+    may be reported visible while being outside.
+
+    Batch tests read bounds from structure-of-arrays streams and test
+    4 (SSE2) or 8 (AVX and above) bounds per instruction. Results go to
+    a bitmask, bit i % 32 of mask[i / 32] set for visible bounds, or to
+    a compacted list of the indices of visible bounds.
+
+    Example:
+        glv_mat4 vp = glv_mat4_multiply(&proj, &view);
+        glv_frustum_planes f = glv_frustum_planes_from_mat4(&vp);
+        uint32_t visible[N];
+        size_t count = glv_frustum_cull_spheres_indices(&f, &centres, radii, N, visible);
+*/
+
+#ifndef GLV_CULL_H
+#define GLV_CULL_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+#include "soa.h"
+
+/* Plane order in glv_frustum_planes */
+enum {
+    GLV_PLANE_LEFT = 0,
+    GLV_PLANE_RIGHT,
+    GLV_PLANE_BOTTOM,
+    GLV_PLANE_TOP,
+    GLV_PLANE_NEAR,
+    GLV_PLANE_FAR,
+    GLV_PLANE_COUNT
+};
+
+typedef struct {
+    glv_vec4 planes[GLV_PLANE_COUNT];
+} glv_frustum_planes;
+
+/* Number of 32-bit words in the bitmask of n bounds */
+#define GLV_CULL_MASK_WORDS(n) (((n) + 31) / 32)
+
+
+/* ----- Extraction ----- */
+
+/* Planes of the frustum of a view-projection matrix, in world space */
+GLV_API glv_frustum_planes glv_frustum_planes_from_mat4(const glv_mat4* m);
+
+
+/* ----- Single tests ----- */
+
+/* Return 1 if the bound may be visible, 0 if it is outside */
+GLV_API int glv_frustum_sphere_visible(const glv_frustum_planes* f, const glv_vec3* centre, float radius);
+GLV_API int glv_frustum_aabb_visible(const glv_frustum_planes* f, const glv_vec3* centre, const glv_vec3* extent);
+
+
+/* ----- Batch tests ----- */
+
+/*
+    Tests n spheres, given by their centres and radii.
+    The mask must hold GLV_CULL_MASK_WORDS(n) words; bits past n are
+    cleared. Returns the number of visible spheres.
+*/
+GLV_API size_t glv_frustum_cull_spheres(const glv_frustum_planes* f, const glv_vec3_soa* centres,
+    const float* radii, size_t n, uint32_t* mask);
+
+/*
+    Tests n axis-aligned boxes, given by their centres and half extents
+    (non-negative). Same output as glv_frustum_cull_spheres.
+*/
+GLV_API size_t glv_frustum_cull_aabbs(const glv_frustum_planes* f, const glv_vec3_soa* centres,
+    const glv_vec3_soa* extents, size_t n, uint32_t* mask);
+
+/*
+    Same tests, writing the indices of visible bounds in increasing
+    order instead. indices must have room for n entries.
+    Returns the number of indices written.
+*/
+GLV_API size_t glv_frustum_cull_spheres_indices(const glv_frustum_planes* f, const glv_vec3_soa* centres,
+    const float* radii, size_t n, uint32_t* indices);
+GLV_API size_t glv_frustum_cull_aabbs_indices(const glv_frustum_planes* f, const glv_vec3_soa* centres,
+    const glv_vec3_soa* extents, size_t n, uint32_t* indices);
+
+#endif /* GLV_CULL_H */
@@ -0,0 +1,87 @@
+/*
+    === fast.h ===
+
+    Fast approximate versions of functions that spend most of their
+    time in libm calls and divisions, for passes that do not need
+    full float precision (particles, lighting, culling helpers).
+
+    Each function is opt-in per call; the regular functions keep their
+    exact results. The fast versions use:
+
+        rsqrt       hardware estimate (SSE) refined by one Newton step
+        rcp         hardware estimate refined by one Newton step
+        sin, cos    quadrant reduction and minimax polynomials
+        tan         fast sin / cos
+
+    Maximum errors, as measured by testing_fast in tests/test.c
+    (relative errors for rsqrt and rcp, absolute for sin and cos over
+    |x| <= GLV_FAST_TRIG_RANGE):
+
+        glv_fast_rsqrt, glv_fast_rcp            4e-7
+        glv_fast_sin, glv_fast_cos              2e-7
+        glv_fast_tan                            4e-7 relative, |x| < 1.5
+        glv_vec*_fast_normalize                 length within 1 +- 4e-7
+
+    Hardware estimates differ between CPU vendors, so fast results are
+    not bit-identical across machines (unlike the rest of the library).
+
+    Speed against the precise functions is reported by tests/bench.c.
+    Single calls are not reliably faster than a current glibc and a
+    hardware divider: sinf, cosf and tanf are already fast polynomials.
+    The batch functions (glv_fast_sincos_array and
+    glv_vec3_soa_fast_normalize) are where the fast mode pays off, at
+    about 2x to 4x the precise loops.
+
+    Example:
+        glv_vec3 n = glv_vec3_fast_normalize(&normal);
+        glv_mat4 p = glv_fast_perspective(fovy, aspect, 0.1f, 100.0f);
+*/
+
+#ifndef GLV_FAST_H
+#define GLV_FAST_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+#include "soa.h"
+
+/* Largest |x| for which the trigonometric error bounds hold */
+#define GLV_FAST_TRIG_RANGE 8192.0f
+
+
+/* ----- Scalars ----- */
+
+/* 1 / sqrt(x) and 1 / x, for finite x > 0 and finite non-zero x */
+GLV_API float glv_fast_rsqrt(float x);
+GLV_API float glv_fast_rcp(float x);
+
+/* Angles in radians */
+GLV_API float glv_fast_sin(float x);
+GLV_API float glv_fast_cos(float x);
+GLV_API void glv_fast_sincos(float x, float* s, float* c);
+GLV_API float glv_fast_tan(float x);
+
+/* Sines and cosines of n angles, 4 or 8 per instruction. The arrays must not overlap */
+GLV_API void glv_fast_sincos_array(const float* x, float* s, float* c, size_t n);
+
+
+/* ----- Vectors ----- */
+
+/* Scales the vector to have length of 1 */
+GLV_API glv_vec2 glv_vec2_fast_normalize(const glv_vec2* v);
+GLV_API glv_vec3 glv_vec3_fast_normalize(const glv_vec3* v);
+GLV_API glv_vec4 glv_vec4_fast_normalize(const glv_vec4* v);
+
+/* Normalizes n vectors, 4 or 8 per instruction. out may equal v */
+GLV_API void glv_vec3_soa_fast_normalize(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n);
+
+
+/* ----- Matrix builders ----- */
+
+/* Same as glv_rotate, glv_frustum and glv_perspective (see transform.h) */
+GLV_API glv_mat4 glv_fast_rotate(const glv_mat4* mat, float angle, const glv_vec3* axis);
+GLV_API glv_mat4 glv_fast_frustum(float left, float right, float bottom, float top, float near, float far);
+GLV_API glv_mat4 glv_fast_perspective(float fovy, float aspect, float near, float far);
+
+#endif /* GLV_FAST_H */
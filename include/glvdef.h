@@ -0,0 +1,38 @@
+/*
+    === glvdef.h ===
+
+    Build configuration shared by all headers.
+
+    By default the library is compiled into lib/libglv.a and every
+    function is an ordinary external symbol.
+
+    Defining GLV_HEADER_ONLY (or GLV_INLINE) before including glvmath.h
+    pulls the whole implementation in as static inline functions, so
+    the compiler can inline, constant-fold and keep values in registers
+    across calls. Nothing needs to be linked in that mode, but the src/
+    folder must sit next to include/ as in this repository.
+
+    The implementation then follows the caller's compiler flags. The
+    library itself is built with -ffp-contract=off; use the same flag to
+    keep results bit-identical to lib/libglv.a, otherwise the compiler
+    may fuse multiply-adds in the AVX-512 and -march=native code paths.
+*/
+
+#ifndef GLV_DEF_H
+#define GLV_DEF_H 1
+
+#if defined(GLV_INLINE) && !defined(GLV_HEADER_ONLY)
+    #define GLV_HEADER_ONLY 1
+#endif
+
+/* Linkage of every public function */
+#ifdef GLV_HEADER_ONLY
+    #define GLV_API static inline
+#else
+    #define GLV_API
+#endif
+
+/* Minimum alignment in bytes of a type, e.g. typedef glv_mat4 glv_mat4a64 GLV_ALIGNED(64) */
+#define GLV_ALIGNED(n) __attribute__((aligned(n)))
+
+#endif /* GLV_DEF_H */
@@ -1,3 +1,60 @@
+/*
+    === glvmath.h ===
+
+    Single include for the whole library. Define GLV_HEADER_ONLY
+    before including it to use the library without linking (see glvdef.h).
+*/
+
+#ifndef GLV_MATH_H
+#define GLV_MATH_H 1
+
+#include "glvdef.h"
 #include "vec.h"
 #include "mat.h"
-#include "transform.h"
\ No newline at end of file
+#include "transform.h"
+#include "simd.h"
+#include "soa.h"
+#include "hierarchy.h"
+#include "pool.h"
+#include "quat.h"
+#include "affine.h"
+#include "cull.h"
+#include "half.h"
+#include "dmat.h"
+#include "fast.h"
+#include "skin.h"
+#include "pack.h"
+#include "profile.h"
+#include "arena.h"
+#include "camera.h"
+#include "ray.h"
+#include "bvh.h"
+#include "ivec.h"
+#include "stream.h"
+
+#ifdef GLV_HEADER_ONLY
+    #include "../src/vec.c"
+    #include "../src/simd.c"
+    #include "../src/mat.c"
+    #include "../src/transform.c"
+    #include "../src/soa.c"
+    #include "../src/hierarchy.c"
+    #include "../src/pool.c"
+    #include "../src/quat.c"
+    #include "../src/affine.c"
+    #include "../src/cull.c"
+    #include "../src/half.c"
+    #include "../src/dmat.c"
+    #include "../src/fast.c"
+    #include "../src/skin.c"
+    #include "../src/pack.c"
+    #include "../src/profile.c"
+    #include "../src/arena.c"
+    #include "../src/camera.c"
+    #include "../src/ray.c"
+    #include "../src/bvh.c"
+    #include "../src/ivec.c"
+    #include "../src/stream.c"
+#endif
+
+#endif /* GLV_MATH_H */
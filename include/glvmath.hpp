@@ -0,0 +1,308 @@
+/*
+    === glvmath.hpp ===
+
+    C++17 interface over the C library. glv::mat4 derives from glv_mat4
+    and glv::vec4 holds a glv_vec4 as its only member, so both keep the
+    C layout: &m converts to a glv_mat4*, and &v.c is a glv_vec4*.
+
+    Products are expression templates. Nothing is computed until
+    the expression is assigned or converted to a mat4 or vec4, and the
+    whole expression is then evaluated inline:
+
+        matrix results      left to right, as glv_mat4_nmultiply
+        vector results      right to left, one matrix-vector product
+                            per matrix, however the source groups them
+
+    A chain of N matrices applied to a vector costs 16N multiplications
+    right to left, against 64(N-1) + 16 when the matrices are
+    multiplied first, so proj * view * model * v runs as three
+    matrix-vector products and no temporary matrix is formed.
+
+    The kernels are the scalar ones of the C library (simd.c) with the
+    same order of operations, so matrix results are bit-identical to
+    glv_mat4_multiply on the scalar, SSE2 and AVX backends. Regrouping
+    a vector chain changes rounding like any reassociation.
+
+    identity, ortho, frustum and perspective are constexpr. They use
+    the formulas of transform.c, so the first three match the C builders
+    exactly. perspective computes its tangent in double and rounds it
+    to float, where glibc tanf is off by one ulp for a few percent of
+    angles, so the two may differ in the last bit.
+
+    Expressions hold references to named operands. Assign them to a
+    mat4 or vec4 rather than to auto when an operand is a temporary.
+
+    Example:
+        constexpr glv::mat4 proj = glv::perspective(0.8f, 1.5f, 0.1f, 100.0f);
+        glv::mat4 view = glv_lookat(&eye, &centre, &up);
+        glv::vec4 clip = proj * view * model * glv::vec4(x, y, z, 1.0f);
+        printf("%f\n", clip.c.w);
+        glv::mat4 mvp = proj * view * model;
+        glv_mat4_inverse(&mvp);
+
+    Header-only mode (GLV_HEADER_ONLY) is C only, link lib/libglv.a
+    to call the C functions from C++.
+*/
+
+#ifndef GLV_MATH_HPP
+#define GLV_MATH_HPP 1
+
+#if __cplusplus < 201703L
+    #error "glvmath.hpp requires C++17"
+#endif
+
+#ifdef GLV_HEADER_ONLY
+    #error "glvmath.hpp does not support GLV_HEADER_ONLY, link lib/libglv.a instead"
+#endif
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+extern "C" {
+#include "glvmath.h"
+}
+
+namespace glv {
+
+namespace detail {
+    struct mat_tag {};
+    struct vec_tag {};
+
+    template<class T, class = void> struct kind { using type = void; };
+    template<class T> struct kind<T, std::void_t<typename T::glv_kind>> { using type = typename T::glv_kind; };
+
+    template<class T> constexpr bool is_mat = std::is_same_v<typename kind<std::decay_t<T>>::type, mat_tag>;
+    template<class T> constexpr bool is_vec = std::is_same_v<typename kind<std::decay_t<T>>::type, vec_tag>;
+
+    /* Named operands are kept by reference, temporaries by value */
+    template<class T> using operand = std::conditional_t<std::is_lvalue_reference_v<T>,
+        const std::decay_t<T>&, std::decay_t<T>>;
+}
+
+
+/* ----- Types ----- */
+
+/* glv_vec4 is a union, which cannot be a base class, so it is held as c */
+struct vec4 {
+    using glv_kind = detail::vec_tag;
+    glv_vec4 c;
+
+    constexpr vec4() : c{} {}
+    constexpr vec4(float x, float y, float z, float w) : c{{x, y, z, w}} {}
+    constexpr vec4(const glv_vec4& v) : c(v) {}
+
+    /* Evaluates a vector expression */
+    template<class E, std::enable_if_t<detail::is_vec<E> && !std::is_same_v<std::decay_t<E>, vec4>, int> = 0>
+    constexpr vec4(const E& e) : vec4(e.eval()) {}
+
+    constexpr operator const glv_vec4&() const { return c; }
+
+    constexpr float& operator[](std::size_t i){ return c.data[i]; }
+    constexpr float operator[](std::size_t i) const { return c.data[i]; }
+
+    constexpr const vec4& eval() const { return *this; }
+};
+
+struct mat4 : glv_mat4 {
+    using glv_kind = detail::mat_tag;
+
+    constexpr mat4() : glv_mat4{} {}
+    constexpr mat4(const glv_mat4& m) : glv_mat4(m) {}
+
+    /* Evaluates a matrix expression */
+    template<class E, std::enable_if_t<detail::is_mat<E> && !std::is_same_v<std::decay_t<E>, mat4>, int> = 0>
+    constexpr mat4(const E& e) : mat4(e.eval()) {}
+
+    /* Diagonal of ones */
+    static constexpr mat4 identity(){
+        mat4 m;
+        for(std::size_t i = 0; i != GLV_MAT4_RANK; ++i) m.data[i][i] = 1.0f;
+        return m;
+    }
+
+    /* Element at row i, column j */
+    constexpr float& operator()(std::size_t i, std::size_t j){ return data[i][j]; }
+    constexpr float operator()(std::size_t i, std::size_t j) const { return data[i][j]; }
+
+    constexpr const mat4& eval() const { return *this; }
+
+    /* Matrix-vector product, same order as transform_scalar in simd.c */
+    constexpr vec4 apply(const vec4& v) const {
+        vec4 t;
+        for(std::size_t i = 0; i != GLV_MAT4_RANK; ++i){
+            for(std::size_t j = 0; j != GLV_MAT4_RANK; ++j){
+                t.c.data[i] += v.c.data[j] * data[i][j];
+            }
+        }
+        return t;
+    }
+
+    /* acc * this, same order as mat4_multiply_scalar in simd.c */
+    constexpr mat4 times_left(const mat4& acc) const {
+        mat4 s;
+        for(std::size_t i = 0; i != GLV_MAT4_RANK; ++i){
+            for(std::size_t j = 0; j != GLV_MAT4_RANK; ++j){
+                for(std::size_t k = 0; k != GLV_MAT4_RANK; ++k){
+                    s.data[i][j] += acc.data[i][k] * data[k][j];
+                }
+            }
+        }
+        return s;
+    }
+};
+
+static_assert(sizeof(vec4) == sizeof(glv_vec4) && std::is_standard_layout_v<vec4>, "vec4 must keep the C layout");
+static_assert(sizeof(mat4) == sizeof(glv_mat4) && std::is_standard_layout_v<mat4>, "mat4 must keep the C layout");
+
+
+/* ----- Expressions ----- */
+
+/* L * R, both matrix expressions */
+template<class L, class R>
+struct mat_product {
+    using glv_kind = detail::mat_tag;
+    detail::operand<L> l;
+    detail::operand<R> r;
+
+    constexpr vec4 apply(const vec4& v) const { return l.apply(r.apply(v)); }
+    constexpr mat4 times_left(const mat4& acc) const { return r.times_left(l.times_left(acc)); }
+    constexpr mat4 eval() const { return r.times_left(mat4(l.eval())); }
+};
+
+/* M * v, a matrix expression times a vector expression */
+template<class M, class V>
+struct mat_vec_product {
+    using glv_kind = detail::vec_tag;
+    detail::operand<M> m;
+    detail::operand<V> v;
+
+    constexpr vec4 eval() const { return m.apply(vec4(v.eval())); }
+};
+
+/* Element-wise a + b (or a - b), and s * a */
+template<class A, class B, bool Subtract>
+struct vec_sum {
+    using glv_kind = detail::vec_tag;
+    detail::operand<A> a;
+    detail::operand<B> b;
+
+    constexpr vec4 eval() const {
+        const vec4 x = a.eval(), y = b.eval();
+        vec4 t;
+        for(std::size_t i = 0; i != GLV_VEC4_LEN; ++i){
+            if constexpr(Subtract) t.c.data[i] = x.c.data[i] - y.c.data[i];
+            else t.c.data[i] = x.c.data[i] + y.c.data[i];
+        }
+        return t;
+    }
+};
+
+template<class A>
+struct vec_scaled {
+    using glv_kind = detail::vec_tag;
+    detail::operand<A> a;
+    float s;
+
+    constexpr vec4 eval() const {
+        const vec4 x = a.eval();
+        vec4 t;
+        for(std::size_t i = 0; i != GLV_VEC4_LEN; ++i) t.c.data[i] = s * x.c.data[i];
+        return t;
+    }
+};
+
+
+/* ----- Operators ----- */
+
+template<class L, class R, std::enable_if_t<detail::is_mat<L> && detail::is_mat<R>, int> = 0>
+constexpr mat_product<L, R> operator*(L&& l, R&& r){
+    return {std::forward<L>(l), std::forward<R>(r)};
+}
+
+template<class M, class V, std::enable_if_t<detail::is_mat<M> && detail::is_vec<V>, int> = 0>
+constexpr mat_vec_product<M, V> operator*(M&& m, V&& v){
+    return {std::forward<M>(m), std::forward<V>(v)};
+}
+
+template<class A, class B, std::enable_if_t<detail::is_vec<A> && detail::is_vec<B>, int> = 0>
+constexpr vec_sum<A, B, false> operator+(A&& a, B&& b){
+    return {std::forward<A>(a), std::forward<B>(b)};
+}
+
+template<class A, class B, std::enable_if_t<detail::is_vec<A> && detail::is_vec<B>, int> = 0>
+constexpr vec_sum<A, B, true> operator-(A&& a, B&& b){
+    return {std::forward<A>(a), std::forward<B>(b)};
+}
+
+template<class A, std::enable_if_t<detail::is_vec<A>, int> = 0>
+constexpr vec_scaled<A> operator*(float s, A&& a){
+    return {std::forward<A>(a), s};
+}
+
+template<class A, std::enable_if_t<detail::is_vec<A>, int> = 0>
+constexpr vec_scaled<A> operator*(A&& a, float s){
+    return {std::forward<A>(a), s};
+}
+
+
+/* ----- Builders ----- */
+
+namespace detail {
+    /* tan in double, for |x| < pi/2 after reduction by pi */
+    constexpr double tan(double x){
+        const double pi = 3.14159265358979323846;
+        const double k = x / pi;
+        x -= pi * (double)(long long)(k < 0.0 ? k - 0.5 : k + 0.5);
+        double s = x, c = 1.0, ts = x, tc = 1.0, z = x * x;
+        for(int n = 1; n != 14; ++n){
+            ts *= -z / ((2 * n) * (2 * n + 1));
+            tc *= -z / ((2 * n - 1) * (2 * n));
+            s += ts;
+            c += tc;
+        }
+        return s / c;
+    }
+}
+
+/* Same as glv_ortho */
+constexpr mat4 ortho(float left, float right, float bottom, float top, float near, float far){
+    mat4 m;
+    m.data[0][0] = 2.0f/(right-left);
+    m.data[1][1] = 2.0f/(top-bottom);
+    m.data[2][2] = -2.0f/(far-near);
+    m.data[3][3] = 1.0f;
+
+    m.data[0][3] = - (right + left) / (right - left);
+    m.data[1][3] = - (top + bottom) / (top - bottom);
+    m.data[2][3] = - (far + near) / (far - near);
+    return m;
+}
+
+/* Same as glv_frustum */
+constexpr mat4 frustum(float left, float right, float bottom, float top, float near, float far){
+    mat4 m;
+    m.data[0][0] = 2.0 * near / (right - left);
+    m.data[1][1] = 2.0 * near / (top - bottom);
+    m.data[2][2] = - (far + near) / (far - near);
+
+    m.data[0][2] = (right + left) / (right - left);
+    m.data[1][2] = (top + bottom) / (top - bottom);
+    m.data[3][2] = -1.0f;
+    m.data[2][3] = - 2.0f * far * near / (far - near);
+    return m;
+}
+
+/* Same as glv_perspective */
+constexpr mat4 perspective(float fovy, float aspect, float near, float far){
+    #ifdef GLV_USE_DEGREES
+        fovy = fovy * 3.14159265358979323846 / 180.0f;
+    #endif
+    const float h = near * (float)detail::tan(fovy / 2.0f);
+    const float w = aspect * h;
+    return frustum(-w, w, -h, h, near, far);
+}
+
+} /* namespace glv */
+
+#endif /* GLV_MATH_HPP */
@@ -0,0 +1,59 @@
+/*
+    === half.h ===
+
+    Half-precision (IEEE 754 binary16) storage for vectors.
+
+    A glv_half holds the bits of a 16-bit float: 1 sign bit, 5 exponent
+    bits and 10 mantissa bits, about 3 decimal digits over +-65504.
+    Half vectors are meant for large vertex, normal or colour streams,
+    which take half the memory and bandwidth of their float versions.
+    They are converted to float for any arithmetic.
+
+    Conversion rounds to nearest even, keeps subnormals, overflows to
+    infinity and keeps NaNs as quiet NaNs. The batch conversions use
+    F16C instructions when the CPU has them (from the AVX level up)
+    and give the same bits as the scalar conversions in all cases.
+
+    Example:
+        glv_hvec3 packed[N];
+        glv_vec3_to_hvec3(normals, packed, N);
+        ...
+        glv_hvec3_to_vec3(packed, normals, N);
+*/
+
+#ifndef GLV_HALF_H
+#define GLV_HALF_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "glvdef.h"
+#include "vec.h"
+
+typedef uint16_t glv_half;
+
+GLV_VEC2__DECL(glv_half) glv_hvec2;
+GLV_VEC3__DECL(glv_half) glv_hvec3;
+GLV_VEC4__DECL(glv_half) glv_hvec4;
+
+
+/* ----- Single values ----- */
+
+GLV_API glv_half glv_half_from_float(float f);
+GLV_API float glv_half_to_float(glv_half h);
+
+
+/* ----- Batch conversion ----- */
+
+/* Converts n values, the arrays must not overlap */
+GLV_API void glv_half_from_float_array(const float* in, glv_half* out, size_t n);
+GLV_API void glv_half_to_float_array(const glv_half* in, float* out, size_t n);
+
+/* Converts n packed vectors, the arrays must not overlap */
+GLV_API void glv_vec2_to_hvec2(const glv_vec2* in, glv_hvec2* out, size_t n);
+GLV_API void glv_vec3_to_hvec3(const glv_vec3* in, glv_hvec3* out, size_t n);
+GLV_API void glv_vec4_to_hvec4(const glv_vec4* in, glv_hvec4* out, size_t n);
+GLV_API void glv_hvec2_to_vec2(const glv_hvec2* in, glv_vec2* out, size_t n);
+GLV_API void glv_hvec3_to_vec3(const glv_hvec3* in, glv_vec3* out, size_t n);
+GLV_API void glv_hvec4_to_vec4(const glv_hvec4* in, glv_vec4* out, size_t n);
+
+#endif /* GLV_HALF_H */
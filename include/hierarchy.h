@@ -0,0 +1,80 @@
+/*
+    === hierarchy.h ===
+
+    Flat transform hierarchy with cached world matrices.
+
+    Nodes live in caller-owned arrays sorted so that every parent comes
+    before its children (parent[i] < i). Each node stores a local
+    translation, rotation and scale, the local matrix built from them
+    (T * R * S) and its world matrix (parent world * local).
+
+    Setters only mark a node dirty. glv_hierarchy_update then walks the
+    arrays once, front to back, rebuilding the local matrix of changed
+    nodes and the world matrix of changed nodes and all their
+    descendants. Untouched subtrees cost one flag test per node.
+
+    Example:
+        unsigned int parent[N];
+        glv_vec3 t[N], s[N];
+        glv_mat3 r[N];
+        glv_mat4 local[N], world[N];
+        unsigned char dirty[N];
+        glv_hierarchy h = {N, parent, t, r, s, local, world, dirty};
+        ... fill parent[] ...
+        glv_hierarchy_init(&h);
+        glv_hierarchy_set_translation(&h, 5, &(glv_vec3){.x = 1.0f});
+        glv_hierarchy_update(&h);
+*/
+
+#ifndef GLV_HIERARCHY_H
+#define GLV_HIERARCHY_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+
+/* Parent index of nodes without a parent */
+#define GLV_NODE_ROOT ((unsigned int)-1)
+
+/* Dirty flags */
+#define GLV_NODE_LOCAL_DIRTY 1  /* translation, rotation or scale changed */
+#define GLV_NODE_WORLD_DIRTY 2  /* world matrix must be recomputed */
+
+typedef struct {
+    size_t count;
+    const unsigned int* parent;     /* parent[i] < i, or GLV_NODE_ROOT */
+    glv_vec3* translation;
+    glv_mat3* rotation;             /* orthonormal */
+    glv_vec3* scale;
+    glv_mat4* local;                /* cached T * R * S */
+    glv_mat4* world;                /* cached parent world * local */
+    unsigned char* dirty;           /* GLV_NODE_* flags */
+} glv_hierarchy;
+
+
+/* Resets every node to the identity transform and marks it dirty */
+GLV_API void glv_hierarchy_init(const glv_hierarchy* h);
+
+/* Returns 1 if every parent index precedes its child, 0 otherwise */
+GLV_API int glv_hierarchy_is_sorted(const glv_hierarchy* h);
+
+/* Set the local components of node i and mark it dirty */
+GLV_API void glv_hierarchy_set_translation(const glv_hierarchy* h, size_t i, const glv_vec3* t);
+GLV_API void glv_hierarchy_set_scale(const glv_hierarchy* h, size_t i, const glv_vec3* s);
+GLV_API void glv_hierarchy_set_rotation(const glv_hierarchy* h, size_t i, const glv_mat3* r);
+
+/* Same as above, from an angle and axis as in glv_rotate */
+GLV_API void glv_hierarchy_set_rotation_axis(const glv_hierarchy* h, size_t i, float angle, const glv_vec3* axis);
+
+/* Marks node i for a local and world rebuild, e.g. after writing the arrays directly */
+GLV_API void glv_hierarchy_mark_dirty(const glv_hierarchy* h, size_t i);
+
+/*
+    Brings the local and world matrices of all dirty nodes and their
+    descendants up to date, and clears the dirty flags.
+    Returns the number of world matrices recomputed.
+*/
+GLV_API size_t glv_hierarchy_update(const glv_hierarchy* h);
+
+#endif /* GLV_HIERARCHY_H */
@@ -0,0 +1,122 @@
+/*
+    === ivec.h ===
+
+    Batch operations on integer vectors, for voxel grids, cell
+    coordinates and spatial hashing, and Morton (Z-order) codes.
+
+    The batch functions work on arrays of n packed glv_ivecN or
+    glv_uvecN, which are processed as flat int arrays: 4 (SSE2, AVX),
+    8 (AVX2) or 16 (AVX-512) components per instruction. Results are
+    the same at every level. Addition wraps around. Outputs may be the
+    same arrays as the inputs, but must not otherwise overlap them.
+
+    glv_vecN_floor_to_ivecN maps points to the cells of a grid,
+    floor((p - origin) * scale) per component, saturating at the int
+    range, with NaN giving INT_MIN.
+
+    The hash mixes the components into 32 well-distributed bits, to
+    index a power-of-two hash table of cells with hash & (size - 1).
+
+    Morton codes interleave the bits of the coordinates, x lowest, so
+    that cells close in space tend to be close in the code order:
+    2D codes take 16 bits per axis into 32, 3D codes 21 bits per axis
+    into 63. Higher coordinate bits are ignored. Signed coordinates
+    must be offset to non-negative first. The batch versions use the
+    BMI2 pdep and pext instructions from the AVX2 level when the CPU
+    has them, and the same bit tricks as the single-value versions
+    otherwise. On AMD processors before Zen 3, pdep and pext are slow
+    microcode; glv_simd_set_level(GLV_SIMD_AVX) avoids them.
+
+    glv_vec3_to_morton quantizes points in a box to 21 bits per axis
+    and encodes them, so that sorting points by their codes orders them
+    along the Z curve.
+
+    Example:
+        glv_ivec3 cells[N];
+        uint32_t slots[N];
+        glv_vec3_floor_to_ivec3(points, &grid_origin, &(glv_vec3){.x=4.0f, .y=4.0f, .z=4.0f}, cells, N);
+        glv_ivec3_hash_batch(cells, slots, N);
+        for(size_t i = 0; i != N; ++i) insert(&table[slots[i] & (TABLE_SIZE - 1)], i);
+*/
+
+#ifndef GLV_IVEC_H
+#define GLV_IVEC_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "glvdef.h"
+#include "vec.h"
+
+
+/* ----- Element-wise batches ----- */
+
+/* out = a + b over n vectors */
+GLV_API void glv_ivec2_add_batch(const glv_ivec2* a, const glv_ivec2* b, glv_ivec2* out, size_t n);
+GLV_API void glv_ivec3_add_batch(const glv_ivec3* a, const glv_ivec3* b, glv_ivec3* out, size_t n);
+GLV_API void glv_ivec4_add_batch(const glv_ivec4* a, const glv_ivec4* b, glv_ivec4* out, size_t n);
+GLV_API void glv_uvec2_add_batch(const glv_uvec2* a, const glv_uvec2* b, glv_uvec2* out, size_t n);
+GLV_API void glv_uvec3_add_batch(const glv_uvec3* a, const glv_uvec3* b, glv_uvec3* out, size_t n);
+GLV_API void glv_uvec4_add_batch(const glv_uvec4* a, const glv_uvec4* b, glv_uvec4* out, size_t n);
+
+/* Component-wise minimum and maximum of a and b over n vectors */
+GLV_API void glv_ivec2_min_batch(const glv_ivec2* a, const glv_ivec2* b, glv_ivec2* out, size_t n);
+GLV_API void glv_ivec3_min_batch(const glv_ivec3* a, const glv_ivec3* b, glv_ivec3* out, size_t n);
+GLV_API void glv_ivec4_min_batch(const glv_ivec4* a, const glv_ivec4* b, glv_ivec4* out, size_t n);
+GLV_API void glv_uvec2_min_batch(const glv_uvec2* a, const glv_uvec2* b, glv_uvec2* out, size_t n);
+GLV_API void glv_uvec3_min_batch(const glv_uvec3* a, const glv_uvec3* b, glv_uvec3* out, size_t n);
+GLV_API void glv_uvec4_min_batch(const glv_uvec4* a, const glv_uvec4* b, glv_uvec4* out, size_t n);
+GLV_API void glv_ivec2_max_batch(const glv_ivec2* a, const glv_ivec2* b, glv_ivec2* out, size_t n);
+GLV_API void glv_ivec3_max_batch(const glv_ivec3* a, const glv_ivec3* b, glv_ivec3* out, size_t n);
+GLV_API void glv_ivec4_max_batch(const glv_ivec4* a, const glv_ivec4* b, glv_ivec4* out, size_t n);
+GLV_API void glv_uvec2_max_batch(const glv_uvec2* a, const glv_uvec2* b, glv_uvec2* out, size_t n);
+GLV_API void glv_uvec3_max_batch(const glv_uvec3* a, const glv_uvec3* b, glv_uvec3* out, size_t n);
+GLV_API void glv_uvec4_max_batch(const glv_uvec4* a, const glv_uvec4* b, glv_uvec4* out, size_t n);
+
+/* Clamps n vectors between the same lo and hi, lo <= hi */
+GLV_API void glv_ivec2_clamp_batch(const glv_ivec2* v, const glv_ivec2* lo, const glv_ivec2* hi, glv_ivec2* out, size_t n);
+GLV_API void glv_ivec3_clamp_batch(const glv_ivec3* v, const glv_ivec3* lo, const glv_ivec3* hi, glv_ivec3* out, size_t n);
+GLV_API void glv_ivec4_clamp_batch(const glv_ivec4* v, const glv_ivec4* lo, const glv_ivec4* hi, glv_ivec4* out, size_t n);
+GLV_API void glv_uvec2_clamp_batch(const glv_uvec2* v, const glv_uvec2* lo, const glv_uvec2* hi, glv_uvec2* out, size_t n);
+GLV_API void glv_uvec3_clamp_batch(const glv_uvec3* v, const glv_uvec3* lo, const glv_uvec3* hi, glv_uvec3* out, size_t n);
+GLV_API void glv_uvec4_clamp_batch(const glv_uvec4* v, const glv_uvec4* lo, const glv_uvec4* hi, glv_uvec4* out, size_t n);
+
+/* Grid cells of n points, floor((in - origin) * scale) */
+GLV_API void glv_vec2_floor_to_ivec2(const glv_vec2* in, const glv_vec2* origin, const glv_vec2* scale,
+    glv_ivec2* out, size_t n);
+GLV_API void glv_vec3_floor_to_ivec3(const glv_vec3* in, const glv_vec3* origin, const glv_vec3* scale,
+    glv_ivec3* out, size_t n);
+GLV_API void glv_vec4_floor_to_ivec4(const glv_vec4* in, const glv_vec4* origin, const glv_vec4* scale,
+    glv_ivec4* out, size_t n);
+
+
+/* ----- Hashing ----- */
+
+GLV_API uint32_t glv_ivec2_hash(const glv_ivec2* v);
+GLV_API uint32_t glv_ivec3_hash(const glv_ivec3* v);
+
+/* Hashes of n vectors, the same as the single-value versions */
+GLV_API void glv_ivec2_hash_batch(const glv_ivec2* in, uint32_t* out, size_t n);
+GLV_API void glv_ivec3_hash_batch(const glv_ivec3* in, uint32_t* out, size_t n);
+
+
+/* ----- Morton codes ----- */
+
+GLV_API uint32_t glv_morton2_encode(uint32_t x, uint32_t y);
+GLV_API uint64_t glv_morton3_encode(uint32_t x, uint32_t y, uint32_t z);
+GLV_API glv_uvec2 glv_morton2_decode(uint32_t code);
+GLV_API glv_uvec3 glv_morton3_decode(uint64_t code);
+
+/* Codes of n coordinates and back */
+GLV_API void glv_uvec2_to_morton(const glv_uvec2* in, uint32_t* out, size_t n);
+GLV_API void glv_uvec3_to_morton(const glv_uvec3* in, uint64_t* out, size_t n);
+GLV_API void glv_morton_to_uvec2(const uint32_t* in, glv_uvec2* out, size_t n);
+GLV_API void glv_morton_to_uvec3(const uint64_t* in, glv_uvec3* out, size_t n);
+
+/*
+    Codes of n points quantized to 2^21 steps per axis of the box
+    (min, max). Points outside the box are clamped to its faces.
+*/
+GLV_API void glv_vec3_to_morton(const glv_vec3* in, const glv_vec3* min, const glv_vec3* max,
+    uint64_t* out, size_t n);
+
+#endif /* GLV_IVEC_H */
@@ -11,6 +11,8 @@
 #ifndef GLV_MAT_H
 #define GLV_MAT_H 1
 
+#include <stddef.h>
+#include "glvdef.h"
 #include "vec.h"
 
 #define GLV_MAT2_RANK 2
@@ -22,12 +24,27 @@ typedef struct{ float data[2][2]; } glv_mat2;
 typedef struct{ float data[3][3]; } glv_mat3;
 typedef struct{ float data[4][4]; } glv_mat4;
 
+/*
+    glv_mat4 aligned to 16, 32 or 64 bytes (a cache line). The layout is
+    unchanged and they convert to glv_mat4 pointers, so every function
+    taking a glv_mat4 takes them too. The _a64 batch functions below use
+    aligned loads and stores on them.
+*/
+typedef glv_mat4 glv_mat4a16 GLV_ALIGNED(16);
+typedef glv_mat4 glv_mat4a32 GLV_ALIGNED(32);
+typedef glv_mat4 glv_mat4a64 GLV_ALIGNED(64);
+
+/* Double precision, operations in dmat.h */
+typedef struct{ double data[4][4]; } glv_dmat4;
+
+/* Affine matrix: the top three rows of a glv_mat4 whose bottom row is 0,0,0,1 (see affine.h) */
+typedef struct{ float data[3][4]; } glv_mat3x4;
+
 /*
 // Additional matrix definitions
 typedef struct{ float data[2][3] } glv_mat2x3;
 typedef struct{ float data[2][4] } glv_mat2x4;
 typedef struct{ float data[3][2] } glv_mat3x2;
-typedef struct{ float data[3][4] } glv_mat3x4;
 typedef struct{ float data[4][2] } glv_mat4x2;
 typedef struct{ float data[4][3] } glv_mat4x3;
 */
@@ -40,43 +57,84 @@ typedef struct{ float data[4][3] } glv_mat4x3;
 /* ----- Matrix Creation ----- */
 
 /* Returns a 4x4 diagonal matrix with given diagonal elements */
-glv_mat4 glv_mat4_diagonal(float e00, float e11, float e22, float e33);
+GLV_API glv_mat4 glv_mat4_diagonal(float e00, float e11, float e22, float e33);
 
 /* Returns an 4x4 identity matrix */
-glv_mat4 glv_mat4_identity();
+GLV_API glv_mat4 glv_mat4_identity();
 
 /* ----- Matrix Operations ----- */
 /* Returns the transpose matrix */
-glv_mat2 glv_mat2_transpose(const glv_mat2* mat);
-glv_mat3 glv_mat3_transpose(const glv_mat3* mat);
-glv_mat4 glv_mat4_transpose(const glv_mat4* mat);
+GLV_API glv_mat2 glv_mat2_transpose(const glv_mat2* mat);
+GLV_API glv_mat3 glv_mat3_transpose(const glv_mat3* mat);
+GLV_API glv_mat4 glv_mat4_transpose(const glv_mat4* mat);
 
 /* Returns the minor of a matrix at i,j */
-float glv_mat3_minor(const glv_mat3* m, unsigned int i, unsigned int j);
-float glv_mat4_minor(const glv_mat4* m, unsigned int i, unsigned int j);
+GLV_API float glv_mat3_minor(const glv_mat3* m, unsigned int i, unsigned int j);
+GLV_API float glv_mat4_minor(const glv_mat4* m, unsigned int i, unsigned int j);
 
 /* Returns the determinant of a matrix */
-float glv_mat2_determinant(const glv_mat2* mat);
-float glv_mat3_determinant(const glv_mat3* mat);
-float glv_mat4_determinant(const glv_mat4* mat);
+GLV_API float glv_mat2_determinant(const glv_mat2* mat);
+GLV_API float glv_mat3_determinant(const glv_mat3* mat);
+GLV_API float glv_mat4_determinant(const glv_mat4* mat);
 
 /* Calculates the cofactor matrix */
-glv_mat3 glv_mat3_cofactors(const glv_mat3* mat);
-glv_mat4 glv_mat4_cofactors(const glv_mat4* mat);
+GLV_API glv_mat3 glv_mat3_cofactors(const glv_mat3* mat);
+GLV_API glv_mat4 glv_mat4_cofactors(const glv_mat4* mat);
+
+/* Calculates the inverse matrix. Singular matrices give a zero matrix */
+GLV_API glv_mat3 glv_mat3_inverse(const glv_mat3* mat);
+GLV_API glv_mat4 glv_mat4_inverse(const glv_mat4* mat);
 
-/* Calculates the inverse matrix */
-glv_mat3 glv_mat3_inverse(const glv_mat3* mat);
-glv_mat4 glv_mat4_inverse(const glv_mat4* mat);
+/* Writes the inverse to out, returns 0 if the matrix is singular (out zeroed) */
+GLV_API int glv_mat4_inverse_status(const glv_mat4* mat, glv_mat4* out);
+
+/* Inverse of an affine matrix (bottom row 0,0,0,1), e.g. rigid or TRS */
+GLV_API glv_mat4 glv_mat4_inverse_affine(const glv_mat4* mat);
+
+/*
+    Inverts n matrices, out may be the same array as in.
+    status[i] is set to 0 for singular matrices and 1 otherwise (may be NULL).
+    Returns the number of singular matrices.
+*/
+GLV_API size_t glv_mat4_inverse_batch(const glv_mat4* in, glv_mat4* out, size_t n, unsigned char* status);
 
 /* Multiplies two matrices */
-glv_mat2 glv_mat2_multiply(const glv_mat2* m1, const glv_mat2* m2);
-glv_mat3 glv_mat3_multiply(const glv_mat3* m1, const glv_mat3* m2);
-glv_mat4 glv_mat4_multiply(const glv_mat4* m1, const glv_mat4* m2);
-
-/* Multiplies n matrices in series */
-glv_mat2 glv_mat2_nmultiply(unsigned int num, ...);
-glv_mat3 glv_mat3_nmultiply(unsigned int num, ...);
-glv_mat4 glv_mat4_nmultiply(unsigned int num, ...);
+GLV_API glv_mat2 glv_mat2_multiply(const glv_mat2* m1, const glv_mat2* m2);
+GLV_API glv_mat3 glv_mat3_multiply(const glv_mat3* m1, const glv_mat3* m2);
+GLV_API glv_mat4 glv_mat4_multiply(const glv_mat4* m1, const glv_mat4* m2);
+
+/* Multiplies every matrix of an array from the left, out[i] = m * in[i]. out may equal in */
+GLV_API void glv_mat4_multiply_array(const glv_mat4* m, const glv_mat4* in, glv_mat4* out, size_t n);
+
+/*
+    Multiplies two arrays pairwise, out[i] = a[i] * b[i], e.g. a skinning
+    palette from world and inverse bind matrices. out may equal a or b.
+    Each product is identical to glv_mat4_multiply.
+*/
+GLV_API void glv_mat4_multiply_pairs(const glv_mat4* a, const glv_mat4* b, glv_mat4* out, size_t n);
+
+/*
+    Same as the two above for cache-line aligned arrays, e.g. from
+    glv_arena_mat4, with aligned loads and stores. m itself needs no
+    alignment. Each product is identical to glv_mat4_multiply.
+*/
+GLV_API void glv_mat4_multiply_array_a64(const glv_mat4* m, const glv_mat4a64* in, glv_mat4a64* out, size_t n);
+GLV_API void glv_mat4_multiply_pairs_a64(const glv_mat4a64* a, const glv_mat4a64* b, glv_mat4a64* out, size_t n);
+
+/* Multiplies n matrices in series, leaving the operands untouched */
+GLV_API glv_mat2 glv_mat2_nmultiply(unsigned int num, ...);
+GLV_API glv_mat3 glv_mat3_nmultiply(unsigned int num, ...);
+GLV_API glv_mat4 glv_mat4_nmultiply(unsigned int num, ...);
+
+/*
+    Writes mats[0] * mats[1] * ... * mats[n-1] to out (identity if n is 0).
+    The inputs are never modified, and out may point to one of them.
+    The product is taken left to right; see pool.h for a parallel version.
+*/
+GLV_API void glv_mat4_multiply_chain(const glv_mat4* const* mats, size_t n, glv_mat4* out);
+
+/* Same as above over a contiguous array */
+GLV_API void glv_mat4_multiply_chain_array(const glv_mat4* mats, size_t n, glv_mat4* out);
 
 
 
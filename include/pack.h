@@ -0,0 +1,77 @@
+/*
+    === pack.h ===
+
+    Writers that lay out arrays for GPU buffers, straight into mapped
+    memory: matrices column-major as GLSL expects, and elements padded
+    to the std140 or std430 array rules.
+
+                    packed      std140      std430
+        float       4           16          4
+        vec2        8           16          8
+        vec3        12          16          16
+        vec4        16          16          16
+        mat2        16          32          16
+        mat3        36          48          48
+        mat4        64          64          64
+
+    Sizes are the array stride in bytes. Padded matrix columns and
+    vec3 elements are vec4s whose unused lanes are written as zero, so
+    no stale memory reaches the GPU.
+
+    Every writer takes a destination stride, 0 for a tight array in the
+    chosen layout, or e.g. the size of a per-instance struct to fill one
+    of its members. It returns the stride used.
+
+    Writes of at least GLV_PACK_STREAM_BYTES whose destination and
+    stride are multiples of 16 bytes use non-temporal stores, which go
+    around the cache. That suits write-combined mapped memory and data
+    the CPU will not read back. The writer ends with a store fence, so
+    the data is visible once it returns.
+
+    Example:
+        glv_mat4* mvp = ...;
+        void* mapped = glMapBufferRange(...);
+        glv_pack_mat4(mapped, 0, mvp, count);
+        glv_pack_mat3(mapped + normals_offset, 0, normal_mats, count, GLV_LAYOUT_STD140);
+*/
+
+#ifndef GLV_PACK_H
+#define GLV_PACK_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+
+/* Smallest write that uses non-temporal stores, about an L2 cache */
+#ifndef GLV_PACK_STREAM_BYTES
+    #define GLV_PACK_STREAM_BYTES (256 * 1024)
+#endif
+
+typedef enum {
+    GLV_LAYOUT_PACKED,      /* no padding, e.g. vertex attributes or glUniformMatrix*fv */
+    GLV_LAYOUT_STD140,      /* uniform blocks */
+    GLV_LAYOUT_STD430       /* shader storage blocks */
+} glv_layout;
+
+
+/* Array stride in bytes of a type with n floats (1, 2, 3 or 4) per column and c columns */
+GLV_API size_t glv_pack_stride(unsigned int n, unsigned int c, glv_layout layout);
+
+
+/* ----- Matrices, written column-major ----- */
+
+/* mat4 has the same layout in every rule */
+GLV_API size_t glv_pack_mat4(void* dst, size_t dst_stride, const glv_mat4* m, size_t count);
+GLV_API size_t glv_pack_mat3(void* dst, size_t dst_stride, const glv_mat3* m, size_t count, glv_layout layout);
+GLV_API size_t glv_pack_mat2(void* dst, size_t dst_stride, const glv_mat2* m, size_t count, glv_layout layout);
+
+
+/* ----- Vectors and scalars ----- */
+
+GLV_API size_t glv_pack_vec4(void* dst, size_t dst_stride, const glv_vec4* v, size_t count);
+GLV_API size_t glv_pack_vec3(void* dst, size_t dst_stride, const glv_vec3* v, size_t count, glv_layout layout);
+GLV_API size_t glv_pack_vec2(void* dst, size_t dst_stride, const glv_vec2* v, size_t count, glv_layout layout);
+GLV_API size_t glv_pack_float(void* dst, size_t dst_stride, const float* f, size_t count, glv_layout layout);
+
+#endif /* GLV_PACK_H */
@@ -0,0 +1,107 @@
+/*
+    === pool.h ===
+
+    Optional worker pool and parallel versions of the batch operations.
+
+    The pool is started once with glv_pool_start and kept for the life
+    of the program. Parallel functions split their input into chunks of
+    about GLV_POOL_CHUNK_BYTES, deal them out evenly to the workers and
+    the calling thread, and let any thread that runs dry steal chunks
+    from the back of another thread's share. The call returns when the
+    whole batch is done.
+
+    Without a running pool, or for batches smaller than the threshold
+    set with glv_pool_set_min_items, the serial function is called
+    directly. Results are identical to the serial functions either way.
+
+    Only one parallel call runs at a time; concurrent callers wait for
+    their turn. Building with GLV_NO_THREADS makes glv_pool_start fail
+    and every parallel function serial. In header-only mode each
+    translation unit has its own pool.
+
+    Example:
+        glv_pool_start(0);      // one thread per core
+        glv_transform_batch_parallel(points, 0, points, 0, count, &model);
+        glv_pool_stop();
+*/
+
+#ifndef GLV_POOL_H
+#define GLV_POOL_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "mat.h"
+#include "soa.h"
+#include "skin.h"
+#include "bvh.h"
+
+/* Upper limit on the number of threads, calling thread included */
+#define GLV_POOL_MAX_THREADS 64
+
+/* Target size of one chunk of work, about a third of a typical L2 */
+#ifndef GLV_POOL_CHUNK_BYTES
+    #define GLV_POOL_CHUNK_BYTES (64 * 1024)
+#endif
+
+/* Default minimum batch size handled in parallel */
+#ifndef GLV_POOL_MIN_ITEMS
+    #define GLV_POOL_MIN_ITEMS 16384
+#endif
+
+
+/* ----- Pool control ----- */
+
+/*
+    Starts the pool with the given number of threads including the
+    caller (0 for one per online core). A running pool is restarted.
+    Returns the number of threads in use, 1 meaning serial.
+*/
+GLV_API unsigned int glv_pool_start(unsigned int threads);
+
+/* Joins the workers, parallel calls run serially afterwards */
+GLV_API void glv_pool_stop(void);
+
+/* Returns the number of threads in use, caller included (1 if stopped) */
+GLV_API unsigned int glv_pool_threads(void);
+
+/* Batches of fewer items than this run serially */
+GLV_API void glv_pool_set_min_items(size_t n);
+
+
+/* ----- Parallel batch operations ----- */
+
+/* See glv_transform_batch and glv_transform_batch_vec3 */
+GLV_API void glv_transform_batch_parallel(const glv_vec4* in, size_t in_stride,
+    glv_vec4* out, size_t out_stride, size_t count, const glv_mat4* m);
+GLV_API void glv_transform_batch_vec3_parallel(const glv_vec3* in, size_t in_stride,
+    glv_vec3* out, size_t out_stride, size_t count, const glv_mat4* m);
+
+/* See glv_vec*_soa_normalize */
+GLV_API void glv_vec2_soa_normalize_parallel(const glv_vec2_soa* v, const glv_vec2_soa* out, size_t n);
+GLV_API void glv_vec3_soa_normalize_parallel(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n);
+GLV_API void glv_vec4_soa_normalize_parallel(const glv_vec4_soa* v, const glv_vec4_soa* out, size_t n);
+
+/* See glv_mat4_multiply_array */
+GLV_API void glv_mat4_multiply_array_parallel(const glv_mat4* m, const glv_mat4* in, glv_mat4* out, size_t n);
+
+/*
+    See glv_mat4_multiply_chain. Chains longer than 1024 matrices are
+    cut into at most 256 blocks that depend only on n; the block
+    products are taken in parallel and then multiplied in order. The
+    regrouping rounds slightly differently from the serial product, but
+    the result does not depend on the pool or the number of threads.
+*/
+GLV_API void glv_mat4_multiply_chain_parallel(const glv_mat4* const* mats, size_t n, glv_mat4* out);
+GLV_API void glv_mat4_multiply_chain_array_parallel(const glv_mat4* mats, size_t n, glv_mat4* out);
+
+/* See glv_skin_vertices */
+GLV_API void glv_skin_vertices_parallel(const glv_skin_stream* s, const glv_mat4* palette);
+
+/*
+    See glv_bvh_build. The top levels are split on the calling thread
+    until there are enough subtrees to share out, then the subtrees are
+    built in parallel. The tree is the same as from glv_bvh_build.
+*/
+GLV_API size_t glv_bvh_build_parallel(glv_bvh* b, unsigned int leaf_size);
+
+#endif /* GLV_POOL_H */
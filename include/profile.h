@@ -0,0 +1,76 @@
+/*
+    === profile.h ===
+
+    Call counts and timings of every public function, for builds made
+    with GLV_PROFILE defined ('make lib PROFILE=1', or defined before
+    including glvmath.h in header-only mode).
+
+    Each thread counts into its own block, so the counters need no
+    locks or atomic read-modify-writes. Blocks are allocated on the
+    first call from a thread and kept after it exits, so the counts of
+    finished workers still show up. Timings are off by default; once
+    enabled with glv_profile_set_timing they read the time-stamp
+    counter on x86 and the monotonic clock elsewhere. They are
+    inclusive: glv_mat4_nmultiply also counts the time of the
+    glv_mat4_multiply calls it makes. glv_simd_get_level, queried by
+    the other functions on every call, is not counted.
+
+    Without GLV_PROFILE the per-function hooks expand to nothing and the
+    functions below report an empty profile.
+
+    Example:
+        glv_profile_set_timing(1);
+        render_frame();
+        glv_profile_snapshot snap;
+        glv_profile_take(&snap);
+        glv_profile_write(&snap, stdout, GLV_PROFILE_TEXT);
+        glv_profile_reset();
+*/
+
+#ifndef GLV_PROFILE_H
+#define GLV_PROFILE_H 1
+
+#include <stdio.h>
+#include <stdint.h>
+#include "glvdef.h"
+
+/* Most functions tracked, later ones are counted together as "(other)" */
+#ifndef GLV_PROFILE_MAX_SITES
+    #define GLV_PROFILE_MAX_SITES 512
+#endif
+
+typedef struct {
+    const char* name;
+    uint64_t calls;
+    uint64_t ticks;             /* 0 unless timing was enabled */
+} glv_profile_entry;
+
+/* Counts summed over every thread, most time (then most calls) first */
+typedef struct {
+    size_t count;               /* functions called at least once */
+    double ticks_per_second;
+    glv_profile_entry entries[GLV_PROFILE_MAX_SITES + 1];
+} glv_profile_snapshot;
+
+typedef enum {
+    GLV_PROFILE_TEXT,
+    GLV_PROFILE_JSON
+} glv_profile_format;
+
+
+/* 1 if the library was built with GLV_PROFILE */
+GLV_API int glv_profile_enabled(void);
+
+/* Starts (1) or stops (0) timing calls, counting goes on either way */
+GLV_API void glv_profile_set_timing(int enabled);
+
+/* Sums the counters of every thread into out */
+GLV_API void glv_profile_take(glv_profile_snapshot* out);
+
+/* Zeroes every counter. Calls running on other threads at the time may be partly kept. */
+GLV_API void glv_profile_reset(void);
+
+/* Writes a snapshot as an aligned table or as a JSON object */
+GLV_API void glv_profile_write(const glv_profile_snapshot* snap, FILE* f, glv_profile_format format);
+
+#endif /* GLV_PROFILE_H */
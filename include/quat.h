@@ -0,0 +1,95 @@
+/*
+    === quat.h ===
+
+    Rotation quaternions.
+
+    A quaternion is stored as x, y, z (vector part) and w (scalar part),
+    with the same layout as glv_vec4. Rotations follow glv_rotate: the
+    angle is in radians (degrees with GLV_USE_DEGREES), counter-clockwise
+    about the axis, and glv_quat_multiply(a, b) rotates by b first, then
+    by a, like the matrix product of the two rotations.
+
+    Composing two rotations takes 16 multiplies instead of 64 for mat4,
+    and a quaternion converts to a matrix with 9 products.
+
+    Example:
+        glv_quat yaw = glv_quat_axis_angle(0.5f, &(glv_vec3){.y = 1.0f});
+        glv_quat pitch = glv_quat_axis_angle(0.2f, &(glv_vec3){.x = 1.0f});
+        glv_quat q = glv_quat_multiply(&yaw, &pitch);
+        glv_mat4 r = glv_quat_to_mat4(&q);
+*/
+
+#ifndef GLV_QUAT_H
+#define GLV_QUAT_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+
+typedef union {
+    float data[4];
+    struct { float x, y, z, w; };
+} glv_quat;
+
+
+/* ----- Creation ----- */
+
+/* Returns the identity rotation */
+GLV_API glv_quat glv_quat_identity(void);
+
+/* Rotation by an angle about an axis, which need not be normalized */
+GLV_API glv_quat glv_quat_axis_angle(float angle, const glv_vec3* axis);
+
+/* Rotation part of a matrix, which must be a pure rotation (no scale) */
+GLV_API glv_quat glv_quat_from_mat3(const glv_mat3* m);
+GLV_API glv_quat glv_quat_from_mat4(const glv_mat4* m);
+
+
+/* ----- Operations ----- */
+
+/* Product a * b, the rotation b followed by a */
+GLV_API glv_quat glv_quat_multiply(const glv_quat* a, const glv_quat* b);
+
+/* Scales the quaternion to have length of 1 */
+GLV_API glv_quat glv_quat_normalize(const glv_quat* q);
+
+/* Negates the vector part, which inverts a unit quaternion */
+GLV_API glv_quat glv_quat_conjugate(const glv_quat* q);
+
+/* Inverse of any non-zero quaternion */
+GLV_API glv_quat glv_quat_inverse(const glv_quat* q);
+
+/* Calculates the 4D dot product */
+GLV_API float glv_quat_dot(const glv_quat* a, const glv_quat* b);
+
+/* Rotates a vector by a unit quaternion */
+GLV_API glv_vec3 glv_quat_rotate(const glv_quat* q, const glv_vec3* v);
+
+/* Interpolates along the shorter arc, t in [0, 1]. nlerp is faster but not constant speed */
+GLV_API glv_quat glv_quat_nlerp(const glv_quat* a, const glv_quat* b, float t);
+GLV_API glv_quat glv_quat_slerp(const glv_quat* a, const glv_quat* b, float t);
+
+/* Rotation matrix of a unit quaternion */
+GLV_API glv_mat3 glv_quat_to_mat3(const glv_quat* q);
+GLV_API glv_mat4 glv_quat_to_mat4(const glv_quat* q);
+
+
+/* ----- Batch operations ----- */
+
+/*
+    Element-wise over arrays of n quaternions. Outputs may be the same
+    arrays as the inputs. Each result is identical to the single version.
+*/
+GLV_API void glv_quat_multiply_batch(const glv_quat* a, const glv_quat* b, glv_quat* out, size_t n);
+GLV_API void glv_quat_normalize_batch(const glv_quat* q, glv_quat* out, size_t n);
+GLV_API void glv_quat_to_mat4_batch(const glv_quat* q, glv_mat4* out, size_t n);
+
+/*
+    Rotates n vectors by the same unit quaternion, out may equal in.
+    Same as glv_transform_batch_vec3 with glv_quat_to_mat4(q), which is
+    faster than glv_quat_rotate per vector but rounds slightly differently.
+*/
+GLV_API void glv_quat_rotate_batch(const glv_quat* q, const glv_vec3* in, glv_vec3* out, size_t n);
+
+#endif /* GLV_QUAT_H */
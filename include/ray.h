@@ -0,0 +1,131 @@
+/*
+    === ray.h ===
+
+    Ray intersection against triangles (Moller-Trumbore) and axis-aligned
+    boxes (slab test), for picking and line-of-sight queries.
+
+    Primitives are read from structure-of-arrays streams, and the batch
+    functions test one ray against 4 (SSE2), 8 (AVX, AVX2) or 16
+    (AVX-512) primitives per instruction, or a packet of rays held as
+    streams against one primitive. Every level computes the same
+    expressions in the same order as the scalar code, without fused
+    multiply-adds, so the results are identical.
+
+    Triangles are stored as a vertex and the two edges from it, as the
+    intersection test uses them; glv_triangle_soa_set fills one from
+    three vertices. Both sides of a triangle are hit. Hits lie strictly
+    in front of the origin (t > 0) and before t_max, where t is measured
+    in lengths of the direction, which need not be normalized. A hit at
+    p = v0 + u * (v1 - v0) + v * (v2 - v0) has barycentrics (1-u-v, u, v).
+    When several primitives are hit at the same distance, the lowest
+    index wins.
+
+    Example:
+        glv_ray r = {.origin = eye, .direction = dir};
+        glv_ray_hit hit;
+        if(glv_ray_triangles_nearest(&r, &mesh, triangle_count, INFINITY, &hit)){
+            pick(hit.index, hit.u, hit.v);
+        }
+*/
+
+#ifndef GLV_RAY_H
+#define GLV_RAY_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "soa.h"
+
+/* Index of a ray that hit nothing */
+#define GLV_RAY_MISS UINT32_MAX
+
+/* Number of 32-bit words in the bitmask of n boxes or rays */
+#define GLV_RAY_MASK_WORDS(n) (((n) + 31) / 32)
+
+typedef struct {
+    glv_vec3 origin;
+    glv_vec3 direction;
+} glv_ray;
+
+/* Packet of rays as streams */
+typedef struct {
+    glv_vec3_soa origin;
+    glv_vec3_soa direction;
+} glv_ray_soa;
+
+typedef struct {
+    float t;                    /* distance along the ray */
+    float u, v;                 /* barycentrics of the second and third vertex */
+    uint32_t index;             /* primitive hit, GLV_RAY_MISS for none */
+} glv_ray_hit;
+
+/* Nearest hits of a packet, one entry per ray */
+typedef struct {
+    float* t;
+    float* u;
+    float* v;
+    uint32_t* index;
+} glv_ray_hit_soa;
+
+/* Triangles as a vertex v0 and the edges e1 = v1 - v0, e2 = v2 - v0 */
+typedef struct {
+    glv_vec3_soa v0, e1, e2;
+} glv_triangle_soa;
+
+/* Boxes as their minimum and maximum corners */
+typedef struct {
+    glv_vec3_soa min, max;
+} glv_aabb_soa;
+
+
+/* Stores triangle (a, b, c) at index i */
+GLV_API void glv_triangle_soa_set(const glv_triangle_soa* tris, size_t i,
+    const glv_vec3* a, const glv_vec3* b, const glv_vec3* c);
+
+
+/* ----- One ray, many primitives ----- */
+
+/*
+    Finds the nearest of n triangles hit before t_max. Returns 1 and
+    fills hit if there is one, otherwise returns 0 and sets hit->index
+    to GLV_RAY_MISS and hit->t to t_max.
+*/
+GLV_API int glv_ray_triangles_nearest(const glv_ray* r, const glv_triangle_soa* tris, size_t n,
+    float t_max, glv_ray_hit* hit);
+
+/*
+    Tests n boxes, setting bit i % 32 of mask[i / 32] for boxes entered
+    before t_max (GLV_RAY_MASK_WORDS(n) words, bits past n cleared).
+    t_enter, if not NULL, gets the entry distance of each box hit, 0
+    when the origin is inside, and INFINITY for misses.
+    Returns the number of boxes hit.
+*/
+GLV_API size_t glv_ray_aabbs(const glv_ray* r, const glv_aabb_soa* boxes, size_t n,
+    float t_max, uint32_t* mask, float* t_enter);
+
+/* Index of the box entered first before t_max, written to *t, or GLV_RAY_MISS */
+GLV_API uint32_t glv_ray_aabbs_nearest(const glv_ray* r, const glv_aabb_soa* boxes, size_t n,
+    float t_max, float* t);
+
+
+/* ----- Many rays, one primitive ----- */
+
+/*
+    Tests n rays against triangle (a, b, c) and records it as the hit of
+    every ray that meets it closer than hits->t, with the given index.
+    Start hits->t at each ray's t_max and hits->index at GLV_RAY_MISS,
+    then call once per triangle. Returns the number of hits recorded.
+*/
+GLV_API size_t glv_rays_triangle(const glv_ray_soa* rays, size_t n, const glv_vec3* a, const glv_vec3* b,
+    const glv_vec3* c, uint32_t index, const glv_ray_hit_soa* hits);
+
+/*
+    Tests n rays against the box (min, max), setting the mask bits of
+    rays that enter it before their t_max[i] (INFINITY if t_max is NULL).
+    Returns the number of rays that do.
+*/
+GLV_API size_t glv_rays_aabb(const glv_ray_soa* rays, size_t n, const glv_vec3* min, const glv_vec3* max,
+    const float* t_max, uint32_t* mask);
+
+#endif /* GLV_RAY_H */
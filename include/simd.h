@@ -0,0 +1,53 @@
+/*
+    === simd.h ===
+
+    Selection of the SIMD backend used by the hot kernels
+    (glv_mat4_multiply, glv_transform).
+
+    The fastest backend supported by the CPU is picked once at
+    startup using cpuid. A specific backend can be forced at build
+    time by defining GLV_SIMD_FORCE to one of the levels below, e.g.
+
+        make lib SIMD=AVX2      (-DGLV_SIMD_FORCE=GLV_SIMD_AVX2)
+
+    A forced level is used as-is, even if the CPU does not support it.
+    AVX512 currently only widens the stream kernels (soa.h); the matrix
+    kernels run the AVX2 code at that level.
+
+    Accuracy with respect to the scalar backend:
+        SSE2, AVX   bit-identical (same products, same summation order).
+        AVX2+       uses fused multiply-add, so each partial sum is
+                    rounded once instead of twice. Every element differs
+                    from scalar by at most 16 ULP of the largest absolute
+                    product k_i * l_i of its 4-term sum (a bound from the
+                    summation error of both paths; tests observe <= 6).
+                    There is no bound relative to the result itself
+                    when the sum cancels.
+*/
+
+#ifndef GLV_SIMD_H
+#define GLV_SIMD_H 1
+
+#include "glvdef.h"
+
+typedef enum {
+    GLV_SIMD_SCALAR = 0,
+    GLV_SIMD_SSE2,
+    GLV_SIMD_AVX,
+    GLV_SIMD_AVX2,
+    GLV_SIMD_AVX512
+} glv_simd_level;
+
+/* Returns the highest level supported by the running CPU */
+GLV_API glv_simd_level glv_simd_detect(void);
+
+/* Returns the level currently in use */
+GLV_API glv_simd_level glv_simd_get_level(void);
+
+/* Switches backend, clamped to what the CPU supports. Returns the level set */
+GLV_API glv_simd_level glv_simd_set_level(glv_simd_level level);
+
+/* Returns a readable name for a level */
+GLV_API const char* glv_simd_name(glv_simd_level level);
+
+#endif /* GLV_SIMD_H */
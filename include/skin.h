@@ -0,0 +1,73 @@
+/*
+    === skin.h ===
+
+    Linear blend skinning on the CPU.
+
+    Each bone contributes a palette matrix, world * inverse bind, built
+    for the whole skeleton with glv_mat4_multiply_pairs (mat.h). Every
+    vertex is then moved by the weighted sum of four palette matrices:
+
+        M = w0 * palette[j0] + w1 * palette[j1] + w2 * palette[j2] + w3 * palette[j3]
+        position = M * (position, 1)
+        normal   = M * (normal, 0)
+
+    Palette matrices must be affine, their bottom row is not read.
+    Weights are used as given and should add up to 1; vertices with
+    fewer influences give the rest weight 0 and any valid index.
+    Normals are not renormalized, and only stay perpendicular to the
+    surface when the palette has no non-uniform scale.
+
+    Vertex data is read through strides as in glv_transform_batch_vec3,
+    so interleaved vertex buffers can be used in place. The SSE2 and AVX
+    kernels (two vertices per instruction) give the same results as the
+    scalar code. glv_skin_vertices_parallel (pool.h) splits large meshes
+    across the worker pool.
+
+    Example:
+        glv_mat4_multiply_pairs(world, inverse_bind, palette, bone_count);
+        glv_skin_stream s = {
+            .count = vertex_count,
+            .position = &vertices[0].position, .position_stride = sizeof(vertex),
+            .normal = &vertices[0].normal, .normal_stride = sizeof(vertex),
+            .joints = vertices[0].joints, .joints_stride = sizeof(vertex),
+            .weights = vertices[0].weights, .weights_stride = sizeof(vertex),
+            .out_position = out_positions, .out_normal = out_normals
+        };
+        glv_skin_vertices(&s, palette);
+*/
+
+#ifndef GLV_SKIN_H
+#define GLV_SKIN_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include "glvdef.h"
+#include "vec.h"
+#include "mat.h"
+
+/* Bone influences per vertex */
+#define GLV_SKIN_INFLUENCES 4
+
+/*
+    Input and output streams of one mesh. Strides are in bytes, 0 for
+    packed arrays. Outputs may equal their inputs. Leave normal and
+    out_normal NULL to skip normals.
+*/
+typedef struct {
+    size_t count;
+    const glv_vec3* position;   size_t position_stride;
+    const glv_vec3* normal;     size_t normal_stride;
+    const uint16_t* joints;     size_t joints_stride;   /* 4 palette indices */
+    const float* weights;       size_t weights_stride;  /* 4 weights */
+    glv_vec3* out_position;     size_t out_position_stride;
+    glv_vec3* out_normal;       size_t out_normal_stride;
+} glv_skin_stream;
+
+
+/* Skins every vertex of the stream with the given palette */
+GLV_API void glv_skin_vertices(const glv_skin_stream* s, const glv_mat4* palette);
+
+/* Skins vertices [begin, end) of the stream, e.g. to split a mesh between threads */
+GLV_API void glv_skin_vertices_range(const glv_skin_stream* s, const glv_mat4* palette, size_t begin, size_t end);
+
+#endif /* GLV_SKIN_H */
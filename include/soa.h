@@ -0,0 +1,67 @@
+/*
+    === soa.h ===
+
+    Structure-of-arrays vector streams.
+
+    Each component lives in its own float array, so that batch kernels
+    process 4, 8 or 16 elements per instruction (SSE2, AVX, AVX-512).
+    The arrays are owned by the caller and need no particular alignment.
+
+    Example:
+        float x[N], y[N], z[N], len[N];
+        glv_vec3_soa pos = {.x = x, .y = y, .z = z};
+        glv_vec3_to_soa(points, N, &pos);
+        glv_vec3_soa_magnitude(&pos, len, N);
+
+    Every kernel gives the same result per element as the matching
+    function in vec.h. Outputs may be the same arrays as the inputs,
+    but must not otherwise overlap them.
+*/
+
+#ifndef GLV_SOA_H
+#define GLV_SOA_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "vec.h"
+
+/* Stream declarations */
+typedef struct { float* x; float* y; } glv_vec2_soa;
+typedef struct { float* x; float* y; float* z; } glv_vec3_soa;
+typedef struct { float* x; float* y; float* z; float* w; } glv_vec4_soa;
+
+
+/* ----- Layout conversion ----- */
+
+/* Scatters n array-of-structures vectors into a stream */
+GLV_API void glv_vec2_to_soa(const glv_vec2* in, size_t n, const glv_vec2_soa* out);
+GLV_API void glv_vec3_to_soa(const glv_vec3* in, size_t n, const glv_vec3_soa* out);
+GLV_API void glv_vec4_to_soa(const glv_vec4* in, size_t n, const glv_vec4_soa* out);
+
+/* Gathers n elements of a stream into array-of-structures vectors */
+GLV_API void glv_vec2_from_soa(const glv_vec2_soa* in, size_t n, glv_vec2* out);
+GLV_API void glv_vec3_from_soa(const glv_vec3_soa* in, size_t n, glv_vec3* out);
+GLV_API void glv_vec4_from_soa(const glv_vec4_soa* in, size_t n, glv_vec4* out);
+
+
+/* ----- Batch operations ----- */
+
+/* Lengths of n vectors */
+GLV_API void glv_vec2_soa_magnitude(const glv_vec2_soa* v, float* out, size_t n);
+GLV_API void glv_vec3_soa_magnitude(const glv_vec3_soa* v, float* out, size_t n);
+GLV_API void glv_vec4_soa_magnitude(const glv_vec4_soa* v, float* out, size_t n);
+
+/* Scales n vectors to have length of 1 */
+GLV_API void glv_vec2_soa_normalize(const glv_vec2_soa* v, const glv_vec2_soa* out, size_t n);
+GLV_API void glv_vec3_soa_normalize(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n);
+GLV_API void glv_vec4_soa_normalize(const glv_vec4_soa* v, const glv_vec4_soa* out, size_t n);
+
+/* Element-wise dot products */
+GLV_API void glv_vec2_soa_dot(const glv_vec2_soa* a, const glv_vec2_soa* b, float* out, size_t n);
+GLV_API void glv_vec3_soa_dot(const glv_vec3_soa* a, const glv_vec3_soa* b, float* out, size_t n);
+GLV_API void glv_vec4_soa_dot(const glv_vec4_soa* a, const glv_vec4_soa* b, float* out, size_t n);
+
+/* Element-wise cross products */
+GLV_API void glv_vec3_soa_cross(const glv_vec3_soa* a, const glv_vec3_soa* b, const glv_vec3_soa* out, size_t n);
+
+#endif /* GLV_SOA_H */
@@ -0,0 +1,69 @@
+/*
+    === stream.h ===
+
+    Transforms vertex files of any size, far beyond memory, by mapping
+    them and running the batch transform over one chunk at a time.
+
+    Files hold raw packed floats, three (points, w=1 implied) or four
+    per vertex, in native byte order, with no header. The input is
+    mapped read-only and the output is sized to match and mapped
+    shared, so the kernels read the input's page cache and write the
+    results straight into the output's, with no buffers in between.
+
+    While a chunk is transformed, the next GLV_STREAM_PREFETCH chunks
+    are requested from the disk (MADV_WILLNEED), so reading overlaps
+    the compute. Finished chunks are handed back: the input pages are
+    dropped from the mapping and the output pages scheduled for
+    writing, which keeps the resident memory to a few chunks. Chunks
+    go through glv_transform_batch_parallel, so a running pool (pool.h)
+    splits each of them between its threads.
+
+    The output space is reserved up front where the system allows, so
+    a full disk fails the call instead of faulting in the middle of it.
+
+    Functions return 0, or the errno of the failing call. The output
+    file is left incomplete on errors. Available on POSIX systems;
+    elsewhere they return ENOSYS.
+
+    Example:
+        glv_stream_stats st;
+        glv_mat4 id = glv_mat4_identity(), m = glv_translate(&id, &offset);
+        if(glv_stream_transform_file("cloud.xyz", "moved.xyz", 3, &m, 0, &st) == 0)
+            printf("%.2f GB/s\n", (st.bytes_read + st.bytes_written) / st.seconds * 1e-9);
+*/
+
+#ifndef GLV_STREAM_H
+#define GLV_STREAM_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
+#include "mat.h"
+
+/* Default bytes of input per chunk, rounded to whole pages and vertices */
+#ifndef GLV_STREAM_CHUNK_BYTES
+    #define GLV_STREAM_CHUNK_BYTES (8 * 1024 * 1024)
+#endif
+
+/* Chunks requested ahead of the one being transformed */
+#ifndef GLV_STREAM_PREFETCH
+    #define GLV_STREAM_PREFETCH 2
+#endif
+
+typedef struct {
+    size_t vertices;
+    size_t bytes_read;
+    size_t bytes_written;
+    double seconds;             /* wall time from opening to unmapping */
+} glv_stream_stats;
+
+/*
+    Writes m times every vertex of in_path to out_path, created or
+    truncated. components is 3 or 4, and the input size must be a whole
+    number of vertices (EINVAL otherwise). out_path NULL, or naming the
+    input file, transforms it in place. chunk_bytes 0 uses
+    GLV_STREAM_CHUNK_BYTES. stats may be NULL.
+*/
+GLV_API int glv_stream_transform_file(const char* in_path, const char* out_path, unsigned int components,
+    const glv_mat4* m, size_t chunk_bytes, glv_stream_stats* stats);
+
+#endif /* GLV_STREAM_H */
@@ -1,38 +1,97 @@
 
+/*
+    === transform.h ===
+
+    Projection, view and model matrix builders,
+    and vector transforms.
+*/
+
+#ifndef GLV_TRANSFORM_H
+#define GLV_TRANSFORM_H 1
+
+#include <stddef.h>
+#include "glvdef.h"
 #include "mat.h"
+#include "quat.h"
+#include "soa.h"
 
 /* ----- Common ------- */
 
 /* Converts degrees to radians */
-float glv_radians(float deg);
+GLV_API float glv_radians(float deg);
 /* Converts radians to degrees */
-float glv_degrees(float rad);
+GLV_API float glv_degrees(float rad);
 
 /* ----- Matrix Creation ------ */
 
 /* Returns a 4x4 orthographic projection matrix */
-glv_mat4 glv_ortho2D(float left, float right, float bottom, float top);
-glv_mat4 glv_ortho(float left, float right, float bottom, float top, float near, float far);
+GLV_API glv_mat4 glv_ortho2D(float left, float right, float bottom, float top);
+GLV_API glv_mat4 glv_ortho(float left, float right, float bottom, float top, float near, float far);
 
 /* Generates a perspective 4x4 matrix */
-glv_mat4 glv_frustum(float left, float right, float bottom, float top, float near, float far);
-glv_mat4 glv_perspective(float fovy, float aspect, float near, float far);
-glv_mat4 glv_perspective_fov(float fov, float width, float height, float near, float far);
+GLV_API glv_mat4 glv_frustum(float left, float right, float bottom, float top, float near, float far);
+GLV_API glv_mat4 glv_perspective(float fovy, float aspect, float near, float far);
+GLV_API glv_mat4 glv_perspective_fov(float fov, float width, float height, float near, float far);
 
 /* Creates a look-at matrix (translation + rotation) */
-glv_mat4 glv_lookat(const glv_vec3* eye, const glv_vec3* centre, const glv_vec3* up);
+GLV_API glv_mat4 glv_lookat(const glv_vec3* eye, const glv_vec3* centre, const glv_vec3* up);
 
 
 /* ----- Matrix Transform ----- */
 
 /* Creates a 4x4 scaling matrix */
-glv_mat4 glv_scale(const glv_mat4* mat, const glv_vec3* scales);
+GLV_API glv_mat4 glv_scale(const glv_mat4* mat, const glv_vec3* scales);
 
 /* Creates a 4x4 translation matrix */
-glv_mat4 glv_translate(const glv_mat4* mat, const glv_vec3* displacement);
+GLV_API glv_mat4 glv_translate(const glv_mat4* mat, const glv_vec3* displacement);
 
 /* Creates 4x4 rotation matrix with given angle in degrees and axis */
-glv_mat4 glv_rotate(const glv_mat4* mat, float angle, const glv_vec3* axis);
+GLV_API glv_mat4 glv_rotate(const glv_mat4* mat, float angle, const glv_vec3* axis);
+
+/*
+    Model matrix T * R * S written directly, with the same result as
+    glv_scale(glv_mat4_multiply(glv_translate(I, t), R), s) for the
+    rotation matrix R of the unit quaternion r, in about 30 flops.
+*/
+GLV_API glv_mat4 glv_compose_trs(const glv_vec3* t, const glv_quat* r, const glv_vec3* s);
+
+/*
+    Same as above for n instances, with quaternions as x, y, z, w streams.
+    Each result is identical to glv_compose_trs.
+*/
+GLV_API void glv_compose_trs_batch(const glv_vec3_soa* t, const glv_vec4_soa* r,
+    const glv_vec3_soa* s, glv_mat4* out, size_t n);
+GLV_API void glv_compose_trs_batch_3x4(const glv_vec3_soa* t, const glv_vec4_soa* r,
+    const glv_vec3_soa* s, glv_mat3x4* out, size_t n);
+
+/*
+    Splits an affine matrix without shear into translation, rotation and
+    scale, so that glv_compose_trs(t, r, s) rebuilds it. A mirroring
+    (negative determinant) is returned as a negative x scale.
+    The scale must be non-zero on every axis.
+*/
+GLV_API void glv_decompose_trs(const glv_mat4* m, glv_vec3* t, glv_quat* r, glv_vec3* s);
 
 /* Transforms a given vector by a transformation matrix */
-glv_vec4 glv_transform(glv_vec4* v, glv_mat4* m);
\ No newline at end of file
+GLV_API glv_vec4 glv_transform(glv_vec4* v, glv_mat4* m);
+
+/*
+    Transforms count vectors of an array by the same matrix.
+    Strides are in bytes between consecutive elements, 0 meaning tightly packed.
+    out may be the same array as in (with the same stride), otherwise
+    the two must not overlap. Each result is identical to glv_transform.
+*/
+GLV_API void glv_transform_batch(const glv_vec4* in, size_t in_stride,
+    glv_vec4* out, size_t out_stride, size_t count, const glv_mat4* m);
+
+/* Same as above for points with implied w=1, writing xyz of the result */
+GLV_API void glv_transform_batch_vec3(const glv_vec3* in, size_t in_stride,
+    glv_vec3* out, size_t out_stride, size_t count, const glv_mat4* m);
+
+/*
+    Same for arrays of padded points, with aligned loads and stores and
+    results identical to glv_transform_batch_vec3. out may equal in.
+*/
+GLV_API void glv_transform_batch_vec3a(const glv_vec3a* in, glv_vec3a* out, size_t count, const glv_mat4* m);
+
+#endif /* GLV_TRANSFORM_H */
@@ -4,10 +4,13 @@
     Implementation of OpenGL Shading language (GLSL) vectors.
 
     Type names are 'glv_' followed by:
-        float   int     unsigned int
-    2D  fvec2   ivec2   uvec2
-    3D  fvec3   ivec3   uvec3
-    4D  fvec4   ivec4   uvec4
+        float   int     unsigned int    double
+    2D  fvec2   ivec2   uvec2           dvec2
+    3D  fvec3   ivec3   uvec3           dvec3
+    4D  fvec4   ivec4   uvec4           dvec4
+
+    Operations on double vectors are in dmat.h, and half-precision
+    storage vectors (hvec2, hvec3, hvec4) are declared in half.h.
     
     Members:
         xyzw for position
@@ -36,6 +39,8 @@
 #ifndef GLV_VEC_H
 #define GLV_VEC_H 1
 
+#include "glvdef.h"
+
 #define GLV_VEC2_LEN 2
 #define GLV_VEC3_LEN 3
 #define GLV_VEC4_LEN 4
@@ -86,30 +91,50 @@ GLV_VEC2__DECL(unsigned int) glv_uvec2;
 GLV_VEC3__DECL(unsigned int) glv_uvec3;
 GLV_VEC4__DECL(unsigned int) glv_uvec4;
 
+GLV_VEC2__DECL(double) glv_dvec2;
+GLV_VEC3__DECL(double) glv_dvec3;
+GLV_VEC4__DECL(double) glv_dvec4;
+
 typedef glv_fvec2 glv_vec2;
 typedef glv_fvec3 glv_vec3;
 typedef glv_fvec4 glv_vec4;
 
+/*
+    vec3 padded to 16 bytes and aligned to them, so that an element is
+    one aligned SSE load and never straddles a cache line. Pass xyz to
+    the glv_vec3 functions. The library writes the padding as 0.
+*/
+typedef union GLV_ALIGNED(16) {
+    float data[4];
+    glv_vec3 xyz;
+    struct{
+        union { float x; float s; float r; };
+        union { float y; float t; float g; };
+        union { float z; float u; float b; };
+        float pad;
+    };
+} glv_vec3a;
+
 /*
     Function Declarations
 */
 /* Returns the length of the vector */
-float glv_vec2_magnitude(const glv_vec2* v);
-float glv_vec3_magnitude(const glv_vec3* v);
-float glv_vec4_magnitude(const glv_vec4* v);
+GLV_API float glv_vec2_magnitude(const glv_vec2* v);
+GLV_API float glv_vec3_magnitude(const glv_vec3* v);
+GLV_API float glv_vec4_magnitude(const glv_vec4* v);
 
 /* Scales the vector to have length of 1 */
-glv_vec2 glv_vec2_normalize(const glv_vec2* v);
-glv_vec3 glv_vec3_normalize(const glv_vec3* v);
-glv_vec4 glv_vec4_normalize(const glv_vec4* v);
+GLV_API glv_vec2 glv_vec2_normalize(const glv_vec2* v);
+GLV_API glv_vec3 glv_vec3_normalize(const glv_vec3* v);
+GLV_API glv_vec4 glv_vec4_normalize(const glv_vec4* v);
 
 /* Calculates dot product */
-float glv_vec2_dot(const glv_vec2* v1, const glv_vec2* v2);
-float glv_vec3_dot(const glv_vec3* v1, const glv_vec3* v2);
-float glv_vec4_dot(const glv_vec4* v1, const glv_vec4* v2);
+GLV_API float glv_vec2_dot(const glv_vec2* v1, const glv_vec2* v2);
+GLV_API float glv_vec3_dot(const glv_vec3* v1, const glv_vec3* v2);
+GLV_API float glv_vec4_dot(const glv_vec4* v1, const glv_vec4* v2);
 
 /* Calculates cross product */
-glv_vec3 glv_vec3_cross(const glv_vec3* v1, const glv_vec3* v2);
+GLV_API glv_vec3 glv_vec3_cross(const glv_vec3* v1, const glv_vec3* v2);
 
 
 
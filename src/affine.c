@@ -0,0 +1,215 @@
+
+#include <string.h>
+#include "../include/affine.h"
+#include "simd_internal.h"
+#include "mat_internal.h"
+#include "profile_internal.h"
+
+
+/* ----- Creation and conversion ----- */
+
+GLV_API glv_mat3x4 glv_mat3x4_identity(void){
+    GLV_PROFILE_FUNC();
+    glv_mat3x4 m = {0};
+    m.data[0][0] = 1.0f;
+    m.data[1][1] = 1.0f;
+    m.data[2][2] = 1.0f;
+    return m;
+}
+
+GLV_API glv_mat3x4 glv_mat3x4_from_mat4(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    glv_mat3x4 a;
+    memcpy(a.data, m->data, sizeof(a.data));
+    return a;
+}
+
+GLV_API glv_mat4 glv_mat3x4_to_mat4(const glv_mat3x4* m){
+    GLV_PROFILE_FUNC();
+    glv_mat4 a;
+    memcpy(a.data, m->data, sizeof(m->data));
+    a.data[3][0] = 0.0f;
+    a.data[3][1] = 0.0f;
+    a.data[3][2] = 0.0f;
+    a.data[3][3] = 1.0f;
+    return a;
+}
+
+GLV_API void glv_mat3x4_from_mat4_batch(const glv_mat4* in, glv_mat3x4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i;
+    for(i = 0; i != n; ++i){
+        memcpy(out[i].data, in[i].data, sizeof(out[i].data));
+    }
+}
+
+GLV_API void glv_mat3x4_to_mat4_batch(const glv_mat3x4* in, glv_mat4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i;
+    for(i = 0; i != n; ++i){
+        out[i] = glv_mat3x4_to_mat4(&in[i]);
+    }
+}
+
+
+/* ----- Operations ----- */
+
+/*
+    Each element is (a0 * b0 + a1 * b1) + a2 * b2, plus a3 in the
+    translation column. The bottom row of b (0,0,0,1) is never read.
+    The SIMD paths add the translation as (-0, -0, -0, a3), which leaves
+    the other columns unchanged since x + (-0) == x for every x.
+*/
+static glv_mat3x4 mat3x4_multiply_scalar(const glv_mat3x4* a, const glv_mat3x4* b){
+    glv_mat3x4 s;
+    unsigned int i, j;
+    for(i = 0; i != 3; ++i){
+        for(j = 0; j != 4; ++j){
+            s.data[i][j] = a->data[i][0] * b->data[0][j] + a->data[i][1] * b->data[1][j]
+                + a->data[i][2] * b->data[2][j];
+        }
+        s.data[i][3] += a->data[i][3];
+    }
+    return s;
+}
+
+GLV_API glv_mat3x4 glv_mat3x4_multiply(const glv_mat3x4* a, const glv_mat3x4* b){
+    GLV_PROFILE_FUNC();
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        const __m128 b0 = _mm_loadu_ps(b->data[0]);
+        const __m128 b1 = _mm_loadu_ps(b->data[1]);
+        const __m128 b2 = _mm_loadu_ps(b->data[2]);
+        const __m128 keep = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+        const __m128 nz = _mm_set_ps(0.0f, -0.0f, -0.0f, -0.0f);
+        glv_mat3x4 s;
+        unsigned int r;
+        for(r = 0; r != 3; ++r){
+            const __m128 ar = _mm_loadu_ps(a->data[r]);
+            __m128 t = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(ar, ar, 0x00), b0),
+                _mm_mul_ps(_mm_shuffle_ps(ar, ar, 0x55), b1));
+            t = _mm_add_ps(t, _mm_mul_ps(_mm_shuffle_ps(ar, ar, 0xAA), b2));
+            t = _mm_add_ps(t, _mm_or_ps(_mm_and_ps(ar, keep), nz));
+            _mm_storeu_ps(s.data[r], t);
+        }
+        return s;
+    }
+#endif
+    return mat3x4_multiply_scalar(a, b);
+}
+
+/* Writes the inverse to out, returns 0 if singular */
+static int mat3x4_inverse(const glv_mat3x4* m, glv_mat3x4* out){
+    const float (*a)[4] = m->data;
+    glv_mat3x4 inv;
+    float lin[3][3];
+    unsigned int i, j;
+
+    // inverse of the linear part, translation becomes -A^-1 * t
+    if(!mat3_block_inverse(a[0], a[1], a[2], lin)){
+        *out = (glv_mat3x4){0};
+        return 0;
+    }
+    for(i = 0; i != 3; ++i){
+        for(j = 0; j != 3; ++j) inv.data[i][j] = lin[i][j];
+        inv.data[i][3] = -(lin[i][0] * a[0][3] + lin[i][1] * a[1][3] + lin[i][2] * a[2][3]);
+    }
+    *out = inv;
+    return 1;
+}
+
+GLV_API glv_mat3x4 glv_mat3x4_inverse(const glv_mat3x4* m){
+    GLV_PROFILE_FUNC();
+    glv_mat3x4 inv;
+    mat3x4_inverse(m, &inv);
+    return inv;
+}
+
+GLV_API glv_vec3 glv_mat3x4_transform_point(const glv_mat3x4* m, const glv_vec3* p){
+    GLV_PROFILE_FUNC();
+    glv_vec3 t;
+    unsigned int i;
+    for(i = 0; i != 3; ++i){
+        t.data[i] = m->data[i][0] * p->x + m->data[i][1] * p->y + m->data[i][2] * p->z + m->data[i][3];
+    }
+    return t;
+}
+
+GLV_API glv_vec3 glv_mat3x4_transform_dir(const glv_mat3x4* m, const glv_vec3* d){
+    GLV_PROFILE_FUNC();
+    glv_vec3 t;
+    unsigned int i;
+    for(i = 0; i != 3; ++i){
+        t.data[i] = m->data[i][0] * d->x + m->data[i][1] * d->y + m->data[i][2] * d->z;
+    }
+    return t;
+}
+
+
+/* ----- Batch operations ----- */
+
+GLV_API void glv_mat3x4_multiply_array(const glv_mat3x4* m, const glv_mat3x4* in, glv_mat3x4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const glv_mat3x4 l = *m; // m may point into out
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        const __m128 a00 = _mm_set1_ps(l.data[0][0]), a01 = _mm_set1_ps(l.data[0][1]), a02 = _mm_set1_ps(l.data[0][2]);
+        const __m128 a10 = _mm_set1_ps(l.data[1][0]), a11 = _mm_set1_ps(l.data[1][1]), a12 = _mm_set1_ps(l.data[1][2]);
+        const __m128 a20 = _mm_set1_ps(l.data[2][0]), a21 = _mm_set1_ps(l.data[2][1]), a22 = _mm_set1_ps(l.data[2][2]);
+        const __m128 t0 = _mm_set_ps(l.data[0][3], -0.0f, -0.0f, -0.0f);
+        const __m128 t1 = _mm_set_ps(l.data[1][3], -0.0f, -0.0f, -0.0f);
+        const __m128 t2 = _mm_set_ps(l.data[2][3], -0.0f, -0.0f, -0.0f);
+        for(; i != n; ++i){
+            const __m128 b0 = _mm_loadu_ps(in[i].data[0]);
+            const __m128 b1 = _mm_loadu_ps(in[i].data[1]);
+            const __m128 b2 = _mm_loadu_ps(in[i].data[2]);
+            __m128 s0 = _mm_add_ps(_mm_mul_ps(a00, b0), _mm_mul_ps(a01, b1));
+            __m128 s1 = _mm_add_ps(_mm_mul_ps(a10, b0), _mm_mul_ps(a11, b1));
+            __m128 s2 = _mm_add_ps(_mm_mul_ps(a20, b0), _mm_mul_ps(a21, b1));
+            s0 = _mm_add_ps(_mm_add_ps(s0, _mm_mul_ps(a02, b2)), t0);
+            s1 = _mm_add_ps(_mm_add_ps(s1, _mm_mul_ps(a12, b2)), t1);
+            s2 = _mm_add_ps(_mm_add_ps(s2, _mm_mul_ps(a22, b2)), t2);
+            _mm_storeu_ps(out[i].data[0], s0);
+            _mm_storeu_ps(out[i].data[1], s1);
+            _mm_storeu_ps(out[i].data[2], s2);
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out[i] = mat3x4_multiply_scalar(&l, &in[i]);
+    }
+}
+
+GLV_API size_t glv_mat3x4_inverse_batch(const glv_mat3x4* in, glv_mat3x4* out, size_t n, unsigned char* status){
+    GLV_PROFILE_FUNC();
+    size_t i, singular = 0;
+    int ok;
+    for(i = 0; i != n; ++i){
+        ok = mat3x4_inverse(&in[i], &out[i]);
+        if(status) status[i] = (unsigned char)ok;
+        singular += !ok;
+    }
+    return singular;
+}
+
+GLV_API void glv_mat3x4_transform_points(const glv_vec3* in, size_t in_stride,
+    glv_vec3* out, size_t out_stride, size_t count, const glv_mat3x4* m){
+    GLV_PROFILE_FUNC();
+    const glv_mat4 a = glv_mat3x4_to_mat4(m);
+    if(in_stride == 0) in_stride = sizeof(glv_vec3);
+    if(out_stride == 0) out_stride = sizeof(glv_vec3);
+    glv__simd.transform_batch3(in, in_stride, out, out_stride, count, &a);
+}
+
+GLV_API void glv_mat3x4_transform_dirs(const glv_vec3* in, size_t in_stride,
+    glv_vec3* out, size_t out_stride, size_t count, const glv_mat3x4* m){
+    GLV_PROFILE_FUNC();
+    glv_mat4 a = glv_mat3x4_to_mat4(m);
+    a.data[0][3] = 0.0f;
+    a.data[1][3] = 0.0f;
+    a.data[2][3] = 0.0f;
+    if(in_stride == 0) in_stride = sizeof(glv_vec3);
+    if(out_stride == 0) out_stride = sizeof(glv_vec3);
+    glv__simd.transform_batch3(in, in_stride, out, out_stride, count, &a);
+}
@@ -0,0 +1,66 @@
+
+#include <stdint.h>
+#include "../include/arena.h"
+#include "profile_internal.h"
+
+GLV_API void glv_arena_init(glv_arena* a, void* buffer, size_t size){
+    GLV_PROFILE_FUNC();
+    a->base = buffer;
+    a->size = buffer ? size : 0;
+    a->used = 0;
+    a->peak = 0;
+}
+
+GLV_API void* glv_arena_alloc(glv_arena* a, size_t bytes, size_t align){
+    GLV_PROFILE_FUNC();
+    if(align == 0) align = 1;
+    if(align & (align - 1)) return NULL;
+    // aligned to the address, the buffer itself may be less aligned
+    const uintptr_t cursor = (uintptr_t)a->base + a->used;
+    const size_t start = a->used + (size_t)(-cursor & (align - 1));
+    if(start > a->size || bytes > a->size - start) return NULL;
+    a->used = start + bytes;
+    if(a->used > a->peak) a->peak = a->used;
+    return a->base + start;
+}
+
+/* Typed arrays, count * size checked for overflow */
+static void* arena_array(glv_arena* a, size_t count, size_t size){
+    if(count > SIZE_MAX / size) return NULL;
+    return glv_arena_alloc(a, count * size, GLV_ARENA_ALIGN);
+}
+
+GLV_API glv_mat4a64* glv_arena_mat4(glv_arena* a, size_t count){
+    GLV_PROFILE_FUNC();
+    return arena_array(a, count, sizeof(glv_mat4));
+}
+
+GLV_API glv_vec4* glv_arena_vec4(glv_arena* a, size_t count){
+    GLV_PROFILE_FUNC();
+    return arena_array(a, count, sizeof(glv_vec4));
+}
+
+GLV_API glv_vec3a* glv_arena_vec3a(glv_arena* a, size_t count){
+    GLV_PROFILE_FUNC();
+    return arena_array(a, count, sizeof(glv_vec3a));
+}
+
+GLV_API float* glv_arena_float(glv_arena* a, size_t count){
+    GLV_PROFILE_FUNC();
+    return arena_array(a, count, sizeof(float));
+}
+
+GLV_API size_t glv_arena_mark(const glv_arena* a){
+    GLV_PROFILE_FUNC();
+    return a->used;
+}
+
+GLV_API void glv_arena_release(glv_arena* a, size_t mark){
+    GLV_PROFILE_FUNC();
+    if(mark < a->used) a->used = mark;
+}
+
+GLV_API void glv_arena_reset(glv_arena* a){
+    GLV_PROFILE_FUNC();
+    a->used = 0;
+}
@@ -0,0 +1,541 @@
+
+#include <math.h>
+#include "../include/bvh.h"
+#include "bvh_internal.h"
+#include "profile_internal.h"
+
+/* As in ray.c, b when either is NaN */
+#define BVH_MINF(a, b) ((a) < (b) ? (a) : (b))
+#define BVH_MAXF(a, b) ((a) > (b) ? (a) : (b))
+
+/* Corners of primitive i */
+#define BVH_LO(b, i) {(b)->boxes.min.x[i], (b)->boxes.min.y[i], (b)->boxes.min.z[i]}
+#define BVH_HI(b, i) {(b)->boxes.max.x[i], (b)->boxes.max.y[i], (b)->boxes.max.z[i]}
+
+typedef struct {
+    float min[3], max[3];
+} bvh_box;
+
+static const bvh_box bvh_empty = {{INFINITY, INFINITY, INFINITY}, {-INFINITY, -INFINITY, -INFINITY}};
+
+/* Written out per axis, -O2 keeps the three-step loops of the build as loops */
+static inline void bvh_grow(bvh_box* box, const float lo[3], const float hi[3]){
+    box->min[0] = BVH_MINF(box->min[0], lo[0]);
+    box->min[1] = BVH_MINF(box->min[1], lo[1]);
+    box->min[2] = BVH_MINF(box->min[2], lo[2]);
+    box->max[0] = BVH_MAXF(box->max[0], hi[0]);
+    box->max[1] = BVH_MAXF(box->max[1], hi[1]);
+    box->max[2] = BVH_MAXF(box->max[2], hi[2]);
+}
+
+/* Half the surface area, 0 for empty boxes */
+static inline float bvh_area(const bvh_box* box){
+    const float x = box->max[0] - box->min[0], y = box->max[1] - box->min[1], z = box->max[2] - box->min[2];
+    return x < 0.0f ? 0.0f : x * y + y * z + z * x;
+}
+
+/* Doubled centroid of primitive p on an axis */
+static inline float bvh_centre2(const glv_bvh* b, uint32_t p, unsigned int axis){
+    return axis == 0 ? b->boxes.min.x[p] + b->boxes.max.x[p]
+        : axis == 1 ? b->boxes.min.y[p] + b->boxes.max.y[p] : b->boxes.min.z[p] + b->boxes.max.z[p];
+}
+
+/* Bin of a doubled centroid coordinate c, the same in the binning and the partition */
+static inline unsigned int bvh_bin(float c, float cmin, float scale, unsigned int bins){
+    const unsigned int k = (unsigned int)((c - cmin) * scale);
+    return k < bins ? k : bins - 1;
+}
+
+/* Slab test against a node box, entry distance clamped to 0 */
+static inline int bvh_ray_box(const float o[3], const float inv[3], const float lo[3], const float hi[3],
+    float* t_enter, float* t_exit){
+    float t1 = (lo[0] - o[0]) * inv[0], t2 = (hi[0] - o[0]) * inv[0];
+    float tn = BVH_MINF(t1, t2), tf = BVH_MAXF(t1, t2);
+    unsigned int a;
+    for(a = 1; a != 3; ++a){
+        t1 = (lo[a] - o[a]) * inv[a];
+        t2 = (hi[a] - o[a]) * inv[a];
+        tn = BVH_MAXF(tn, BVH_MINF(t1, t2));
+        tf = BVH_MINF(tf, BVH_MAXF(t1, t2));
+    }
+    *t_enter = BVH_MAXF(tn, 0.0f);
+    *t_exit = tf;
+    return *t_enter <= tf;
+}
+
+/* Squared distance from p to a box, 0 inside */
+static inline float bvh_distance2(const float p[3], const float lo[3], const float hi[3]){
+    float d2 = 0.0f;
+    unsigned int a;
+    for(a = 0; a != 3; ++a){
+        const float d = BVH_MAXF(BVH_MAXF(lo[a] - p[a], p[a] - hi[a]), 0.0f);
+        d2 += d * d;
+    }
+    return d2;
+}
+
+static inline int bvh_overlaps(const float lo[3], const float hi[3], const float min[3], const float max[3]){
+    return lo[0] <= max[0] && lo[1] <= max[1] && lo[2] <= max[2]
+        && min[0] <= hi[0] && min[1] <= hi[1] && min[2] <= hi[2];
+}
+
+/* Closer than the best so far, ties going to the lowest index */
+static inline int bvh_better(float d, uint32_t index, float best_d, uint32_t best){
+    return d < best_d || (d == best_d && best != GLV_RAY_MISS && index < best);
+}
+
+
+/* ----- Bounds ----- */
+
+GLV_API void glv_aabbs_transform(const glv_aabb_soa* local, const glv_mat4* m, size_t n, const glv_aabb_soa* out){
+    GLV_PROFILE_FUNC();
+    size_t i;
+    unsigned int r, c;
+    for(i = 0; i != n; ++i){
+        // each output axis gathers the extreme of every term, Arvo's method
+        const float lo[3] = {local->min.x[i], local->min.y[i], local->min.z[i]};
+        const float hi[3] = {local->max.x[i], local->max.y[i], local->max.z[i]};
+        float mn[3], mx[3];
+        for(r = 0; r != 3; ++r){
+            mn[r] = mx[r] = m[i].data[r][3];
+            for(c = 0; c != 3; ++c){
+                const float a = m[i].data[r][c] * lo[c], b = m[i].data[r][c] * hi[c];
+                mn[r] += BVH_MINF(a, b);
+                mx[r] += BVH_MAXF(a, b);
+            }
+        }
+        out->min.x[i] = mn[0]; out->min.y[i] = mn[1]; out->min.z[i] = mn[2];
+        out->max.x[i] = mx[0]; out->max.y[i] = mx[1]; out->max.z[i] = mx[2];
+    }
+}
+
+
+/* ----- Build steps ----- */
+
+GLV_API unsigned int glv__bvh_split(const glv_bvh* b, const glv__bvh_task* t, unsigned int leaf_size,
+    glv__bvh_task children[2]){
+    glv_bvh_node* node = &b->nodes[t->node];
+    uint32_t* idx = b->indices;
+    const uint32_t n = t->end - t->begin;
+    bvh_box bounds = bvh_empty, centres = bvh_empty;
+    float best_cost = INFINITY;
+    unsigned int a, k, best_split = 0, best_axis = 3;
+    uint32_t i, mid;
+
+    // bounds of the boxes and of their doubled centroids
+    for(i = t->begin; i != t->end; ++i){
+        const float lo[3] = BVH_LO(b, idx[i]), hi[3] = BVH_HI(b, idx[i]);
+        const float c[3] = {lo[0] + hi[0], lo[1] + hi[1], lo[2] + hi[2]};
+        bvh_grow(&bounds, lo, hi);
+        bvh_grow(&centres, c, c);
+    }
+    for(a = 0; a != 3; ++a){
+        node->min[a] = bounds.min[a];
+        node->max[a] = bounds.max[a];
+    }
+    node->index = t->begin;
+    node->count = n;
+    if(n <= 1 || t->depth + 1 >= GLV_BVH_MAX_DEPTH) return 0;
+
+    // one pass bins every primitive on all three axes, small nodes with a bin per primitive
+    const unsigned int nbins = n < GLV_BVH_BINS ? n : GLV_BVH_BINS;
+    bvh_box bins[3][GLV_BVH_BINS];
+    uint32_t counts[3][GLV_BVH_BINS];
+    float scales[3];
+    for(a = 0; a != 3; ++a){
+        const float extent = centres.max[a] - centres.min[a];
+        scales[a] = extent > 0.0f ? (float)nbins / extent : 0.0f;
+        for(k = 0; k != nbins; ++k){
+            bins[a][k] = bvh_empty;
+            counts[a][k] = 0;
+        }
+    }
+#define BVH_BIN_AXIS(a) \
+            k = bvh_bin(lo[a] + hi[a], centres.min[a], scales[a], nbins); \
+            ++counts[a][k]; \
+            bvh_grow(&bins[a][k], lo, hi);
+    for(i = t->begin; i != t->end; ++i){
+        const float lo[3] = BVH_LO(b, idx[i]), hi[3] = BVH_HI(b, idx[i]);
+        BVH_BIN_AXIS(0)
+        BVH_BIN_AXIS(1)
+        BVH_BIN_AXIS(2)
+    }
+#undef BVH_BIN_AXIS
+
+    // SAH cost count * area of both sides, at every bin boundary of every axis
+    for(a = 0; a != 3; ++a){
+        uint32_t left = 0, right;
+        float right_area[GLV_BVH_BINS];
+        bvh_box acc = bvh_empty;
+        if(scales[a] == 0.0f) continue;
+        for(k = nbins - 1; k != 0; --k){
+            bvh_grow(&acc, bins[a][k].min, bins[a][k].max);
+            right_area[k] = bvh_area(&acc);
+        }
+        acc = bvh_empty;
+        for(k = 1; k != nbins; ++k){
+            float cost;
+            bvh_grow(&acc, bins[a][k - 1].min, bins[a][k - 1].max);
+            left += counts[a][k - 1];
+            right = n - left;
+            if(left == 0 || right == 0) continue;
+            cost = (float)left * bvh_area(&acc) + (float)right * right_area[k];
+            if(cost < best_cost){
+                best_cost = cost;
+                best_axis = a;
+                best_split = k;
+            }
+        }
+    }
+
+    if(best_axis == 3){
+        // all centroids coincide, any split is as good
+        if(n <= leaf_size) return 0;
+        mid = t->begin + n / 2;
+    }
+    else{
+        // a split costs one more box test than a leaf
+        const float area = bvh_area(&bounds);
+        if(n <= leaf_size && area + best_cost >= (float)n * area) return 0;
+        uint32_t j = t->end;
+        i = t->begin;
+        while(i != j){
+            const uint32_t p = idx[i];
+            if(bvh_bin(bvh_centre2(b, p, best_axis), centres.min[best_axis], scales[best_axis], nbins) < best_split){
+                ++i;
+            }
+            else{
+                idx[i] = idx[--j];
+                idx[j] = p;
+            }
+        }
+        mid = i;
+    }
+
+    node->index = t->node + 2 * (mid - t->begin);
+    node->count = 0;
+    children[0] = (glv__bvh_task){t->node + 1, t->begin, mid, t->depth + 1};
+    children[1] = (glv__bvh_task){node->index, mid, t->end, t->depth + 1};
+    return 2;
+}
+
+GLV_API void glv__bvh_build_task(const glv_bvh* b, const glv__bvh_task* t, unsigned int leaf_size){
+    glv__bvh_task stack[GLV_BVH_MAX_DEPTH], cur = *t, children[2];
+    size_t top = 0;
+    for(;;){
+        if(glv__bvh_split(b, &cur, leaf_size, children)){
+            // the smaller child first, so the stack holds one entry per level at most
+            const unsigned int small = children[0].end - children[0].begin > children[1].end - children[1].begin;
+            stack[top++] = children[!small];
+            cur = children[small];
+            continue;
+        }
+        if(top == 0) break;
+        cur = stack[--top];
+    }
+}
+
+GLV_API size_t glv__bvh_compact(const glv_bvh* b){
+    // the slots of a preorder walk only increase, so every node moves down onto a visited one
+    struct { uint32_t node, parent; } stack[GLV_BVH_MAX_DEPTH];
+    glv_bvh_node* nodes = b->nodes;
+    size_t top = 0;
+    uint32_t i = 0, parent = GLV_RAY_MISS, next = 0;
+    for(;;){
+        const glv_bvh_node node = nodes[i];
+        if(parent != GLV_RAY_MISS) nodes[parent].index = next;
+        nodes[next] = node;
+        if(node.count == 0){
+            stack[top].node = node.index;
+            stack[top++].parent = next++;
+            i = i + 1;
+            parent = GLV_RAY_MISS;
+            continue;
+        }
+        ++next;
+        if(top == 0) break;
+        --top;
+        i = stack[top].node;
+        parent = stack[top].parent;
+    }
+    return next;
+}
+
+
+/* ----- Build and refit ----- */
+
+GLV_API size_t glv_bvh_build(glv_bvh* b, unsigned int leaf_size){
+    GLV_PROFILE_FUNC();
+    const glv__bvh_task root = {0, 0, (uint32_t)b->count, 0};
+    size_t i;
+    b->node_count = 0;
+    if(b->count == 0) return 0;
+    for(i = 0; i != b->count; ++i) b->indices[i] = (uint32_t)i;
+    glv__bvh_build_task(b, &root, leaf_size);
+    b->node_count = glv__bvh_compact(b);
+    return b->node_count;
+}
+
+GLV_API void glv_bvh_refit(const glv_bvh* b){
+    GLV_PROFILE_FUNC();
+    size_t i = b->node_count;
+    uint32_t k;
+    unsigned int a;
+    // children come after their parent, so a backward pass sees them first
+    while(i--){
+        glv_bvh_node* node = &b->nodes[i];
+        bvh_box box = bvh_empty;
+        if(node->count){
+            for(k = node->index; k != node->index + node->count; ++k){
+                const float lo[3] = BVH_LO(b, b->indices[k]), hi[3] = BVH_HI(b, b->indices[k]);
+                bvh_grow(&box, lo, hi);
+            }
+        }
+        else{
+            bvh_grow(&box, node[1].min, node[1].max);
+            bvh_grow(&box, b->nodes[node->index].min, b->nodes[node->index].max);
+        }
+        for(a = 0; a != 3; ++a){
+            node->min[a] = box.min[a];
+            node->max[a] = box.max[a];
+        }
+    }
+}
+
+
+/* ----- Queries ----- */
+
+/* Pending node and its entry distance, for the queries that keep a best so far */
+typedef struct {
+    uint32_t node;
+    float d;
+} bvh_entry;
+
+GLV_API size_t glv_bvh_ray(const glv_bvh* b, const glv_ray* r, float t_max, uint32_t* out, size_t capacity){
+    GLV_PROFILE_FUNC();
+    const float inv[3] = {1.0f / r->direction.x, 1.0f / r->direction.y, 1.0f / r->direction.z};
+    uint32_t stack[GLV_BVH_MAX_DEPTH], i = 0, k;
+    size_t top = 0, found = 0;
+    float tn, tf;
+    if(b->node_count == 0) return 0;
+    for(;;){
+        const glv_bvh_node* node = &b->nodes[i];
+        if(bvh_ray_box(r->origin.data, inv, node->min, node->max, &tn, &tf) && tn < t_max){
+            if(node->count == 0){
+                stack[top++] = node->index;
+                i = i + 1;
+                continue;
+            }
+            for(k = node->index; k != node->index + node->count; ++k){
+                const uint32_t p = b->indices[k];
+                const float lo[3] = BVH_LO(b, p), hi[3] = BVH_HI(b, p);
+                if(bvh_ray_box(r->origin.data, inv, lo, hi, &tn, &tf) && tn < t_max){
+                    if(found < capacity) out[found] = p;
+                    ++found;
+                }
+            }
+        }
+        if(top == 0) break;
+        i = stack[--top];
+    }
+    return found;
+}
+
+/* Tests primitive p against the ray, lowering *t on a closer hit */
+typedef void (*bvh_leaf_fn)(const glv_bvh* b, const glv_ray* r, const float inv[3], uint32_t p, float* t, void* ctx);
+
+/*
+    Front to back walk shared by the nearest ray queries: visits the
+    primitives of every leaf entered no later than *t, nearer child first.
+*/
+static inline void bvh_ray_walk(const glv_bvh* b, const glv_ray* r, float* t, bvh_leaf_fn leaf, void* ctx){
+    const float inv[3] = {1.0f / r->direction.x, 1.0f / r->direction.y, 1.0f / r->direction.z};
+    const float* o = r->origin.data;
+    bvh_entry stack[GLV_BVH_MAX_DEPTH];
+    size_t top = 0;
+    uint32_t i = 0, k;
+    float tn, tf, tl, tr;
+    if(b->node_count == 0 || !bvh_ray_box(o, inv, b->nodes[0].min, b->nodes[0].max, &tn, &tf) || tn > *t) return;
+    for(;;){
+        const glv_bvh_node* node = &b->nodes[i];
+        if(node->count){
+            for(k = node->index; k != node->index + node->count; ++k) leaf(b, r, inv, b->indices[k], t, ctx);
+        }
+        else{
+            const glv_bvh_node *left = node + 1, *right = &b->nodes[node->index];
+            const int hl = bvh_ray_box(o, inv, left->min, left->max, &tl, &tf) && tl <= *t;
+            const int hr = bvh_ray_box(o, inv, right->min, right->max, &tr, &tf) && tr <= *t;
+            if(hl && hr){
+                const int right_first = tr < tl;
+                stack[top].node = right_first ? i + 1 : node->index;
+                stack[top++].d = right_first ? tl : tr;
+                i = right_first ? node->index : i + 1;
+                continue;
+            }
+            if(hl || hr){
+                i = hl ? i + 1 : node->index;
+                continue;
+            }
+        }
+        // skip pending nodes entered after the best so far
+        while(top && stack[top - 1].d > *t) --top;
+        if(top == 0) break;
+        i = stack[--top].node;
+    }
+}
+
+static void bvh_leaf_box(const glv_bvh* b, const glv_ray* r, const float inv[3], uint32_t p, float* t, void* ctx){
+    uint32_t* best = ctx;
+    const float lo[3] = BVH_LO(b, p), hi[3] = BVH_HI(b, p);
+    float tn, tf;
+    if(bvh_ray_box(r->origin.data, inv, lo, hi, &tn, &tf) && bvh_better(tn, p, *t, *best)){
+        *t = tn;
+        *best = p;
+    }
+}
+
+typedef struct {
+    const glv_triangle_soa* tris;
+    glv_ray_hit* hit;
+} bvh_triangles;
+
+/* One triangle at a time through ray.h, with the limit just past the best to see ties */
+static void bvh_leaf_triangle(const glv_bvh* b, const glv_ray* r, const float inv[3], uint32_t p, float* t, void* ctx){
+    const glv_triangle_soa* tris = ((const bvh_triangles*)ctx)->tris;
+    glv_ray_hit* hit = ((const bvh_triangles*)ctx)->hit;
+    const glv_triangle_soa one = {
+        {tris->v0.x + p, tris->v0.y + p, tris->v0.z + p},
+        {tris->e1.x + p, tris->e1.y + p, tris->e1.z + p},
+        {tris->e2.x + p, tris->e2.y + p, tris->e2.z + p}};
+    glv_ray_hit h;
+    (void)b;
+    (void)inv;
+    if(glv_ray_triangles_nearest(r, &one, 1, nextafterf(*t, INFINITY), &h) && bvh_better(h.t, p, *t, hit->index)){
+        *hit = h;
+        hit->index = p;
+    }
+}
+
+GLV_API uint32_t glv_bvh_ray_nearest(const glv_bvh* b, const glv_ray* r, float t_max, float* t){
+    GLV_PROFILE_FUNC();
+    uint32_t best = GLV_RAY_MISS;
+    *t = t_max;
+    bvh_ray_walk(b, r, t, bvh_leaf_box, &best);
+    return best;
+}
+
+GLV_API int glv_bvh_ray_triangles(const glv_bvh* b, const glv_ray* r, const glv_triangle_soa* tris,
+    float t_max, glv_ray_hit* hit){
+    GLV_PROFILE_FUNC();
+    bvh_triangles ctx = {tris, hit};
+    hit->t = t_max;
+    hit->u = hit->v = 0.0f;
+    hit->index = GLV_RAY_MISS;
+    bvh_ray_walk(b, r, &hit->t, bvh_leaf_triangle, &ctx);
+    return hit->index != GLV_RAY_MISS;
+}
+
+GLV_API size_t glv_bvh_overlap(const glv_bvh* b, const glv_vec3* min, const glv_vec3* max,
+    uint32_t* out, size_t capacity){
+    GLV_PROFILE_FUNC();
+    uint32_t stack[GLV_BVH_MAX_DEPTH], i = 0, k;
+    size_t top = 0, found = 0;
+    if(b->node_count == 0) return 0;
+    for(;;){
+        const glv_bvh_node* node = &b->nodes[i];
+        if(bvh_overlaps(node->min, node->max, min->data, max->data)){
+            if(node->count == 0){
+                stack[top++] = node->index;
+                i = i + 1;
+                continue;
+            }
+            for(k = node->index; k != node->index + node->count; ++k){
+                const uint32_t p = b->indices[k];
+                const float lo[3] = BVH_LO(b, p), hi[3] = BVH_HI(b, p);
+                if(bvh_overlaps(lo, hi, min->data, max->data)){
+                    if(found < capacity) out[found] = p;
+                    ++found;
+                }
+            }
+        }
+        if(top == 0) break;
+        i = stack[--top];
+    }
+    return found;
+}
+
+GLV_API size_t glv_bvh_sphere(const glv_bvh* b, const glv_vec3* centre, float radius,
+    uint32_t* out, size_t capacity){
+    GLV_PROFILE_FUNC();
+    const float r2 = radius * radius;
+    uint32_t stack[GLV_BVH_MAX_DEPTH], i = 0, k;
+    size_t top = 0, found = 0;
+    if(b->node_count == 0) return 0;
+    for(;;){
+        const glv_bvh_node* node = &b->nodes[i];
+        if(bvh_distance2(centre->data, node->min, node->max) <= r2){
+            if(node->count == 0){
+                stack[top++] = node->index;
+                i = i + 1;
+                continue;
+            }
+            for(k = node->index; k != node->index + node->count; ++k){
+                const uint32_t p = b->indices[k];
+                const float lo[3] = BVH_LO(b, p), hi[3] = BVH_HI(b, p);
+                if(bvh_distance2(centre->data, lo, hi) <= r2){
+                    if(found < capacity) out[found] = p;
+                    ++found;
+                }
+            }
+        }
+        if(top == 0) break;
+        i = stack[--top];
+    }
+    return found;
+}
+
+GLV_API uint32_t glv_bvh_nearest(const glv_bvh* b, const glv_vec3* p, float max_distance, float* distance){
+    GLV_PROFILE_FUNC();
+    bvh_entry stack[GLV_BVH_MAX_DEPTH];
+    size_t top = 0;
+    uint32_t i = 0, k, best = GLV_RAY_MISS;
+    float best_d2 = max_distance * max_distance;
+    *distance = max_distance;
+    if(b->node_count == 0 || bvh_distance2(p->data, b->nodes[0].min, b->nodes[0].max) > best_d2) return best;
+    // same walk as the rays, ordered by squared distance
+    for(;;){
+        const glv_bvh_node* node = &b->nodes[i];
+        if(node->count){
+            for(k = node->index; k != node->index + node->count; ++k){
+                const uint32_t q = b->indices[k];
+                const float lo[3] = BVH_LO(b, q), hi[3] = BVH_HI(b, q);
+                const float d2 = bvh_distance2(p->data, lo, hi);
+                if(bvh_better(d2, q, best_d2, best)){
+                    best_d2 = d2;
+                    best = q;
+                }
+            }
+        }
+        else{
+            const glv_bvh_node *l = node + 1, *r = &b->nodes[node->index];
+            const float dl = bvh_distance2(p->data, l->min, l->max), dr = bvh_distance2(p->data, r->min, r->max);
+            const int hl = dl <= best_d2, hr = dr <= best_d2;
+            if(hl && hr){
+                const int right_first = dr < dl;
+                stack[top].node = right_first ? i + 1 : node->index;
+                stack[top++].d = right_first ? dl : dr;
+                i = right_first ? node->index : i + 1;
+                continue;
+            }
+            if(hl || hr){
+                i = hl ? i + 1 : node->index;
+                continue;
+            }
+        }
+        while(top && stack[top - 1].d > best_d2) --top;
+        if(top == 0) break;
+        i = stack[--top].node;
+    }
+    if(best != GLV_RAY_MISS) *distance = sqrtf(best_d2);
+    return best;
+}
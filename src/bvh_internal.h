@@ -0,0 +1,35 @@
+/*
+    === bvh_internal.h ===
+
+    Private to the library: the steps of glv_bvh_build, shared with the
+    parallel build in pool.c.
+
+    During the build every node owns a block of 2 * n - 1 slots for its
+    n primitives: itself, then its left child's block, then its right
+    child's. Subtrees can then be built in any order, or on any thread,
+    and the result depends only on the boxes. The tree is compacted to
+    depth-first order at the end.
+*/
+
+#ifndef GLV_BVH_INTERNAL_H
+#define GLV_BVH_INTERNAL_H 1
+
+#include <stdint.h>
+#include "../include/bvh.h"
+
+/* Subtree still to build: node slot, range of the index array and depth of the node */
+typedef struct {
+    uint32_t node, begin, end, depth;
+} glv__bvh_task;
+
+/* Fills the node of t and splits it. Returns the number of children written, 0 for a leaf */
+GLV_API unsigned int glv__bvh_split(const glv_bvh* b, const glv__bvh_task* t, unsigned int leaf_size,
+    glv__bvh_task children[2]);
+
+/* Builds the whole subtree of t */
+GLV_API void glv__bvh_build_task(const glv_bvh* b, const glv__bvh_task* t, unsigned int leaf_size);
+
+/* Moves the built nodes to depth-first order, returns the node count */
+GLV_API size_t glv__bvh_compact(const glv_bvh* b);
+
+#endif /* GLV_BVH_INTERNAL_H */
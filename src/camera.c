@@ -0,0 +1,158 @@
+
+#include <string.h>
+#include "../include/camera.h"
+#include "../include/transform.h"
+#include "profile_internal.h"
+
+/* Results that depend on each group of inputs */
+#define CAMERA_VIEW_DEPENDENTS (GLV_CAMERA_VIEW | GLV_CAMERA_VIEW_PROJECTION | GLV_CAMERA_INVERSE_VIEW \
+    | GLV_CAMERA_INVERSE_VIEW_PROJECTION | GLV_CAMERA_FRUSTUM)
+#define CAMERA_PROJECTION_DEPENDENTS (GLV_CAMERA_PROJECTION | GLV_CAMERA_VIEW_PROJECTION \
+    | GLV_CAMERA_INVERSE_PROJECTION | GLV_CAMERA_INVERSE_VIEW_PROJECTION | GLV_CAMERA_FRUSTUM)
+
+/* Points unprojected per call of glv_transform_batch */
+#define CAMERA_CHUNK 64
+
+
+/* ----- Inputs ----- */
+
+GLV_API void glv_camera_init(glv_camera* c, const glv_vec3* eye, const glv_vec3* target, const glv_vec3* up,
+    float fovy, float aspect, float near, float far){
+    GLV_PROFILE_FUNC();
+    memset(c, 0, sizeof(*c));
+    c->eye = *eye;
+    c->target = *target;
+    c->up = *up;
+    c->fovy = fovy;
+    c->aspect = aspect;
+    c->near = near;
+    c->far = far;
+    c->stale = GLV_CAMERA_ALL;
+}
+
+GLV_API void glv_camera_set_view(glv_camera* c, const glv_vec3* eye, const glv_vec3* target, const glv_vec3* up){
+    GLV_PROFILE_FUNC();
+    if(memcmp(&c->eye, eye, sizeof(glv_vec3)) == 0 && memcmp(&c->target, target, sizeof(glv_vec3)) == 0
+        && memcmp(&c->up, up, sizeof(glv_vec3)) == 0) return;
+    c->eye = *eye;
+    c->target = *target;
+    c->up = *up;
+    c->stale |= CAMERA_VIEW_DEPENDENTS;
+}
+
+GLV_API void glv_camera_set_projection(glv_camera* c, float fovy, float aspect, float near, float far){
+    GLV_PROFILE_FUNC();
+    if(c->fovy == fovy && c->aspect == aspect && c->near == near && c->far == far) return;
+    c->fovy = fovy;
+    c->aspect = aspect;
+    c->near = near;
+    c->far = far;
+    c->stale |= CAMERA_PROJECTION_DEPENDENTS;
+}
+
+GLV_API void glv_camera_set_aspect(glv_camera* c, float aspect){
+    GLV_PROFILE_FUNC();
+    glv_camera_set_projection(c, c->fovy, aspect, c->near, c->far);
+}
+
+
+/* ----- Cached results ----- */
+
+GLV_API const glv_mat4* glv_camera_view(glv_camera* c){
+    GLV_PROFILE_FUNC();
+    if(c->stale & GLV_CAMERA_VIEW){
+        c->view = glv_lookat(&c->eye, &c->target, &c->up);
+        c->stale &= ~GLV_CAMERA_VIEW;
+    }
+    return &c->view;
+}
+
+GLV_API const glv_mat4* glv_camera_projection(glv_camera* c){
+    GLV_PROFILE_FUNC();
+    if(c->stale & GLV_CAMERA_PROJECTION){
+        c->projection = glv_perspective(c->fovy, c->aspect, c->near, c->far);
+        c->stale &= ~GLV_CAMERA_PROJECTION;
+    }
+    return &c->projection;
+}
+
+GLV_API const glv_mat4* glv_camera_view_projection(glv_camera* c){
+    GLV_PROFILE_FUNC();
+    if(c->stale & GLV_CAMERA_VIEW_PROJECTION){
+        c->view_projection = glv_mat4_multiply(glv_camera_projection(c), glv_camera_view(c));
+        c->stale &= ~GLV_CAMERA_VIEW_PROJECTION;
+    }
+    return &c->view_projection;
+}
+
+GLV_API const glv_mat4* glv_camera_inverse_view(glv_camera* c){
+    GLV_PROFILE_FUNC();
+    if(c->stale & GLV_CAMERA_INVERSE_VIEW){
+        c->inverse_view = glv_mat4_inverse_affine(glv_camera_view(c));
+        c->stale &= ~GLV_CAMERA_INVERSE_VIEW;
+    }
+    return &c->inverse_view;
+}
+
+GLV_API const glv_mat4* glv_camera_inverse_projection(glv_camera* c){
+    GLV_PROFILE_FUNC();
+    if(c->stale & GLV_CAMERA_INVERSE_PROJECTION){
+        // inverse of the glv_frustum layout, with rows (a 0 b 0) (0 d e 0) (0 0 p q) (0 0 -1 0)
+        const glv_mat4* m = glv_camera_projection(c);
+        glv_mat4 r = {0};
+        r.data[0][0] = 1.0f / m->data[0][0];
+        r.data[0][3] = m->data[0][2] / m->data[0][0];
+        r.data[1][1] = 1.0f / m->data[1][1];
+        r.data[1][3] = m->data[1][2] / m->data[1][1];
+        r.data[2][3] = -1.0f;
+        r.data[3][2] = 1.0f / m->data[2][3];
+        r.data[3][3] = m->data[2][2] / m->data[2][3];
+        c->inverse_projection = r;
+        c->stale &= ~GLV_CAMERA_INVERSE_PROJECTION;
+    }
+    return &c->inverse_projection;
+}
+
+GLV_API const glv_mat4* glv_camera_inverse_view_projection(glv_camera* c){
+    GLV_PROFILE_FUNC();
+    if(c->stale & GLV_CAMERA_INVERSE_VIEW_PROJECTION){
+        c->inverse_view_projection = glv_mat4_multiply(glv_camera_inverse_view(c), glv_camera_inverse_projection(c));
+        c->stale &= ~GLV_CAMERA_INVERSE_VIEW_PROJECTION;
+    }
+    return &c->inverse_view_projection;
+}
+
+GLV_API const glv_frustum_planes* glv_camera_frustum(glv_camera* c){
+    GLV_PROFILE_FUNC();
+    if(c->stale & GLV_CAMERA_FRUSTUM){
+        c->frustum = glv_frustum_planes_from_mat4(glv_camera_view_projection(c));
+        c->stale &= ~GLV_CAMERA_FRUSTUM;
+    }
+    return &c->frustum;
+}
+
+
+/* ----- Unprojection ----- */
+
+GLV_API void glv_camera_unproject(glv_camera* c, const glv_vec4* viewport,
+    const glv_vec3* in, glv_vec3* out, size_t count){
+    GLV_PROFILE_FUNC();
+    const glv_mat4* m = glv_camera_inverse_view_projection(c);
+    const float sx = 2.0f / viewport->data[2], sy = 2.0f / viewport->data[3];
+    glv_vec4 clip[CAMERA_CHUNK];
+    size_t i, k, n;
+    // window to normalized device coordinates, then one batch transform per chunk
+    for(i = 0; i < count; i += n){
+        n = count - i < CAMERA_CHUNK ? count - i : CAMERA_CHUNK;
+        for(k = 0; k != n; ++k){
+            const glv_vec3* p = &in[i + k];
+            clip[k] = (glv_vec4){.x = (p->x - viewport->x) * sx - 1.0f, .y = (p->y - viewport->y) * sy - 1.0f,
+                .z = 2.0f * p->z - 1.0f, .w = 1.0f};
+        }
+        glv_transform_batch(clip, 0, clip, 0, n, m);
+        for(k = 0; k != n; ++k){
+            const float w = 1.0f / clip[k].w;
+            out[i + k] = (glv_vec3){.x = clip[k].x * w, .y = clip[k].y * w, .z = clip[k].z * w};
+        }
+    }
+}
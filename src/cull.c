@@ -0,0 +1,223 @@
+
+#include <math.h>
+#include "../include/cull.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* ----- Kernel instances ----- */
+
+#ifdef GLV_X86
+
+#define CULL_ISA sse2
+#define CULL_TARGET GLV_TARGET_SSE2
+#define CULL_W 4
+#define CULL_V __m128
+#define CULL_SET1 _mm_set1_ps
+#define CULL_LOAD _mm_loadu_ps
+#define CULL_ADD _mm_add_ps
+#define CULL_SUB _mm_sub_ps
+#define CULL_MUL _mm_mul_ps
+#define CULL_AND _mm_and_ps
+#define CULL_GE _mm_cmpge_ps
+#define CULL_MOVEMASK _mm_movemask_ps
+#include "cull_simd.h"
+#undef CULL_ISA
+#undef CULL_TARGET
+#undef CULL_W
+#undef CULL_V
+#undef CULL_SET1
+#undef CULL_LOAD
+#undef CULL_ADD
+#undef CULL_SUB
+#undef CULL_MUL
+#undef CULL_AND
+#undef CULL_GE
+#undef CULL_MOVEMASK
+
+#define CULL_ISA avx
+#define CULL_TARGET GLV_TARGET_AVX
+#define CULL_W 8
+#define CULL_V __m256
+#define CULL_SET1 _mm256_set1_ps
+#define CULL_LOAD _mm256_loadu_ps
+#define CULL_ADD _mm256_add_ps
+#define CULL_SUB _mm256_sub_ps
+#define CULL_MUL _mm256_mul_ps
+#define CULL_AND _mm256_and_ps
+#define CULL_GE(a, b) _mm256_cmp_ps(a, b, _CMP_GE_OQ)
+#define CULL_MOVEMASK _mm256_movemask_ps
+#include "cull_simd.h"
+#undef CULL_ISA
+#undef CULL_TARGET
+#undef CULL_W
+#undef CULL_V
+#undef CULL_SET1
+#undef CULL_LOAD
+#undef CULL_ADD
+#undef CULL_SUB
+#undef CULL_MUL
+#undef CULL_AND
+#undef CULL_GE
+#undef CULL_MOVEMASK
+
+/* Runs the widest instance for the current level, returns bounds done. AVX-512 runs the AVX code */
+#define CULL_DISPATCH(fn, ...)                                          \
+    (glv_simd_get_level() >= GLV_SIMD_AVX  ? fn##_avx(__VA_ARGS__)  : \
+     glv_simd_get_level() >= GLV_SIMD_SSE2 ? fn##_sse2(__VA_ARGS__) : 0)
+
+#else
+
+#define CULL_DISPATCH(fn, ...) ((size_t)0)
+
+#endif /* GLV_X86 */
+
+
+/* ----- Extraction ----- */
+
+GLV_API glv_frustum_planes glv_frustum_planes_from_mat4(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    // clip = m * p is inside when -w <= x, y, z <= w, with w the last row
+    const float (*a)[4] = m->data;
+    const float sign[GLV_PLANE_COUNT] = {1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f};
+    glv_frustum_planes f;
+    unsigned int p, j;
+    for(p = 0; p != GLV_PLANE_COUNT; ++p){
+        glv_vec4* pl = &f.planes[p];
+        float len;
+        for(j = 0; j != 4; ++j){
+            pl->data[j] = a[3][j] + sign[p] * a[p / 2][j];
+        }
+        len = sqrtf(pl->x * pl->x + pl->y * pl->y + pl->z * pl->z);
+        for(j = 0; j != 4; ++j){
+            pl->data[j] /= len;
+        }
+    }
+    return f;
+}
+
+
+/* ----- Single tests ----- */
+
+/* The comparisons are written so that NaN bounds count as outside, like the kernels */
+static int sphere_visible(const glv_vec4* pl, float x, float y, float z, float r){
+    unsigned int p;
+    for(p = 0; p != GLV_PLANE_COUNT; ++p){
+        const float d = pl[p].x * x + pl[p].y * y + pl[p].z * z + pl[p].w;
+        if(!(d >= -r)) return 0;
+    }
+    return 1;
+}
+
+static int aabb_visible(const glv_vec4* pl, float x, float y, float z, float ex, float ey, float ez){
+    unsigned int p;
+    for(p = 0; p != GLV_PLANE_COUNT; ++p){
+        const float d = pl[p].x * x + pl[p].y * y + pl[p].z * z + pl[p].w;
+        const float s = fabsf(pl[p].x) * ex + fabsf(pl[p].y) * ey + fabsf(pl[p].z) * ez;
+        if(!(d >= -s)) return 0;
+    }
+    return 1;
+}
+
+GLV_API int glv_frustum_sphere_visible(const glv_frustum_planes* f, const glv_vec3* centre, float radius){
+    GLV_PROFILE_FUNC();
+    return sphere_visible(f->planes, centre->x, centre->y, centre->z, radius);
+}
+
+GLV_API int glv_frustum_aabb_visible(const glv_frustum_planes* f, const glv_vec3* centre, const glv_vec3* extent){
+    GLV_PROFILE_FUNC();
+    return aabb_visible(f->planes, centre->x, centre->y, centre->z, extent->x, extent->y, extent->z);
+}
+
+
+/* ----- Batch tests ----- */
+
+/* Finishes the mask from bound i with scalar tests, returns the visible count */
+static size_t cull_spheres_tail(const glv_vec4* pl, const glv_vec3_soa* c, const float* r,
+    size_t i, size_t n, uint32_t* mask){
+    size_t visible = 0, w;
+    for(; i != n; ++i){
+        if(i % 32 == 0) mask[i / 32] = 0;
+        if(sphere_visible(pl, c->x[i], c->y[i], c->z[i], r[i])) mask[i / 32] |= (uint32_t)1 << (i % 32);
+    }
+    for(w = 0; w != GLV_CULL_MASK_WORDS(n); ++w){
+        visible += (size_t)__builtin_popcount(mask[w]);
+    }
+    return visible;
+}
+
+static size_t cull_aabbs_tail(const glv_vec4* pl, const glv_vec3_soa* c, const glv_vec3_soa* e,
+    size_t i, size_t n, uint32_t* mask){
+    size_t visible = 0, w;
+    for(; i != n; ++i){
+        if(i % 32 == 0) mask[i / 32] = 0;
+        if(aabb_visible(pl, c->x[i], c->y[i], c->z[i], e->x[i], e->y[i], e->z[i])){
+            mask[i / 32] |= (uint32_t)1 << (i % 32);
+        }
+    }
+    for(w = 0; w != GLV_CULL_MASK_WORDS(n); ++w){
+        visible += (size_t)__builtin_popcount(mask[w]);
+    }
+    return visible;
+}
+
+GLV_API size_t glv_frustum_cull_spheres(const glv_frustum_planes* f, const glv_vec3_soa* centres,
+    const float* radii, size_t n, uint32_t* mask){
+    GLV_PROFILE_FUNC();
+    const size_t i = CULL_DISPATCH(cull_spheres, f->planes, centres, radii, n, mask);
+    return cull_spheres_tail(f->planes, centres, radii, i, n, mask);
+}
+
+GLV_API size_t glv_frustum_cull_aabbs(const glv_frustum_planes* f, const glv_vec3_soa* centres,
+    const glv_vec3_soa* extents, size_t n, uint32_t* mask){
+    GLV_PROFILE_FUNC();
+    const size_t i = CULL_DISPATCH(cull_aabbs, f->planes, centres, extents, n, mask);
+    return cull_aabbs_tail(f->planes, centres, extents, i, n, mask);
+}
+
+/*
+    The index lists are built from the bitmask of blocks of
+    CULL_BLOCK bounds, kept on the stack, one set bit at a time.
+*/
+#define CULL_BLOCK 1024
+
+/* Appends the indices of the set bits of a block mask starting at bound base */
+static size_t cull_expand(const uint32_t* mask, size_t count, size_t base, uint32_t* indices){
+    size_t w, out = 0;
+    for(w = 0; w != GLV_CULL_MASK_WORDS(count); ++w){
+        uint32_t bits = mask[w];
+        while(bits){
+            indices[out++] = (uint32_t)(base + w * 32 + (size_t)__builtin_ctz(bits));
+            bits &= bits - 1;
+        }
+    }
+    return out;
+}
+
+GLV_API size_t glv_frustum_cull_spheres_indices(const glv_frustum_planes* f, const glv_vec3_soa* centres,
+    const float* radii, size_t n, uint32_t* indices){
+    GLV_PROFILE_FUNC();
+    uint32_t mask[GLV_CULL_MASK_WORDS(CULL_BLOCK)];
+    size_t i, count, out = 0;
+    for(i = 0; i < n; i += CULL_BLOCK){
+        const glv_vec3_soa c = {centres->x + i, centres->y + i, centres->z + i};
+        count = n - i < CULL_BLOCK ? n - i : CULL_BLOCK;
+        glv_frustum_cull_spheres(f, &c, radii + i, count, mask);
+        out += cull_expand(mask, count, i, indices + out);
+    }
+    return out;
+}
+
+GLV_API size_t glv_frustum_cull_aabbs_indices(const glv_frustum_planes* f, const glv_vec3_soa* centres,
+    const glv_vec3_soa* extents, size_t n, uint32_t* indices){
+    GLV_PROFILE_FUNC();
+    uint32_t mask[GLV_CULL_MASK_WORDS(CULL_BLOCK)];
+    size_t i, count, out = 0;
+    for(i = 0; i < n; i += CULL_BLOCK){
+        const glv_vec3_soa c = {centres->x + i, centres->y + i, centres->z + i};
+        const glv_vec3_soa e = {extents->x + i, extents->y + i, extents->z + i};
+        count = n - i < CULL_BLOCK ? n - i : CULL_BLOCK;
+        glv_frustum_cull_aabbs(f, &c, &e, count, mask);
+        out += cull_expand(mask, count, i, indices + out);
+    }
+    return out;
+}
@@ -0,0 +1,103 @@
+/*
+    === cull_simd.h ===
+
+    Frustum culling kernels written once over a generic vector type,
+    and included by cull.c once per instruction set. Before inclusion,
+    define:
+
+        CULL_ISA       suffix of the generated functions
+        CULL_TARGET    target attribute (GLV_TARGET_*)
+        CULL_W         lanes per vector, dividing 32
+        CULL_V         vector type
+        CULL_SET1, CULL_LOAD, CULL_ADD, CULL_SUB, CULL_MUL, CULL_AND
+        CULL_GE        lane-wise a >= b, false for NaN
+        CULL_MOVEMASK  sign bit of each lane as an int
+
+    Each kernel fills whole 32-bit mask words and returns how many
+    bounds it tested; the caller finishes the tail with scalar code.
+    A group of bounds stops being tested at the first plane that has
+    all of them outside, which pays off when nearby bounds are stored
+    next to each other.
+    Distances are summed in the same order as the scalar tests, so the
+    results are identical.
+*/
+
+#define CULL_CAT_(a, b) a##_##b
+#define CULL_CAT(a, b) CULL_CAT_(a, b)
+#define CULL_FN(name) CULL_CAT(name, CULL_ISA)
+
+
+CULL_TARGET
+static size_t CULL_FN(cull_spheres)(const glv_vec4* pl, const glv_vec3_soa* c, const float* r,
+    size_t n, uint32_t* mask){
+    CULL_V nx[GLV_PLANE_COUNT], ny[GLV_PLANE_COUNT], nz[GLV_PLANE_COUNT], nd[GLV_PLANE_COUNT];
+    const CULL_V zero = CULL_SET1(0.0f);
+    size_t i, k;
+    unsigned int p;
+    for(p = 0; p != GLV_PLANE_COUNT; ++p){
+        nx[p] = CULL_SET1(pl[p].x);
+        ny[p] = CULL_SET1(pl[p].y);
+        nz[p] = CULL_SET1(pl[p].z);
+        nd[p] = CULL_SET1(pl[p].w);
+    }
+    for(i = 0; i + 32 <= n; i += 32){
+        uint32_t word = 0;
+        for(k = 0; k != 32; k += CULL_W){
+            const CULL_V x = CULL_LOAD(c->x + i + k), y = CULL_LOAD(c->y + i + k), z = CULL_LOAD(c->z + i + k);
+            const CULL_V nr = CULL_SUB(zero, CULL_LOAD(r + i + k));
+            CULL_V in = CULL_SET1(0.0f);
+            for(p = 0; p != GLV_PLANE_COUNT; ++p){
+                CULL_V d = CULL_ADD(CULL_MUL(nx[p], x), CULL_MUL(ny[p], y));
+                d = CULL_ADD(CULL_ADD(d, CULL_MUL(nz[p], z)), nd[p]);
+                in = p == 0 ? CULL_GE(d, nr) : CULL_AND(in, CULL_GE(d, nr));
+                if(!CULL_MOVEMASK(in)) break;
+            }
+            word |= (uint32_t)CULL_MOVEMASK(in) << k;
+        }
+        mask[i / 32] = word;
+    }
+    return i;
+}
+
+CULL_TARGET
+static size_t CULL_FN(cull_aabbs)(const glv_vec4* pl, const glv_vec3_soa* c, const glv_vec3_soa* e,
+    size_t n, uint32_t* mask){
+    CULL_V nx[GLV_PLANE_COUNT], ny[GLV_PLANE_COUNT], nz[GLV_PLANE_COUNT], nd[GLV_PLANE_COUNT];
+    CULL_V ax[GLV_PLANE_COUNT], ay[GLV_PLANE_COUNT], az[GLV_PLANE_COUNT];
+    const CULL_V zero = CULL_SET1(0.0f);
+    size_t i, k;
+    unsigned int p;
+    for(p = 0; p != GLV_PLANE_COUNT; ++p){
+        nx[p] = CULL_SET1(pl[p].x);
+        ny[p] = CULL_SET1(pl[p].y);
+        nz[p] = CULL_SET1(pl[p].z);
+        nd[p] = CULL_SET1(pl[p].w);
+        ax[p] = CULL_SET1(fabsf(pl[p].x));
+        ay[p] = CULL_SET1(fabsf(pl[p].y));
+        az[p] = CULL_SET1(fabsf(pl[p].z));
+    }
+    for(i = 0; i + 32 <= n; i += 32){
+        uint32_t word = 0;
+        for(k = 0; k != 32; k += CULL_W){
+            const CULL_V x = CULL_LOAD(c->x + i + k), y = CULL_LOAD(c->y + i + k), z = CULL_LOAD(c->z + i + k);
+            const CULL_V ex = CULL_LOAD(e->x + i + k), ey = CULL_LOAD(e->y + i + k), ez = CULL_LOAD(e->z + i + k);
+            CULL_V in = CULL_SET1(0.0f);
+            for(p = 0; p != GLV_PLANE_COUNT; ++p){
+                CULL_V d = CULL_ADD(CULL_MUL(nx[p], x), CULL_MUL(ny[p], y));
+                CULL_V s = CULL_ADD(CULL_MUL(ax[p], ex), CULL_MUL(ay[p], ey));
+                d = CULL_ADD(CULL_ADD(d, CULL_MUL(nz[p], z)), nd[p]);
+                s = CULL_SUB(zero, CULL_ADD(s, CULL_MUL(az[p], ez)));
+                in = p == 0 ? CULL_GE(d, s) : CULL_AND(in, CULL_GE(d, s));
+                if(!CULL_MOVEMASK(in)) break;
+            }
+            word |= (uint32_t)CULL_MOVEMASK(in) << k;
+        }
+        mask[i / 32] = word;
+    }
+    return i;
+}
+
+
+#undef CULL_FN
+#undef CULL_CAT
+#undef CULL_CAT_
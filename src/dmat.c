@@ -0,0 +1,508 @@
+
+#include <math.h>
+#include <stdarg.h>
+#include "../include/dmat.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* ----- Vectors ----- */
+
+GLV_API double glv_dvec2_magnitude(const glv_dvec2* v){
+    GLV_PROFILE_FUNC();
+    return sqrt(v->x*v->x + v->y*v->y);
+}
+GLV_API double glv_dvec3_magnitude(const glv_dvec3* v){
+    GLV_PROFILE_FUNC();
+    return sqrt(v->x*v->x + v->y*v->y + v->z*v->z);
+}
+GLV_API double glv_dvec4_magnitude(const glv_dvec4* v){
+    GLV_PROFILE_FUNC();
+    return sqrt(v->x*v->x + v->y*v->y + v->z*v->z + v->w*v->w);
+}
+
+GLV_API glv_dvec2 glv_dvec2_normalize(const glv_dvec2* v){
+    GLV_PROFILE_FUNC();
+    double m = glv_dvec2_magnitude(v);
+    return (glv_dvec2){.x = v->x/m, .y = v->y/m};
+}
+GLV_API glv_dvec3 glv_dvec3_normalize(const glv_dvec3* v){
+    GLV_PROFILE_FUNC();
+    double m = glv_dvec3_magnitude(v);
+    return (glv_dvec3){.x = v->x/m, .y = v->y/m, .z = v->z/m};
+}
+GLV_API glv_dvec4 glv_dvec4_normalize(const glv_dvec4* v){
+    GLV_PROFILE_FUNC();
+    double m = glv_dvec4_magnitude(v);
+    return (glv_dvec4){.x = v->x/m, .y = v->y/m, .z = v->z/m, .w = v->w/m};
+}
+
+GLV_API double glv_dvec2_dot(const glv_dvec2* v1, const glv_dvec2* v2){
+    GLV_PROFILE_FUNC();
+    return (v1->x * v2->x + v1->y * v2->y);
+}
+GLV_API double glv_dvec3_dot(const glv_dvec3* v1, const glv_dvec3* v2){
+    GLV_PROFILE_FUNC();
+    return (v1->x * v2->x + v1->y * v2->y + v1->z * v2->z);
+}
+GLV_API double glv_dvec4_dot(const glv_dvec4* v1, const glv_dvec4* v2){
+    GLV_PROFILE_FUNC();
+    return (v1->x * v2->x + v1->y * v2->y + v1->z * v2->z + v1->w * v2->w);
+}
+
+GLV_API glv_dvec3 glv_dvec3_cross(const glv_dvec3* v1, const glv_dvec3* v2){
+    GLV_PROFILE_FUNC();
+    double x, y, z;
+    x = v1->y * v2->z - v1->z * v2->y;
+    y = v1->z * v2->x - v1->x * v2->z;
+    z = v1->x * v2->y - v1->y * v2->x;
+    return (glv_dvec3){.x = x, .y = y, .z = z};
+}
+
+
+/* ----- Matrices ----- */
+
+GLV_API glv_dmat4 glv_dmat4_diagonal(double e00, double e11, double e22, double e33){
+    GLV_PROFILE_FUNC();
+    glv_dmat4 m = {0};
+    m.data[0][0] = e00;
+    m.data[1][1] = e11;
+    m.data[2][2] = e22;
+    m.data[3][3] = e33;
+    return m;
+}
+
+GLV_API glv_dmat4 glv_dmat4_identity(void){
+    GLV_PROFILE_FUNC();
+    return glv_dmat4_diagonal(1.0, 1.0, 1.0, 1.0);
+}
+
+GLV_API glv_dmat4 glv_dmat4_transpose(const glv_dmat4* m){
+    GLV_PROFILE_FUNC();
+    glv_dmat4 t;
+    unsigned int i, j;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            t.data[i][j] = m->data[j][i];
+        }
+    }
+    return t;
+}
+
+GLV_API double glv_dmat4_minor(const glv_dmat4* m, unsigned int i, unsigned int j){
+    GLV_PROFILE_FUNC();
+    double s[3][3], det = 0;
+    unsigned int k, l; // input matrix 4x4 indices
+    unsigned int a = 0, b = 0; // submatrix 3x3 indices
+    for(k = 0; k != GLV_MAT4_RANK; k++){
+        if (k == i) continue;
+        for(l = 0; l != GLV_MAT4_RANK; l++){
+            if (l == j) continue;
+            s[a][b] = m->data[k][l];
+            b++;
+        }
+        a++;
+        b = 0;
+    }
+    // same terms and order as glv_mat3_determinant
+    det += s[0][0] * s[1][1] * s[2][2];
+    det += s[1][0] * s[2][1] * s[0][2];
+    det += s[0][1] * s[1][2] * s[2][0];
+    det -= s[0][2] * s[1][1] * s[2][0];
+    det -= s[1][0] * s[0][1] * s[2][2];
+    det -= s[0][0] * s[2][1] * s[1][2];
+    return det;
+}
+
+/* 2x2 sub-determinants of rows 0-1 (s) and rows 2-3 (c), as in mat.c */
+typedef struct { double s[6]; double c[6]; } dmat4_subdets;
+
+static void dmat4_subdets_compute(const glv_dmat4* m, dmat4_subdets* d){
+    const double (*a)[4] = m->data;
+    d->s[0] = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    d->s[1] = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    d->s[2] = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    d->s[3] = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    d->s[4] = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    d->s[5] = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+    d->c[5] = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    d->c[4] = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    d->c[3] = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    d->c[2] = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    d->c[1] = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    d->c[0] = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+}
+
+static double dmat4_subdets_det(const dmat4_subdets* d){
+    return d->s[0] * d->c[5] - d->s[1] * d->c[4] + d->s[2] * d->c[3]
+         + d->s[3] * d->c[2] - d->s[4] * d->c[1] + d->s[5] * d->c[0];
+}
+
+GLV_API double glv_dmat4_determinant(const glv_dmat4* m){
+    GLV_PROFILE_FUNC();
+    dmat4_subdets d;
+    dmat4_subdets_compute(m, &d);
+    return dmat4_subdets_det(&d);
+}
+
+GLV_API glv_dmat4 glv_dmat4_cofactors(const glv_dmat4* m){
+    GLV_PROFILE_FUNC();
+    glv_dmat4 cof;
+    double minor;
+    unsigned int i, j;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            minor = glv_dmat4_minor(m, i, j);
+            cof.data[i][j] = ((i + j) & 1) ? -minor : minor;
+        }
+    }
+    return cof;
+}
+
+GLV_API glv_dmat4 glv_dmat4_inverse(const glv_dmat4* m){
+    GLV_PROFILE_FUNC();
+    const double (*a)[4] = m->data;
+    dmat4_subdets d;
+    double det, r;
+    glv_dmat4 b;
+
+    dmat4_subdets_compute(m, &d);
+    det = dmat4_subdets_det(&d);
+    if(det == 0) return (glv_dmat4){0}; // non-invertible matrix
+    r = 1.0 / det;
+
+    b.data[0][0] = ( a[1][1] * d.c[5] - a[1][2] * d.c[4] + a[1][3] * d.c[3]) * r;
+    b.data[0][1] = (-a[0][1] * d.c[5] + a[0][2] * d.c[4] - a[0][3] * d.c[3]) * r;
+    b.data[0][2] = ( a[3][1] * d.s[5] - a[3][2] * d.s[4] + a[3][3] * d.s[3]) * r;
+    b.data[0][3] = (-a[2][1] * d.s[5] + a[2][2] * d.s[4] - a[2][3] * d.s[3]) * r;
+
+    b.data[1][0] = (-a[1][0] * d.c[5] + a[1][2] * d.c[2] - a[1][3] * d.c[1]) * r;
+    b.data[1][1] = ( a[0][0] * d.c[5] - a[0][2] * d.c[2] + a[0][3] * d.c[1]) * r;
+    b.data[1][2] = (-a[3][0] * d.s[5] + a[3][2] * d.s[2] - a[3][3] * d.s[1]) * r;
+    b.data[1][3] = ( a[2][0] * d.s[5] - a[2][2] * d.s[2] + a[2][3] * d.s[1]) * r;
+
+    b.data[2][0] = ( a[1][0] * d.c[4] - a[1][1] * d.c[2] + a[1][3] * d.c[0]) * r;
+    b.data[2][1] = (-a[0][0] * d.c[4] + a[0][1] * d.c[2] - a[0][3] * d.c[0]) * r;
+    b.data[2][2] = ( a[3][0] * d.s[4] - a[3][1] * d.s[2] + a[3][3] * d.s[0]) * r;
+    b.data[2][3] = (-a[2][0] * d.s[4] + a[2][1] * d.s[2] - a[2][3] * d.s[0]) * r;
+
+    b.data[3][0] = (-a[1][0] * d.c[3] + a[1][1] * d.c[1] - a[1][2] * d.c[0]) * r;
+    b.data[3][1] = ( a[0][0] * d.c[3] - a[0][1] * d.c[1] + a[0][2] * d.c[0]) * r;
+    b.data[3][2] = (-a[3][0] * d.s[3] + a[3][1] * d.s[1] - a[3][2] * d.s[0]) * r;
+    b.data[3][3] = ( a[2][0] * d.s[3] - a[2][1] * d.s[1] + a[2][2] * d.s[0]) * r;
+    return b;
+}
+
+GLV_API glv_dmat4 glv_dmat4_inverse_affine(const glv_dmat4* m){
+    GLV_PROFILE_FUNC();
+    const double (*a)[4] = m->data;
+    glv_dmat4 inv = {0};
+    double det, r;
+    unsigned int i, j;
+
+    // inverse of the upper-left 3x3 block via its adjugate
+    inv.data[0][0] = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+    inv.data[1][0] = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+    inv.data[2][0] = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+    det = a[0][0] * inv.data[0][0] + a[0][1] * inv.data[1][0] + a[0][2] * inv.data[2][0];
+    if(det == 0) return (glv_dmat4){0}; // non-invertible matrix
+
+    inv.data[0][1] = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+    inv.data[0][2] = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+    inv.data[1][1] = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+    inv.data[1][2] = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+    inv.data[2][1] = a[0][1] * a[2][0] - a[0][0] * a[2][1];
+    inv.data[2][2] = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+
+    r = 1.0 / det;
+    for(i = 0; i != 3; ++i){
+        for(j = 0; j != 3; ++j){
+            inv.data[i][j] *= r;
+        }
+    }
+
+    // translation becomes -A^-1 * t
+    for(i = 0; i != 3; ++i){
+        inv.data[i][3] = -(inv.data[i][0] * a[0][3] + inv.data[i][1] * a[1][3] + inv.data[i][2] * a[2][3]);
+    }
+    inv.data[3][3] = 1.0;
+    return inv;
+}
+
+/*
+    Each element is ((a0 * b0 + a1 * b1) + a2 * b2) + a3 * b3.
+    The AVX path computes a whole row per instruction and the SSE2
+    path half a row, with the same products and order of sums.
+*/
+#ifdef GLV_X86
+GLV_TARGET_AVX
+static void dmat4_multiply_avx(const glv_dmat4* a, const glv_dmat4* b, glv_dmat4* s){
+    const __m256d b0 = _mm256_loadu_pd(b->data[0]), b1 = _mm256_loadu_pd(b->data[1]);
+    const __m256d b2 = _mm256_loadu_pd(b->data[2]), b3 = _mm256_loadu_pd(b->data[3]);
+    unsigned int i;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        __m256d r = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(a->data[i][0]), b0),
+            _mm256_mul_pd(_mm256_set1_pd(a->data[i][1]), b1));
+        r = _mm256_add_pd(r, _mm256_mul_pd(_mm256_set1_pd(a->data[i][2]), b2));
+        r = _mm256_add_pd(r, _mm256_mul_pd(_mm256_set1_pd(a->data[i][3]), b3));
+        _mm256_storeu_pd(s->data[i], r);
+    }
+}
+
+GLV_TARGET_SSE2
+static void dmat4_multiply_sse2(const glv_dmat4* a, const glv_dmat4* b, glv_dmat4* s){
+    unsigned int i, h;
+    for(h = 0; h != 4; h += 2){
+        const __m128d b0 = _mm_loadu_pd(b->data[0] + h), b1 = _mm_loadu_pd(b->data[1] + h);
+        const __m128d b2 = _mm_loadu_pd(b->data[2] + h), b3 = _mm_loadu_pd(b->data[3] + h);
+        for(i = 0; i != GLV_MAT4_RANK; ++i){
+            __m128d r = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(a->data[i][0]), b0),
+                _mm_mul_pd(_mm_set1_pd(a->data[i][1]), b1));
+            r = _mm_add_pd(r, _mm_mul_pd(_mm_set1_pd(a->data[i][2]), b2));
+            r = _mm_add_pd(r, _mm_mul_pd(_mm_set1_pd(a->data[i][3]), b3));
+            _mm_storeu_pd(s->data[i] + h, r);
+        }
+    }
+}
+#endif /* GLV_X86 */
+
+GLV_API glv_dmat4 glv_dmat4_multiply(const glv_dmat4* m1, const glv_dmat4* m2){
+    GLV_PROFILE_FUNC();
+    glv_dmat4 s;
+    unsigned int i, j;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_AVX){
+        dmat4_multiply_avx(m1, m2, &s);
+        return s;
+    }
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        dmat4_multiply_sse2(m1, m2, &s);
+        return s;
+    }
+#endif
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            s.data[i][j] = m1->data[i][0] * m2->data[0][j] + m1->data[i][1] * m2->data[1][j]
+                + m1->data[i][2] * m2->data[2][j] + m1->data[i][3] * m2->data[3][j];
+        }
+    }
+    return s;
+}
+
+GLV_API glv_dmat4 glv_dmat4_nmultiply(unsigned int len, ...){
+    GLV_PROFILE_FUNC();
+    if(len == 0) return (glv_dmat4){0};
+    va_list args;
+    va_start(args, len);
+    glv_dmat4 s, *n;
+    s = *va_arg(args, glv_dmat4*);
+    unsigned int i;
+    for(i = 1; i != len; ++i){
+        n = va_arg(args, glv_dmat4*);
+        s = glv_dmat4_multiply(&s, n);
+    }
+    va_end(args);
+    return s;
+}
+
+
+/* ----- Transforms ----- */
+
+GLV_API glv_dmat4 glv_dscale(const glv_dmat4* m, const glv_dvec3* v){
+    GLV_PROFILE_FUNC();
+    glv_dmat4 s = glv_dmat4_diagonal(v->x, v->y, v->z, 1.0);
+    return glv_dmat4_multiply(m, &s);
+}
+
+GLV_API glv_dmat4 glv_dtranslate(const glv_dmat4* m, const glv_dvec3* v){
+    GLV_PROFILE_FUNC();
+    glv_dmat4 t = glv_dmat4_identity();
+    t.data[0][3] = v->x;
+    t.data[1][3] = v->y;
+    t.data[2][3] = v->z;
+    return glv_dmat4_multiply(m, &t);
+}
+
+GLV_API glv_dmat4 glv_drotate(const glv_dmat4* m, double a, const glv_dvec3* v){
+    GLV_PROFILE_FUNC();
+
+    #ifdef GLV_USE_DEGREES
+        a = a * (M_PI / 180.0);
+    #endif
+
+    const double c = cos(a);
+    const double s = sin(a);
+    const glv_dvec3 axis = glv_dvec3_normalize(v);
+    const glv_dvec3 temp = {.x = (1.0 - c) * axis.x, .y = (1.0 - c) * axis.y, .z = (1.0 - c) * axis.z};
+    double rot[3][3];
+    glv_dmat4 res;
+    unsigned int i;
+
+    rot[0][0] = c + temp.x * axis.x;
+    rot[1][0] = temp.x * axis.y + s * axis.z;
+    rot[2][0] = temp.x * axis.z - s * axis.y;
+
+    rot[0][1] = temp.y * axis.x - s * axis.z;
+    rot[1][1] = c + temp.y * axis.y;
+    rot[2][1] = temp.y * axis.z + s * axis.x;
+
+    rot[0][2] = temp.z * axis.x + s * axis.y;
+    rot[1][2] = temp.z * axis.y - s * axis.x;
+    rot[2][2] = c + temp.z * axis.z;
+
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        res.data[i][0] = m->data[i][0] * rot[0][0] + m->data[i][1] * rot[1][0] + m->data[i][2] * rot[2][0];
+        res.data[i][1] = m->data[i][0] * rot[0][1] + m->data[i][1] * rot[1][1] + m->data[i][2] * rot[2][1];
+        res.data[i][2] = m->data[i][0] * rot[0][2] + m->data[i][1] * rot[1][2] + m->data[i][2] * rot[2][2];
+        res.data[i][3] = m->data[i][3];
+    }
+    return res;
+}
+
+GLV_API glv_dmat4 glv_dortho2D(double left, double right, double bottom, double top){
+    GLV_PROFILE_FUNC();
+    glv_dmat4 m = {0};
+    m.data[0][0] = 2.0/(right-left);
+    m.data[1][1] = 2.0/(top-bottom);
+    m.data[2][2] = -1.0;
+    m.data[3][3] = 1.0;
+
+    m.data[0][3] = - (right + left) / (right - left);
+    m.data[1][3] = - (top + bottom) / (top - bottom);
+    return m;
+}
+
+GLV_API glv_dmat4 glv_dortho(double left, double right, double bottom, double top, double near, double far){
+    GLV_PROFILE_FUNC();
+    // uses right-handed [-1,1] clip space.
+    glv_dmat4 m = {0};
+    m.data[0][0] = 2.0/(right-left);
+    m.data[1][1] = 2.0/(top-bottom);
+    m.data[2][2] = -2.0/(far-near);
+    m.data[3][3] = 1.0;
+
+    m.data[0][3] = - (right + left) / (right - left);
+    m.data[1][3] = - (top + bottom) / (top - bottom);
+    m.data[2][3] = - (far + near) / (far - near);
+    return m;
+}
+
+GLV_API glv_dmat4 glv_dfrustum(double left, double right, double bottom, double top, double near, double far){
+    GLV_PROFILE_FUNC();
+    // uses right-handed [-1,1] clip space.
+    glv_dmat4 m = {0};
+
+    m.data[0][0] = 2.0 * near / (right - left);
+    m.data[1][1] = 2.0 * near / (top - bottom);
+    m.data[2][2] = - (far + near) / (far - near);
+
+    m.data[0][2] = (right + left) / (right - left);
+    m.data[1][2] = (top + bottom) / (top - bottom);
+    m.data[3][2] = -1.0;
+    m.data[2][3] = - 2.0 * far * near / (far - near);
+
+    return m;
+}
+
+GLV_API glv_dmat4 glv_dperspective(double fovy, double aspect, double near, double far){
+    GLV_PROFILE_FUNC();
+    // uses right-handed [-1,1] clip space.
+    #ifdef GLV_USE_DEGREES
+        fovy = fovy * (M_PI / 180.0);
+    #endif
+    double h = near * tan(fovy / 2.0);
+    double w = aspect * h;
+    return glv_dfrustum(-w, w, -h, h, near, far);
+}
+
+GLV_API glv_dmat4 glv_dlookat(const glv_dvec3* eye, const glv_dvec3* centre, const glv_dvec3* up){
+    GLV_PROFILE_FUNC();
+    glv_dvec3 f, s, u;
+    glv_dmat4 m = glv_dmat4_identity();
+    f = glv_dvec3_normalize(&(glv_dvec3){
+        .x = centre->x - eye->x,
+        .y = centre->y - eye->y,
+        .z = centre->z - eye->z
+    });
+    s = glv_dvec3_cross(&f, up);
+    s = glv_dvec3_normalize(&s);
+    u = glv_dvec3_cross(&s, &f);
+
+    m.data[0][0] = s.x;
+    m.data[0][1] = s.y;
+    m.data[0][2] = s.z;
+    m.data[1][0] = u.x;
+    m.data[1][1] = u.y;
+    m.data[1][2] = u.z;
+    m.data[2][0] = -f.x;
+    m.data[2][1] = -f.y;
+    m.data[2][2] = -f.z;
+    m.data[0][3] = -glv_dvec3_dot(&s, eye);
+    m.data[1][3] = -glv_dvec3_dot(&u, eye);
+    m.data[2][3] = glv_dvec3_dot(&f, eye);
+    return m;
+}
+
+GLV_API glv_dvec4 glv_dtransform(const glv_dvec4* v, const glv_dmat4* m){
+    GLV_PROFILE_FUNC();
+    glv_dvec4 t;
+    unsigned int i;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        t.data[i] = v->x * m->data[i][0] + v->y * m->data[i][1] + v->z * m->data[i][2] + v->w * m->data[i][3];
+    }
+    return t;
+}
+
+
+/* ----- Conversion ----- */
+
+GLV_API glv_dmat4 glv_mat4_to_dmat4(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    glv_dmat4 d;
+    unsigned int i, j;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            d.data[i][j] = m->data[i][j];
+        }
+    }
+    return d;
+}
+
+GLV_API glv_mat4 glv_dmat4_to_mat4(const glv_dmat4* m){
+    GLV_PROFILE_FUNC();
+    glv_mat4 f;
+    unsigned int i, j;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            f.data[i][j] = (float)m->data[i][j];
+        }
+    }
+    return f;
+}
+
+GLV_API glv_mat4 glv_dmat4_to_mat4_relative(const glv_dmat4* m, const glv_dvec3* origin){
+    GLV_PROFILE_FUNC();
+    // row i of translate(-origin) * m is m[i] - origin[i] * m[3], exact in double before rounding
+    glv_mat4 f;
+    unsigned int i, j;
+    for(i = 0; i != 3; ++i){
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            f.data[i][j] = (float)(m->data[i][j] - origin->data[i] * m->data[3][j]);
+        }
+    }
+    for(j = 0; j != GLV_MAT4_RANK; ++j){
+        f.data[3][j] = (float)m->data[3][j];
+    }
+    return f;
+}
+
+GLV_API void glv_dvec3_to_vec3_relative(const glv_dvec3* in, const glv_dvec3* origin, glv_vec3* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const double ox = origin->x, oy = origin->y, oz = origin->z;
+    size_t i;
+    for(i = 0; i != n; ++i){
+        out[i].x = (float)(in[i].x - ox);
+        out[i].y = (float)(in[i].y - oy);
+        out[i].z = (float)(in[i].z - oz);
+    }
+}
@@ -0,0 +1,198 @@
+
+#include "../include/fast.h"
+#include "fast_internal.h"
+#include "profile_internal.h"
+
+/* ----- Scalars ----- */
+
+GLV_API float glv_fast_rsqrt(float x){
+    GLV_PROFILE_FUNC();
+    return fast_rsqrt(x);
+}
+
+GLV_API float glv_fast_rcp(float x){
+    GLV_PROFILE_FUNC();
+    return fast_rcp(x);
+}
+
+GLV_API void glv_fast_sincos(float x, float* s, float* c){
+    GLV_PROFILE_FUNC();
+    fast_sincos(x, s, c);
+}
+
+GLV_API float glv_fast_sin(float x){
+    GLV_PROFILE_FUNC();
+    float s, c;
+    fast_sincos(x, &s, &c);
+    return s;
+}
+
+GLV_API float glv_fast_cos(float x){
+    GLV_PROFILE_FUNC();
+    float s, c;
+    fast_sincos(x, &s, &c);
+    return c;
+}
+
+GLV_API float glv_fast_tan(float x){
+    GLV_PROFILE_FUNC();
+    float s, c;
+    fast_sincos(x, &s, &c);
+    return s * fast_rcp(c);
+}
+
+/*
+    The kernels evaluate fast_sincos lane by lane with the same
+    operations, so every element matches the scalar function.
+    The quadrant logic needs 32-bit integer lanes, so AVX runs the
+    SSE2 code and AVX2 and above the 256-bit one.
+*/
+#ifdef GLV_X86
+GLV_TARGET_SSE2
+static size_t fast_sincos_sse2(const float* x, float* s, float* c, size_t n){
+    const __m128 sign = _mm_set1_ps(-0.0f), half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f);
+    const __m128i i1 = _mm_set1_epi32(1), i2 = _mm_set1_epi32(2);
+    size_t i;
+    for(i = 0; i + 4 <= n; i += 4){
+        const __m128 a = _mm_loadu_ps(x + i);
+        const __m128 bias = _mm_or_ps(_mm_and_ps(a, sign), half);
+        const __m128i k = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(0.636619772f)), bias));
+        const __m128 kf = _mm_cvtepi32_ps(k);
+        __m128 r = _mm_sub_ps(a, _mm_mul_ps(kf, _mm_set1_ps(1.5703125f)));
+        r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(4.837512969970703125e-4f)));
+        r = _mm_sub_ps(r, _mm_mul_ps(kf, _mm_set1_ps(7.54978995489188216e-8f)));
+        const __m128 z = _mm_mul_ps(r, r);
+        __m128 sr = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), z), _mm_set1_ps(8.3321608736e-3f));
+        sr = _mm_sub_ps(_mm_mul_ps(sr, z), _mm_set1_ps(1.6666654611e-1f));
+        sr = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sr, z), r), r);
+        __m128 cr = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), z), _mm_set1_ps(1.388731625493765e-3f));
+        cr = _mm_add_ps(_mm_mul_ps(cr, z), _mm_set1_ps(4.166664568298827e-2f));
+        cr = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(cr, z), z), _mm_mul_ps(half, z));
+        cr = _mm_add_ps(cr, one);
+        const __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(k, i1), i1));
+        const __m128 ssign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(k, i2), 30));
+        const __m128 csign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(k, i1), i2), 30));
+        _mm_storeu_ps(s + i, _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, cr), _mm_andnot_ps(swap, sr)), ssign));
+        _mm_storeu_ps(c + i, _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, sr), _mm_andnot_ps(swap, cr)), csign));
+    }
+    return i;
+}
+
+GLV_TARGET_AVX2
+static size_t fast_sincos_avx2(const float* x, float* s, float* c, size_t n){
+    const __m256 sign = _mm256_set1_ps(-0.0f), half = _mm256_set1_ps(0.5f), one = _mm256_set1_ps(1.0f);
+    const __m256i i1 = _mm256_set1_epi32(1), i2 = _mm256_set1_epi32(2);
+    size_t i;
+    for(i = 0; i + 8 <= n; i += 8){
+        const __m256 a = _mm256_loadu_ps(x + i);
+        const __m256 bias = _mm256_or_ps(_mm256_and_ps(a, sign), half);
+        const __m256i k = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(a, _mm256_set1_ps(0.636619772f)), bias));
+        const __m256 kf = _mm256_cvtepi32_ps(k);
+        __m256 r = _mm256_sub_ps(a, _mm256_mul_ps(kf, _mm256_set1_ps(1.5703125f)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(kf, _mm256_set1_ps(4.837512969970703125e-4f)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(kf, _mm256_set1_ps(7.54978995489188216e-8f)));
+        const __m256 z = _mm256_mul_ps(r, r);
+        __m256 sr = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-1.9515295891e-4f), z), _mm256_set1_ps(8.3321608736e-3f));
+        sr = _mm256_sub_ps(_mm256_mul_ps(sr, z), _mm256_set1_ps(1.6666654611e-1f));
+        sr = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sr, z), r), r);
+        __m256 cr = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(2.443315711809948e-5f), z), _mm256_set1_ps(1.388731625493765e-3f));
+        cr = _mm256_add_ps(_mm256_mul_ps(cr, z), _mm256_set1_ps(4.166664568298827e-2f));
+        cr = _mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(cr, z), z), _mm256_mul_ps(half, z));
+        cr = _mm256_add_ps(cr, one);
+        const __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(k, i1), i1));
+        const __m256 ssign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(k, i2), 30));
+        const __m256 csign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(k, i1), i2), 30));
+        _mm256_storeu_ps(s + i, _mm256_xor_ps(_mm256_blendv_ps(sr, cr, swap), ssign));
+        _mm256_storeu_ps(c + i, _mm256_xor_ps(_mm256_blendv_ps(cr, sr, swap), csign));
+    }
+    return i;
+}
+#endif /* GLV_X86 */
+
+GLV_API void glv_fast_sincos_array(const float* x, float* s, float* c, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_AVX2) i = fast_sincos_avx2(x, s, c, n);
+    else if(glv_simd_get_level() >= GLV_SIMD_SSE2) i = fast_sincos_sse2(x, s, c, n);
+#endif
+    for(; i != n; ++i){
+        fast_sincos(x[i], &s[i], &c[i]);
+    }
+}
+
+
+/* ----- Vectors ----- */
+
+GLV_API glv_vec2 glv_vec2_fast_normalize(const glv_vec2* v){
+    GLV_PROFILE_FUNC();
+    const float r = fast_rsqrt(v->x*v->x + v->y*v->y);
+    return (glv_vec2){.x = v->x * r, .y = v->y * r};
+}
+
+GLV_API glv_vec3 glv_vec3_fast_normalize(const glv_vec3* v){
+    GLV_PROFILE_FUNC();
+    const float r = fast_rsqrt(v->x*v->x + v->y*v->y + v->z*v->z);
+    return (glv_vec3){.x = v->x * r, .y = v->y * r, .z = v->z * r};
+}
+
+GLV_API glv_vec4 glv_vec4_fast_normalize(const glv_vec4* v){
+    GLV_PROFILE_FUNC();
+    const float r = fast_rsqrt(v->x*v->x + v->y*v->y + v->z*v->z + v->w*v->w);
+    return (glv_vec4){.x = v->x * r, .y = v->y * r, .z = v->z * r, .w = v->w * r};
+}
+
+/*
+    The kernels repeat fast_rsqrt lane by lane. rsqrtps and rsqrtss
+    share their estimate table, so every element matches the scalar
+    function. AVX-512 runs the AVX code, as its rsqrt14 estimate differs.
+*/
+#ifdef GLV_X86
+GLV_TARGET_SSE2
+static size_t soa_fast_normalize3_sse2(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n){
+    const __m128 half = _mm_set1_ps(0.5f), three_halves = _mm_set1_ps(1.5f);
+    size_t i;
+    for(i = 0; i + 4 <= n; i += 4){
+        const __m128 x = _mm_loadu_ps(v->x + i), y = _mm_loadu_ps(v->y + i), z = _mm_loadu_ps(v->z + i);
+        const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        __m128 r = _mm_rsqrt_ps(d);
+        r = _mm_mul_ps(r, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, d), _mm_mul_ps(r, r))));
+        _mm_storeu_ps(out->x + i, _mm_mul_ps(x, r));
+        _mm_storeu_ps(out->y + i, _mm_mul_ps(y, r));
+        _mm_storeu_ps(out->z + i, _mm_mul_ps(z, r));
+    }
+    return i;
+}
+
+GLV_TARGET_AVX
+static size_t soa_fast_normalize3_avx(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n){
+    const __m256 half = _mm256_set1_ps(0.5f), three_halves = _mm256_set1_ps(1.5f);
+    size_t i;
+    for(i = 0; i + 8 <= n; i += 8){
+        const __m256 x = _mm256_loadu_ps(v->x + i), y = _mm256_loadu_ps(v->y + i), z = _mm256_loadu_ps(v->z + i);
+        const __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+        __m256 r = _mm256_rsqrt_ps(d);
+        r = _mm256_mul_ps(r, _mm256_sub_ps(three_halves, _mm256_mul_ps(_mm256_mul_ps(half, d), _mm256_mul_ps(r, r))));
+        _mm256_storeu_ps(out->x + i, _mm256_mul_ps(x, r));
+        _mm256_storeu_ps(out->y + i, _mm256_mul_ps(y, r));
+        _mm256_storeu_ps(out->z + i, _mm256_mul_ps(z, r));
+    }
+    return i;
+}
+#endif /* GLV_X86 */
+
+GLV_API void glv_vec3_soa_fast_normalize(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+    glv_vec3 r;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_AVX) i = soa_fast_normalize3_avx(v, out, n);
+    else if(glv_simd_get_level() >= GLV_SIMD_SSE2) i = soa_fast_normalize3_sse2(v, out, n);
+#endif
+    for(; i != n; ++i){
+        r = glv_vec3_fast_normalize(&(glv_vec3){.x = v->x[i], .y = v->y[i], .z = v->z[i]});
+        out->x[i] = r.x;
+        out->y[i] = r.y;
+        out->z[i] = r.z;
+    }
+}
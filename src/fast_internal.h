@@ -0,0 +1,67 @@
+/*
+    === fast_internal.h ===
+
+    Private to the library: the fast.h primitives as inline functions,
+    shared by fast.c and the fast matrix builders in transform.c so that
+    they inline across translation units of lib/libglv.a.
+*/
+
+#ifndef GLV_FAST_INTERNAL_H
+#define GLV_FAST_INTERNAL_H 1
+
+#include <stdint.h>
+#include <string.h>
+#include "simd_internal.h"
+
+static inline float fast_rsqrt(float x){
+#ifdef GLV_X86
+    const float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+    // bit-level estimate, about 4 bits short of the SSE one
+    uint32_t i;
+    float y;
+    memcpy(&i, &x, sizeof(i));
+    i = 0x5f375a86 - (i >> 1);
+    memcpy(&y, &i, sizeof(y));
+    y = y * (1.5f - (0.5f * x) * (y * y));
+#endif
+    // Newton step for 1/y^2 = x
+    return y * (1.5f - (0.5f * x) * (y * y));
+}
+
+static inline float fast_rcp(float x){
+#ifdef GLV_X86
+    const float y = _mm_cvtss_f32(_mm_rcp_ss(_mm_set_ss(x)));
+    // Newton step for 1/y = x
+    return y * (2.0f - x * y);
+#else
+    return 1.0f / x;
+#endif
+}
+
+/*
+    x is reduced to r in [-pi/4, pi/4] with x = r + k * pi/2, subtracting
+    k * pi/2 in three parts so that the first two products are exact.
+    sin(r) and cos(r) use the minimax polynomials of the Cephes library.
+    The quadrant swaps the two and flips their signs without branches.
+*/
+static inline void fast_sincos(float x, float* s, float* c){
+    const int k = (int)(x * 0.636619772f + (x < 0.0f ? -0.5f : 0.5f));
+    const float kf = (float)k;
+    const float r = ((x - kf * 1.5703125f) - kf * 4.837512969970703125e-4f) - kf * 7.54978995489188216e-8f;
+    const float z = r * r;
+    const float sr = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+    const float cr = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z
+        - 0.5f * z + 1.0f;
+    const uint32_t ssign = (uint32_t)(k & 2) << 30, csign = (uint32_t)((k + 1) & 2) << 30;
+    float a = (k & 1) ? cr : sr, b = (k & 1) ? sr : cr;
+    uint32_t ai, bi;
+    memcpy(&ai, &a, sizeof(ai));
+    memcpy(&bi, &b, sizeof(bi));
+    ai ^= ssign;
+    bi ^= csign;
+    memcpy(s, &ai, sizeof(ai));
+    memcpy(c, &bi, sizeof(bi));
+}
+
+#endif /* GLV_FAST_INTERNAL_H */
@@ -0,0 +1,146 @@
+
+#include <string.h>
+#include "../include/half.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* ----- Single values ----- */
+
+GLV_API glv_half glv_half_from_float(float f){
+    GLV_PROFILE_FUNC();
+    uint32_t x, ax, sign;
+    memcpy(&x, &f, sizeof(x));
+    sign = (x >> 16) & 0x8000;
+    ax = x & 0x7fffffff;
+
+    if(ax > 0x7f800000){
+        // NaN: quiet, keeping the top of the payload like F16C
+        return (glv_half)(sign | 0x7e00 | ((ax >> 13) & 0x3ff));
+    }
+    if(ax >= 0x477ff000){
+        // 65520 and above round to infinity
+        return (glv_half)(sign | 0x7c00);
+    }
+    if(ax < 0x38800000){
+        // subnormal or zero: adding 0.5 shifts the mantissa into place,
+        // and the float addition rounds to nearest even
+        float a, magic = 0.5f;
+        uint32_t bits, mbits;
+        memcpy(&a, &ax, sizeof(a));
+        a += magic;
+        memcpy(&bits, &a, sizeof(bits));
+        memcpy(&mbits, &magic, sizeof(mbits));
+        return (glv_half)(sign | (bits - mbits));
+    }
+    // normal: rebias the exponent, round the 13 dropped bits to nearest even
+    ax = ax - 0x38000000 + 0xfff + ((ax >> 13) & 1);
+    return (glv_half)(sign | (ax >> 13));
+}
+
+GLV_API float glv_half_to_float(glv_half h){
+    GLV_PROFILE_FUNC();
+    const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    const uint32_t e = (h >> 10) & 0x1f, m = h & 0x3ff;
+    uint32_t x;
+    float f;
+    if(e == 0x1f){
+        // infinity or NaN, NaNs are made quiet like F16C
+        x = 0x7f800000 | (m << 13) | (m ? 0x400000 : 0);
+    }
+    else if(e == 0){
+        // zero or subnormal, m * 2^-24 is exact
+        f = (float)m * 5.9604644775390625e-8f;
+        memcpy(&x, &f, sizeof(x));
+    }
+    else{
+        x = ((e + 112) << 23) | (m << 13);
+    }
+    x |= sign;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+
+/* ----- Batch conversion ----- */
+
+#ifdef GLV_X86
+
+GLV_TARGET_F16C
+static size_t half_from_float_f16c(const float* in, glv_half* out, size_t n){
+    size_t i;
+    for(i = 0; i + 8 <= n; i += 8){
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(out + i), h);
+    }
+    return i;
+}
+
+GLV_TARGET_F16C
+static size_t half_to_float_f16c(const glv_half* in, float* out, size_t n){
+    size_t i;
+    for(i = 0; i + 8 <= n; i += 8){
+        const __m128i h = _mm_loadu_si128((const __m128i*)(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+    return i;
+}
+
+/* F16C comes with every AVX2 CPU and most AVX ones, so it is checked apart from the level */
+static int half_use_f16c(void){
+    return glv_simd_get_level() >= GLV_SIMD_AVX && __builtin_cpu_supports("f16c");
+}
+
+#endif /* GLV_X86 */
+
+GLV_API void glv_half_from_float_array(const float* in, glv_half* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(half_use_f16c()) i = half_from_float_f16c(in, out, n);
+#endif
+    for(; i != n; ++i){
+        out[i] = glv_half_from_float(in[i]);
+    }
+}
+
+GLV_API void glv_half_to_float_array(const glv_half* in, float* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(half_use_f16c()) i = half_to_float_f16c(in, out, n);
+#endif
+    for(; i != n; ++i){
+        out[i] = glv_half_to_float(in[i]);
+    }
+}
+
+/* Both layouts are packed, so vectors convert as flat arrays */
+GLV_API void glv_vec2_to_hvec2(const glv_vec2* in, glv_hvec2* out, size_t n){
+    GLV_PROFILE_FUNC();
+    glv_half_from_float_array(in->data, out->data, n * GLV_VEC2_LEN);
+}
+
+GLV_API void glv_vec3_to_hvec3(const glv_vec3* in, glv_hvec3* out, size_t n){
+    GLV_PROFILE_FUNC();
+    glv_half_from_float_array(in->data, out->data, n * GLV_VEC3_LEN);
+}
+
+GLV_API void glv_vec4_to_hvec4(const glv_vec4* in, glv_hvec4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    glv_half_from_float_array(in->data, out->data, n * GLV_VEC4_LEN);
+}
+
+GLV_API void glv_hvec2_to_vec2(const glv_hvec2* in, glv_vec2* out, size_t n){
+    GLV_PROFILE_FUNC();
+    glv_half_to_float_array(in->data, out->data, n * GLV_VEC2_LEN);
+}
+
+GLV_API void glv_hvec3_to_vec3(const glv_hvec3* in, glv_vec3* out, size_t n){
+    GLV_PROFILE_FUNC();
+    glv_half_to_float_array(in->data, out->data, n * GLV_VEC3_LEN);
+}
+
+GLV_API void glv_hvec4_to_vec4(const glv_hvec4* in, glv_vec4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    glv_half_to_float_array(in->data, out->data, n * GLV_VEC4_LEN);
+}
@@ -0,0 +1,96 @@
+
+#include <string.h>
+#include "../include/hierarchy.h"
+#include "../include/transform.h"
+#include "mat_internal.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+GLV_API void glv_hierarchy_init(const glv_hierarchy* h){
+    GLV_PROFILE_FUNC();
+    const glv_mat3 r = {.data = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}}};
+    size_t i;
+    for(i = 0; i != h->count; ++i){
+        h->translation[i] = (glv_vec3){.x = 0.0f, .y = 0.0f, .z = 0.0f};
+        h->rotation[i] = r;
+        h->scale[i] = (glv_vec3){.x = 1.0f, .y = 1.0f, .z = 1.0f};
+        h->dirty[i] = GLV_NODE_LOCAL_DIRTY | GLV_NODE_WORLD_DIRTY;
+    }
+}
+
+GLV_API int glv_hierarchy_is_sorted(const glv_hierarchy* h){
+    GLV_PROFILE_FUNC();
+    size_t i;
+    for(i = 0; i != h->count; ++i){
+        if(h->parent[i] != GLV_NODE_ROOT && h->parent[i] >= i) return 0;
+    }
+    return 1;
+}
+
+GLV_API void glv_hierarchy_set_translation(const glv_hierarchy* h, size_t i, const glv_vec3* t){
+    GLV_PROFILE_FUNC();
+    h->translation[i] = *t;
+    h->dirty[i] |= GLV_NODE_LOCAL_DIRTY;
+}
+
+GLV_API void glv_hierarchy_set_scale(const glv_hierarchy* h, size_t i, const glv_vec3* s){
+    GLV_PROFILE_FUNC();
+    h->scale[i] = *s;
+    h->dirty[i] |= GLV_NODE_LOCAL_DIRTY;
+}
+
+GLV_API void glv_hierarchy_set_rotation(const glv_hierarchy* h, size_t i, const glv_mat3* r){
+    GLV_PROFILE_FUNC();
+    h->rotation[i] = *r;
+    h->dirty[i] |= GLV_NODE_LOCAL_DIRTY;
+}
+
+GLV_API void glv_hierarchy_set_rotation_axis(const glv_hierarchy* h, size_t i, float angle, const glv_vec3* axis){
+    GLV_PROFILE_FUNC();
+    // rotating the identity gives the rotation matrix itself, in glv_rotate's units
+    glv_mat4 m = glv_mat4_identity();
+    unsigned int j;
+    m = glv_rotate(&m, angle, axis);
+    for(j = 0; j != GLV_MAT3_RANK; ++j){
+        h->rotation[i].data[j][0] = m.data[j][0];
+        h->rotation[i].data[j][1] = m.data[j][1];
+        h->rotation[i].data[j][2] = m.data[j][2];
+    }
+    h->dirty[i] |= GLV_NODE_LOCAL_DIRTY;
+}
+
+GLV_API void glv_hierarchy_mark_dirty(const glv_hierarchy* h, size_t i){
+    GLV_PROFILE_FUNC();
+    h->dirty[i] |= GLV_NODE_LOCAL_DIRTY | GLV_NODE_WORLD_DIRTY;
+}
+
+/*
+    Parents precede children, so a single forward pass sees every parent
+    world matrix final before its children read it. A node that was
+    recomputed keeps GLV_NODE_WORLD_DIRTY until the end of the pass so
+    that its children pick the change up; the flags from the first
+    touched node onwards are cleared afterwards.
+*/
+GLV_API size_t glv_hierarchy_update(const glv_hierarchy* h){
+    GLV_PROFILE_FUNC();
+    const size_t n = h->count;
+    size_t i, first = n, done = 0;
+    unsigned int p;
+    unsigned char d;
+    for(i = 0; i != n; ++i){
+        d = h->dirty[i];
+        p = h->parent[i];
+        if(p != GLV_NODE_ROOT && (h->dirty[p] & GLV_NODE_WORLD_DIRTY)) d |= GLV_NODE_WORLD_DIRTY;
+        if(!d) continue;
+        if(first == n) first = i;
+        if(d & GLV_NODE_LOCAL_DIRTY){
+            mat4_compose_trs(&h->translation[i], &h->rotation[i], &h->scale[i], &h->local[i]);
+        }
+        if(p == GLV_NODE_ROOT) h->world[i] = h->local[i];
+        else glv__simd.mat4_multiply(&h->world[p], &h->local[i], &h->world[i]);
+        h->dirty[i] = GLV_NODE_WORLD_DIRTY;
+        ++done;
+    }
+    if(first != n) memset(h->dirty + first, 0, n - first);
+    return done;
+}
@@ -0,0 +1,664 @@
+#include "../include/ivec.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* ----- Kernel instances ----- */
+
+#ifdef GLV_X86
+
+/* SSE2 lacks 32-bit min and max and float floor. Without a 32-bit multiply, the hash stays scalar */
+
+GLV_TARGET_SSE2
+static inline __m128i ivec_select_sse2(__m128i m, __m128i a, __m128i b){
+    return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+
+/* Unsigned order is signed order with the top bits flipped */
+GLV_TARGET_SSE2
+static inline __m128i ivec_gt_u_sse2(__m128i a, __m128i b){
+    const __m128i bias = _mm_set1_epi32((int)0x80000000u);
+    return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+/* Truncates, then steps down where that rounded up */
+GLV_TARGET_SSE2
+static inline __m128i ivec_floor_ps_sse2(__m128 x){
+    const __m128i t = _mm_cvttps_epi32(x);
+    return _mm_add_epi32(t, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(t), x)));
+}
+
+/* Loads lane by lane, idx is for the AVX-512 gather */
+GLV_TARGET_SSE2
+static inline __m128i ivec_gather_sse2(const int* p, unsigned int s, __m128i idx){
+    (void)idx;
+    return _mm_setr_epi32(p[0], p[s], p[2 * s], p[3 * s]);
+}
+
+#define IV_ISA sse2
+#define IV_TARGET GLV_TARGET_SSE2
+#define IV_W 4
+#define IV_I __m128i
+#define IV_F __m128
+#define IV_SET1 _mm_set1_epi32
+#define IV_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define IV_STORE(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define IV_ADD _mm_add_epi32
+#define IV_XOR _mm_xor_si128
+#define IV_SRLI _mm_srli_epi32
+#define IV_MIN_S(a, b) ivec_select_sse2(_mm_cmpgt_epi32(a, b), b, a)
+#define IV_MAX_S(a, b) ivec_select_sse2(_mm_cmpgt_epi32(a, b), a, b)
+#define IV_MIN_U(a, b) ivec_select_sse2(ivec_gt_u_sse2(a, b), b, a)
+#define IV_MAX_U(a, b) ivec_select_sse2(ivec_gt_u_sse2(a, b), a, b)
+#define IV_SET1F _mm_set1_ps
+#define IV_LOADF _mm_loadu_ps
+#define IV_SUBF _mm_sub_ps
+#define IV_MULF _mm_mul_ps
+#define IV_MINF _mm_min_ps
+#define IV_MAXF _mm_max_ps
+#define IV_FLOOR ivec_floor_ps_sse2
+#define IV_STRIDE(s) _mm_setzero_si128()
+#define IV_GATHER ivec_gather_sse2
+#define IV_NO_HASH
+#include "ivec_simd.h"
+#undef IV_NO_HASH
+#undef IV_ISA
+#undef IV_TARGET
+#undef IV_W
+#undef IV_I
+#undef IV_F
+#undef IV_SET1
+#undef IV_LOAD
+#undef IV_STORE
+#undef IV_ADD
+#undef IV_MUL
+#undef IV_XOR
+#undef IV_SRLI
+#undef IV_MIN_S
+#undef IV_MAX_S
+#undef IV_MIN_U
+#undef IV_MAX_U
+#undef IV_SET1F
+#undef IV_LOADF
+#undef IV_SUBF
+#undef IV_MULF
+#undef IV_MINF
+#undef IV_MAXF
+#undef IV_FLOOR
+#undef IV_STRIDE
+#undef IV_GATHER
+
+/* AVX has no 256-bit integer ops, but brings the SSE4.1 ones at 128 bits */
+#define IV_ISA avx
+#define IV_TARGET GLV_TARGET_AVX
+#define IV_W 4
+#define IV_I __m128i
+#define IV_F __m128
+#define IV_SET1 _mm_set1_epi32
+#define IV_LOAD(p) _mm_loadu_si128((const __m128i*)(p))
+#define IV_STORE(p, v) _mm_storeu_si128((__m128i*)(p), v)
+#define IV_ADD _mm_add_epi32
+#define IV_MUL _mm_mullo_epi32
+#define IV_XOR _mm_xor_si128
+#define IV_SRLI _mm_srli_epi32
+#define IV_MIN_S _mm_min_epi32
+#define IV_MAX_S _mm_max_epi32
+#define IV_MIN_U _mm_min_epu32
+#define IV_MAX_U _mm_max_epu32
+#define IV_SET1F _mm_set1_ps
+#define IV_LOADF _mm_loadu_ps
+#define IV_SUBF _mm_sub_ps
+#define IV_MULF _mm_mul_ps
+#define IV_MINF _mm_min_ps
+#define IV_MAXF _mm_max_ps
+#define IV_FLOOR(x) _mm_cvttps_epi32(_mm_floor_ps(x))
+#define IV_STRIDE(s) _mm_setzero_si128()
+#define IV_GATHER ivec_gather_sse2
+#include "ivec_simd.h"
+#undef IV_ISA
+#undef IV_TARGET
+#undef IV_W
+#undef IV_I
+#undef IV_F
+#undef IV_SET1
+#undef IV_LOAD
+#undef IV_STORE
+#undef IV_ADD
+#undef IV_MUL
+#undef IV_XOR
+#undef IV_SRLI
+#undef IV_MIN_S
+#undef IV_MAX_S
+#undef IV_MIN_U
+#undef IV_MAX_U
+#undef IV_SET1F
+#undef IV_LOADF
+#undef IV_SUBF
+#undef IV_MULF
+#undef IV_MINF
+#undef IV_MAXF
+#undef IV_FLOOR
+#undef IV_STRIDE
+#undef IV_GATHER
+
+#define IV_ISA avx2
+#define IV_TARGET GLV_TARGET_AVX2
+#define IV_W 8
+#define IV_I __m256i
+#define IV_F __m256
+#define IV_SET1 _mm256_set1_epi32
+#define IV_LOAD(p) _mm256_loadu_si256((const __m256i*)(p))
+#define IV_STORE(p, v) _mm256_storeu_si256((__m256i*)(p), v)
+#define IV_ADD _mm256_add_epi32
+#define IV_MUL _mm256_mullo_epi32
+#define IV_XOR _mm256_xor_si256
+#define IV_SRLI _mm256_srli_epi32
+#define IV_MIN_S _mm256_min_epi32
+#define IV_MAX_S _mm256_max_epi32
+#define IV_MIN_U _mm256_min_epu32
+#define IV_MAX_U _mm256_max_epu32
+#define IV_SET1F _mm256_set1_ps
+#define IV_LOADF _mm256_loadu_ps
+#define IV_SUBF _mm256_sub_ps
+#define IV_MULF _mm256_mul_ps
+#define IV_MINF _mm256_min_ps
+#define IV_MAXF _mm256_max_ps
+#define IV_FLOOR(x) _mm256_cvttps_epi32(_mm256_floor_ps(x))
+/* vpgatherdd loses to plain loads here */
+#define IV_STRIDE(s) _mm256_setzero_si256()
+#define IV_GATHER(p, s, idx) ((void)(idx), _mm256_setr_epi32((p)[0], (p)[s], (p)[2 * (s)], (p)[3 * (s)], \
+    (p)[4 * (s)], (p)[5 * (s)], (p)[6 * (s)], (p)[7 * (s)]))
+#include "ivec_simd.h"
+#undef IV_ISA
+#undef IV_TARGET
+#undef IV_W
+#undef IV_I
+#undef IV_F
+#undef IV_SET1
+#undef IV_LOAD
+#undef IV_STORE
+#undef IV_ADD
+#undef IV_MUL
+#undef IV_XOR
+#undef IV_SRLI
+#undef IV_MIN_S
+#undef IV_MAX_S
+#undef IV_MIN_U
+#undef IV_MAX_U
+#undef IV_SET1F
+#undef IV_LOADF
+#undef IV_SUBF
+#undef IV_MULF
+#undef IV_MINF
+#undef IV_MAXF
+#undef IV_FLOOR
+#undef IV_STRIDE
+#undef IV_GATHER
+
+#define IV_ISA avx512
+#define IV_TARGET GLV_TARGET_AVX512
+#define IV_W 16
+#define IV_I __m512i
+#define IV_F __m512
+#define IV_SET1 _mm512_set1_epi32
+#define IV_LOAD _mm512_loadu_si512
+#define IV_STORE _mm512_storeu_si512
+#define IV_ADD _mm512_add_epi32
+#define IV_MUL _mm512_mullo_epi32
+#define IV_XOR _mm512_xor_si512
+#define IV_SRLI _mm512_srli_epi32
+#define IV_MIN_S _mm512_min_epi32
+#define IV_MAX_S _mm512_max_epi32
+#define IV_MIN_U _mm512_min_epu32
+#define IV_MAX_U _mm512_max_epu32
+#define IV_SET1F _mm512_set1_ps
+#define IV_LOADF _mm512_loadu_ps
+#define IV_SUBF _mm512_sub_ps
+#define IV_MULF _mm512_mul_ps
+#define IV_MINF _mm512_min_ps
+#define IV_MAXF _mm512_max_ps
+#define IV_FLOOR(x) _mm512_cvt_roundps_epi32(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)
+#define IV_STRIDE(s) _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), \
+    _mm512_set1_epi32((int)(s)))
+#define IV_GATHER(p, s, idx) _mm512_i32gather_epi32(idx, p, 4)
+#include "ivec_simd.h"
+#undef IV_ISA
+#undef IV_TARGET
+#undef IV_W
+#undef IV_I
+#undef IV_F
+#undef IV_SET1
+#undef IV_LOAD
+#undef IV_STORE
+#undef IV_ADD
+#undef IV_MUL
+#undef IV_XOR
+#undef IV_SRLI
+#undef IV_MIN_S
+#undef IV_MAX_S
+#undef IV_MIN_U
+#undef IV_MAX_U
+#undef IV_SET1F
+#undef IV_LOADF
+#undef IV_SUBF
+#undef IV_MULF
+#undef IV_MINF
+#undef IV_MAXF
+#undef IV_FLOOR
+#undef IV_STRIDE
+#undef IV_GATHER
+
+/* Runs the widest instance for the current level, returns elements done */
+#define IV_DISPATCH(fn, ...)                                            \
+    (glv_simd_get_level() >= GLV_SIMD_AVX512 ? fn##_avx512(__VA_ARGS__) : \
+     glv_simd_get_level() >= GLV_SIMD_AVX2   ? fn##_avx2(__VA_ARGS__)   : \
+     glv_simd_get_level() >= GLV_SIMD_AVX    ? fn##_avx(__VA_ARGS__)    : \
+     glv_simd_get_level() >= GLV_SIMD_SSE2   ? fn##_sse2(__VA_ARGS__)   : 0)
+
+#else
+
+#define IV_DISPATCH(fn, ...) ((size_t)0)
+
+#endif /* GLV_X86 */
+
+
+/* ----- Flat kernels with scalar tails ----- */
+
+#define IVEC_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define IVEC_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+static void ivec_add(const int* a, const int* b, int* out, size_t n){
+    size_t i = IV_DISPATCH(ivec_add, a, b, out, n);
+    for(; i != n; ++i){
+        out[i] = (int)((unsigned int)a[i] + (unsigned int)b[i]);
+    }
+}
+
+static void ivec_min_s(const int* a, const int* b, int* out, size_t n){
+    size_t i = IV_DISPATCH(ivec_min_s, a, b, out, n);
+    for(; i != n; ++i){
+        out[i] = IVEC_MIN(a[i], b[i]);
+    }
+}
+
+static void ivec_max_s(const int* a, const int* b, int* out, size_t n){
+    size_t i = IV_DISPATCH(ivec_max_s, a, b, out, n);
+    for(; i != n; ++i){
+        out[i] = IVEC_MAX(a[i], b[i]);
+    }
+}
+
+static void ivec_min_u(const unsigned int* a, const unsigned int* b, unsigned int* out, size_t n){
+    size_t i = IV_DISPATCH(ivec_min_u, (const int*)a, (const int*)b, (int*)out, n);
+    for(; i != n; ++i){
+        out[i] = IVEC_MIN(a[i], b[i]);
+    }
+}
+
+static void ivec_max_u(const unsigned int* a, const unsigned int* b, unsigned int* out, size_t n){
+    size_t i = IV_DISPATCH(ivec_max_u, (const int*)a, (const int*)b, (int*)out, n);
+    for(; i != n; ++i){
+        out[i] = IVEC_MAX(a[i], b[i]);
+    }
+}
+
+/* lo and hi hold len components, repeated along v */
+static void ivec_clamp_s(const int* v, const int* lo, const int* hi, int* out, size_t n, unsigned int len){
+    size_t i = IV_DISPATCH(ivec_clamp_s, v, lo, hi, out, n, len);
+    for(; i != n; ++i){
+        out[i] = IVEC_MIN(IVEC_MAX(v[i], lo[i % len]), hi[i % len]);
+    }
+}
+
+static void ivec_clamp_u(const unsigned int* v, const unsigned int* lo, const unsigned int* hi, unsigned int* out,
+    size_t n, unsigned int len){
+    size_t i = IV_DISPATCH(ivec_clamp_u, (const int*)v, (const int*)lo, (const int*)hi, (int*)out, n, len);
+    for(; i != n; ++i){
+        out[i] = IVEC_MIN(IVEC_MAX(v[i], lo[i % len]), hi[i % len]);
+    }
+}
+
+/*
+    floor((x - o) * s) saturated to the int range. The clamps compare
+    as minps and maxps do, so NaN becomes the lower limit, INT_MIN.
+*/
+static void ivec_floor(const float* in, const float* origin, const float* scale, int* out, size_t n, unsigned int len){
+    size_t i = IV_DISPATCH(ivec_floor, in, origin, scale, out, n, len);
+    for(; i != n; ++i){
+        float x = (in[i] - origin[i % len]) * scale[i % len];
+        int t;
+        x = x > -2147483648.0f ? x : -2147483648.0f;
+        x = x < 2147483520.0f ? x : 2147483520.0f;
+        t = (int)x;
+        out[i] = (float)t > x ? t - 1 : t;
+    }
+}
+
+/* Weighted sum of the components, then the murmur3 finalizer to spread it over all bits */
+static uint32_t ivec_hash(const int* v, unsigned int len){
+    uint32_t h = (uint32_t)v[0] * 0x8da6b343u + (uint32_t)v[1] * 0xd8163841u;
+    if(len == 3) h += (uint32_t)v[2] * 0xcb1ab31fu;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static void ivec_hash_batch(const int* in, uint32_t* out, size_t n, unsigned int len){
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_AVX512) i = ivec_hash_avx512(in, out, n, len);
+    else if(glv_simd_get_level() >= GLV_SIMD_AVX2) i = ivec_hash_avx2(in, out, n, len);
+    else if(glv_simd_get_level() >= GLV_SIMD_AVX) i = ivec_hash_avx(in, out, n, len);
+#endif
+    for(; i != n; ++i){
+        out[i] = ivec_hash(in + i * len, len);
+    }
+}
+
+
+/* ----- Element-wise batches ----- */
+
+#define IVEC_BATCH(fn, type, len, kernel, elem)                                     \
+GLV_API void fn(const type* a, const type* b, type* out, size_t n){                 \
+    GLV_PROFILE_FUNC();                                                             \
+    kernel((const elem*)a, (const elem*)b, (elem*)out, n * (len));                  \
+}
+
+IVEC_BATCH(glv_ivec2_add_batch, glv_ivec2, GLV_VEC2_LEN, ivec_add, int)
+IVEC_BATCH(glv_ivec3_add_batch, glv_ivec3, GLV_VEC3_LEN, ivec_add, int)
+IVEC_BATCH(glv_ivec4_add_batch, glv_ivec4, GLV_VEC4_LEN, ivec_add, int)
+IVEC_BATCH(glv_uvec2_add_batch, glv_uvec2, GLV_VEC2_LEN, ivec_add, int)
+IVEC_BATCH(glv_uvec3_add_batch, glv_uvec3, GLV_VEC3_LEN, ivec_add, int)
+IVEC_BATCH(glv_uvec4_add_batch, glv_uvec4, GLV_VEC4_LEN, ivec_add, int)
+
+IVEC_BATCH(glv_ivec2_min_batch, glv_ivec2, GLV_VEC2_LEN, ivec_min_s, int)
+IVEC_BATCH(glv_ivec3_min_batch, glv_ivec3, GLV_VEC3_LEN, ivec_min_s, int)
+IVEC_BATCH(glv_ivec4_min_batch, glv_ivec4, GLV_VEC4_LEN, ivec_min_s, int)
+IVEC_BATCH(glv_uvec2_min_batch, glv_uvec2, GLV_VEC2_LEN, ivec_min_u, unsigned int)
+IVEC_BATCH(glv_uvec3_min_batch, glv_uvec3, GLV_VEC3_LEN, ivec_min_u, unsigned int)
+IVEC_BATCH(glv_uvec4_min_batch, glv_uvec4, GLV_VEC4_LEN, ivec_min_u, unsigned int)
+
+IVEC_BATCH(glv_ivec2_max_batch, glv_ivec2, GLV_VEC2_LEN, ivec_max_s, int)
+IVEC_BATCH(glv_ivec3_max_batch, glv_ivec3, GLV_VEC3_LEN, ivec_max_s, int)
+IVEC_BATCH(glv_ivec4_max_batch, glv_ivec4, GLV_VEC4_LEN, ivec_max_s, int)
+IVEC_BATCH(glv_uvec2_max_batch, glv_uvec2, GLV_VEC2_LEN, ivec_max_u, unsigned int)
+IVEC_BATCH(glv_uvec3_max_batch, glv_uvec3, GLV_VEC3_LEN, ivec_max_u, unsigned int)
+IVEC_BATCH(glv_uvec4_max_batch, glv_uvec4, GLV_VEC4_LEN, ivec_max_u, unsigned int)
+
+#undef IVEC_BATCH
+
+#define IVEC_CLAMP(fn, type, len, kernel, elem)                                     \
+GLV_API void fn(const type* v, const type* lo, const type* hi, type* out, size_t n){ \
+    GLV_PROFILE_FUNC();                                                             \
+    kernel((const elem*)v, (const elem*)lo, (const elem*)hi, (elem*)out, n * (len), len); \
+}
+
+IVEC_CLAMP(glv_ivec2_clamp_batch, glv_ivec2, GLV_VEC2_LEN, ivec_clamp_s, int)
+IVEC_CLAMP(glv_ivec3_clamp_batch, glv_ivec3, GLV_VEC3_LEN, ivec_clamp_s, int)
+IVEC_CLAMP(glv_ivec4_clamp_batch, glv_ivec4, GLV_VEC4_LEN, ivec_clamp_s, int)
+IVEC_CLAMP(glv_uvec2_clamp_batch, glv_uvec2, GLV_VEC2_LEN, ivec_clamp_u, unsigned int)
+IVEC_CLAMP(glv_uvec3_clamp_batch, glv_uvec3, GLV_VEC3_LEN, ivec_clamp_u, unsigned int)
+IVEC_CLAMP(glv_uvec4_clamp_batch, glv_uvec4, GLV_VEC4_LEN, ivec_clamp_u, unsigned int)
+
+#undef IVEC_CLAMP
+
+GLV_API void glv_vec2_floor_to_ivec2(const glv_vec2* in, const glv_vec2* origin, const glv_vec2* scale,
+    glv_ivec2* out, size_t n){
+    GLV_PROFILE_FUNC();
+    ivec_floor(in->data, origin->data, scale->data, out->data, n * GLV_VEC2_LEN, GLV_VEC2_LEN);
+}
+
+GLV_API void glv_vec3_floor_to_ivec3(const glv_vec3* in, const glv_vec3* origin, const glv_vec3* scale,
+    glv_ivec3* out, size_t n){
+    GLV_PROFILE_FUNC();
+    ivec_floor(in->data, origin->data, scale->data, out->data, n * GLV_VEC3_LEN, GLV_VEC3_LEN);
+}
+
+GLV_API void glv_vec4_floor_to_ivec4(const glv_vec4* in, const glv_vec4* origin, const glv_vec4* scale,
+    glv_ivec4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    ivec_floor(in->data, origin->data, scale->data, out->data, n * GLV_VEC4_LEN, GLV_VEC4_LEN);
+}
+
+
+/* ----- Hashing ----- */
+
+GLV_API uint32_t glv_ivec2_hash(const glv_ivec2* v){
+    GLV_PROFILE_FUNC();
+    return ivec_hash(v->data, GLV_VEC2_LEN);
+}
+
+GLV_API uint32_t glv_ivec3_hash(const glv_ivec3* v){
+    GLV_PROFILE_FUNC();
+    return ivec_hash(v->data, GLV_VEC3_LEN);
+}
+
+GLV_API void glv_ivec2_hash_batch(const glv_ivec2* in, uint32_t* out, size_t n){
+    GLV_PROFILE_FUNC();
+    ivec_hash_batch(in->data, out, n, GLV_VEC2_LEN);
+}
+
+GLV_API void glv_ivec3_hash_batch(const glv_ivec3* in, uint32_t* out, size_t n){
+    GLV_PROFILE_FUNC();
+    ivec_hash_batch(in->data, out, n, GLV_VEC3_LEN);
+}
+
+
+/* ----- Morton codes ----- */
+
+/* Bit masks of each axis in the codes */
+#define MORTON2_X 0x55555555u
+#define MORTON2_Y 0xaaaaaaaau
+#define MORTON3_X 0x1249249249249249ull
+#define MORTON3_Y 0x2492492492492492ull
+#define MORTON3_Z 0x4924924924924924ull
+
+/* Spreads the low 16 bits of x to the even bits */
+static uint32_t morton2_spread(uint32_t x){
+    x &= 0x0000ffffu;
+    x = (x | (x << 8)) & 0x00ff00ffu;
+    x = (x | (x << 4)) & 0x0f0f0f0fu;
+    x = (x | (x << 2)) & 0x33333333u;
+    x = (x | (x << 1)) & 0x55555555u;
+    return x;
+}
+
+static uint32_t morton2_compact(uint32_t x){
+    x &= 0x55555555u;
+    x = (x ^ (x >> 1)) & 0x33333333u;
+    x = (x ^ (x >> 2)) & 0x0f0f0f0fu;
+    x = (x ^ (x >> 4)) & 0x00ff00ffu;
+    x = (x ^ (x >> 8)) & 0x0000ffffu;
+    return x;
+}
+
+/* Spreads the low 21 bits of x to every third bit */
+static uint64_t morton3_spread(uint64_t x){
+    x &= 0x1fffffull;
+    x = (x | (x << 32)) & 0x1f00000000ffffull;
+    x = (x | (x << 16)) & 0x1f0000ff0000ffull;
+    x = (x | (x << 8)) & 0x100f00f00f00f00full;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+    x = (x | (x << 2)) & 0x1249249249249249ull;
+    return x;
+}
+
+static uint32_t morton3_compact(uint64_t x){
+    x &= 0x1249249249249249ull;
+    x = (x ^ (x >> 2)) & 0x10c30c30c30c30c3ull;
+    x = (x ^ (x >> 4)) & 0x100f00f00f00f00full;
+    x = (x ^ (x >> 8)) & 0x1f0000ff0000ffull;
+    x = (x ^ (x >> 16)) & 0x1f00000000ffffull;
+    x = (x ^ (x >> 32)) & 0x1fffffull;
+    return (uint32_t)x;
+}
+
+/* pdep and pext do the spreading in one instruction; the 64-bit forms need x86-64 */
+#if defined(GLV_X86) && defined(__x86_64__)
+
+#define MORTON_BMI2 1
+
+GLV_TARGET_BMI2
+static void morton2_encode_bmi2(const glv_uvec2* in, uint32_t* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        out[i] = _pdep_u32(in[i].x, MORTON2_X) | _pdep_u32(in[i].y, MORTON2_Y);
+    }
+}
+
+GLV_TARGET_BMI2
+static void morton3_encode_bmi2(const glv_uvec3* in, uint64_t* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        out[i] = _pdep_u64(in[i].x, MORTON3_X) | _pdep_u64(in[i].y, MORTON3_Y) | _pdep_u64(in[i].z, MORTON3_Z);
+    }
+}
+
+GLV_TARGET_BMI2
+static void morton2_decode_bmi2(const uint32_t* in, glv_uvec2* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        out[i].x = _pext_u32(in[i], MORTON2_X);
+        out[i].y = _pext_u32(in[i], MORTON2_Y);
+    }
+}
+
+GLV_TARGET_BMI2
+static void morton3_decode_bmi2(const uint64_t* in, glv_uvec3* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        out[i].x = (uint32_t)_pext_u64(in[i], MORTON3_X);
+        out[i].y = (uint32_t)_pext_u64(in[i], MORTON3_Y);
+        out[i].z = (uint32_t)_pext_u64(in[i], MORTON3_Z);
+    }
+}
+
+/* BMI2 came with AVX2 on both vendors, but is checked apart from the level */
+static int morton_use_bmi2(void){
+    return glv_simd_get_level() >= GLV_SIMD_AVX2 && __builtin_cpu_supports("bmi2");
+}
+
+#endif /* GLV_X86 && __x86_64__ */
+
+GLV_API uint32_t glv_morton2_encode(uint32_t x, uint32_t y){
+    GLV_PROFILE_FUNC();
+#if defined(MORTON_BMI2) && defined(__BMI2__)
+    return _pdep_u32(x, MORTON2_X) | _pdep_u32(y, MORTON2_Y);
+#else
+    return morton2_spread(x) | (morton2_spread(y) << 1);
+#endif
+}
+
+GLV_API uint64_t glv_morton3_encode(uint32_t x, uint32_t y, uint32_t z){
+    GLV_PROFILE_FUNC();
+#if defined(MORTON_BMI2) && defined(__BMI2__)
+    return _pdep_u64(x, MORTON3_X) | _pdep_u64(y, MORTON3_Y) | _pdep_u64(z, MORTON3_Z);
+#else
+    return morton3_spread(x) | (morton3_spread(y) << 1) | (morton3_spread(z) << 2);
+#endif
+}
+
+GLV_API glv_uvec2 glv_morton2_decode(uint32_t code){
+    GLV_PROFILE_FUNC();
+    glv_uvec2 v;
+    v.x = morton2_compact(code);
+    v.y = morton2_compact(code >> 1);
+    return v;
+}
+
+GLV_API glv_uvec3 glv_morton3_decode(uint64_t code){
+    GLV_PROFILE_FUNC();
+    glv_uvec3 v;
+    v.x = morton3_compact(code);
+    v.y = morton3_compact(code >> 1);
+    v.z = morton3_compact(code >> 2);
+    return v;
+}
+
+GLV_API void glv_uvec2_to_morton(const glv_uvec2* in, uint32_t* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i;
+#ifdef MORTON_BMI2
+    if(morton_use_bmi2()){
+        morton2_encode_bmi2(in, out, n);
+        return;
+    }
+#endif
+    for(i = 0; i != n; ++i){
+        out[i] = morton2_spread(in[i].x) | (morton2_spread(in[i].y) << 1);
+    }
+}
+
+static void morton3_encode_batch(const glv_uvec3* in, uint64_t* out, size_t n){
+    size_t i;
+#ifdef MORTON_BMI2
+    if(morton_use_bmi2()){
+        morton3_encode_bmi2(in, out, n);
+        return;
+    }
+#endif
+    for(i = 0; i != n; ++i){
+        out[i] = morton3_spread(in[i].x) | (morton3_spread(in[i].y) << 1) | (morton3_spread(in[i].z) << 2);
+    }
+}
+
+GLV_API void glv_uvec3_to_morton(const glv_uvec3* in, uint64_t* out, size_t n){
+    GLV_PROFILE_FUNC();
+    morton3_encode_batch(in, out, n);
+}
+
+GLV_API void glv_morton_to_uvec2(const uint32_t* in, glv_uvec2* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i;
+#ifdef MORTON_BMI2
+    if(morton_use_bmi2()){
+        morton2_decode_bmi2(in, out, n);
+        return;
+    }
+#endif
+    for(i = 0; i != n; ++i){
+        out[i].x = morton2_compact(in[i]);
+        out[i].y = morton2_compact(in[i] >> 1);
+    }
+}
+
+GLV_API void glv_morton_to_uvec3(const uint64_t* in, glv_uvec3* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i;
+#ifdef MORTON_BMI2
+    if(morton_use_bmi2()){
+        morton3_decode_bmi2(in, out, n);
+        return;
+    }
+#endif
+    for(i = 0; i != n; ++i){
+        out[i].x = morton3_compact(in[i]);
+        out[i].y = morton3_compact(in[i] >> 1);
+        out[i].z = morton3_compact(in[i] >> 2);
+    }
+}
+
+/* Points per pass of glv_vec3_to_morton, with cells on the stack */
+#define MORTON_CHUNK 256
+
+GLV_API void glv_vec3_to_morton(const glv_vec3* in, const glv_vec3* min, const glv_vec3* max,
+    uint64_t* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const int lo[3] = {0, 0, 0}, hi[3] = {(1 << 21) - 1, (1 << 21) - 1, (1 << 21) - 1};
+    float scale[3];
+    glv_ivec3 cells[MORTON_CHUNK];
+    size_t i, c;
+    unsigned int a;
+    for(a = 0; a != 3; ++a){
+        const float extent = max->data[a] - min->data[a];
+        scale[a] = extent > 0.0f ? 2097152.0f / extent : 0.0f;
+    }
+    for(i = 0; i < n; i += MORTON_CHUNK){
+        c = IVEC_MIN(n - i, MORTON_CHUNK);
+        ivec_floor(in[i].data, min->data, scale, cells[0].data, c * GLV_VEC3_LEN, GLV_VEC3_LEN);
+        ivec_clamp_s(cells[0].data, lo, hi, cells[0].data, c * GLV_VEC3_LEN, GLV_VEC3_LEN);
+        morton3_encode_batch((const glv_uvec3*)cells, out + i, c);
+    }
+}
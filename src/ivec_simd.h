@@ -0,0 +1,134 @@
+/*
+    === ivec_simd.h ===
+
+    Integer vector kernels written once over a generic vector type, and
+    included by ivec.c once per instruction set. Before inclusion,
+    define:
+
+        IV_ISA         suffix of the generated functions
+        IV_TARGET      target attribute (GLV_TARGET_*)
+        IV_W           32-bit lanes per vector
+        IV_I, IV_F     integer and float vector types
+        IV_SET1, IV_LOAD, IV_STORE, IV_ADD, IV_XOR   on ints
+        IV_MUL         product keeping the low 32 bits, for the hash
+        IV_SRLI(v, n)  logical right shift by a constant
+        IV_MIN_S, IV_MAX_S, IV_MIN_U, IV_MAX_U   signed and unsigned
+        IV_SET1F, IV_LOADF, IV_SUBF, IV_MULF     on floats
+        IV_MINF, IV_MAXF     as minps/maxps: (a < b ? a : b), (a > b ? a : b)
+        IV_FLOOR       floats in the int range to ints, rounding down
+        IV_STRIDE(s)   index vector 0, s, 2s, ... for IV_GATHER
+        IV_GATHER(p, s, idx)  p[0], p[s], p[2s], ...
+        IV_NO_HASH     skips the hash kernel, for sets without IV_MUL
+
+    Element-wise kernels take counts of ints. Kernels with a per-vector
+    operand (clamp bounds, grid origin and scale) repeat it every len
+    ints, and work in blocks of len vectors, which hold a whole number
+    of vectors. Each kernel returns how many ints (vectors for the hash)
+    it processed; ivec.c finishes the tail with the same operations.
+*/
+
+#define IV_CAT_(a, b) a##_##b
+#define IV_CAT(a, b) IV_CAT_(a, b)
+#define IV_FN(name) IV_CAT(name, IV_ISA)
+
+/* Hash constants, see ivec_hash in ivec.c */
+#define IV_HASH_X 0x8da6b343u
+#define IV_HASH_Y 0xd8163841u
+#define IV_HASH_Z 0xcb1ab31fu
+
+
+/* ----- Element-wise ----- */
+
+#define IV_BINARY(name, OP)                                                     \
+IV_TARGET                                                                       \
+static size_t IV_FN(name)(const int* a, const int* b, int* out, size_t n){      \
+    size_t i;                                                                   \
+    for(i = 0; i + IV_W <= n; i += IV_W){                                       \
+        IV_STORE(out + i, OP(IV_LOAD(a + i), IV_LOAD(b + i)));                  \
+    }                                                                           \
+    return i;                                                                   \
+}
+
+IV_BINARY(ivec_add, IV_ADD)
+IV_BINARY(ivec_min_s, IV_MIN_S)
+IV_BINARY(ivec_max_s, IV_MAX_S)
+IV_BINARY(ivec_min_u, IV_MIN_U)
+IV_BINARY(ivec_max_u, IV_MAX_U)
+
+#undef IV_BINARY
+
+#define IV_CLAMP(name, MIN, MAX)                                                \
+IV_TARGET                                                                       \
+static size_t IV_FN(name)(const int* v, const int* lo, const int* hi, int* out, \
+    size_t n, unsigned int len){                                                \
+    int plo[4 * IV_W], phi[4 * IV_W];                                           \
+    size_t i;                                                                   \
+    unsigned int r;                                                             \
+    for(r = 0; r != len * IV_W; ++r){                                           \
+        plo[r] = lo[r % len];                                                   \
+        phi[r] = hi[r % len];                                                   \
+    }                                                                           \
+    for(i = 0; i + len * IV_W <= n; i += len * IV_W){                           \
+        for(r = 0; r != len; ++r){                                              \
+            const IV_I x = IV_LOAD(v + i + r * IV_W);                           \
+            IV_STORE(out + i + r * IV_W,                                        \
+                MIN(MAX(x, IV_LOAD(plo + r * IV_W)), IV_LOAD(phi + r * IV_W))); \
+        }                                                                       \
+    }                                                                           \
+    return i;                                                                   \
+}
+
+IV_CLAMP(ivec_clamp_s, IV_MIN_S, IV_MAX_S)
+IV_CLAMP(ivec_clamp_u, IV_MIN_U, IV_MAX_U)
+
+#undef IV_CLAMP
+
+IV_TARGET
+static size_t IV_FN(ivec_floor)(const float* in, const float* origin, const float* scale, int* out,
+    size_t n, unsigned int len){
+    // limits of the int range as floats, the upper one rounded down
+    const IV_F lo = IV_SET1F(-2147483648.0f), hi = IV_SET1F(2147483520.0f);
+    float po[4 * IV_W], ps[4 * IV_W];
+    size_t i;
+    unsigned int r;
+    for(r = 0; r != len * IV_W; ++r){
+        po[r] = origin[r % len];
+        ps[r] = scale[r % len];
+    }
+    for(i = 0; i + len * IV_W <= n; i += len * IV_W){
+        for(r = 0; r != len; ++r){
+            IV_F x = IV_MULF(IV_SUBF(IV_LOADF(in + i + r * IV_W), IV_LOADF(po + r * IV_W)), IV_LOADF(ps + r * IV_W));
+            x = IV_MINF(IV_MAXF(x, lo), hi);
+            IV_STORE(out + i + r * IV_W, IV_FLOOR(x));
+        }
+    }
+    return i;
+}
+
+
+/* ----- Hashing ----- */
+
+#ifndef IV_NO_HASH
+
+/* n vectors of len 2 or 3 ints */
+IV_TARGET
+static size_t IV_FN(ivec_hash)(const int* in, uint32_t* out, size_t n, unsigned int len){
+    const IV_I idx = IV_STRIDE(len);
+    const IV_I px = IV_SET1((int)IV_HASH_X), py = IV_SET1((int)IV_HASH_Y), pz = IV_SET1((int)IV_HASH_Z);
+    const IV_I m1 = IV_SET1((int)0x85ebca6bu), m2 = IV_SET1((int)0xc2b2ae35u);
+    size_t i;
+    for(i = 0; i + IV_W <= n; i += IV_W){
+        const int* p = in + i * len;
+        IV_I h = IV_ADD(IV_MUL(IV_GATHER(p, len, idx), px), IV_MUL(IV_GATHER(p + 1, len, idx), py));
+        if(len == 3) h = IV_ADD(h, IV_MUL(IV_GATHER(p + 2, len, idx), pz));
+        h = IV_XOR(h, IV_SRLI(h, 16));
+        h = IV_MUL(h, m1);
+        h = IV_XOR(h, IV_SRLI(h, 13));
+        h = IV_MUL(h, m2);
+        h = IV_XOR(h, IV_SRLI(h, 16));
+        IV_STORE((int*)out + i, h);
+    }
+    return i;
+}
+
+#endif /* IV_NO_HASH */
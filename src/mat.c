@@ -3,14 +3,18 @@
 #include <math.h>
 #include <stdarg.h>
 
-#include "mat.h"
+#include "../include/mat.h"
+#include "simd_internal.h"
+#include "mat_internal.h"
+#include "profile_internal.h"
 
 
 
 /* ----- Matrix Creation ----- */
 
 /* Creates 4x4 diagonal matrix */
-glv_mat4 glv_mat4_diagonal(float e00, float e11, float e22, float e33){
+GLV_API glv_mat4 glv_mat4_diagonal(float e00, float e11, float e22, float e33){
+    GLV_PROFILE_FUNC();
     unsigned int i;
     float values[] = {e00, e11, e22, e33};
     glv_mat4 m = {0};
@@ -21,14 +25,16 @@ glv_mat4 glv_mat4_diagonal(float e00, float e11, float e22, float e33){
 }
 
 /* Creates 4x4 identity matrix */
-glv_mat4 glv_mat4_identity(){
+GLV_API glv_mat4 glv_mat4_identity(){
+    GLV_PROFILE_FUNC();
     return glv_mat4_diagonal(1.0, 1.0, 1.0, 1.0);
 }
 
 
 /* ----- Matrix Operations ----- */
 /* Returns the transpose matrix */
-glv_mat2 glv_mat2_transpose(const glv_mat2* m){
+GLV_API glv_mat2 glv_mat2_transpose(const glv_mat2* m){
+    GLV_PROFILE_FUNC();
     glv_mat2 t;
     t.data[0][0] = m->data[0][0];
     t.data[1][1] = m->data[1][1];
@@ -37,7 +43,8 @@ glv_mat2 glv_mat2_transpose(const glv_mat2* m){
     return t;
 }
 
-glv_mat3 glv_mat3_transpose(const glv_mat3* m){
+GLV_API glv_mat3 glv_mat3_transpose(const glv_mat3* m){
+    GLV_PROFILE_FUNC();
     glv_mat3 t = {0};
     unsigned int i, j;
     for(i = 0; i != GLV_MAT3_RANK; ++i){
@@ -48,7 +55,8 @@ glv_mat3 glv_mat3_transpose(const glv_mat3* m){
     return t;
 }
 
-glv_mat4 glv_mat4_transpose(const glv_mat4* m){
+GLV_API glv_mat4 glv_mat4_transpose(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
     glv_mat4 t = {0};
     unsigned int i, j;
     for(i = 0; i != GLV_MAT4_RANK; ++i){
@@ -60,7 +68,8 @@ glv_mat4 glv_mat4_transpose(const glv_mat4* m){
 }
 
 /* Returns the minor of a matrix at i,j */
-float glv_mat3_minor(const glv_mat3* m, unsigned int i,  unsigned int j){
+GLV_API float glv_mat3_minor(const glv_mat3* m, unsigned int i,  unsigned int j){
+    GLV_PROFILE_FUNC();
     glv_mat2 subm;
     unsigned int k, l; // input matrix 4x4 indices
     unsigned int a = 0, b = 0; // submatrix 3x3 indices
@@ -78,7 +87,8 @@ float glv_mat3_minor(const glv_mat3* m, unsigned int i,  unsigned int j){
 }
 
 
-float glv_mat4_minor(const glv_mat4* m, unsigned int i,  unsigned int j){
+GLV_API float glv_mat4_minor(const glv_mat4* m, unsigned int i,  unsigned int j){
+    GLV_PROFILE_FUNC();
     glv_mat3 subm;
     unsigned int k, l; // input matrix 4x4 indices
     unsigned int a = 0, b = 0; // submatrix 3x3 indices
@@ -96,11 +106,13 @@ float glv_mat4_minor(const glv_mat4* m, unsigned int i,  unsigned int j){
 }
 
 /* Returns the determinant of a matrix */
-float glv_mat2_determinant(const glv_mat2* m){
+GLV_API float glv_mat2_determinant(const glv_mat2* m){
+    GLV_PROFILE_FUNC();
     return (m->data[0][0] * m->data[1][1] - m->data[1][0] * m->data[0][1]);
 }
 
-float glv_mat3_determinant(const glv_mat3* m){
+GLV_API float glv_mat3_determinant(const glv_mat3* m){
+    GLV_PROFILE_FUNC();
     float det = 0;
     det += m->data[0][0] * m->data[1][1] * m->data[2][2];
     det += m->data[1][0] * m->data[2][1] * m->data[0][2];
@@ -111,66 +123,163 @@ float glv_mat3_determinant(const glv_mat3* m){
     return det;
 }
 
-float glv_mat4_determinant(const glv_mat4* m){
-    unsigned int i;
-    float sign = 1.0, det = 0.0;
-    for(i = 0; i != GLV_MAT4_RANK; ++i){
-        det += sign * m->data[0][i] *  glv_mat4_minor(m, 0, i);
-        sign *= -1.0;
-    }
-    return det;
+/*
+    2x2 sub-determinants of rows 0-1 (s) and rows 2-3 (c), shared by the
+    closed-form determinant and inverse (Laplace expansion by 2x2 minors).
+*/
+typedef struct { float s[6]; float c[6]; } mat4_subdets;
+
+static inline void mat4_subdets_compute(const glv_mat4* m, mat4_subdets* d){
+    const float (*a)[4] = m->data;
+    d->s[0] = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+    d->s[1] = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+    d->s[2] = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+    d->s[3] = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+    d->s[4] = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+    d->s[5] = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+    d->c[5] = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+    d->c[4] = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+    d->c[3] = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+    d->c[2] = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+    d->c[1] = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+    d->c[0] = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+}
+
+static inline float mat4_subdets_det(const mat4_subdets* d){
+    return d->s[0] * d->c[5] - d->s[1] * d->c[4] + d->s[2] * d->c[3]
+         + d->s[3] * d->c[2] - d->s[4] * d->c[1] + d->s[5] * d->c[0];
+}
+
+GLV_API float glv_mat4_determinant(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    mat4_subdets d;
+    mat4_subdets_compute(m, &d);
+    return mat4_subdets_det(&d);
 }
 
 
 /* Returns the cofactor matrix */
-glv_mat3 glv_mat3_cofactors(const glv_mat3* m){
+GLV_API glv_mat3 glv_mat3_cofactors(const glv_mat3* m){
+    GLV_PROFILE_FUNC();
     glv_mat3 cof = {0};
     float minor;
     unsigned int i, j;
     for(i = 0; i != GLV_MAT3_RANK; ++i){
         for(j = 0; j != GLV_MAT3_RANK; ++j){
             minor = glv_mat3_minor(m, i, j);
-            cof.data[i][j] = powf(-1, i+j) * minor;
+            cof.data[i][j] = ((i + j) & 1) ? -minor : minor;
         }
     }
     return cof;
 }
 
-glv_mat4 glv_mat4_cofactors(const glv_mat4* m){
+GLV_API glv_mat4 glv_mat4_cofactors(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
     glv_mat4 cof = {0};
     float minor;
     unsigned int i, j;
     for(i = 0; i != GLV_MAT4_RANK; ++i){
         for(j = 0; j != GLV_MAT4_RANK; ++j){
             minor = glv_mat4_minor(m, i, j);
-            cof.data[i][j] = powf(-1, i+j) * minor;
+            cof.data[i][j] = ((i + j) & 1) ? -minor : minor;
         }
     }
     return cof;
 }
 
 /* Returns the inverse matrix */
-glv_mat4 glv_mat4_inverse(const glv_mat4* m){
-    glv_mat4 cof, adj, inv;
-    float det;
-    unsigned int i, j;
+GLV_API glv_mat3 glv_mat3_inverse(const glv_mat3* m){
+    GLV_PROFILE_FUNC();
+    glv_mat3 inv;
+    if(!mat3_block_inverse(m->data[0], m->data[1], m->data[2], inv.data)) return (glv_mat3){0};
+    return inv;
+}
 
-    cof = glv_mat4_cofactors(m); // cofactor matrix
-    adj = glv_mat4_transpose(&cof); // adjoint matrix
-    det = glv_mat4_determinant(m);
-    if(det == 0) return (glv_mat4){0}; // non-invertible matrix
+/* Closed-form inverse, returns 0 and a zero matrix if singular */
+static inline int mat4_inverse_closed(const glv_mat4* m, glv_mat4* out){
+    const float (*a)[4] = m->data;
+    mat4_subdets d;
+    float det, r;
+    glv_mat4 b;
+
+    mat4_subdets_compute(m, &d);
+    det = mat4_subdets_det(&d);
+    if(det == 0){
+        *out = (glv_mat4){0}; // non-invertible matrix
+        return 0;
+    }
+    r = 1.0f / det;
+
+    b.data[0][0] = ( a[1][1] * d.c[5] - a[1][2] * d.c[4] + a[1][3] * d.c[3]) * r;
+    b.data[0][1] = (-a[0][1] * d.c[5] + a[0][2] * d.c[4] - a[0][3] * d.c[3]) * r;
+    b.data[0][2] = ( a[3][1] * d.s[5] - a[3][2] * d.s[4] + a[3][3] * d.s[3]) * r;
+    b.data[0][3] = (-a[2][1] * d.s[5] + a[2][2] * d.s[4] - a[2][3] * d.s[3]) * r;
+
+    b.data[1][0] = (-a[1][0] * d.c[5] + a[1][2] * d.c[2] - a[1][3] * d.c[1]) * r;
+    b.data[1][1] = ( a[0][0] * d.c[5] - a[0][2] * d.c[2] + a[0][3] * d.c[1]) * r;
+    b.data[1][2] = (-a[3][0] * d.s[5] + a[3][2] * d.s[2] - a[3][3] * d.s[1]) * r;
+    b.data[1][3] = ( a[2][0] * d.s[5] - a[2][2] * d.s[2] + a[2][3] * d.s[1]) * r;
+
+    b.data[2][0] = ( a[1][0] * d.c[4] - a[1][1] * d.c[2] + a[1][3] * d.c[0]) * r;
+    b.data[2][1] = (-a[0][0] * d.c[4] + a[0][1] * d.c[2] - a[0][3] * d.c[0]) * r;
+    b.data[2][2] = ( a[3][0] * d.s[4] - a[3][1] * d.s[2] + a[3][3] * d.s[0]) * r;
+    b.data[2][3] = (-a[2][0] * d.s[4] + a[2][1] * d.s[2] - a[2][3] * d.s[0]) * r;
+
+    b.data[3][0] = (-a[1][0] * d.c[3] + a[1][1] * d.c[1] - a[1][2] * d.c[0]) * r;
+    b.data[3][1] = ( a[0][0] * d.c[3] - a[0][1] * d.c[1] + a[0][2] * d.c[0]) * r;
+    b.data[3][2] = (-a[3][0] * d.s[3] + a[3][1] * d.s[1] - a[3][2] * d.s[0]) * r;
+    b.data[3][3] = ( a[2][0] * d.s[3] - a[2][1] * d.s[1] + a[2][2] * d.s[0]) * r;
+
+    *out = b;
+    return 1;
+}
 
-    for(i = 0; i != GLV_MAT4_RANK; ++i){
-        for(j = 0; j != GLV_MAT4_RANK; ++j){
-            inv.data[i][j] = adj.data[i][j] / det;
-        }
+GLV_API glv_mat4 glv_mat4_inverse(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    glv_mat4 inv;
+    mat4_inverse_closed(m, &inv);
+    return inv;
+}
+
+GLV_API int glv_mat4_inverse_status(const glv_mat4* m, glv_mat4* out){
+    GLV_PROFILE_FUNC();
+    return mat4_inverse_closed(m, out);
+}
+
+GLV_API glv_mat4 glv_mat4_inverse_affine(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    const float (*a)[4] = m->data;
+    glv_mat4 inv = {0};
+    float lin[3][3];
+    unsigned int i, j;
+
+    // inverse of the upper-left 3x3 block, translation becomes -A^-1 * t
+    if(!mat3_block_inverse(a[0], a[1], a[2], lin)) return inv;
+    for(i = 0; i != 3; ++i){
+        for(j = 0; j != 3; ++j) inv.data[i][j] = lin[i][j];
+        inv.data[i][3] = -(lin[i][0] * a[0][3] + lin[i][1] * a[1][3] + lin[i][2] * a[2][3]);
     }
+    inv.data[3][3] = 1.0f;
     return inv;
 }
 
+GLV_API size_t glv_mat4_inverse_batch(const glv_mat4* in, glv_mat4* out, size_t n, unsigned char* status){
+    GLV_PROFILE_FUNC();
+    size_t i, singular = 0;
+    int ok;
+    for(i = 0; i != n; ++i){
+        ok = mat4_inverse_closed(&in[i], &out[i]);
+        if(status) status[i] = (unsigned char)ok;
+        singular += !ok;
+    }
+    return singular;
+}
+
 
 /* Multiplies two matrices */
-glv_mat2 glv_mat2_multiply(const glv_mat2* m, const glv_mat2* n){
+GLV_API glv_mat2 glv_mat2_multiply(const glv_mat2* m, const glv_mat2* n){
+    GLV_PROFILE_FUNC();
     glv_mat2 s = {0};
     unsigned int i, j, k;
     for(i = 0; i != GLV_MAT2_RANK; ++i){
@@ -183,7 +292,8 @@ glv_mat2 glv_mat2_multiply(const glv_mat2* m, const glv_mat2* n){
     return s;
 }
 
-glv_mat3 glv_mat3_multiply(const glv_mat3* m, const glv_mat3* n){
+GLV_API glv_mat3 glv_mat3_multiply(const glv_mat3* m, const glv_mat3* n){
+    GLV_PROFILE_FUNC();
     glv_mat3 s = {0};
     unsigned int i, j, k;
     for(i = 0; i != GLV_MAT3_RANK; ++i){
@@ -196,76 +306,201 @@ glv_mat3 glv_mat3_multiply(const glv_mat3* m, const glv_mat3* n){
     return s;
 }
 
-glv_mat4 glv_mat4_multiply(const glv_mat4* m, const glv_mat4* n){
-    glv_mat4 s = {0};
-    unsigned int i, j, k;
-    for(i = 0; i != GLV_MAT4_RANK; ++i){
-        for(j = 0; j != GLV_MAT4_RANK; ++j){
-            for(k = 0; k != GLV_MAT4_RANK; ++k){
-                s.data[i][j] += m->data[i][k] * n->data[k][j];
-            }
+GLV_API glv_mat4 glv_mat4_multiply(const glv_mat4* m, const glv_mat4* n){
+    GLV_PROFILE_FUNC();
+    // backend chosen at startup, see simd.h
+    glv_mat4 s;
+    glv__simd.mat4_multiply(m, n, &s);
+    return s;
+}
+
+/* Multiplies every matrix of an array from the left */
+GLV_API void glv_mat4_multiply_array(const glv_mat4* m, const glv_mat4* in, glv_mat4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const glv_mat4 l = *m; // m may point into out
+    glv_mat4 t;
+    size_t i;
+    for(i = 0; i != n; ++i){
+        glv__simd.mat4_multiply(&l, &in[i], &t);
+        out[i] = t;
+    }
+}
+
+/* Multiplies two arrays element by element */
+GLV_API void glv_mat4_multiply_pairs(const glv_mat4* a, const glv_mat4* b, glv_mat4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    glv__simd.mat4_multiply_pairs(a, b, out, n);
+}
+
+/*
+    Aligned versions of the pair kernels in simd.c, out[i] = a[i * a_step]
+    * b[i] with a_step 0 or 1. The arithmetic is that of glv_mat4_multiply
+    at each level, so the results are identical to it. Both operands are
+    loaded before the store, out may equal a or b.
+*/
+#ifdef GLV_X86
+GLV_TARGET_SSE2
+static void multiply_a64_sse2(const glv_mat4a64* a, size_t a_step,
+    const glv_mat4a64* b, glv_mat4a64* out, size_t n){
+    size_t i;
+    unsigned int r;
+    for(i = 0; i != n; ++i, a += a_step){
+        const __m128 n0 = _mm_load_ps(b[i].data[0]);
+        const __m128 n1 = _mm_load_ps(b[i].data[1]);
+        const __m128 n2 = _mm_load_ps(b[i].data[2]);
+        const __m128 n3 = _mm_load_ps(b[i].data[3]);
+        __m128 acc[GLV_MAT4_RANK];
+        for(r = 0; r != GLV_MAT4_RANK; ++r){
+            const __m128 m = _mm_load_ps(a->data[r]);
+            acc[r] = _mm_setzero_ps();
+            acc[r] = _mm_add_ps(acc[r], _mm_mul_ps(_mm_shuffle_ps(m, m, 0x00), n0));
+            acc[r] = _mm_add_ps(acc[r], _mm_mul_ps(_mm_shuffle_ps(m, m, 0x55), n1));
+            acc[r] = _mm_add_ps(acc[r], _mm_mul_ps(_mm_shuffle_ps(m, m, 0xAA), n2));
+            acc[r] = _mm_add_ps(acc[r], _mm_mul_ps(_mm_shuffle_ps(m, m, 0xFF), n3));
         }
+        for(r = 0; r != GLV_MAT4_RANK; ++r) _mm_store_ps(out[i].data[r], acc[r]);
     }
-    return s;
 }
 
-/* Multiplies n matrices in series */
-glv_mat2 glv_mat2_nmultiply(unsigned int len, ...){
+GLV_TARGET_AVX2
+static void multiply_a64_avx2(const glv_mat4a64* a, size_t a_step,
+    const glv_mat4a64* b, glv_mat4a64* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i, a += a_step){
+        const __m256 n0 = _mm256_broadcast_ps((const __m128*)b[i].data[0]);
+        const __m256 n1 = _mm256_broadcast_ps((const __m128*)b[i].data[1]);
+        const __m256 n2 = _mm256_broadcast_ps((const __m128*)b[i].data[2]);
+        const __m256 n3 = _mm256_broadcast_ps((const __m128*)b[i].data[3]);
+        const __m256 lo = _mm256_load_ps(a->data[0]);
+        const __m256 hi = _mm256_load_ps(a->data[2]);
+        __m256 l = _mm256_mul_ps(_mm256_permute_ps(lo, 0x00), n0);
+        __m256 h = _mm256_mul_ps(_mm256_permute_ps(hi, 0x00), n0);
+        l = _mm256_fmadd_ps(_mm256_permute_ps(lo, 0x55), n1, l);
+        h = _mm256_fmadd_ps(_mm256_permute_ps(hi, 0x55), n1, h);
+        l = _mm256_fmadd_ps(_mm256_permute_ps(lo, 0xAA), n2, l);
+        h = _mm256_fmadd_ps(_mm256_permute_ps(hi, 0xAA), n2, h);
+        l = _mm256_fmadd_ps(_mm256_permute_ps(lo, 0xFF), n3, l);
+        h = _mm256_fmadd_ps(_mm256_permute_ps(hi, 0xFF), n3, h);
+        _mm256_store_ps(out[i].data[0], l);
+        _mm256_store_ps(out[i].data[2], h);
+    }
+}
+
+GLV_TARGET_AVX512
+static void multiply_a64_avx512(const glv_mat4a64* a, size_t a_step,
+    const glv_mat4a64* b, glv_mat4a64* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i, a += a_step){
+        const __m512 r = _mm512_load_ps(a->data);
+        const __m512 n0 = _mm512_broadcast_f32x4(_mm_load_ps(b[i].data[0]));
+        const __m512 n1 = _mm512_broadcast_f32x4(_mm_load_ps(b[i].data[1]));
+        const __m512 n2 = _mm512_broadcast_f32x4(_mm_load_ps(b[i].data[2]));
+        const __m512 n3 = _mm512_broadcast_f32x4(_mm_load_ps(b[i].data[3]));
+        __m512 acc = _mm512_mul_ps(_mm512_permute_ps(r, 0x00), n0);
+        acc = _mm512_fmadd_ps(_mm512_permute_ps(r, 0x55), n1, acc);
+        acc = _mm512_fmadd_ps(_mm512_permute_ps(r, 0xAA), n2, acc);
+        acc = _mm512_fmadd_ps(_mm512_permute_ps(r, 0xFF), n3, acc);
+        _mm512_store_ps(out[i].data, acc);
+    }
+}
+#endif /* GLV_X86 */
+
+/* Returns 0 if no aligned kernel covers the current level */
+static int multiply_a64(const glv_mat4a64* a, size_t a_step,
+    const glv_mat4a64* b, glv_mat4a64* out, size_t n){
+#ifdef GLV_X86
+    switch(glv_simd_get_level()){
+        case GLV_SIMD_AVX512: multiply_a64_avx512(a, a_step, b, out, n); return 1;
+        case GLV_SIMD_AVX2: multiply_a64_avx2(a, a_step, b, out, n); return 1;
+        // the AVX product rounds as the SSE2 one, two rows at a time
+        case GLV_SIMD_AVX:
+        case GLV_SIMD_SSE2: multiply_a64_sse2(a, a_step, b, out, n); return 1;
+        default: break;
+    }
+#endif
+    (void)a; (void)a_step; (void)b; (void)out; (void)n;
+    return 0;
+}
+
+GLV_API void glv_mat4_multiply_array_a64(const glv_mat4* m, const glv_mat4a64* in, glv_mat4a64* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const glv_mat4a64 l = *m; // m may point into out, and need not be aligned
+    if(!multiply_a64(&l, 0, in, out, n)) glv_mat4_multiply_array(&l, in, out, n);
+}
+
+GLV_API void glv_mat4_multiply_pairs_a64(const glv_mat4a64* a, const glv_mat4a64* b, glv_mat4a64* out, size_t n){
+    GLV_PROFILE_FUNC();
+    if(!multiply_a64(a, 1, b, out, n)) glv__simd.mat4_multiply_pairs(a, b, out, n);
+}
+
+/* Multiplies n matrices in series, leaving the operands untouched */
+GLV_API glv_mat2 glv_mat2_nmultiply(unsigned int len, ...){
+    GLV_PROFILE_FUNC();
     if(len == 0) return (glv_mat2){0};
     va_list args;
     va_start(args, len);
-    glv_mat2 *m, *n;
-    m = va_arg(args, glv_mat2*);
-    if(len == 1){
-        va_end(args);
-        return *m;
-    }
+    glv_mat2 s, *n;
+    s = *va_arg(args, glv_mat2*);
     unsigned int i;
     for(i = 1; i != len; ++i){
         n = va_arg(args, glv_mat2*);
-        *m = glv_mat2_multiply(m, n);
+        s = glv_mat2_multiply(&s, n);
     }
     va_end(args);
-    return *m;
+    return s;
 }
 
-glv_mat3 glv_mat3_nmultiply(unsigned int len, ...){
+GLV_API glv_mat3 glv_mat3_nmultiply(unsigned int len, ...){
+    GLV_PROFILE_FUNC();
     if(len == 0) return (glv_mat3){0};
     va_list args;
     va_start(args, len);
-    glv_mat3 *m, *n;
-    m = va_arg(args, glv_mat3*);
-    if(len == 1){
-        va_end(args);
-        return *m;
-    }
+    glv_mat3 s, *n;
+    s = *va_arg(args, glv_mat3*);
     unsigned int i;
     for(i = 1; i != len; ++i){
         n = va_arg(args, glv_mat3*);
-        *m = glv_mat3_multiply(m, n);
+        s = glv_mat3_multiply(&s, n);
     }
     va_end(args);
-    return *m;
+    return s;
 }
 
-glv_mat4 glv_mat4_nmultiply(unsigned int len, ...){
+GLV_API glv_mat4 glv_mat4_nmultiply(unsigned int len, ...){
+    GLV_PROFILE_FUNC();
     if(len == 0) return (glv_mat4){0};
     va_list args;
     va_start(args, len);
-    glv_mat4 *m, *n;
-    m = va_arg(args, glv_mat4*);
-    if(len == 1){
-        va_end(args);
-        return *m;
-    }
+    glv_mat4 s, *n;
+    s = *va_arg(args, glv_mat4*);
     unsigned int i;
     for(i = 1; i != len; ++i){
         n = va_arg(args, glv_mat4*);
-        *m = glv_mat4_multiply(m, n);
+        s = glv_mat4_multiply(&s, n);
     }
     va_end(args);
-    return *m;
+    return s;
 }
 
 
+/* ----- Matrix chains ----- */
+
+static void mat4_chain_reduce(const glv_mat4* const* ptrs, const glv_mat4* array,
+    size_t n, glv_mat4* out){
+    if(n == 0){
+        *out = glv_mat4_identity();
+        return;
+    }
+    glv__simd.mat4_chain(ptrs, array, n, out);
+}
+
+/* Multiplies a chain of matrices without modifying them */
+GLV_API void glv_mat4_multiply_chain(const glv_mat4* const* mats, size_t n, glv_mat4* out){
+    GLV_PROFILE_FUNC();
+    mat4_chain_reduce(mats, NULL, n, out);
+}
 
+GLV_API void glv_mat4_multiply_chain_array(const glv_mat4* mats, size_t n, glv_mat4* out){
+    GLV_PROFILE_FUNC();
+    mat4_chain_reduce(NULL, mats, n, out);
+}
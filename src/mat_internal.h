@@ -0,0 +1,63 @@
+/*
+    === mat_internal.h ===
+
+    Private to the library: matrix helpers shared between translation
+    units as inline functions, so that they inline into each caller.
+*/
+
+#ifndef GLV_MAT_INTERNAL_H
+#define GLV_MAT_INTERNAL_H 1
+
+#include "../include/vec.h"
+#include "../include/mat.h"
+
+/* Writes T * R * S for a rotation matrix r, as glv_compose_trs */
+static inline void mat4_compose_trs(const glv_vec3* t, const glv_mat3* r, const glv_vec3* s, glv_mat4* m){
+    unsigned int i;
+    for(i = 0; i != GLV_MAT3_RANK; ++i){
+        m->data[i][0] = r->data[i][0] * s->x;
+        m->data[i][1] = r->data[i][1] * s->y;
+        m->data[i][2] = r->data[i][2] * s->z;
+    }
+    m->data[0][3] = t->x;
+    m->data[1][3] = t->y;
+    m->data[2][3] = t->z;
+    m->data[3][0] = 0.0f;
+    m->data[3][1] = 0.0f;
+    m->data[3][2] = 0.0f;
+    m->data[3][3] = 1.0f;
+}
+
+/*
+    Inverts the 3x3 block of rows r0, r1, r2 via its adjugate into inv.
+    Returns 0 and leaves inv unfinished if the block is singular.
+*/
+static inline int mat3_block_inverse(const float* r0, const float* r1, const float* r2, float inv[3][3]){
+    const float* a[3] = {r0, r1, r2};
+    float det, r;
+    unsigned int i, j;
+
+    // first column of the adjugate doubles as the determinant expansion
+    inv[0][0] = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+    inv[1][0] = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+    inv[2][0] = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+    det = a[0][0] * inv[0][0] + a[0][1] * inv[1][0] + a[0][2] * inv[2][0];
+    if(det == 0) return 0; // non-invertible matrix
+
+    inv[0][1] = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+    inv[0][2] = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+    inv[1][1] = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+    inv[1][2] = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+    inv[2][1] = a[0][1] * a[2][0] - a[0][0] * a[2][1];
+    inv[2][2] = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+
+    r = 1.0f / det;
+    for(i = 0; i != 3; ++i){
+        for(j = 0; j != 3; ++j){
+            inv[i][j] *= r;
+        }
+    }
+    return 1;
+}
+
+#endif /* GLV_MAT_INTERNAL_H */
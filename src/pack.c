@@ -0,0 +1,166 @@
+
+#include <stdint.h>
+#include <string.h>
+#include "../include/pack.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/*
+    Every type is an array of count elements of c columns with n floats
+    each, column col of element i at src[i * n * c + row * c + col]
+    (vectors are one column). Elements are gathered column-major into a
+    zero-padded buffer and written whole.
+*/
+
+GLV_API size_t glv_pack_stride(unsigned int n, unsigned int c, glv_layout layout){
+    GLV_PROFILE_FUNC();
+    size_t column = n * sizeof(float);
+    if(layout == GLV_LAYOUT_STD140 || (layout == GLV_LAYOUT_STD430 && n == 3)) column = 4 * sizeof(float);
+    return column * c;
+}
+
+/* Non-temporal stores need 16-byte aligned destinations */
+static int pack_streaming(const void* dst, size_t stride, size_t size, size_t count){
+#ifdef GLV_X86
+    return glv_simd_get_level() >= GLV_SIMD_SSE2 && count * stride >= GLV_PACK_STREAM_BYTES
+        && ((uintptr_t)dst | stride | size) % 16 == 0;
+#else
+    (void)dst; (void)stride; (void)size; (void)count;
+    return 0;
+#endif
+}
+
+#ifdef GLV_X86
+GLV_TARGET_SSE2
+#endif
+static inline void pack_generic(char* dst, size_t stride, const float* src, size_t count,
+    unsigned int n, unsigned int c, size_t size, int stream){
+    const unsigned int cs = (unsigned int)(size / (c * sizeof(float))); // floats per written column
+    float e[16] = {0};
+    unsigned int row, col;
+    size_t i;
+    for(i = 0; i != count; ++i, src += n * c, dst += stride){
+        for(col = 0; col != c; ++col){
+            for(row = 0; row != n; ++row) e[col * cs + row] = src[row * c + col];
+        }
+#ifdef GLV_X86
+        if(stream){
+            size_t k;
+            for(k = 0; k != size / 16; ++k) _mm_stream_ps((float*)dst + 4 * k, _mm_loadu_ps(e + 4 * k));
+            continue;
+        }
+#endif
+        memcpy(dst, e, size);
+    }
+#ifdef GLV_X86
+    if(stream) _mm_sfence();
+#endif
+}
+
+/* Tight arrays already in the source layout */
+#ifdef GLV_X86
+GLV_TARGET_SSE2
+#endif
+static void pack_copy(char* dst, const float* src, size_t bytes, int stream){
+#ifdef GLV_X86
+    if(stream){
+        size_t k;
+        for(k = 0; k + 16 <= bytes; k += 16) _mm_stream_ps((float*)(dst + k), _mm_loadu_ps(src + k / 4));
+        _mm_sfence();
+        memcpy(dst + k, src + k / 4, bytes - k);
+        return;
+    }
+#endif
+    memcpy(dst, src, bytes);
+}
+
+#ifdef GLV_X86
+GLV_TARGET_SSE2
+static void pack_mat4_sse2(char* dst, size_t stride, const glv_mat4* m, size_t count, int stream){
+    size_t i;
+    for(i = 0; i != count; ++i, dst += stride){
+        __m128 c0 = _mm_loadu_ps(m[i].data[0]);
+        __m128 c1 = _mm_loadu_ps(m[i].data[1]);
+        __m128 c2 = _mm_loadu_ps(m[i].data[2]);
+        __m128 c3 = _mm_loadu_ps(m[i].data[3]);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        if(stream){
+            _mm_stream_ps((float*)dst, c0);
+            _mm_stream_ps((float*)dst + 4, c1);
+            _mm_stream_ps((float*)dst + 8, c2);
+            _mm_stream_ps((float*)dst + 12, c3);
+        }
+        else{
+            _mm_storeu_ps((float*)dst, c0);
+            _mm_storeu_ps((float*)dst + 4, c1);
+            _mm_storeu_ps((float*)dst + 8, c2);
+            _mm_storeu_ps((float*)dst + 12, c3);
+        }
+    }
+    if(stream) _mm_sfence();
+}
+#endif /* GLV_X86 */
+
+/* Resolves the stride and picks a kernel for n x c elements */
+static inline size_t pack_array(void* dst, size_t dst_stride, const float* src, size_t count,
+    unsigned int n, unsigned int c, glv_layout layout){
+    const size_t size = glv_pack_stride(n, c, layout);
+    const size_t stride = dst_stride ? dst_stride : size;
+    const int stream = pack_streaming(dst, stride, size, count);
+    if(count == 0) return stride;
+    if(stride == size && size == n * c * sizeof(float) && (c == 1 || n == 1)){
+        pack_copy(dst, src, count * size, stream);
+    }
+    else{
+        pack_generic(dst, stride, src, count, n, c, size, stream);
+    }
+    return stride;
+}
+
+
+/* ----- Matrices ----- */
+
+GLV_API size_t glv_pack_mat4(void* dst, size_t dst_stride, const glv_mat4* m, size_t count){
+    GLV_PROFILE_FUNC();
+#ifdef GLV_X86
+    const size_t stride = dst_stride ? dst_stride : sizeof(glv_mat4);
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        pack_mat4_sse2(dst, stride, m, count, pack_streaming(dst, stride, sizeof(glv_mat4), count));
+        return stride;
+    }
+#endif
+    return pack_array(dst, dst_stride, m->data[0], count, 4, 4, GLV_LAYOUT_PACKED);
+}
+
+GLV_API size_t glv_pack_mat3(void* dst, size_t dst_stride, const glv_mat3* m, size_t count, glv_layout layout){
+    GLV_PROFILE_FUNC();
+    return pack_array(dst, dst_stride, m->data[0], count, 3, 3, layout);
+}
+
+GLV_API size_t glv_pack_mat2(void* dst, size_t dst_stride, const glv_mat2* m, size_t count, glv_layout layout){
+    GLV_PROFILE_FUNC();
+    return pack_array(dst, dst_stride, m->data[0], count, 2, 2, layout);
+}
+
+
+/* ----- Vectors and scalars ----- */
+
+GLV_API size_t glv_pack_vec4(void* dst, size_t dst_stride, const glv_vec4* v, size_t count){
+    GLV_PROFILE_FUNC();
+    return pack_array(dst, dst_stride, v->data, count, 4, 1, GLV_LAYOUT_PACKED);
+}
+
+GLV_API size_t glv_pack_vec3(void* dst, size_t dst_stride, const glv_vec3* v, size_t count, glv_layout layout){
+    GLV_PROFILE_FUNC();
+    return pack_array(dst, dst_stride, v->data, count, 3, 1, layout);
+}
+
+GLV_API size_t glv_pack_vec2(void* dst, size_t dst_stride, const glv_vec2* v, size_t count, glv_layout layout){
+    GLV_PROFILE_FUNC();
+    return pack_array(dst, dst_stride, v->data, count, 2, 1, layout);
+}
+
+GLV_API size_t glv_pack_float(void* dst, size_t dst_stride, const float* f, size_t count, glv_layout layout){
+    GLV_PROFILE_FUNC();
+    return pack_array(dst, dst_stride, f, count, 1, 1, layout);
+}
@@ -0,0 +1,444 @@
+
+#include "../include/pool.h"
+#include "../include/transform.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+#include "bvh_internal.h"
+
+#ifndef GLV_NO_THREADS
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+/* Processes items [begin, end) of a job */
+typedef void (*pool_fn)(const void* ctx, size_t begin, size_t end);
+
+static size_t pool_min_items = GLV_POOL_MIN_ITEMS;
+
+
+#ifndef GLV_NO_THREADS
+
+/*
+    Chunks still owed by one thread: first in the high half, one past
+    the last in the low half. The owner pops from the front and thieves
+    from the back, both with a compare-and-swap on the whole word.
+    Padded to a cache line so that owners do not contend with each other.
+*/
+typedef struct {
+    unsigned long long range;
+    char pad[64 - sizeof(unsigned long long)];
+} pool_share;
+
+static struct {
+    unsigned int threads;           /* caller included, 1 when stopped */
+    pthread_t workers[GLV_POOL_MAX_THREADS];
+    pthread_mutex_t submit;         /* held for a whole job, or start/stop */
+    pthread_mutex_t lock;           /* guards generation, busy, quit */
+    pthread_cond_t wake, idle;
+    unsigned long generation, base;
+    unsigned int busy;              /* workers still on the current job */
+    int quit;
+    pool_fn fn;                     /* current job */
+    const void* ctx;
+    size_t count, chunk;
+    pool_share share[GLV_POOL_MAX_THREADS];
+} pool = {
+    .threads = 1,
+    .submit = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .idle = PTHREAD_COND_INITIALIZER
+};
+
+static int share_pop(pool_share* s, size_t* chunk){
+    unsigned long long r = __atomic_load_n(&s->range, __ATOMIC_ACQUIRE), next;
+    unsigned int b, e;
+    do{
+        b = (unsigned int)(r >> 32);
+        e = (unsigned int)r;
+        if(b >= e) return 0;
+        next = ((unsigned long long)(b + 1) << 32) | e;
+    }while(!__atomic_compare_exchange_n(&s->range, &r, next, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    *chunk = b;
+    return 1;
+}
+
+static int share_steal(pool_share* s, size_t* chunk){
+    unsigned long long r = __atomic_load_n(&s->range, __ATOMIC_ACQUIRE), next;
+    unsigned int b, e;
+    do{
+        b = (unsigned int)(r >> 32);
+        e = (unsigned int)r;
+        if(b >= e) return 0;
+        next = ((unsigned long long)b << 32) | (e - 1);
+    }while(!__atomic_compare_exchange_n(&s->range, &r, next, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    *chunk = e - 1;
+    return 1;
+}
+
+static void pool_run_chunk(size_t c){
+    size_t begin = c * pool.chunk, end = begin + pool.chunk;
+    pool.fn(pool.ctx, begin, end < pool.count ? end : pool.count);
+}
+
+/* Runs the own share, then steals until every share is empty */
+static void pool_work(unsigned int self, unsigned int threads){
+    size_t c;
+    unsigned int k;
+    while(share_pop(&pool.share[self], &c)) pool_run_chunk(c);
+    for(k = 1; k != threads; ++k){
+        pool_share* victim = &pool.share[(self + k) % threads];
+        while(share_steal(victim, &c)) pool_run_chunk(c);
+    }
+}
+
+static void* pool_worker(void* arg){
+    const unsigned int self = (unsigned int)(size_t)arg;
+    unsigned long seen;
+    unsigned int threads;
+    pthread_mutex_lock(&pool.lock);
+    seen = pool.base;
+    for(;;){
+        while(pool.generation == seen && !pool.quit) pthread_cond_wait(&pool.wake, &pool.lock);
+        if(pool.quit) break;
+        seen = pool.generation;
+        threads = pool.threads;
+        pthread_mutex_unlock(&pool.lock);
+        pool_work(self, threads);
+        pthread_mutex_lock(&pool.lock);
+        if(--pool.busy == 0) pthread_cond_signal(&pool.idle);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+/* Calls fn over [0, count) in chunks of about GLV_POOL_CHUNK_BYTES */
+static void pool_parallel_for(pool_fn fn, const void* ctx, size_t count, size_t item_bytes){
+    size_t chunk, chunks;
+    unsigned int t, n;
+    if(count < pool_min_items || __atomic_load_n(&pool.threads, __ATOMIC_ACQUIRE) < 2){
+        fn(ctx, 0, count);
+        return;
+    }
+    pthread_mutex_lock(&pool.submit);
+    n = pool.threads;
+    if(n < 2){
+        pthread_mutex_unlock(&pool.submit);
+        fn(ctx, 0, count);
+        return;
+    }
+    chunk = GLV_POOL_CHUNK_BYTES / (item_bytes ? item_bytes : 1);
+    if(chunk == 0) chunk = 1;
+    chunks = (count + chunk - 1) / chunk;
+    if(chunks > 0xFFFFFFFFu){
+        // chunk indices must fit in half of the share word
+        chunk = count / 0xFFFFFFFFu + 1;
+        chunks = (count + chunk - 1) / chunk;
+    }
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.count = count;
+    pool.chunk = chunk;
+    for(t = 0; t != n; ++t){
+        const unsigned long long b = chunks * t / n, e = chunks * (t + 1) / n;
+        __atomic_store_n(&pool.share[t].range, (b << 32) | e, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    pool.busy = n - 1;
+    ++pool.generation;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    pool_work(0, n);
+
+    pthread_mutex_lock(&pool.lock);
+    while(pool.busy) pthread_cond_wait(&pool.idle, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.submit);
+}
+
+#else
+
+static void pool_parallel_for(pool_fn fn, const void* ctx, size_t count, size_t item_bytes){
+    (void)item_bytes;
+    fn(ctx, 0, count);
+}
+
+#endif /* GLV_NO_THREADS */
+
+
+/* ----- Pool control ----- */
+
+GLV_API unsigned int glv_pool_start(unsigned int threads){
+    GLV_PROFILE_FUNC();
+#ifndef GLV_NO_THREADS
+    unsigned int t;
+    glv_pool_stop();
+    if(threads == 0){
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus < 1 ? 1 : (unsigned int)cpus;
+    }
+    if(threads > GLV_POOL_MAX_THREADS) threads = GLV_POOL_MAX_THREADS;
+
+    pthread_mutex_lock(&pool.submit);
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = 0;
+    pool.base = pool.generation;
+    pthread_mutex_unlock(&pool.lock);
+    for(t = 1; t < threads; ++t){
+        if(pthread_create(&pool.workers[t], NULL, pool_worker, (void*)(size_t)t) != 0) break;
+    }
+    __atomic_store_n(&pool.threads, t, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&pool.submit);
+    return t;
+#else
+    (void)threads;
+    return 1;
+#endif
+}
+
+GLV_API void glv_pool_stop(void){
+    GLV_PROFILE_FUNC();
+#ifndef GLV_NO_THREADS
+    unsigned int t;
+    pthread_mutex_lock(&pool.submit);
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = 1;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    for(t = 1; t < pool.threads; ++t) pthread_join(pool.workers[t], NULL);
+    __atomic_store_n(&pool.threads, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&pool.submit);
+#endif
+}
+
+GLV_API unsigned int glv_pool_threads(void){
+    GLV_PROFILE_FUNC();
+#ifndef GLV_NO_THREADS
+    return __atomic_load_n(&pool.threads, __ATOMIC_ACQUIRE);
+#else
+    return 1;
+#endif
+}
+
+GLV_API void glv_pool_set_min_items(size_t n){
+    GLV_PROFILE_FUNC();
+    pool_min_items = n;
+}
+
+
+/* ----- Parallel batch operations ----- */
+
+typedef struct {
+    const char* in;
+    size_t in_stride;
+    char* out;
+    size_t out_stride;
+    const glv_mat4* m;
+} transform_job;
+
+static void transform4_run(const void* ctx, size_t begin, size_t end){
+    const transform_job* j = ctx;
+    glv__simd.transform_batch4((const glv_vec4*)(j->in + begin * j->in_stride), j->in_stride,
+        (glv_vec4*)(j->out + begin * j->out_stride), j->out_stride, end - begin, j->m);
+}
+
+static void transform3_run(const void* ctx, size_t begin, size_t end){
+    const transform_job* j = ctx;
+    glv__simd.transform_batch3((const glv_vec3*)(j->in + begin * j->in_stride), j->in_stride,
+        (glv_vec3*)(j->out + begin * j->out_stride), j->out_stride, end - begin, j->m);
+}
+
+GLV_API void glv_transform_batch_parallel(const glv_vec4* in, size_t in_stride,
+    glv_vec4* out, size_t out_stride, size_t count, const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    if(in_stride == 0) in_stride = sizeof(glv_vec4);
+    if(out_stride == 0) out_stride = sizeof(glv_vec4);
+    const transform_job j = {(const char*)in, in_stride, (char*)out, out_stride, m};
+    pool_parallel_for(transform4_run, &j, count, in_stride + out_stride);
+}
+
+GLV_API void glv_transform_batch_vec3_parallel(const glv_vec3* in, size_t in_stride,
+    glv_vec3* out, size_t out_stride, size_t count, const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    if(in_stride == 0) in_stride = sizeof(glv_vec3);
+    if(out_stride == 0) out_stride = sizeof(glv_vec3);
+    const transform_job j = {(const char*)in, in_stride, (char*)out, out_stride, m};
+    pool_parallel_for(transform3_run, &j, count, in_stride + out_stride);
+}
+
+typedef struct {
+    const void* v;
+    const void* out;
+} normalize_job;
+
+static void normalize2_run(const void* ctx, size_t begin, size_t end){
+    const normalize_job* j = ctx;
+    const glv_vec2_soa *v = j->v, *o = j->out;
+    glv_vec2_soa_normalize(&(glv_vec2_soa){v->x + begin, v->y + begin},
+        &(glv_vec2_soa){o->x + begin, o->y + begin}, end - begin);
+}
+
+static void normalize3_run(const void* ctx, size_t begin, size_t end){
+    const normalize_job* j = ctx;
+    const glv_vec3_soa *v = j->v, *o = j->out;
+    glv_vec3_soa_normalize(&(glv_vec3_soa){v->x + begin, v->y + begin, v->z + begin},
+        &(glv_vec3_soa){o->x + begin, o->y + begin, o->z + begin}, end - begin);
+}
+
+static void normalize4_run(const void* ctx, size_t begin, size_t end){
+    const normalize_job* j = ctx;
+    const glv_vec4_soa *v = j->v, *o = j->out;
+    glv_vec4_soa_normalize(&(glv_vec4_soa){v->x + begin, v->y + begin, v->z + begin, v->w + begin},
+        &(glv_vec4_soa){o->x + begin, o->y + begin, o->z + begin, o->w + begin}, end - begin);
+}
+
+GLV_API void glv_vec2_soa_normalize_parallel(const glv_vec2_soa* v, const glv_vec2_soa* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const normalize_job j = {v, out};
+    pool_parallel_for(normalize2_run, &j, n, 4 * sizeof(float));
+}
+
+GLV_API void glv_vec3_soa_normalize_parallel(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const normalize_job j = {v, out};
+    pool_parallel_for(normalize3_run, &j, n, 6 * sizeof(float));
+}
+
+GLV_API void glv_vec4_soa_normalize_parallel(const glv_vec4_soa* v, const glv_vec4_soa* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const normalize_job j = {v, out};
+    pool_parallel_for(normalize4_run, &j, n, 8 * sizeof(float));
+}
+
+typedef struct {
+    glv_mat4 m;
+    const glv_mat4* in;
+    glv_mat4* out;
+} multiply_array_job;
+
+static void multiply_array_run(const void* ctx, size_t begin, size_t end){
+    const multiply_array_job* j = ctx;
+    glv_mat4_multiply_array(&j->m, j->in + begin, j->out + begin, end - begin);
+}
+
+GLV_API void glv_mat4_multiply_array_parallel(const glv_mat4* m, const glv_mat4* in, glv_mat4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const multiply_array_job j = {*m, in, out}; // copied, m may point into out
+    pool_parallel_for(multiply_array_run, &j, n, 2 * sizeof(glv_mat4));
+}
+
+/* Matrices per block of a chain product, and the most blocks, beyond which blocks grow */
+#define POOL_CHAIN_BLOCK 1024
+#define POOL_CHAIN_BLOCKS 256
+
+typedef struct {
+    const glv_mat4* const* ptrs;
+    const glv_mat4* array;
+    size_t n, block;
+    glv_mat4* partial;
+} chain_job;
+
+/* Reduces the blocks starting in [begin, end) */
+static void chain_run(const void* ctx, size_t begin, size_t end){
+    const chain_job* j = ctx;
+    size_t b;
+    for(b = (begin + j->block - 1) / j->block; b * j->block < end; ++b){
+        const size_t first = b * j->block, len = j->n - first < j->block ? j->n - first : j->block;
+        glv__simd.mat4_chain(j->ptrs ? j->ptrs + first : NULL, j->array ? j->array + first : NULL, len, &j->partial[b]);
+    }
+}
+
+/*
+    The chain is cut into blocks whose size depends only on n, each
+    reduced left to right, and the block products are then multiplied
+    in order, so the result is the same on any number of threads.
+*/
+static void chain_reduce(const glv_mat4* const* ptrs, const glv_mat4* array, size_t n, glv_mat4* out){
+    glv_mat4 partial[POOL_CHAIN_BLOCKS];
+    size_t block = (n + POOL_CHAIN_BLOCKS - 1) / POOL_CHAIN_BLOCKS;
+    if(block < POOL_CHAIN_BLOCK) block = POOL_CHAIN_BLOCK;
+    if(n <= block){
+        if(n == 0) *out = glv_mat4_identity();
+        else glv__simd.mat4_chain(ptrs, array, n, out);
+        return;
+    }
+    const chain_job j = {ptrs, array, n, block, partial};
+    pool_parallel_for(chain_run, &j, n, sizeof(glv_mat4));
+    glv__simd.mat4_chain(NULL, partial, (n + block - 1) / block, out);
+}
+
+GLV_API void glv_mat4_multiply_chain_parallel(const glv_mat4* const* mats, size_t n, glv_mat4* out){
+    GLV_PROFILE_FUNC();
+    chain_reduce(mats, NULL, n, out);
+}
+
+GLV_API void glv_mat4_multiply_chain_array_parallel(const glv_mat4* mats, size_t n, glv_mat4* out){
+    GLV_PROFILE_FUNC();
+    chain_reduce(NULL, mats, n, out);
+}
+
+typedef struct {
+    const glv_skin_stream* s;
+    const glv_mat4* palette;
+} skin_job;
+
+static void skin_run(const void* ctx, size_t begin, size_t end){
+    const skin_job* j = ctx;
+    glv_skin_vertices_range(j->s, j->palette, begin, end);
+}
+
+GLV_API void glv_skin_vertices_parallel(const glv_skin_stream* s, const glv_mat4* palette){
+    GLV_PROFILE_FUNC();
+    const skin_job j = {s, palette};
+    // inputs and outputs of one vertex, the palette rows are shared in cache
+    const size_t bytes = (s->normal && s->out_normal ? 4 : 2) * sizeof(glv_vec3)
+        + GLV_SKIN_INFLUENCES * (sizeof(uint16_t) + sizeof(float));
+    pool_parallel_for(skin_run, &j, s->count, bytes);
+}
+
+/* Most subtrees handed to the pool, and the size below which a subtree is not split further for it */
+#define POOL_BVH_TASKS 256
+#define POOL_BVH_MIN_SPLIT 1024
+
+typedef struct {
+    const glv_bvh* b;
+    const glv__bvh_task* tasks;
+    size_t count;
+    unsigned int leaf_size;
+} bvh_job;
+
+/* Builds the subtrees whose primitives start in [begin, end) */
+static void bvh_run(const void* ctx, size_t begin, size_t end){
+    const bvh_job* j = ctx;
+    size_t t;
+    for(t = 0; t != j->count; ++t){
+        if(j->tasks[t].begin >= begin && j->tasks[t].begin < end) glv__bvh_build_task(j->b, &j->tasks[t], j->leaf_size);
+    }
+}
+
+GLV_API size_t glv_bvh_build_parallel(glv_bvh* b, unsigned int leaf_size){
+    GLV_PROFILE_FUNC();
+    glv__bvh_task tasks[POOL_BVH_TASKS], children[2];
+    size_t count = 1, i, largest;
+    if(b->count < pool_min_items || glv_pool_threads() < 2) return glv_bvh_build(b, leaf_size);
+    for(i = 0; i != b->count; ++i) b->indices[i] = (uint32_t)i;
+    tasks[0] = (glv__bvh_task){0, 0, (uint32_t)b->count, 0};
+    // split the largest subtree until every thread has several to start with; leaves are done and leave the list
+    while(count != 0 && count < 8 * glv_pool_threads() && count <= POOL_BVH_TASKS - 2){
+        largest = 0;
+        for(i = 1; i != count; ++i){
+            if(tasks[i].end - tasks[i].begin > tasks[largest].end - tasks[largest].begin) largest = i;
+        }
+        if(tasks[largest].end - tasks[largest].begin < POOL_BVH_MIN_SPLIT) break;
+        const unsigned int c = glv__bvh_split(b, &tasks[largest], leaf_size, children);
+        tasks[largest] = tasks[--count];
+        for(i = 0; i != c; ++i) tasks[count++] = children[i];
+    }
+    const bvh_job j = {b, tasks, count, leaf_size};
+    // a primitive's boxes, centroid and index, read once per level
+    if(count != 0) pool_parallel_for(bvh_run, &j, b->count, 7 * sizeof(float));
+    b->node_count = glv__bvh_compact(b);
+    return b->node_count;
+}
@@ -0,0 +1,219 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/profile.h"
+#include "profile_internal.h"
+#include "simd_internal.h"
+
+#if defined(GLV_PROFILE) && !defined(GLV_NO_THREADS)
+    #include <pthread.h>
+#endif
+
+#ifdef GLV_PROFILE
+
+typedef struct {
+    uint64_t calls, ticks;
+} profile_counter;
+
+/* Counters of one thread, written only by that thread */
+typedef struct profile_block {
+    struct profile_block* next;
+    profile_counter c[GLV_PROFILE_MAX_SITES + 1];
+} profile_block;
+
+static struct {
+    const char* names[GLV_PROFILE_MAX_SITES + 1];
+    unsigned int sites;             /* registered, overflow slot excluded */
+    profile_block* blocks;          /* every thread that made a call */
+    int timing;
+    uint64_t base_ticks, base_ns;   /* when timing was first enabled */
+#ifndef GLV_NO_THREADS
+    pthread_mutex_t lock;           /* guards names, sites, blocks, bases */
+#endif
+} profile = {
+    .names[GLV_PROFILE_MAX_SITES] = "(other)",
+#ifndef GLV_NO_THREADS
+    .lock = PTHREAD_MUTEX_INITIALIZER
+#endif
+};
+
+#ifdef GLV_NO_THREADS
+    static profile_block* profile_mine;
+    #define PROFILE_LOCK()
+    #define PROFILE_UNLOCK()
+#else
+    static __thread profile_block* profile_mine;
+    #define PROFILE_LOCK() pthread_mutex_lock(&profile.lock)
+    #define PROFILE_UNLOCK() pthread_mutex_unlock(&profile.lock)
+#endif
+
+static uint64_t profile_ns(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/* Time-stamp counter on x86, nanoseconds elsewhere */
+static uint64_t profile_ticks(void){
+#ifdef GLV_X86
+    return __rdtsc();
+#else
+    return profile_ns();
+#endif
+}
+
+static unsigned int profile_register(glv__profile_site* site){
+    unsigned int slot;
+    PROFILE_LOCK();
+    slot = site->slot;
+    if(slot == 0){
+        slot = profile.sites < GLV_PROFILE_MAX_SITES ? ++profile.sites : GLV_PROFILE_MAX_SITES + 1;
+        if(slot <= GLV_PROFILE_MAX_SITES) profile.names[slot - 1] = site->name;
+        __atomic_store_n(&site->slot, slot, __ATOMIC_RELEASE);
+    }
+    PROFILE_UNLOCK();
+    return slot;
+}
+
+static profile_block* profile_attach(void){
+    profile_block* b = calloc(1, sizeof(profile_block));
+    if(b == NULL) return NULL;
+    PROFILE_LOCK();
+    b->next = profile.blocks;
+    profile.blocks = b;
+    PROFILE_UNLOCK();
+    profile_mine = b;
+    return b;
+}
+
+GLV_API glv__profile_scope glv__profile_enter(glv__profile_site* site){
+    glv__profile_scope scope = {NULL, 0};
+    unsigned int slot = __atomic_load_n(&site->slot, __ATOMIC_ACQUIRE);
+    profile_block* b = profile_mine;
+    profile_counter* c;
+    if(slot == 0) slot = profile_register(site);
+    if(b == NULL && (b = profile_attach()) == NULL) return scope;
+    // plain increments, atomic only so that glv_profile_take never reads a torn value
+    c = &b->c[slot - 1];
+    __atomic_store_n(&c->calls, c->calls + 1, __ATOMIC_RELAXED);
+    if(__atomic_load_n(&profile.timing, __ATOMIC_RELAXED)){
+        scope.ticks = &c->ticks;
+        scope.start = profile_ticks();
+    }
+    return scope;
+}
+
+GLV_API void glv__profile_stop(const glv__profile_scope* scope){
+    const uint64_t t = profile_ticks() - scope->start;
+    __atomic_store_n(scope->ticks, *scope->ticks + t, __ATOMIC_RELAXED);
+}
+
+/* Ticks per second, from the time elapsed since timing was first enabled */
+static double profile_rate(void){
+#ifdef GLV_X86
+    uint64_t ns = profile_ns(), ticks;
+    if(profile.base_ns == 0) return 0.0;
+    while(ns - profile.base_ns < 1000000u) ns = profile_ns();
+    ticks = profile_ticks();
+    return (double)(ticks - profile.base_ticks) / (double)(ns - profile.base_ns) * 1e9;
+#else
+    return profile.base_ns ? 1e9 : 0.0;
+#endif
+}
+
+static int profile_compare(const void* a, const void* b){
+    const glv_profile_entry *x = a, *y = b;
+    if(x->ticks != y->ticks) return x->ticks < y->ticks ? 1 : -1;
+    if(x->calls != y->calls) return x->calls < y->calls ? 1 : -1;
+    return strcmp(x->name, y->name);
+}
+
+GLV_API int glv_profile_enabled(void){
+    return 1;
+}
+
+GLV_API void glv_profile_set_timing(int enabled){
+    PROFILE_LOCK();
+    if(enabled && profile.base_ns == 0){
+        profile.base_ticks = profile_ticks();
+        profile.base_ns = profile_ns();
+    }
+    __atomic_store_n(&profile.timing, enabled != 0, __ATOMIC_RELAXED);
+    PROFILE_UNLOCK();
+}
+
+GLV_API void glv_profile_take(glv_profile_snapshot* out){
+    unsigned int i;
+    out->count = 0;
+    PROFILE_LOCK();
+    for(i = 0; i != GLV_PROFILE_MAX_SITES + 1; ++i){
+        glv_profile_entry e = {profile.names[i], 0, 0};
+        const profile_block* b;
+        if(i >= profile.sites && i != GLV_PROFILE_MAX_SITES) continue;
+        for(b = profile.blocks; b; b = b->next){
+            e.calls += __atomic_load_n(&b->c[i].calls, __ATOMIC_RELAXED);
+            e.ticks += __atomic_load_n(&b->c[i].ticks, __ATOMIC_RELAXED);
+        }
+        if(e.calls) out->entries[out->count++] = e;
+    }
+    out->ticks_per_second = profile_rate();
+    PROFILE_UNLOCK();
+    qsort(out->entries, out->count, sizeof(glv_profile_entry), profile_compare);
+}
+
+GLV_API void glv_profile_reset(void){
+    profile_block* b;
+    unsigned int i;
+    PROFILE_LOCK();
+    for(b = profile.blocks; b; b = b->next){
+        for(i = 0; i != GLV_PROFILE_MAX_SITES + 1; ++i){
+            __atomic_store_n(&b->c[i].calls, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&b->c[i].ticks, 0, __ATOMIC_RELAXED);
+        }
+    }
+    PROFILE_UNLOCK();
+}
+
+#else
+
+GLV_API int glv_profile_enabled(void){
+    return 0;
+}
+
+GLV_API void glv_profile_set_timing(int enabled){
+    (void)enabled;
+}
+
+GLV_API void glv_profile_take(glv_profile_snapshot* out){
+    out->count = 0;
+    out->ticks_per_second = 0.0;
+}
+
+GLV_API void glv_profile_reset(void){
+}
+
+#endif /* GLV_PROFILE */
+
+
+GLV_API void glv_profile_write(const glv_profile_snapshot* snap, FILE* f, glv_profile_format format){
+    const double ns_per_tick = snap->ticks_per_second > 0.0 ? 1e9 / snap->ticks_per_second : 0.0;
+    size_t i;
+    if(format == GLV_PROFILE_JSON){
+        fprintf(f, "{\"ticks_per_second\": %.0f, \"functions\": [", snap->ticks_per_second);
+        for(i = 0; i != snap->count; ++i){
+            const glv_profile_entry* e = &snap->entries[i];
+            fprintf(f, "%s\n  {\"name\": \"%s\", \"calls\": %llu, \"ticks\": %llu, \"ns\": %.0f}", i ? "," : "",
+                e->name, (unsigned long long)e->calls, (unsigned long long)e->ticks, (double)e->ticks * ns_per_tick);
+        }
+        fprintf(f, "%s]}\n", snap->count ? "\n" : "");
+        return;
+    }
+    fprintf(f, "%-40s %12s %12s %12s\n", "function", "calls", "total ms", "ns/call");
+    for(i = 0; i != snap->count; ++i){
+        const glv_profile_entry* e = &snap->entries[i];
+        const double ns = (double)e->ticks * ns_per_tick;
+        fprintf(f, "%-40s %12llu %12.3f %12.1f\n", e->name, (unsigned long long)e->calls,
+            ns * 1e-6, ns / (double)e->calls);
+    }
+}
@@ -0,0 +1,47 @@
+/*
+    === profile_internal.h ===
+
+    Private to the library: GLV_PROFILE_FUNC() opens the body of every
+    public function. It counts the call in the thread's block and, with
+    timing on, adds the elapsed ticks when the function returns. It
+    expands to nothing unless GLV_PROFILE is defined.
+*/
+
+#ifndef GLV_PROFILE_INTERNAL_H
+#define GLV_PROFILE_INTERNAL_H 1
+
+#include <stdint.h>
+#include "../include/profile.h"
+
+#ifdef GLV_PROFILE
+
+/* One per public function, slot is 1 + its counter index once registered */
+typedef struct {
+    const char* name;
+    unsigned int slot;
+} glv__profile_site;
+
+/* start is 0 for untimed calls */
+typedef struct {
+    uint64_t* ticks;
+    uint64_t start;
+} glv__profile_scope;
+
+GLV_API glv__profile_scope glv__profile_enter(glv__profile_site* site);
+GLV_API void glv__profile_stop(const glv__profile_scope* scope);
+
+static inline void glv__profile_leave(const glv__profile_scope* scope){
+    if(scope->start) glv__profile_stop(scope);
+}
+
+/* The cleanup attribute runs glv__profile_leave on every return path */
+#define GLV_PROFILE_FUNC() \
+    static glv__profile_site glv__profile_site_ = {__func__, 0}; \
+    const glv__profile_scope glv__profile_scope_ __attribute__((cleanup(glv__profile_leave))) = \
+        glv__profile_enter(&glv__profile_site_)
+
+#else
+    #define GLV_PROFILE_FUNC() ((void)0)
+#endif
+
+#endif /* GLV_PROFILE_INTERNAL_H */
@@ -0,0 +1,335 @@
+
+#include <math.h>
+#include "../include/quat.h"
+#include "../include/transform.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* Above this cosine slerp falls back to nlerp, the arc being too short for acosf */
+#define GLV_QUAT_SLERP_LINEAR 0.9995f
+
+
+/* ----- Creation ----- */
+
+GLV_API glv_quat glv_quat_identity(void){
+    GLV_PROFILE_FUNC();
+    return (glv_quat){.x = 0.0f, .y = 0.0f, .z = 0.0f, .w = 1.0f};
+}
+
+GLV_API glv_quat glv_quat_axis_angle(float a, const glv_vec3* v){
+    GLV_PROFILE_FUNC();
+
+    #ifdef GLV_USE_DEGREES
+        a = glv_radians(a);
+    #endif
+
+    const glv_vec3 axis = glv_vec3_normalize(v);
+    const float s = sinf(a * 0.5f);
+    return (glv_quat){.x = axis.x * s, .y = axis.y * s, .z = axis.z * s, .w = cosf(a * 0.5f)};
+}
+
+/* Shepperd's method: divides by the largest of the four components */
+static glv_quat quat_from_rotation(float m00, float m01, float m02,
+    float m10, float m11, float m12, float m20, float m21, float m22){
+    const float trace = m00 + m11 + m22;
+    float s;
+    glv_quat q;
+    if(trace > 0.0f){
+        s = sqrtf(trace + 1.0f) * 2.0f;
+        q.w = 0.25f * s;
+        q.x = (m21 - m12) / s;
+        q.y = (m02 - m20) / s;
+        q.z = (m10 - m01) / s;
+    }
+    else if(m00 > m11 && m00 > m22){
+        s = sqrtf(1.0f + m00 - m11 - m22) * 2.0f;
+        q.w = (m21 - m12) / s;
+        q.x = 0.25f * s;
+        q.y = (m01 + m10) / s;
+        q.z = (m02 + m20) / s;
+    }
+    else if(m11 > m22){
+        s = sqrtf(1.0f + m11 - m00 - m22) * 2.0f;
+        q.w = (m02 - m20) / s;
+        q.x = (m01 + m10) / s;
+        q.y = 0.25f * s;
+        q.z = (m12 + m21) / s;
+    }
+    else{
+        s = sqrtf(1.0f + m22 - m00 - m11) * 2.0f;
+        q.w = (m10 - m01) / s;
+        q.x = (m02 + m20) / s;
+        q.y = (m12 + m21) / s;
+        q.z = 0.25f * s;
+    }
+    return q;
+}
+
+GLV_API glv_quat glv_quat_from_mat3(const glv_mat3* m){
+    GLV_PROFILE_FUNC();
+    return quat_from_rotation(
+        m->data[0][0], m->data[0][1], m->data[0][2],
+        m->data[1][0], m->data[1][1], m->data[1][2],
+        m->data[2][0], m->data[2][1], m->data[2][2]);
+}
+
+GLV_API glv_quat glv_quat_from_mat4(const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    return quat_from_rotation(
+        m->data[0][0], m->data[0][1], m->data[0][2],
+        m->data[1][0], m->data[1][1], m->data[1][2],
+        m->data[2][0], m->data[2][1], m->data[2][2]);
+}
+
+
+/* ----- Operations ----- */
+
+GLV_API glv_quat glv_quat_multiply(const glv_quat* a, const glv_quat* b){
+    GLV_PROFILE_FUNC();
+    glv_quat r;
+    r.x = a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y;
+    r.y = a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x;
+    r.z = a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w;
+    r.w = a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z;
+    return r;
+}
+
+GLV_API float glv_quat_dot(const glv_quat* a, const glv_quat* b){
+    GLV_PROFILE_FUNC();
+    return (a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w);
+}
+
+GLV_API glv_quat glv_quat_normalize(const glv_quat* q){
+    GLV_PROFILE_FUNC();
+    float m = sqrtf(glv_quat_dot(q, q));
+    return (glv_quat){.x = q->x / m, .y = q->y / m, .z = q->z / m, .w = q->w / m};
+}
+
+GLV_API glv_quat glv_quat_conjugate(const glv_quat* q){
+    GLV_PROFILE_FUNC();
+    return (glv_quat){.x = -q->x, .y = -q->y, .z = -q->z, .w = q->w};
+}
+
+GLV_API glv_quat glv_quat_inverse(const glv_quat* q){
+    GLV_PROFILE_FUNC();
+    float d = glv_quat_dot(q, q);
+    return (glv_quat){.x = -q->x / d, .y = -q->y / d, .z = -q->z / d, .w = q->w / d};
+}
+
+GLV_API glv_vec3 glv_quat_rotate(const glv_quat* q, const glv_vec3* v){
+    GLV_PROFILE_FUNC();
+    // v + w t + u x t, with u the vector part and t = 2 u x v
+    const float tx = 2.0f * (q->y * v->z - q->z * v->y);
+    const float ty = 2.0f * (q->z * v->x - q->x * v->z);
+    const float tz = 2.0f * (q->x * v->y - q->y * v->x);
+    return (glv_vec3){
+        .x = v->x + q->w * tx + (q->y * tz - q->z * ty),
+        .y = v->y + q->w * ty + (q->z * tx - q->x * tz),
+        .z = v->z + q->w * tz + (q->x * ty - q->y * tx)
+    };
+}
+
+GLV_API glv_quat glv_quat_nlerp(const glv_quat* a, const glv_quat* b, float t){
+    GLV_PROFILE_FUNC();
+    // q and -q are the same rotation, flip b onto a's hemisphere
+    const float sb = glv_quat_dot(a, b) < 0.0f ? -t : t, sa = 1.0f - t;
+    glv_quat r = {
+        .x = a->x * sa + b->x * sb,
+        .y = a->y * sa + b->y * sb,
+        .z = a->z * sa + b->z * sb,
+        .w = a->w * sa + b->w * sb
+    };
+    return glv_quat_normalize(&r);
+}
+
+GLV_API glv_quat glv_quat_slerp(const glv_quat* a, const glv_quat* b, float t){
+    GLV_PROFILE_FUNC();
+    float d = glv_quat_dot(a, b), sign = 1.0f, theta, sa, sb;
+    if(d < 0.0f){
+        d = -d;
+        sign = -1.0f;
+    }
+    if(d > GLV_QUAT_SLERP_LINEAR) return glv_quat_nlerp(a, b, t);
+    theta = acosf(d);
+    sa = sinf((1.0f - t) * theta) / sinf(theta);
+    sb = sign * sinf(t * theta) / sinf(theta);
+    return (glv_quat){
+        .x = a->x * sa + b->x * sb,
+        .y = a->y * sa + b->y * sb,
+        .z = a->z * sa + b->z * sb,
+        .w = a->w * sa + b->w * sb
+    };
+}
+
+/* Rotation block, row by row. The SIMD batch kernel below repeats these steps */
+static void quat_rows(const glv_quat* q, float r[3][3]){
+    const float x2 = q->x + q->x, y2 = q->y + q->y, z2 = q->z + q->z;
+    const float xx = q->x * x2, yy = q->y * y2, zz = q->z * z2;
+    const float xy = q->x * y2, xz = q->x * z2, yz = q->y * z2;
+    const float wx = q->w * x2, wy = q->w * y2, wz = q->w * z2;
+    r[0][0] = 1.0f - (yy + zz);
+    r[0][1] = xy - wz;
+    r[0][2] = xz + wy;
+    r[1][0] = xy + wz;
+    r[1][1] = 1.0f - (xx + zz);
+    r[1][2] = yz - wx;
+    r[2][0] = xz - wy;
+    r[2][1] = yz + wx;
+    r[2][2] = 1.0f - (xx + yy);
+}
+
+GLV_API glv_mat3 glv_quat_to_mat3(const glv_quat* q){
+    GLV_PROFILE_FUNC();
+    glv_mat3 m;
+    quat_rows(q, m.data);
+    return m;
+}
+
+GLV_API glv_mat4 glv_quat_to_mat4(const glv_quat* q){
+    GLV_PROFILE_FUNC();
+    float r[3][3];
+    unsigned int i;
+    glv_mat4 m = {0};
+    quat_rows(q, r);
+    for(i = 0; i != GLV_MAT3_RANK; ++i){
+        m.data[i][0] = r[i][0];
+        m.data[i][1] = r[i][1];
+        m.data[i][2] = r[i][2];
+    }
+    m.data[3][3] = 1.0f;
+    return m;
+}
+
+
+/* ----- Batch operations ----- */
+
+/*
+    The SSE2 kernels load four quaternions, transpose them into x, y, z
+    and w registers and repeat the scalar arithmetic on four lanes in the
+    same order, so the results are bit-identical.
+*/
+
+GLV_API void glv_quat_multiply_batch(const glv_quat* a, const glv_quat* b, glv_quat* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        for(; i + 4 <= n; i += 4){
+            __m128 ax = _mm_loadu_ps(a[i].data), ay = _mm_loadu_ps(a[i + 1].data);
+            __m128 az = _mm_loadu_ps(a[i + 2].data), aw = _mm_loadu_ps(a[i + 3].data);
+            __m128 bx = _mm_loadu_ps(b[i].data), by = _mm_loadu_ps(b[i + 1].data);
+            __m128 bz = _mm_loadu_ps(b[i + 2].data), bw = _mm_loadu_ps(b[i + 3].data);
+            __m128 rx, ry, rz, rw;
+            _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+            _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+            rx = _mm_add_ps(_mm_mul_ps(aw, bx), _mm_mul_ps(ax, bw));
+            rx = _mm_sub_ps(_mm_add_ps(rx, _mm_mul_ps(ay, bz)), _mm_mul_ps(az, by));
+            ry = _mm_sub_ps(_mm_mul_ps(aw, by), _mm_mul_ps(ax, bz));
+            ry = _mm_add_ps(_mm_add_ps(ry, _mm_mul_ps(ay, bw)), _mm_mul_ps(az, bx));
+            rz = _mm_add_ps(_mm_mul_ps(aw, bz), _mm_mul_ps(ax, by));
+            rz = _mm_add_ps(_mm_sub_ps(rz, _mm_mul_ps(ay, bx)), _mm_mul_ps(az, bw));
+            rw = _mm_sub_ps(_mm_mul_ps(aw, bw), _mm_mul_ps(ax, bx));
+            rw = _mm_sub_ps(_mm_sub_ps(rw, _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+            _MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+            _mm_storeu_ps(out[i].data, rx);
+            _mm_storeu_ps(out[i + 1].data, ry);
+            _mm_storeu_ps(out[i + 2].data, rz);
+            _mm_storeu_ps(out[i + 3].data, rw);
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out[i] = glv_quat_multiply(&a[i], &b[i]);
+    }
+}
+
+GLV_API void glv_quat_normalize_batch(const glv_quat* q, glv_quat* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        for(; i + 4 <= n; i += 4){
+            __m128 x = _mm_loadu_ps(q[i].data), y = _mm_loadu_ps(q[i + 1].data);
+            __m128 z = _mm_loadu_ps(q[i + 2].data), w = _mm_loadu_ps(q[i + 3].data);
+            __m128 m;
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            m = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+            m = _mm_add_ps(m, _mm_mul_ps(z, z));
+            m = _mm_sqrt_ps(_mm_add_ps(m, _mm_mul_ps(w, w)));
+            x = _mm_div_ps(x, m);
+            y = _mm_div_ps(y, m);
+            z = _mm_div_ps(z, m);
+            w = _mm_div_ps(w, m);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            _mm_storeu_ps(out[i].data, x);
+            _mm_storeu_ps(out[i + 1].data, y);
+            _mm_storeu_ps(out[i + 2].data, z);
+            _mm_storeu_ps(out[i + 3].data, w);
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out[i] = glv_quat_normalize(&q[i]);
+    }
+}
+
+GLV_API void glv_quat_to_mat4_batch(const glv_quat* q, glv_mat4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        const __m128 one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+        const __m128 last = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+        for(; i + 4 <= n; i += 4){
+            __m128 x = _mm_loadu_ps(q[i].data), y = _mm_loadu_ps(q[i + 1].data);
+            __m128 z = _mm_loadu_ps(q[i + 2].data), w = _mm_loadu_ps(q[i + 3].data);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            const __m128 x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z);
+            const __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+            const __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+            const __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+            __m128 r0 = _mm_sub_ps(one, _mm_add_ps(yy, zz));
+            __m128 r1 = _mm_sub_ps(xy, wz);
+            __m128 r2 = _mm_add_ps(xz, wy);
+            __m128 r3 = zero;
+            // each transpose turns one row of four matrices into four rows
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(out[i].data[0], r0);
+            _mm_storeu_ps(out[i + 1].data[0], r1);
+            _mm_storeu_ps(out[i + 2].data[0], r2);
+            _mm_storeu_ps(out[i + 3].data[0], r3);
+            r0 = _mm_add_ps(xy, wz);
+            r1 = _mm_sub_ps(one, _mm_add_ps(xx, zz));
+            r2 = _mm_sub_ps(yz, wx);
+            r3 = zero;
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(out[i].data[1], r0);
+            _mm_storeu_ps(out[i + 1].data[1], r1);
+            _mm_storeu_ps(out[i + 2].data[1], r2);
+            _mm_storeu_ps(out[i + 3].data[1], r3);
+            r0 = _mm_sub_ps(xz, wy);
+            r1 = _mm_add_ps(yz, wx);
+            r2 = _mm_sub_ps(one, _mm_add_ps(xx, yy));
+            r3 = zero;
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(out[i].data[2], r0);
+            _mm_storeu_ps(out[i + 1].data[2], r1);
+            _mm_storeu_ps(out[i + 2].data[2], r2);
+            _mm_storeu_ps(out[i + 3].data[2], r3);
+            _mm_storeu_ps(out[i].data[3], last);
+            _mm_storeu_ps(out[i + 1].data[3], last);
+            _mm_storeu_ps(out[i + 2].data[3], last);
+            _mm_storeu_ps(out[i + 3].data[3], last);
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out[i] = glv_quat_to_mat4(&q[i]);
+    }
+}
+
+GLV_API void glv_quat_rotate_batch(const glv_quat* q, const glv_vec3* in, glv_vec3* out, size_t n){
+    GLV_PROFILE_FUNC();
+    const glv_mat4 m = glv_quat_to_mat4(q);
+    glv__simd.transform_batch3(in, sizeof(glv_vec3), out, sizeof(glv_vec3), n, &m);
+}
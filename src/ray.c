@@ -0,0 +1,332 @@
+
+#include <math.h>
+#include "../include/ray.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* ----- Kernel instances ----- */
+
+#ifdef GLV_X86
+
+#define RAY_ISA sse2
+#define RAY_TARGET GLV_TARGET_SSE2
+#define RAY_W 4
+#define RAY_V __m128
+#define RAY_M __m128
+#define RAY_SET1 _mm_set1_ps
+#define RAY_LOAD _mm_loadu_ps
+#define RAY_STORE _mm_storeu_ps
+#define RAY_ADD _mm_add_ps
+#define RAY_SUB _mm_sub_ps
+#define RAY_MUL _mm_mul_ps
+#define RAY_DIV _mm_div_ps
+#define RAY_MIN _mm_min_ps
+#define RAY_MAX _mm_max_ps
+#define RAY_LT _mm_cmplt_ps
+#define RAY_LE _mm_cmple_ps
+#define RAY_NE _mm_cmpneq_ps
+#define RAY_AND _mm_and_ps
+#define RAY_MOVEMASK _mm_movemask_ps
+#define RAY_SELECT(m, a, b) _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+#define RAY_SET1_BITS(x) _mm_castsi128_ps(_mm_set1_epi32((int)(x)))
+#include "ray_simd.h"
+#undef RAY_ISA
+#undef RAY_TARGET
+#undef RAY_W
+#undef RAY_V
+#undef RAY_M
+#undef RAY_SET1
+#undef RAY_LOAD
+#undef RAY_STORE
+#undef RAY_ADD
+#undef RAY_SUB
+#undef RAY_MUL
+#undef RAY_DIV
+#undef RAY_MIN
+#undef RAY_MAX
+#undef RAY_LT
+#undef RAY_LE
+#undef RAY_NE
+#undef RAY_AND
+#undef RAY_MOVEMASK
+#undef RAY_SELECT
+#undef RAY_SET1_BITS
+
+#define RAY_ISA avx
+#define RAY_TARGET GLV_TARGET_AVX
+#define RAY_W 8
+#define RAY_V __m256
+#define RAY_M __m256
+#define RAY_SET1 _mm256_set1_ps
+#define RAY_LOAD _mm256_loadu_ps
+#define RAY_STORE _mm256_storeu_ps
+#define RAY_ADD _mm256_add_ps
+#define RAY_SUB _mm256_sub_ps
+#define RAY_MUL _mm256_mul_ps
+#define RAY_DIV _mm256_div_ps
+#define RAY_MIN _mm256_min_ps
+#define RAY_MAX _mm256_max_ps
+#define RAY_LT(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define RAY_LE(a, b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+#define RAY_NE(a, b) _mm256_cmp_ps(a, b, _CMP_NEQ_UQ)
+#define RAY_AND _mm256_and_ps
+#define RAY_MOVEMASK _mm256_movemask_ps
+#define RAY_SELECT(m, a, b) _mm256_blendv_ps(b, a, m)
+#define RAY_SET1_BITS(x) _mm256_castsi256_ps(_mm256_set1_epi32((int)(x)))
+#include "ray_simd.h"
+#undef RAY_ISA
+#undef RAY_TARGET
+#undef RAY_W
+#undef RAY_V
+#undef RAY_M
+#undef RAY_SET1
+#undef RAY_LOAD
+#undef RAY_STORE
+#undef RAY_ADD
+#undef RAY_SUB
+#undef RAY_MUL
+#undef RAY_DIV
+#undef RAY_MIN
+#undef RAY_MAX
+#undef RAY_LT
+#undef RAY_LE
+#undef RAY_NE
+#undef RAY_AND
+#undef RAY_MOVEMASK
+#undef RAY_SELECT
+#undef RAY_SET1_BITS
+
+#define RAY_ISA avx512
+#define RAY_TARGET GLV_TARGET_AVX512
+#define RAY_W 16
+#define RAY_V __m512
+#define RAY_M __mmask16
+#define RAY_SET1 _mm512_set1_ps
+#define RAY_LOAD _mm512_loadu_ps
+#define RAY_STORE _mm512_storeu_ps
+#define RAY_ADD _mm512_add_ps
+#define RAY_SUB _mm512_sub_ps
+#define RAY_MUL _mm512_mul_ps
+#define RAY_DIV _mm512_div_ps
+#define RAY_MIN _mm512_min_ps
+#define RAY_MAX _mm512_max_ps
+#define RAY_LT(a, b) _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
+#define RAY_LE(a, b) _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ)
+#define RAY_NE(a, b) _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ)
+#define RAY_AND(a, b) ((__mmask16)((a) & (b)))
+#define RAY_MOVEMASK(m) ((int)(m))
+#define RAY_SELECT(m, a, b) _mm512_mask_blend_ps(m, b, a)
+#define RAY_SET1_BITS(x) _mm512_castsi512_ps(_mm512_set1_epi32((int)(x)))
+#include "ray_simd.h"
+#undef RAY_ISA
+#undef RAY_TARGET
+#undef RAY_W
+#undef RAY_V
+#undef RAY_M
+#undef RAY_SET1
+#undef RAY_LOAD
+#undef RAY_STORE
+#undef RAY_ADD
+#undef RAY_SUB
+#undef RAY_MUL
+#undef RAY_DIV
+#undef RAY_MIN
+#undef RAY_MAX
+#undef RAY_LT
+#undef RAY_LE
+#undef RAY_NE
+#undef RAY_AND
+#undef RAY_MOVEMASK
+#undef RAY_SELECT
+#undef RAY_SET1_BITS
+
+/* Runs the widest instance for the current level, returns elements done. AVX2 runs the AVX code */
+#define RAY_DISPATCH(fn, ...)                                           \
+    (glv_simd_get_level() >= GLV_SIMD_AVX512 ? fn##_avx512(__VA_ARGS__) : \
+     glv_simd_get_level() >= GLV_SIMD_AVX    ? fn##_avx(__VA_ARGS__)    : \
+     glv_simd_get_level() >= GLV_SIMD_SSE2   ? fn##_sse2(__VA_ARGS__)   : 0)
+
+#else
+
+#define RAY_DISPATCH(fn, ...) ((size_t)0)
+
+#endif /* GLV_X86 */
+
+
+/* ----- Scalar tests ----- */
+
+/* As minps and maxps, returning b when either is NaN */
+#define RAY_MINF(a, b) ((a) < (b) ? (a) : (b))
+#define RAY_MAXF(a, b) ((a) > (b) ? (a) : (b))
+
+/*
+    Moller-Trumbore: with p = d x e2 and s = o - v0, the hit is at
+    u = (s.p) / det, v = (d.(s x e1)) / det, t = (e2.(s x e1)) / det,
+    det = e1.p. Returns 1 for a hit closer than best.
+*/
+static int ray_triangle(const float o[3], const float d[3], const float v0[3], const float e1[3], const float e2[3],
+    float best, float* t, float* u, float* v){
+    const float px = d[1] * e2[2] - d[2] * e2[1];
+    const float py = d[2] * e2[0] - d[0] * e2[2];
+    const float pz = d[0] * e2[1] - d[1] * e2[0];
+    const float det = (e1[0] * px + e1[1] * py) + e1[2] * pz;
+    const float inv = 1.0f / det;
+    const float sx = o[0] - v0[0], sy = o[1] - v0[1], sz = o[2] - v0[2];
+    const float qx = sy * e1[2] - sz * e1[1];
+    const float qy = sz * e1[0] - sx * e1[2];
+    const float qz = sx * e1[1] - sy * e1[0];
+    *u = ((sx * px + sy * py) + sz * pz) * inv;
+    *v = ((d[0] * qx + d[1] * qy) + d[2] * qz) * inv;
+    *t = ((e2[0] * qx + e2[1] * qy) + e2[2] * qz) * inv;
+    return det != 0.0f && 0.0f <= *u && 0.0f <= *v && *u + *v <= 1.0f && 0.0f < *t && *t < best;
+}
+
+/* Slab test with the reciprocal direction, entry distance clamped to 0 */
+static int ray_aabb(const float o[3], const float inv[3], const float lo[3], const float hi[3],
+    float t_max, float* t_enter){
+    float t1 = (lo[0] - o[0]) * inv[0], t2 = (hi[0] - o[0]) * inv[0];
+    float tn = RAY_MINF(t1, t2), tf = RAY_MAXF(t1, t2);
+    unsigned int a;
+    for(a = 1; a != 3; ++a){
+        t1 = (lo[a] - o[a]) * inv[a];
+        t2 = (hi[a] - o[a]) * inv[a];
+        tn = RAY_MAXF(tn, RAY_MINF(t1, t2));
+        tf = RAY_MINF(tf, RAY_MAXF(t1, t2));
+    }
+    tn = RAY_MAXF(tn, 0.0f);
+    *t_enter = tn;
+    return tn <= tf && tn < t_max;
+}
+
+/* Gathers element i of three streams */
+#define RAY_GET(soa, i) {(soa).x[i], (soa).y[i], (soa).z[i]}
+
+
+/* ----- Public functions ----- */
+
+GLV_API void glv_triangle_soa_set(const glv_triangle_soa* tris, size_t i,
+    const glv_vec3* a, const glv_vec3* b, const glv_vec3* c){
+    GLV_PROFILE_FUNC();
+    tris->v0.x[i] = a->x;
+    tris->v0.y[i] = a->y;
+    tris->v0.z[i] = a->z;
+    tris->e1.x[i] = b->x - a->x;
+    tris->e1.y[i] = b->y - a->y;
+    tris->e1.z[i] = b->z - a->z;
+    tris->e2.x[i] = c->x - a->x;
+    tris->e2.y[i] = c->y - a->y;
+    tris->e2.z[i] = c->z - a->z;
+}
+
+GLV_API int glv_ray_triangles_nearest(const glv_ray* r, const glv_triangle_soa* tris, size_t n,
+    float t_max, glv_ray_hit* hit){
+    GLV_PROFILE_FUNC();
+    size_t i;
+    hit->t = t_max;
+    hit->u = hit->v = 0.0f;
+    hit->index = GLV_RAY_MISS;
+    i = RAY_DISPATCH(ray_triangles, r, tris, n, hit);
+    for(; i != n; ++i){
+        const float v0[3] = RAY_GET(tris->v0, i), e1[3] = RAY_GET(tris->e1, i), e2[3] = RAY_GET(tris->e2, i);
+        float t, u, v;
+        if(ray_triangle(r->origin.data, r->direction.data, v0, e1, e2, hit->t, &t, &u, &v)){
+            hit->t = t;
+            hit->u = u;
+            hit->v = v;
+            hit->index = (uint32_t)i;
+        }
+    }
+    return hit->index != GLV_RAY_MISS;
+}
+
+GLV_API size_t glv_ray_aabbs(const glv_ray* r, const glv_aabb_soa* boxes, size_t n,
+    float t_max, uint32_t* mask, float* t_enter){
+    GLV_PROFILE_FUNC();
+    const float inv[3] = {1.0f / r->direction.x, 1.0f / r->direction.y, 1.0f / r->direction.z};
+    size_t i = RAY_DISPATCH(ray_aabbs, r, inv[0], inv[1], inv[2], boxes, n, t_max, mask, t_enter);
+    size_t hits = 0, w;
+    for(; i != n; ++i){
+        const float lo[3] = RAY_GET(boxes->min, i), hi[3] = RAY_GET(boxes->max, i);
+        float te;
+        const int h = ray_aabb(r->origin.data, inv, lo, hi, t_max, &te);
+        if(i % 32 == 0) mask[i / 32] = 0;
+        if(h) mask[i / 32] |= (uint32_t)1 << (i % 32);
+        if(t_enter) t_enter[i] = h ? te : INFINITY;
+    }
+    for(w = 0; w != GLV_RAY_MASK_WORDS(n); ++w){
+        hits += (size_t)__builtin_popcount(mask[w]);
+    }
+    return hits;
+}
+
+/* Boxes are tested in blocks, with their masks and entry distances on the stack */
+#define RAY_BLOCK 256
+
+GLV_API uint32_t glv_ray_aabbs_nearest(const glv_ray* r, const glv_aabb_soa* boxes, size_t n,
+    float t_max, float* t){
+    GLV_PROFILE_FUNC();
+    uint32_t mask[GLV_RAY_MASK_WORDS(RAY_BLOCK)], best = GLV_RAY_MISS;
+    float te[RAY_BLOCK];
+    size_t i, w, count;
+    *t = t_max;
+    for(i = 0; i < n; i += RAY_BLOCK){
+        const glv_aabb_soa b = {{boxes->min.x + i, boxes->min.y + i, boxes->min.z + i},
+            {boxes->max.x + i, boxes->max.y + i, boxes->max.z + i}};
+        count = n - i < RAY_BLOCK ? n - i : RAY_BLOCK;
+        // boxes entered after the best so far are misses
+        if(!glv_ray_aabbs(r, &b, count, *t, mask, te)) continue;
+        for(w = 0; w != GLV_RAY_MASK_WORDS(count); ++w){
+            uint32_t bits = mask[w];
+            while(bits){
+                const size_t k = w * 32 + (size_t)__builtin_ctz(bits);
+                if(te[k] < *t || best == GLV_RAY_MISS){
+                    *t = te[k];
+                    best = (uint32_t)(i + k);
+                }
+                bits &= bits - 1;
+            }
+        }
+    }
+    return best;
+}
+
+GLV_API size_t glv_rays_triangle(const glv_ray_soa* rays, size_t n, const glv_vec3* a, const glv_vec3* b,
+    const glv_vec3* c, uint32_t index, const glv_ray_hit_soa* hits){
+    GLV_PROFILE_FUNC();
+    const glv_vec3 e1 = {.x = b->x - a->x, .y = b->y - a->y, .z = b->z - a->z};
+    const glv_vec3 e2 = {.x = c->x - a->x, .y = c->y - a->y, .z = c->z - a->z};
+    size_t count = 0;
+    size_t i = RAY_DISPATCH(rays_triangle, rays, n, a, &e1, &e2, index, hits, &count);
+    for(; i != n; ++i){
+        const float o[3] = RAY_GET(rays->origin, i), d[3] = RAY_GET(rays->direction, i);
+        float t, u, v;
+        if(ray_triangle(o, d, a->data, e1.data, e2.data, hits->t[i], &t, &u, &v)){
+            hits->t[i] = t;
+            hits->u[i] = u;
+            hits->v[i] = v;
+            hits->index[i] = index;
+            ++count;
+        }
+    }
+    return count;
+}
+
+GLV_API size_t glv_rays_aabb(const glv_ray_soa* rays, size_t n, const glv_vec3* min, const glv_vec3* max,
+    const float* t_max, uint32_t* mask){
+    GLV_PROFILE_FUNC();
+    size_t i = RAY_DISPATCH(rays_aabb, rays, n, min, max, t_max, mask);
+    size_t hits = 0, w;
+    for(; i != n; ++i){
+        const float o[3] = RAY_GET(rays->origin, i), d[3] = RAY_GET(rays->direction, i);
+        const float inv[3] = {1.0f / d[0], 1.0f / d[1], 1.0f / d[2]};
+        float te;
+        if(i % 32 == 0) mask[i / 32] = 0;
+        if(ray_aabb(o, inv, min->data, max->data, t_max ? t_max[i] : INFINITY, &te)){
+            mask[i / 32] |= (uint32_t)1 << (i % 32);
+        }
+    }
+    for(w = 0; w != GLV_RAY_MASK_WORDS(n); ++w){
+        hits += (size_t)__builtin_popcount(mask[w]);
+    }
+    return hits;
+}
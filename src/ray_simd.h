@@ -0,0 +1,188 @@
+/*
+    === ray_simd.h ===
+
+    Ray intersection kernels written once over a generic vector type,
+    and included by ray.c once per instruction set. Before inclusion,
+    define:
+
+        RAY_ISA        suffix of the generated functions
+        RAY_TARGET     target attribute (GLV_TARGET_*)
+        RAY_W          lanes per vector, dividing 32
+        RAY_V          vector type
+        RAY_M          comparison result type
+        RAY_SET1, RAY_LOAD, RAY_STORE, RAY_ADD, RAY_SUB, RAY_MUL, RAY_DIV
+        RAY_MIN, RAY_MAX     as minps/maxps: (a < b ? a : b), (a > b ? a : b)
+        RAY_LT, RAY_LE       lane-wise, false for NaN
+        RAY_NE               lane-wise, true for NaN
+        RAY_AND              of two comparison results
+        RAY_MOVEMASK         comparison result as an int, bit per lane
+        RAY_SELECT(m, a, b)  a in the lanes of m, b elsewhere
+        RAY_SET1_BITS        vector of a 32-bit pattern
+
+    Each kernel handles the largest multiple of RAY_W primitives or rays
+    (of 32 for the masks) and returns how many it processed; the caller
+    finishes the tail with the scalar tests of ray.c, which use the same
+    expressions in the same order.
+*/
+
+#define RAY_CAT_(a, b) a##_##b
+#define RAY_CAT(a, b) RAY_CAT_(a, b)
+#define RAY_FN(name) RAY_CAT(name, RAY_ISA)
+
+
+/* Moller-Trumbore on every lane, see ray_triangle in ray.c */
+RAY_TARGET
+static inline RAY_M RAY_FN(ray_triangle_lanes)(RAY_V ox, RAY_V oy, RAY_V oz, RAY_V dx, RAY_V dy, RAY_V dz,
+    RAY_V v0x, RAY_V v0y, RAY_V v0z, RAY_V e1x, RAY_V e1y, RAY_V e1z, RAY_V e2x, RAY_V e2y, RAY_V e2z,
+    RAY_V best, RAY_V* t, RAY_V* u, RAY_V* v){
+    const RAY_V zero = RAY_SET1(0.0f), one = RAY_SET1(1.0f);
+    const RAY_V px = RAY_SUB(RAY_MUL(dy, e2z), RAY_MUL(dz, e2y));
+    const RAY_V py = RAY_SUB(RAY_MUL(dz, e2x), RAY_MUL(dx, e2z));
+    const RAY_V pz = RAY_SUB(RAY_MUL(dx, e2y), RAY_MUL(dy, e2x));
+    const RAY_V det = RAY_ADD(RAY_ADD(RAY_MUL(e1x, px), RAY_MUL(e1y, py)), RAY_MUL(e1z, pz));
+    const RAY_V inv = RAY_DIV(one, det);
+    const RAY_V sx = RAY_SUB(ox, v0x), sy = RAY_SUB(oy, v0y), sz = RAY_SUB(oz, v0z);
+    const RAY_V qx = RAY_SUB(RAY_MUL(sy, e1z), RAY_MUL(sz, e1y));
+    const RAY_V qy = RAY_SUB(RAY_MUL(sz, e1x), RAY_MUL(sx, e1z));
+    const RAY_V qz = RAY_SUB(RAY_MUL(sx, e1y), RAY_MUL(sy, e1x));
+    *u = RAY_MUL(RAY_ADD(RAY_ADD(RAY_MUL(sx, px), RAY_MUL(sy, py)), RAY_MUL(sz, pz)), inv);
+    *v = RAY_MUL(RAY_ADD(RAY_ADD(RAY_MUL(dx, qx), RAY_MUL(dy, qy)), RAY_MUL(dz, qz)), inv);
+    *t = RAY_MUL(RAY_ADD(RAY_ADD(RAY_MUL(e2x, qx), RAY_MUL(e2y, qy)), RAY_MUL(e2z, qz)), inv);
+    RAY_M m = RAY_AND(RAY_NE(det, zero), RAY_LE(zero, *u));
+    m = RAY_AND(m, RAY_LE(zero, *v));
+    m = RAY_AND(m, RAY_LE(RAY_ADD(*u, *v), one));
+    m = RAY_AND(m, RAY_LT(zero, *t));
+    return RAY_AND(m, RAY_LT(*t, best));
+}
+
+/* Slab test on every lane, see ray_aabb in ray.c */
+RAY_TARGET
+static inline RAY_M RAY_FN(ray_aabb_lanes)(RAY_V ox, RAY_V oy, RAY_V oz, RAY_V ix, RAY_V iy, RAY_V iz,
+    RAY_V lx, RAY_V ly, RAY_V lz, RAY_V hx, RAY_V hy, RAY_V hz, RAY_V t_max, RAY_V* t_enter){
+    RAY_V t1 = RAY_MUL(RAY_SUB(lx, ox), ix), t2 = RAY_MUL(RAY_SUB(hx, ox), ix);
+    RAY_V tn = RAY_MIN(t1, t2), tf = RAY_MAX(t1, t2);
+    t1 = RAY_MUL(RAY_SUB(ly, oy), iy);
+    t2 = RAY_MUL(RAY_SUB(hy, oy), iy);
+    tn = RAY_MAX(tn, RAY_MIN(t1, t2));
+    tf = RAY_MIN(tf, RAY_MAX(t1, t2));
+    t1 = RAY_MUL(RAY_SUB(lz, oz), iz);
+    t2 = RAY_MUL(RAY_SUB(hz, oz), iz);
+    tn = RAY_MAX(tn, RAY_MIN(t1, t2));
+    tf = RAY_MIN(tf, RAY_MAX(t1, t2));
+    tn = RAY_MAX(tn, RAY_SET1(0.0f));
+    *t_enter = tn;
+    return RAY_AND(RAY_LE(tn, tf), RAY_LT(tn, t_max));
+}
+
+
+/* ----- One ray, many primitives ----- */
+
+/* Lanes that hit are merged in index order, keeping the scalar tie-break */
+RAY_TARGET
+static size_t RAY_FN(ray_triangles)(const glv_ray* r, const glv_triangle_soa* tr, size_t n, glv_ray_hit* hit){
+    const RAY_V ox = RAY_SET1(r->origin.x), oy = RAY_SET1(r->origin.y), oz = RAY_SET1(r->origin.z);
+    const RAY_V dx = RAY_SET1(r->direction.x), dy = RAY_SET1(r->direction.y), dz = RAY_SET1(r->direction.z);
+    RAY_V best = RAY_SET1(hit->t);
+    float ts[RAY_W], us[RAY_W], vs[RAY_W];
+    size_t i;
+    for(i = 0; i + RAY_W <= n; i += RAY_W){
+        RAY_V t, u, v;
+        const RAY_M m = RAY_FN(ray_triangle_lanes)(ox, oy, oz, dx, dy, dz,
+            RAY_LOAD(tr->v0.x + i), RAY_LOAD(tr->v0.y + i), RAY_LOAD(tr->v0.z + i),
+            RAY_LOAD(tr->e1.x + i), RAY_LOAD(tr->e1.y + i), RAY_LOAD(tr->e1.z + i),
+            RAY_LOAD(tr->e2.x + i), RAY_LOAD(tr->e2.y + i), RAY_LOAD(tr->e2.z + i), best, &t, &u, &v);
+        unsigned int bits = (unsigned int)RAY_MOVEMASK(m);
+        if(!bits) continue;
+        RAY_STORE(ts, t);
+        RAY_STORE(us, u);
+        RAY_STORE(vs, v);
+        while(bits){
+            const unsigned int k = (unsigned int)__builtin_ctz(bits);
+            if(ts[k] < hit->t){
+                hit->t = ts[k];
+                hit->u = us[k];
+                hit->v = vs[k];
+                hit->index = (uint32_t)(i + k);
+            }
+            bits &= bits - 1;
+        }
+        best = RAY_SET1(hit->t);
+    }
+    return i;
+}
+
+/* ix, iy, iz are the reciprocals of the direction */
+RAY_TARGET
+static size_t RAY_FN(ray_aabbs)(const glv_ray* r, float ix, float iy, float iz, const glv_aabb_soa* b,
+    size_t n, float t_max, uint32_t* mask, float* t_enter){
+    const RAY_V ox = RAY_SET1(r->origin.x), oy = RAY_SET1(r->origin.y), oz = RAY_SET1(r->origin.z);
+    const RAY_V vix = RAY_SET1(ix), viy = RAY_SET1(iy), viz = RAY_SET1(iz);
+    const RAY_V tm = RAY_SET1(t_max), inf = RAY_SET1(INFINITY);
+    size_t i, k;
+    for(i = 0; i + 32 <= n; i += 32){
+        uint32_t word = 0;
+        for(k = i; k != i + 32; k += RAY_W){
+            RAY_V te;
+            const RAY_M m = RAY_FN(ray_aabb_lanes)(ox, oy, oz, vix, viy, viz,
+                RAY_LOAD(b->min.x + k), RAY_LOAD(b->min.y + k), RAY_LOAD(b->min.z + k),
+                RAY_LOAD(b->max.x + k), RAY_LOAD(b->max.y + k), RAY_LOAD(b->max.z + k), tm, &te);
+            word |= (uint32_t)RAY_MOVEMASK(m) << (k - i);
+            if(t_enter) RAY_STORE(t_enter + k, RAY_SELECT(m, te, inf));
+        }
+        mask[i / 32] = word;
+    }
+    return i;
+}
+
+
+/* ----- Many rays, one primitive ----- */
+
+RAY_TARGET
+static size_t RAY_FN(rays_triangle)(const glv_ray_soa* rays, size_t n, const glv_vec3* v0, const glv_vec3* e1,
+    const glv_vec3* e2, uint32_t index, const glv_ray_hit_soa* hits, size_t* count){
+    const RAY_V v0x = RAY_SET1(v0->x), v0y = RAY_SET1(v0->y), v0z = RAY_SET1(v0->z);
+    const RAY_V e1x = RAY_SET1(e1->x), e1y = RAY_SET1(e1->y), e1z = RAY_SET1(e1->z);
+    const RAY_V e2x = RAY_SET1(e2->x), e2y = RAY_SET1(e2->y), e2z = RAY_SET1(e2->z);
+    const RAY_V id = RAY_SET1_BITS(index);
+    size_t i;
+    for(i = 0; i + RAY_W <= n; i += RAY_W){
+        const RAY_V best = RAY_LOAD(hits->t + i);
+        RAY_V t, u, v;
+        const RAY_M m = RAY_FN(ray_triangle_lanes)(
+            RAY_LOAD(rays->origin.x + i), RAY_LOAD(rays->origin.y + i), RAY_LOAD(rays->origin.z + i),
+            RAY_LOAD(rays->direction.x + i), RAY_LOAD(rays->direction.y + i), RAY_LOAD(rays->direction.z + i),
+            v0x, v0y, v0z, e1x, e1y, e1z, e2x, e2y, e2z, best, &t, &u, &v);
+        const unsigned int bits = (unsigned int)RAY_MOVEMASK(m);
+        if(!bits) continue;
+        RAY_STORE(hits->t + i, RAY_SELECT(m, t, best));
+        RAY_STORE(hits->u + i, RAY_SELECT(m, u, RAY_LOAD(hits->u + i)));
+        RAY_STORE(hits->v + i, RAY_SELECT(m, v, RAY_LOAD(hits->v + i)));
+        // indices are moved as bit patterns, never as floats
+        RAY_STORE((float*)(hits->index + i), RAY_SELECT(m, id, RAY_LOAD((const float*)(hits->index + i))));
+        *count += (size_t)__builtin_popcount(bits);
+    }
+    return i;
+}
+
+RAY_TARGET
+static size_t RAY_FN(rays_aabb)(const glv_ray_soa* rays, size_t n, const glv_vec3* lo, const glv_vec3* hi,
+    const float* t_max, uint32_t* mask){
+    const RAY_V lx = RAY_SET1(lo->x), ly = RAY_SET1(lo->y), lz = RAY_SET1(lo->z);
+    const RAY_V hx = RAY_SET1(hi->x), hy = RAY_SET1(hi->y), hz = RAY_SET1(hi->z);
+    const RAY_V one = RAY_SET1(1.0f), inf = RAY_SET1(INFINITY);
+    size_t i, k;
+    for(i = 0; i + 32 <= n; i += 32){
+        uint32_t word = 0;
+        for(k = i; k != i + 32; k += RAY_W){
+            RAY_V te;
+            const RAY_M m = RAY_FN(ray_aabb_lanes)(
+                RAY_LOAD(rays->origin.x + k), RAY_LOAD(rays->origin.y + k), RAY_LOAD(rays->origin.z + k),
+                RAY_DIV(one, RAY_LOAD(rays->direction.x + k)), RAY_DIV(one, RAY_LOAD(rays->direction.y + k)),
+                RAY_DIV(one, RAY_LOAD(rays->direction.z + k)), lx, ly, lz, hx, hy, hz,
+                t_max ? RAY_LOAD(t_max + k) : inf, &te);
+            word |= (uint32_t)RAY_MOVEMASK(m) << (k - i);
+        }
+        mask[i / 32] = word;
+    }
+    return i;
+}
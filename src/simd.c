@@ -0,0 +1,565 @@
+
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* ----- Scalar kernels ----- */
+
+static void mat4_multiply_scalar(const glv_mat4* m, const glv_mat4* n, glv_mat4* s){
+    unsigned int i, j, k;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            s->data[i][j] = 0.0f;
+            for(k = 0; k != GLV_MAT4_RANK; ++k){
+                s->data[i][j] += m->data[i][k] * n->data[k][j];
+            }
+        }
+    }
+}
+
+static void transform_scalar(const glv_vec4* v, const glv_mat4* m, glv_vec4* t){
+    unsigned int i, j;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        t->data[i] = 0.0f;
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            t->data[i] += v->data[j] * m->data[i][j];
+        }
+    }
+}
+
+static void transform_batch4_scalar(const glv_vec4* in, size_t is,
+    glv_vec4* out, size_t os, size_t count, const glv_mat4* m){
+    const char* src = (const char*)in;
+    char* dst = (char*)out;
+    glv_vec4 t;
+    size_t n;
+    for(n = 0; n != count; ++n, src += is, dst += os){
+        transform_scalar((const glv_vec4*)src, m, &t);
+        *(glv_vec4*)dst = t;
+    }
+}
+
+static void transform_batch3_scalar(const glv_vec3* in, size_t is,
+    glv_vec3* out, size_t os, size_t count, const glv_mat4* m){
+    const char* src = (const char*)in;
+    char* dst = (char*)out;
+    const glv_vec3* p;
+    glv_vec3* q;
+    size_t n;
+    unsigned int i;
+    float t[3];
+    for(n = 0; n != count; ++n, src += is, dst += os){
+        p = (const glv_vec3*)src;
+        q = (glv_vec3*)dst;
+        for(i = 0; i != 3; ++i){
+            t[i] = 0.0f;
+            t[i] += p->x * m->data[i][0];
+            t[i] += p->y * m->data[i][1];
+            t[i] += p->z * m->data[i][2];
+            t[i] += m->data[i][3];
+        }
+        q->x = t[0]; q->y = t[1]; q->z = t[2];
+    }
+}
+
+/* Pair kernels inline the single product, out[i] may alias a[i] or b[i] */
+static void mat4_multiply_pairs_scalar(const glv_mat4* a, const glv_mat4* b, glv_mat4* out, size_t n){
+    glv_mat4 t;
+    size_t i;
+    for(i = 0; i != n; ++i){
+        mat4_multiply_scalar(&a[i], &b[i], &t);
+        out[i] = t;
+    }
+}
+
+static void mat4_chain_scalar(const glv_mat4* const* ptrs, const glv_mat4* array,
+    size_t n, glv_mat4* out){
+    glv_mat4 acc = ptrs ? *ptrs[0] : array[0], t;
+    size_t i;
+    for(i = 1; i != n; ++i){
+        mat4_multiply_scalar(&acc, ptrs ? ptrs[i] : &array[i], &t);
+        acc = t;
+    }
+    *out = acc;
+}
+
+
+#ifdef GLV_X86
+
+/*
+    Every row of the product is a linear combination of the rows of n,
+    weighted by the elements of the same row of m. Accumulating from zero
+    in k order keeps the SSE2 and AVX results identical to the scalar loop.
+*/
+
+/* ----- SSE2 kernels ----- */
+
+GLV_TARGET_SSE2
+static void mat4_multiply_sse2(const glv_mat4* m, const glv_mat4* n, glv_mat4* s){
+    const __m128 n0 = _mm_loadu_ps(n->data[0]);
+    const __m128 n1 = _mm_loadu_ps(n->data[1]);
+    const __m128 n2 = _mm_loadu_ps(n->data[2]);
+    const __m128 n3 = _mm_loadu_ps(n->data[3]);
+    unsigned int i;
+    for(i = 0; i != GLV_MAT4_RANK; ++i){
+        __m128 acc = _mm_setzero_ps();
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(m->data[i][0]), n0));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(m->data[i][1]), n1));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(m->data[i][2]), n2));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(m->data[i][3]), n3));
+        _mm_storeu_ps(s->data[i], acc);
+    }
+}
+
+GLV_TARGET_SSE2
+static void transform_sse2(const glv_vec4* v, const glv_mat4* m, glv_vec4* t){
+    // columns of m, so that t = sum_j col_j * v_j in scalar order
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    __m128 acc = _mm_setzero_ps();
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(v->data[0]), c0));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(v->data[1]), c1));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(v->data[2]), c2));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(v->data[3]), c3));
+    _mm_storeu_ps(t->data, acc);
+}
+
+/*
+    Batch kernels keep the transposed matrix in registers for the whole
+    array. vec3 elements are read and written per component, so packed
+    12-byte arrays are never over-read or over-written.
+*/
+GLV_TARGET_SSE2
+static void transform_batch4_sse2(const glv_vec4* in, size_t is,
+    glv_vec4* out, size_t os, size_t count, const glv_mat4* m){
+    const char* src = (const char*)in;
+    char* dst = (char*)out;
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    size_t n;
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    for(n = 0; n != count; ++n, src += is, dst += os){
+        const __m128 v = _mm_loadu_ps((const float*)src);
+        __m128 acc = _mm_setzero_ps();
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0x00), c0));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0x55), c1));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xAA), c2));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xFF), c3));
+        _mm_storeu_ps((float*)dst, acc);
+    }
+}
+
+GLV_TARGET_SSE2
+static void transform_batch3_sse2(const glv_vec3* in, size_t is,
+    glv_vec3* out, size_t os, size_t count, const glv_mat4* m){
+    const char* src = (const char*)in;
+    char* dst = (char*)out;
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    size_t n;
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    for(n = 0; n != count; ++n, src += is, dst += os){
+        const glv_vec3* p = (const glv_vec3*)src;
+        float* q = (float*)dst;
+        __m128 acc = _mm_setzero_ps();
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(p->x), c0));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(p->y), c1));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(p->z), c2));
+        acc = _mm_add_ps(acc, c3);
+        _mm_storel_pi((__m64*)q, acc);
+        _mm_store_ss(q + 2, _mm_movehl_ps(acc, acc));
+    }
+}
+
+GLV_TARGET_SSE2
+static void mat4_multiply_pairs_sse2(const glv_mat4* a, const glv_mat4* b, glv_mat4* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i) mat4_multiply_sse2(&a[i], &b[i], &out[i]);
+}
+
+/* Chain kernels keep the running product in registers between steps */
+GLV_TARGET_SSE2
+static void mat4_chain_sse2(const glv_mat4* const* ptrs, const glv_mat4* array,
+    size_t n, glv_mat4* out){
+    const glv_mat4* m = ptrs ? ptrs[0] : array;
+    __m128 a0 = _mm_loadu_ps(m->data[0]);
+    __m128 a1 = _mm_loadu_ps(m->data[1]);
+    __m128 a2 = _mm_loadu_ps(m->data[2]);
+    __m128 a3 = _mm_loadu_ps(m->data[3]);
+    size_t i;
+    for(i = 1; i != n; ++i){
+        m = ptrs ? ptrs[i] : &array[i];
+        const __m128 n0 = _mm_loadu_ps(m->data[0]);
+        const __m128 n1 = _mm_loadu_ps(m->data[1]);
+        const __m128 n2 = _mm_loadu_ps(m->data[2]);
+        const __m128 n3 = _mm_loadu_ps(m->data[3]);
+        __m128 r[4] = {a0, a1, a2, a3};
+        unsigned int j;
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            const __m128 a = r[j];
+            __m128 acc = _mm_setzero_ps();
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(a, a, 0x00), n0));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(a, a, 0x55), n1));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(a, a, 0xAA), n2));
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(a, a, 0xFF), n3));
+            r[j] = acc;
+        }
+        a0 = r[0]; a1 = r[1]; a2 = r[2]; a3 = r[3];
+    }
+    _mm_storeu_ps(out->data[0], a0);
+    _mm_storeu_ps(out->data[1], a1);
+    _mm_storeu_ps(out->data[2], a2);
+    _mm_storeu_ps(out->data[3], a3);
+}
+
+
+/* ----- AVX kernels ----- */
+
+/* Two rows of the result per iteration */
+GLV_TARGET_AVX
+static void mat4_multiply_avx(const glv_mat4* m, const glv_mat4* n, glv_mat4* s){
+    const __m256 n0 = _mm256_broadcast_ps((const __m128*)n->data[0]);
+    const __m256 n1 = _mm256_broadcast_ps((const __m128*)n->data[1]);
+    const __m256 n2 = _mm256_broadcast_ps((const __m128*)n->data[2]);
+    const __m256 n3 = _mm256_broadcast_ps((const __m128*)n->data[3]);
+    unsigned int i;
+    for(i = 0; i != GLV_MAT4_RANK; i += 2){
+        const __m256 r = _mm256_loadu_ps(m->data[i]);
+        __m256 acc = _mm256_setzero_ps();
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(r, 0x00), n0));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(r, 0x55), n1));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(r, 0xAA), n2));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(r, 0xFF), n3));
+        _mm256_storeu_ps(s->data[i], acc);
+    }
+}
+
+/* Two vectors per iteration, the matrix columns duplicated in both lanes */
+GLV_TARGET_AVX
+static void transform_batch4_avx(const glv_vec4* in, size_t is,
+    glv_vec4* out, size_t os, size_t count, const glv_mat4* m){
+    const char* src = (const char*)in;
+    char* dst = (char*)out;
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    size_t n;
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    const __m256 C0 = _mm256_insertf128_ps(_mm256_castps128_ps256(c0), c0, 1);
+    const __m256 C1 = _mm256_insertf128_ps(_mm256_castps128_ps256(c1), c1, 1);
+    const __m256 C2 = _mm256_insertf128_ps(_mm256_castps128_ps256(c2), c2, 1);
+    const __m256 C3 = _mm256_insertf128_ps(_mm256_castps128_ps256(c3), c3, 1);
+    for(n = 0; n + 2 <= count; n += 2, src += 2 * is, dst += 2 * os){
+        const __m256 v = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(_mm_loadu_ps((const float*)src)),
+            _mm_loadu_ps((const float*)(src + is)), 1);
+        __m256 acc = _mm256_setzero_ps();
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(v, 0x00), C0));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(v, 0x55), C1));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(v, 0xAA), C2));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_permute_ps(v, 0xFF), C3));
+        _mm_storeu_ps((float*)dst, _mm256_castps256_ps128(acc));
+        _mm_storeu_ps((float*)(dst + os), _mm256_extractf128_ps(acc, 1));
+    }
+    if(n != count){
+        const __m128 v = _mm_loadu_ps((const float*)src);
+        __m128 acc = _mm_setzero_ps();
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_permute_ps(v, 0x00), c0));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_permute_ps(v, 0x55), c1));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_permute_ps(v, 0xAA), c2));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_permute_ps(v, 0xFF), c3));
+        _mm_storeu_ps((float*)dst, acc);
+    }
+}
+
+GLV_TARGET_AVX
+static void mat4_multiply_pairs_avx(const glv_mat4* a, const glv_mat4* b, glv_mat4* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i) mat4_multiply_avx(&a[i], &b[i], &out[i]);
+}
+
+/* Running product held as rows 0-1 and rows 2-3 */
+GLV_TARGET_AVX
+static void mat4_chain_avx(const glv_mat4* const* ptrs, const glv_mat4* array,
+    size_t n, glv_mat4* out){
+    const glv_mat4* m = ptrs ? ptrs[0] : array;
+    __m256 lo = _mm256_loadu_ps(m->data[0]);
+    __m256 hi = _mm256_loadu_ps(m->data[2]);
+    size_t i;
+    for(i = 1; i != n; ++i){
+        m = ptrs ? ptrs[i] : &array[i];
+        const __m256 n0 = _mm256_broadcast_ps((const __m128*)m->data[0]);
+        const __m256 n1 = _mm256_broadcast_ps((const __m128*)m->data[1]);
+        const __m256 n2 = _mm256_broadcast_ps((const __m128*)m->data[2]);
+        const __m256 n3 = _mm256_broadcast_ps((const __m128*)m->data[3]);
+        __m256 l = _mm256_setzero_ps(), h = _mm256_setzero_ps();
+        l = _mm256_add_ps(l, _mm256_mul_ps(_mm256_permute_ps(lo, 0x00), n0));
+        h = _mm256_add_ps(h, _mm256_mul_ps(_mm256_permute_ps(hi, 0x00), n0));
+        l = _mm256_add_ps(l, _mm256_mul_ps(_mm256_permute_ps(lo, 0x55), n1));
+        h = _mm256_add_ps(h, _mm256_mul_ps(_mm256_permute_ps(hi, 0x55), n1));
+        l = _mm256_add_ps(l, _mm256_mul_ps(_mm256_permute_ps(lo, 0xAA), n2));
+        h = _mm256_add_ps(h, _mm256_mul_ps(_mm256_permute_ps(hi, 0xAA), n2));
+        l = _mm256_add_ps(l, _mm256_mul_ps(_mm256_permute_ps(lo, 0xFF), n3));
+        h = _mm256_add_ps(h, _mm256_mul_ps(_mm256_permute_ps(hi, 0xFF), n3));
+        lo = l;
+        hi = h;
+    }
+    _mm256_storeu_ps(out->data[0], lo);
+    _mm256_storeu_ps(out->data[2], hi);
+}
+
+
+/* ----- AVX2 + FMA kernels ----- */
+
+GLV_TARGET_AVX2
+static void mat4_multiply_avx2(const glv_mat4* m, const glv_mat4* n, glv_mat4* s){
+    const __m256 n0 = _mm256_broadcast_ps((const __m128*)n->data[0]);
+    const __m256 n1 = _mm256_broadcast_ps((const __m128*)n->data[1]);
+    const __m256 n2 = _mm256_broadcast_ps((const __m128*)n->data[2]);
+    const __m256 n3 = _mm256_broadcast_ps((const __m128*)n->data[3]);
+    unsigned int i;
+    for(i = 0; i != GLV_MAT4_RANK; i += 2){
+        const __m256 r = _mm256_loadu_ps(m->data[i]);
+        __m256 acc = _mm256_mul_ps(_mm256_permute_ps(r, 0x00), n0);
+        acc = _mm256_fmadd_ps(_mm256_permute_ps(r, 0x55), n1, acc);
+        acc = _mm256_fmadd_ps(_mm256_permute_ps(r, 0xAA), n2, acc);
+        acc = _mm256_fmadd_ps(_mm256_permute_ps(r, 0xFF), n3, acc);
+        _mm256_storeu_ps(s->data[i], acc);
+    }
+}
+
+GLV_TARGET_AVX2
+static void transform_avx2(const glv_vec4* v, const glv_mat4* m, glv_vec4* t){
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    __m128 acc = _mm_mul_ps(_mm_set1_ps(v->data[0]), c0);
+    acc = _mm_fmadd_ps(_mm_set1_ps(v->data[1]), c1, acc);
+    acc = _mm_fmadd_ps(_mm_set1_ps(v->data[2]), c2, acc);
+    acc = _mm_fmadd_ps(_mm_set1_ps(v->data[3]), c3, acc);
+    _mm_storeu_ps(t->data, acc);
+}
+
+GLV_TARGET_AVX2
+static void transform_batch4_avx2(const glv_vec4* in, size_t is,
+    glv_vec4* out, size_t os, size_t count, const glv_mat4* m){
+    const char* src = (const char*)in;
+    char* dst = (char*)out;
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    size_t n;
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    const __m256 C0 = _mm256_broadcast_ps(&c0);
+    const __m256 C1 = _mm256_broadcast_ps(&c1);
+    const __m256 C2 = _mm256_broadcast_ps(&c2);
+    const __m256 C3 = _mm256_broadcast_ps(&c3);
+    for(n = 0; n + 2 <= count; n += 2, src += 2 * is, dst += 2 * os){
+        const __m256 v = _mm256_insertf128_ps(
+            _mm256_castps128_ps256(_mm_loadu_ps((const float*)src)),
+            _mm_loadu_ps((const float*)(src + is)), 1);
+        __m256 acc = _mm256_mul_ps(_mm256_permute_ps(v, 0x00), C0);
+        acc = _mm256_fmadd_ps(_mm256_permute_ps(v, 0x55), C1, acc);
+        acc = _mm256_fmadd_ps(_mm256_permute_ps(v, 0xAA), C2, acc);
+        acc = _mm256_fmadd_ps(_mm256_permute_ps(v, 0xFF), C3, acc);
+        _mm_storeu_ps((float*)dst, _mm256_castps256_ps128(acc));
+        _mm_storeu_ps((float*)(dst + os), _mm256_extractf128_ps(acc, 1));
+    }
+    if(n != count){
+        const __m128 v = _mm_loadu_ps((const float*)src);
+        __m128 acc = _mm_mul_ps(_mm_permute_ps(v, 0x00), c0);
+        acc = _mm_fmadd_ps(_mm_permute_ps(v, 0x55), c1, acc);
+        acc = _mm_fmadd_ps(_mm_permute_ps(v, 0xAA), c2, acc);
+        acc = _mm_fmadd_ps(_mm_permute_ps(v, 0xFF), c3, acc);
+        _mm_storeu_ps((float*)dst, acc);
+    }
+}
+
+GLV_TARGET_AVX2
+static void transform_batch3_avx2(const glv_vec3* in, size_t is,
+    glv_vec3* out, size_t os, size_t count, const glv_mat4* m){
+    const char* src = (const char*)in;
+    char* dst = (char*)out;
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    size_t n;
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    for(n = 0; n != count; ++n, src += is, dst += os){
+        const glv_vec3* p = (const glv_vec3*)src;
+        float* q = (float*)dst;
+        __m128 acc = _mm_mul_ps(_mm_set1_ps(p->x), c0);
+        acc = _mm_fmadd_ps(_mm_set1_ps(p->y), c1, acc);
+        acc = _mm_fmadd_ps(_mm_set1_ps(p->z), c2, acc);
+        acc = _mm_add_ps(acc, c3);
+        _mm_storel_pi((__m64*)q, acc);
+        _mm_store_ss(q + 2, _mm_movehl_ps(acc, acc));
+    }
+}
+
+GLV_TARGET_AVX2
+static void mat4_multiply_pairs_avx2(const glv_mat4* a, const glv_mat4* b, glv_mat4* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i) mat4_multiply_avx2(&a[i], &b[i], &out[i]);
+}
+
+/* A whole matrix per register, same operation order as mat4_multiply_avx2 */
+GLV_TARGET_AVX512
+static void mat4_multiply_pairs_avx512(const glv_mat4* a, const glv_mat4* b, glv_mat4* out, size_t n){
+    size_t i;
+    for(i = 0; i != n; ++i){
+        const __m512 r = _mm512_loadu_ps(a[i].data);
+        const __m512 n0 = _mm512_broadcast_f32x4(_mm_loadu_ps(b[i].data[0]));
+        const __m512 n1 = _mm512_broadcast_f32x4(_mm_loadu_ps(b[i].data[1]));
+        const __m512 n2 = _mm512_broadcast_f32x4(_mm_loadu_ps(b[i].data[2]));
+        const __m512 n3 = _mm512_broadcast_f32x4(_mm_loadu_ps(b[i].data[3]));
+        __m512 acc = _mm512_mul_ps(_mm512_permute_ps(r, 0x00), n0);
+        acc = _mm512_fmadd_ps(_mm512_permute_ps(r, 0x55), n1, acc);
+        acc = _mm512_fmadd_ps(_mm512_permute_ps(r, 0xAA), n2, acc);
+        acc = _mm512_fmadd_ps(_mm512_permute_ps(r, 0xFF), n3, acc);
+        _mm512_storeu_ps(out[i].data, acc);
+    }
+}
+
+GLV_TARGET_AVX2
+static void mat4_chain_avx2(const glv_mat4* const* ptrs, const glv_mat4* array,
+    size_t n, glv_mat4* out){
+    const glv_mat4* m = ptrs ? ptrs[0] : array;
+    __m256 lo = _mm256_loadu_ps(m->data[0]);
+    __m256 hi = _mm256_loadu_ps(m->data[2]);
+    size_t i;
+    for(i = 1; i != n; ++i){
+        m = ptrs ? ptrs[i] : &array[i];
+        const __m256 n0 = _mm256_broadcast_ps((const __m128*)m->data[0]);
+        const __m256 n1 = _mm256_broadcast_ps((const __m128*)m->data[1]);
+        const __m256 n2 = _mm256_broadcast_ps((const __m128*)m->data[2]);
+        const __m256 n3 = _mm256_broadcast_ps((const __m128*)m->data[3]);
+        __m256 l = _mm256_mul_ps(_mm256_permute_ps(lo, 0x00), n0);
+        __m256 h = _mm256_mul_ps(_mm256_permute_ps(hi, 0x00), n0);
+        l = _mm256_fmadd_ps(_mm256_permute_ps(lo, 0x55), n1, l);
+        h = _mm256_fmadd_ps(_mm256_permute_ps(hi, 0x55), n1, h);
+        l = _mm256_fmadd_ps(_mm256_permute_ps(lo, 0xAA), n2, l);
+        h = _mm256_fmadd_ps(_mm256_permute_ps(hi, 0xAA), n2, h);
+        l = _mm256_fmadd_ps(_mm256_permute_ps(lo, 0xFF), n3, l);
+        h = _mm256_fmadd_ps(_mm256_permute_ps(hi, 0xFF), n3, h);
+        lo = l;
+        hi = h;
+    }
+    _mm256_storeu_ps(out->data[0], lo);
+    _mm256_storeu_ps(out->data[2], hi);
+}
+
+#endif /* GLV_X86 */
+
+
+/* ----- Dispatch ----- */
+
+/* Scalar until the constructor below has run */
+GLV_INTERNAL glv_simd_kernels glv__simd = {
+    mat4_multiply_scalar, transform_scalar,
+    transform_batch4_scalar, transform_batch3_scalar,
+    mat4_chain_scalar, mat4_multiply_pairs_scalar
+};
+static glv_simd_level current_level = GLV_SIMD_SCALAR;
+
+GLV_API glv_simd_level glv_simd_detect(void){
+    GLV_PROFILE_FUNC();
+#ifdef GLV_X86
+    // cpuid-based, also checks that the OS saves the AVX registers
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        return __builtin_cpu_supports("avx512f") ? GLV_SIMD_AVX512 : GLV_SIMD_AVX2;
+    }
+    if(__builtin_cpu_supports("avx")) return GLV_SIMD_AVX;
+    if(__builtin_cpu_supports("sse2")) return GLV_SIMD_SSE2;
+#endif
+    return GLV_SIMD_SCALAR;
+}
+
+static void simd_install(glv_simd_level level){
+    glv_simd_kernels k = {
+        mat4_multiply_scalar, transform_scalar,
+        transform_batch4_scalar, transform_batch3_scalar,
+        mat4_chain_scalar, mat4_multiply_pairs_scalar
+    };
+#ifdef GLV_X86
+    switch(level){
+        case GLV_SIMD_AVX512:
+        case GLV_SIMD_AVX2:
+            k.mat4_multiply = mat4_multiply_avx2;
+            k.transform = transform_avx2;
+            k.transform_batch4 = transform_batch4_avx2;
+            k.transform_batch3 = transform_batch3_avx2;
+            k.mat4_chain = mat4_chain_avx2;
+            k.mat4_multiply_pairs = level == GLV_SIMD_AVX512 ? mat4_multiply_pairs_avx512 : mat4_multiply_pairs_avx2;
+            break;
+        case GLV_SIMD_AVX:
+            k.mat4_multiply = mat4_multiply_avx;
+            k.transform = transform_sse2; // a single vec4 gains nothing from 256 bits
+            k.transform_batch4 = transform_batch4_avx;
+            k.transform_batch3 = transform_batch3_sse2;
+            k.mat4_chain = mat4_chain_avx;
+            k.mat4_multiply_pairs = mat4_multiply_pairs_avx;
+            break;
+        case GLV_SIMD_SSE2:
+            k.mat4_multiply = mat4_multiply_sse2;
+            k.transform = transform_sse2;
+            k.transform_batch4 = transform_batch4_sse2;
+            k.transform_batch3 = transform_batch3_sse2;
+            k.mat4_chain = mat4_chain_sse2;
+            k.mat4_multiply_pairs = mat4_multiply_pairs_sse2;
+            break;
+        default:
+            level = GLV_SIMD_SCALAR;
+            break;
+    }
+#else
+    level = GLV_SIMD_SCALAR;
+#endif
+    glv__simd = k;
+    current_level = level;
+}
+
+__attribute__((constructor))
+static void simd_startup(void){
+#ifdef GLV_SIMD_FORCE
+    simd_install(GLV_SIMD_FORCE);
+#else
+    simd_install(glv_simd_detect());
+#endif
+}
+
+GLV_API glv_simd_level glv_simd_get_level(void){
+    return current_level;
+}
+
+GLV_API glv_simd_level glv_simd_set_level(glv_simd_level level){
+    GLV_PROFILE_FUNC();
+    glv_simd_level max = glv_simd_detect();
+    simd_install(level > max ? max : level);
+    return current_level;
+}
+
+GLV_API const char* glv_simd_name(glv_simd_level level){
+    GLV_PROFILE_FUNC();
+    switch(level){
+        case GLV_SIMD_SSE2: return "sse2";
+        case GLV_SIMD_AVX:  return "avx";
+        case GLV_SIMD_AVX2: return "avx2+fma";
+        case GLV_SIMD_AVX512: return "avx512";
+        default:            return "scalar";
+    }
+}
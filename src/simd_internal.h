@@ -0,0 +1,55 @@
+/*
+    === simd_internal.h ===
+
+    Private to the library: kernel dispatch table and helpers
+    to compile per-ISA functions in a single translation unit.
+*/
+
+#ifndef GLV_SIMD_INTERNAL_H
+#define GLV_SIMD_INTERNAL_H 1
+
+#include <stddef.h>
+#include "../include/simd.h"
+#include "../include/mat.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define GLV_X86 1
+    #include <immintrin.h>
+    #define GLV_TARGET_SSE2 __attribute__((target("sse2")))
+    #define GLV_TARGET_AVX  __attribute__((target("avx")))
+    #define GLV_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #define GLV_TARGET_AVX512 __attribute__((target("avx512f")))
+    #define GLV_TARGET_F16C __attribute__((target("avx,f16c")))
+    #define GLV_TARGET_BMI2 __attribute__((target("bmi2")))
+#endif
+
+/* Library-wide state: one copy per translation unit in header-only mode */
+#ifdef GLV_HEADER_ONLY
+    #define GLV_INTERNAL static
+#else
+    #define GLV_INTERNAL
+#endif
+
+/* Kernels selected at startup. Unless noted, outputs never alias inputs. */
+typedef struct {
+    void (*mat4_multiply)(const glv_mat4* m, const glv_mat4* n, glv_mat4* out);
+    void (*transform)(const glv_vec4* v, const glv_mat4* m, glv_vec4* out);
+    /* Strides in bytes, already resolved to non-zero. out may equal in. */
+    void (*transform_batch4)(const glv_vec4* in, size_t in_stride,
+        glv_vec4* out, size_t out_stride, size_t count, const glv_mat4* m);
+    void (*transform_batch3)(const glv_vec3* in, size_t in_stride,
+        glv_vec3* out, size_t out_stride, size_t count, const glv_mat4* m);
+    /* Left-to-right product of n >= 1 matrices, from ptrs if not NULL, else from array */
+    void (*mat4_chain)(const glv_mat4* const* ptrs, const glv_mat4* array,
+        size_t n, glv_mat4* out);
+    /* out[i] = a[i] * b[i], out may equal a or b */
+    void (*mat4_multiply_pairs)(const glv_mat4* a, const glv_mat4* b, glv_mat4* out, size_t n);
+} glv_simd_kernels;
+
+#ifdef GLV_HEADER_ONLY
+static glv_simd_kernels glv__simd;
+#else
+extern glv_simd_kernels glv__simd;
+#endif
+
+#endif /* GLV_SIMD_INTERNAL_H */
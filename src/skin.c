@@ -0,0 +1,206 @@
+
+#include "../include/skin.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* Element i of a strided stream */
+#define SKIN_AT(type, base, stride, i) ((type)((const char*)(base) + (i) * (stride)))
+
+/*
+    Every kernel blends the top three rows in influence order,
+    w0 * P0 + w1 * P1 + w2 * P2 + w3 * P3, then sums the products of
+    each row with (v, 1) or (v, 0) in pairs, (x + y) + (z + w).
+    The pairs are what a transposed SIMD sum gives, so the scalar,
+    SSE2 and AVX results are identical.
+*/
+
+/* ----- Scalar ----- */
+
+static void skin_blend_scalar(const glv_mat4* palette, const uint16_t* j, const float* w, float r[3][4]){
+    const glv_mat4 *a = &palette[j[0]], *b = &palette[j[1]], *c = &palette[j[2]], *d = &palette[j[3]];
+    unsigned int i, k;
+    for(i = 0; i != 3; ++i){
+        for(k = 0; k != 4; ++k){
+            float acc = w[0] * a->data[i][k];
+            acc += w[1] * b->data[i][k];
+            acc += w[2] * c->data[i][k];
+            acc += w[3] * d->data[i][k];
+            r[i][k] = acc;
+        }
+    }
+}
+
+static void skin_apply_scalar(const float r[3][4], const float v[4], glv_vec3* out){
+    unsigned int i;
+    for(i = 0; i != 3; ++i){
+        out->data[i] = (r[i][0] * v[0] + r[i][1] * v[1]) + (r[i][2] * v[2] + r[i][3] * v[3]);
+    }
+}
+
+static void skin_range_scalar(const glv_skin_stream* s, const glv_mat4* palette, size_t begin, size_t end){
+    float r[3][4];
+    size_t i;
+    for(i = begin; i != end; ++i){
+        const glv_vec3* p = SKIN_AT(const glv_vec3*, s->position, s->position_stride, i);
+        const float vp[4] = {p->x, p->y, p->z, 1.0f};
+        skin_blend_scalar(palette, SKIN_AT(const uint16_t*, s->joints, s->joints_stride, i),
+            SKIN_AT(const float*, s->weights, s->weights_stride, i), r);
+        if(s->normal){
+            const glv_vec3* n = SKIN_AT(const glv_vec3*, s->normal, s->normal_stride, i);
+            const float vn[4] = {n->x, n->y, n->z, 0.0f};
+            skin_apply_scalar(r, vp, SKIN_AT(glv_vec3*, s->out_position, s->out_position_stride, i));
+            skin_apply_scalar(r, vn, SKIN_AT(glv_vec3*, s->out_normal, s->out_normal_stride, i));
+        }
+        else{
+            skin_apply_scalar(r, vp, SKIN_AT(glv_vec3*, s->out_position, s->out_position_stride, i));
+        }
+    }
+}
+
+
+#ifdef GLV_X86
+
+/* ----- SSE2 ----- */
+
+/* Row products transposed into columns and summed in pairs; lane 3 is 0 */
+GLV_TARGET_SSE2
+static inline __m128 skin_apply_sse2(__m128 r0, __m128 r1, __m128 r2, __m128 v){
+    __m128 t0 = _mm_mul_ps(r0, v), t1 = _mm_mul_ps(r1, v), t2 = _mm_mul_ps(r2, v), t3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+    return _mm_add_ps(_mm_add_ps(t0, t1), _mm_add_ps(t2, t3));
+}
+
+/* vec3 elements are read and written per component, packed arrays are never overrun */
+GLV_TARGET_SSE2
+static inline void skin_store_sse2(glv_vec3* out, __m128 v){
+    _mm_storel_pi((__m64*)out->data, v);
+    _mm_store_ss(out->data + 2, _mm_movehl_ps(v, v));
+}
+
+GLV_TARGET_SSE2
+static void skin_range_sse2(const glv_skin_stream* s, const glv_mat4* palette, size_t begin, size_t end){
+    size_t i;
+    for(i = begin; i != end; ++i){
+        const uint16_t* j = SKIN_AT(const uint16_t*, s->joints, s->joints_stride, i);
+        const float* w = SKIN_AT(const float*, s->weights, s->weights_stride, i);
+        const glv_vec3* p = SKIN_AT(const glv_vec3*, s->position, s->position_stride, i);
+        const glv_mat4 *a = &palette[j[0]], *b = &palette[j[1]], *c = &palette[j[2]], *d = &palette[j[3]];
+        const __m128 w0 = _mm_set1_ps(w[0]), w1 = _mm_set1_ps(w[1]), w2 = _mm_set1_ps(w[2]), w3 = _mm_set1_ps(w[3]);
+        __m128 r[3];
+        unsigned int k;
+        for(k = 0; k != 3; ++k){
+            __m128 acc = _mm_mul_ps(w0, _mm_loadu_ps(a->data[k]));
+            acc = _mm_add_ps(acc, _mm_mul_ps(w1, _mm_loadu_ps(b->data[k])));
+            acc = _mm_add_ps(acc, _mm_mul_ps(w2, _mm_loadu_ps(c->data[k])));
+            acc = _mm_add_ps(acc, _mm_mul_ps(w3, _mm_loadu_ps(d->data[k])));
+            r[k] = acc;
+        }
+        const __m128 op = skin_apply_sse2(r[0], r[1], r[2], _mm_setr_ps(p->x, p->y, p->z, 1.0f));
+        if(s->normal){
+            const glv_vec3* n = SKIN_AT(const glv_vec3*, s->normal, s->normal_stride, i);
+            const __m128 on = skin_apply_sse2(r[0], r[1], r[2], _mm_setr_ps(n->x, n->y, n->z, 0.0f));
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_position, s->out_position_stride, i), op);
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_normal, s->out_normal_stride, i), on);
+        }
+        else{
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_position, s->out_position_stride, i), op);
+        }
+    }
+}
+
+
+/* ----- AVX ----- */
+
+/* Two vertices per iteration, one in each 128-bit lane, running the SSE2 steps */
+GLV_TARGET_AVX
+static inline __m256 skin_pair_avx(__m128 lo, __m128 hi){
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+GLV_TARGET_AVX
+static inline __m256 skin_apply_avx(__m256 r0, __m256 r1, __m256 r2, __m256 v){
+    const __m256 t0 = _mm256_mul_ps(r0, v), t1 = _mm256_mul_ps(r1, v), t2 = _mm256_mul_ps(r2, v);
+    const __m256 t3 = _mm256_setzero_ps();
+    // in-lane 4x4 transpose, as _MM_TRANSPOSE4_PS
+    const __m256 l01 = _mm256_unpacklo_ps(t0, t1), h01 = _mm256_unpackhi_ps(t0, t1);
+    const __m256 l23 = _mm256_unpacklo_ps(t2, t3), h23 = _mm256_unpackhi_ps(t2, t3);
+    const __m256 c0 = _mm256_shuffle_ps(l01, l23, 0x44), c1 = _mm256_shuffle_ps(l01, l23, 0xEE);
+    const __m256 c2 = _mm256_shuffle_ps(h01, h23, 0x44), c3 = _mm256_shuffle_ps(h01, h23, 0xEE);
+    return _mm256_add_ps(_mm256_add_ps(c0, c1), _mm256_add_ps(c2, c3));
+}
+
+GLV_TARGET_AVX
+static void skin_range_avx(const glv_skin_stream* s, const glv_mat4* palette, size_t begin, size_t end){
+    size_t i;
+    for(i = begin; i + 2 <= end; i += 2){
+        const uint16_t* ja = SKIN_AT(const uint16_t*, s->joints, s->joints_stride, i);
+        const uint16_t* jb = SKIN_AT(const uint16_t*, s->joints, s->joints_stride, i + 1);
+        const float* wa = SKIN_AT(const float*, s->weights, s->weights_stride, i);
+        const float* wb = SKIN_AT(const float*, s->weights, s->weights_stride, i + 1);
+        const glv_vec3* pa = SKIN_AT(const glv_vec3*, s->position, s->position_stride, i);
+        const glv_vec3* pb = SKIN_AT(const glv_vec3*, s->position, s->position_stride, i + 1);
+        __m256 r[3];
+        unsigned int k, q;
+        for(k = 0; k != 3; ++k) r[k] = _mm256_setzero_ps();
+        for(q = 0; q != GLV_SKIN_INFLUENCES; ++q){
+            const glv_mat4 *ma = &palette[ja[q]], *mb = &palette[jb[q]];
+            const __m256 wq = skin_pair_avx(_mm_set1_ps(wa[q]), _mm_set1_ps(wb[q]));
+            for(k = 0; k != 3; ++k){
+                const __m256 m = _mm256_mul_ps(wq, skin_pair_avx(_mm_loadu_ps(ma->data[k]), _mm_loadu_ps(mb->data[k])));
+                r[k] = q == 0 ? m : _mm256_add_ps(r[k], m);
+            }
+        }
+        const __m256 op = skin_apply_avx(r[0], r[1], r[2], skin_pair_avx(
+            _mm_setr_ps(pa->x, pa->y, pa->z, 1.0f), _mm_setr_ps(pb->x, pb->y, pb->z, 1.0f)));
+        if(s->normal){
+            const glv_vec3* na = SKIN_AT(const glv_vec3*, s->normal, s->normal_stride, i);
+            const glv_vec3* nb = SKIN_AT(const glv_vec3*, s->normal, s->normal_stride, i + 1);
+            const __m256 on = skin_apply_avx(r[0], r[1], r[2], skin_pair_avx(
+                _mm_setr_ps(na->x, na->y, na->z, 0.0f), _mm_setr_ps(nb->x, nb->y, nb->z, 0.0f)));
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_position, s->out_position_stride, i), _mm256_castps256_ps128(op));
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_position, s->out_position_stride, i + 1), _mm256_extractf128_ps(op, 1));
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_normal, s->out_normal_stride, i), _mm256_castps256_ps128(on));
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_normal, s->out_normal_stride, i + 1), _mm256_extractf128_ps(on, 1));
+        }
+        else{
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_position, s->out_position_stride, i), _mm256_castps256_ps128(op));
+            skin_store_sse2(SKIN_AT(glv_vec3*, s->out_position, s->out_position_stride, i + 1), _mm256_extractf128_ps(op, 1));
+        }
+    }
+    skin_range_sse2(s, palette, i, end);
+}
+
+#endif /* GLV_X86 */
+
+
+/* ----- Public functions ----- */
+
+GLV_API void glv_skin_vertices_range(const glv_skin_stream* s, const glv_mat4* palette, size_t begin, size_t end){
+    GLV_PROFILE_FUNC();
+    glv_skin_stream r = *s;
+    if(r.position_stride == 0) r.position_stride = sizeof(glv_vec3);
+    if(r.normal_stride == 0) r.normal_stride = sizeof(glv_vec3);
+    if(r.joints_stride == 0) r.joints_stride = GLV_SKIN_INFLUENCES * sizeof(uint16_t);
+    if(r.weights_stride == 0) r.weights_stride = GLV_SKIN_INFLUENCES * sizeof(float);
+    if(r.out_position_stride == 0) r.out_position_stride = sizeof(glv_vec3);
+    if(r.out_normal_stride == 0) r.out_normal_stride = sizeof(glv_vec3);
+    if(r.out_normal == NULL) r.normal = NULL;
+    if(begin >= end) return;
+#ifdef GLV_X86
+    // AVX-512 runs the AVX kernel, wider lanes would need gathers
+    if(glv_simd_get_level() >= GLV_SIMD_AVX){
+        skin_range_avx(&r, palette, begin, end);
+        return;
+    }
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        skin_range_sse2(&r, palette, begin, end);
+        return;
+    }
+#endif
+    skin_range_scalar(&r, palette, begin, end);
+}
+
+GLV_API void glv_skin_vertices(const glv_skin_stream* s, const glv_mat4* palette){
+    GLV_PROFILE_FUNC();
+    glv_skin_vertices_range(s, palette, 0, s->count);
+}
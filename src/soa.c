@@ -0,0 +1,360 @@
+
+#include "../include/soa.h"
+#include "simd_internal.h"
+#include "profile_internal.h"
+
+/* ----- Kernel instances ----- */
+
+#ifdef GLV_X86
+
+#define SOA_ISA sse2
+#define SOA_TARGET GLV_TARGET_SSE2
+#define SOA_W 4
+#define SOA_V __m128
+#define SOA_LOAD _mm_loadu_ps
+#define SOA_STORE _mm_storeu_ps
+#define SOA_ADD _mm_add_ps
+#define SOA_SUB _mm_sub_ps
+#define SOA_MUL _mm_mul_ps
+#define SOA_DIV _mm_div_ps
+#define SOA_SQRT _mm_sqrt_ps
+#include "soa_simd.h"
+#undef SOA_ISA
+#undef SOA_TARGET
+#undef SOA_W
+#undef SOA_V
+#undef SOA_LOAD
+#undef SOA_STORE
+#undef SOA_ADD
+#undef SOA_SUB
+#undef SOA_MUL
+#undef SOA_DIV
+#undef SOA_SQRT
+
+#define SOA_ISA avx
+#define SOA_TARGET GLV_TARGET_AVX
+#define SOA_W 8
+#define SOA_V __m256
+#define SOA_LOAD _mm256_loadu_ps
+#define SOA_STORE _mm256_storeu_ps
+#define SOA_ADD _mm256_add_ps
+#define SOA_SUB _mm256_sub_ps
+#define SOA_MUL _mm256_mul_ps
+#define SOA_DIV _mm256_div_ps
+#define SOA_SQRT _mm256_sqrt_ps
+#include "soa_simd.h"
+#undef SOA_ISA
+#undef SOA_TARGET
+#undef SOA_W
+#undef SOA_V
+#undef SOA_LOAD
+#undef SOA_STORE
+#undef SOA_ADD
+#undef SOA_SUB
+#undef SOA_MUL
+#undef SOA_DIV
+#undef SOA_SQRT
+
+#define SOA_ISA avx512
+#define SOA_TARGET GLV_TARGET_AVX512
+#define SOA_W 16
+#define SOA_V __m512
+#define SOA_LOAD _mm512_loadu_ps
+#define SOA_STORE _mm512_storeu_ps
+#define SOA_ADD _mm512_add_ps
+#define SOA_SUB _mm512_sub_ps
+#define SOA_MUL _mm512_mul_ps
+#define SOA_DIV _mm512_div_ps
+#define SOA_SQRT _mm512_sqrt_ps
+#include "soa_simd.h"
+#undef SOA_ISA
+#undef SOA_TARGET
+#undef SOA_W
+#undef SOA_V
+#undef SOA_LOAD
+#undef SOA_STORE
+#undef SOA_ADD
+#undef SOA_SUB
+#undef SOA_MUL
+#undef SOA_DIV
+#undef SOA_SQRT
+
+/* Runs the widest instance for the current level, returns elements done */
+#define SOA_DISPATCH(fn, ...)                                           \
+    (glv_simd_get_level() >= GLV_SIMD_AVX512 ? fn##_avx512(__VA_ARGS__) : \
+     glv_simd_get_level() >= GLV_SIMD_AVX    ? fn##_avx(__VA_ARGS__)    : \
+     glv_simd_get_level() >= GLV_SIMD_SSE2   ? fn##_sse2(__VA_ARGS__)   : 0)
+
+#else
+
+#define SOA_DISPATCH(fn, ...) ((size_t)0)
+
+#endif /* GLV_X86 */
+
+
+/* ----- Layout conversion ----- */
+
+/*
+    Conversion is bound by memory traffic, so 4-wide shuffles are
+    used at every level. The tail is handled element by element.
+*/
+
+GLV_API void glv_vec2_to_soa(const glv_vec2* in, size_t n, const glv_vec2_soa* out){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        for(; i + 4 <= n; i += 4){
+            const __m128 a = _mm_loadu_ps(in[i].data);
+            const __m128 b = _mm_loadu_ps(in[i + 2].data);
+            _mm_storeu_ps(out->x + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(out->y + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out->x[i] = in[i].x;
+        out->y[i] = in[i].y;
+    }
+}
+
+GLV_API void glv_vec3_to_soa(const glv_vec3* in, size_t n, const glv_vec3_soa* out){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        for(; i + 4 <= n; i += 4){
+            // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+            const float* p = in[i].data;
+            const __m128 a = _mm_loadu_ps(p);
+            const __m128 b = _mm_loadu_ps(p + 4);
+            const __m128 c = _mm_loadu_ps(p + 8);
+            __m128 t0, t1;
+            t0 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0));
+            t1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+            _mm_storeu_ps(out->x + i, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+            t0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+            t1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+            _mm_storeu_ps(out->y + i, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+            t0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+            t1 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+            _mm_storeu_ps(out->z + i, _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out->x[i] = in[i].x;
+        out->y[i] = in[i].y;
+        out->z[i] = in[i].z;
+    }
+}
+
+GLV_API void glv_vec4_to_soa(const glv_vec4* in, size_t n, const glv_vec4_soa* out){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        for(; i + 4 <= n; i += 4){
+            __m128 r0 = _mm_loadu_ps(in[i].data);
+            __m128 r1 = _mm_loadu_ps(in[i + 1].data);
+            __m128 r2 = _mm_loadu_ps(in[i + 2].data);
+            __m128 r3 = _mm_loadu_ps(in[i + 3].data);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(out->x + i, r0);
+            _mm_storeu_ps(out->y + i, r1);
+            _mm_storeu_ps(out->z + i, r2);
+            _mm_storeu_ps(out->w + i, r3);
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out->x[i] = in[i].x;
+        out->y[i] = in[i].y;
+        out->z[i] = in[i].z;
+        out->w[i] = in[i].w;
+    }
+}
+
+GLV_API void glv_vec2_from_soa(const glv_vec2_soa* in, size_t n, glv_vec2* out){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        for(; i + 4 <= n; i += 4){
+            const __m128 x = _mm_loadu_ps(in->x + i);
+            const __m128 y = _mm_loadu_ps(in->y + i);
+            _mm_storeu_ps(out[i].data, _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(out[i + 2].data, _mm_unpackhi_ps(x, y));
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out[i].x = in->x[i];
+        out[i].y = in->y[i];
+    }
+}
+
+GLV_API void glv_vec3_from_soa(const glv_vec3_soa* in, size_t n, glv_vec3* out){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        for(; i + 4 <= n; i += 4){
+            const __m128 x = _mm_loadu_ps(in->x + i);
+            const __m128 y = _mm_loadu_ps(in->y + i);
+            const __m128 z = _mm_loadu_ps(in->z + i);
+            const __m128 xy_lo = _mm_unpacklo_ps(x, y); // x0 y0 x1 y1
+            const __m128 xy_hi = _mm_unpackhi_ps(x, y); // x2 y2 x3 y3
+            float* p = out[i].data;
+            __m128 t;
+            t = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+            _mm_storeu_ps(p, _mm_shuffle_ps(xy_lo, t, _MM_SHUFFLE(2, 0, 1, 0)));
+            t = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+            _mm_storeu_ps(p + 4, _mm_shuffle_ps(t, xy_hi, _MM_SHUFFLE(1, 0, 2, 0)));
+            t = _mm_shuffle_ps(z, xy_hi, _MM_SHUFFLE(3, 2, 3, 2));
+            _mm_storeu_ps(p + 8, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 3, 2, 0)));
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out[i].x = in->x[i];
+        out[i].y = in->y[i];
+        out[i].z = in->z[i];
+    }
+}
+
+GLV_API void glv_vec4_from_soa(const glv_vec4_soa* in, size_t n, glv_vec4* out){
+    GLV_PROFILE_FUNC();
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        for(; i + 4 <= n; i += 4){
+            __m128 r0 = _mm_loadu_ps(in->x + i);
+            __m128 r1 = _mm_loadu_ps(in->y + i);
+            __m128 r2 = _mm_loadu_ps(in->z + i);
+            __m128 r3 = _mm_loadu_ps(in->w + i);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(out[i].data, r0);
+            _mm_storeu_ps(out[i + 1].data, r1);
+            _mm_storeu_ps(out[i + 2].data, r2);
+            _mm_storeu_ps(out[i + 3].data, r3);
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        out[i].x = in->x[i];
+        out[i].y = in->y[i];
+        out[i].z = in->z[i];
+        out[i].w = in->w[i];
+    }
+}
+
+
+/* ----- Batch operations ----- */
+
+/* Lengths of n vectors */
+GLV_API void glv_vec2_soa_magnitude(const glv_vec2_soa* v, float* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_magnitude2, v, out, n);
+    for(; i != n; ++i){
+        out[i] = glv_vec2_magnitude(&(glv_vec2){.x = v->x[i], .y = v->y[i]});
+    }
+}
+
+GLV_API void glv_vec3_soa_magnitude(const glv_vec3_soa* v, float* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_magnitude3, v, out, n);
+    for(; i != n; ++i){
+        out[i] = glv_vec3_magnitude(&(glv_vec3){.x = v->x[i], .y = v->y[i], .z = v->z[i]});
+    }
+}
+
+GLV_API void glv_vec4_soa_magnitude(const glv_vec4_soa* v, float* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_magnitude4, v, out, n);
+    for(; i != n; ++i){
+        out[i] = glv_vec4_magnitude(&(glv_vec4){
+            .x = v->x[i], .y = v->y[i], .z = v->z[i], .w = v->w[i]
+        });
+    }
+}
+
+/* Scales n vectors to have length of 1 */
+GLV_API void glv_vec2_soa_normalize(const glv_vec2_soa* v, const glv_vec2_soa* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_normalize2, v, out, n);
+    glv_vec2 r;
+    for(; i != n; ++i){
+        r = glv_vec2_normalize(&(glv_vec2){.x = v->x[i], .y = v->y[i]});
+        out->x[i] = r.x;
+        out->y[i] = r.y;
+    }
+}
+
+GLV_API void glv_vec3_soa_normalize(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_normalize3, v, out, n);
+    glv_vec3 r;
+    for(; i != n; ++i){
+        r = glv_vec3_normalize(&(glv_vec3){.x = v->x[i], .y = v->y[i], .z = v->z[i]});
+        out->x[i] = r.x;
+        out->y[i] = r.y;
+        out->z[i] = r.z;
+    }
+}
+
+GLV_API void glv_vec4_soa_normalize(const glv_vec4_soa* v, const glv_vec4_soa* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_normalize4, v, out, n);
+    glv_vec4 r;
+    for(; i != n; ++i){
+        r = glv_vec4_normalize(&(glv_vec4){
+            .x = v->x[i], .y = v->y[i], .z = v->z[i], .w = v->w[i]
+        });
+        out->x[i] = r.x;
+        out->y[i] = r.y;
+        out->z[i] = r.z;
+        out->w[i] = r.w;
+    }
+}
+
+/* Element-wise dot products */
+GLV_API void glv_vec2_soa_dot(const glv_vec2_soa* a, const glv_vec2_soa* b, float* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_dot2, a, b, out, n);
+    for(; i != n; ++i){
+        out[i] = a->x[i] * b->x[i] + a->y[i] * b->y[i];
+    }
+}
+
+GLV_API void glv_vec3_soa_dot(const glv_vec3_soa* a, const glv_vec3_soa* b, float* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_dot3, a, b, out, n);
+    for(; i != n; ++i){
+        out[i] = a->x[i] * b->x[i] + a->y[i] * b->y[i] + a->z[i] * b->z[i];
+    }
+}
+
+GLV_API void glv_vec4_soa_dot(const glv_vec4_soa* a, const glv_vec4_soa* b, float* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_dot4, a, b, out, n);
+    for(; i != n; ++i){
+        out[i] = a->x[i] * b->x[i] + a->y[i] * b->y[i] + a->z[i] * b->z[i] + a->w[i] * b->w[i];
+    }
+}
+
+/* Element-wise cross products */
+GLV_API void glv_vec3_soa_cross(const glv_vec3_soa* a, const glv_vec3_soa* b, const glv_vec3_soa* out, size_t n){
+    GLV_PROFILE_FUNC();
+    size_t i = SOA_DISPATCH(soa_cross3, a, b, out, n);
+    glv_vec3 r;
+    for(; i != n; ++i){
+        r = glv_vec3_cross(
+            &(glv_vec3){.x = a->x[i], .y = a->y[i], .z = a->z[i]},
+            &(glv_vec3){.x = b->x[i], .y = b->y[i], .z = b->z[i]}
+        );
+        out->x[i] = r.x;
+        out->y[i] = r.y;
+        out->z[i] = r.z;
+    }
+}
@@ -0,0 +1,166 @@
+/*
+    === soa_simd.h ===
+
+    Stream kernels written once over a generic vector type, and
+    included by soa.c once per instruction set. Before inclusion, define:
+
+        SOA_ISA      suffix of the generated functions
+        SOA_TARGET   target attribute (GLV_TARGET_*)
+        SOA_W        lanes per vector
+        SOA_V        vector type
+        SOA_LOAD, SOA_STORE, SOA_ADD, SOA_SUB, SOA_MUL, SOA_DIV, SOA_SQRT
+
+    Each kernel handles the largest multiple of SOA_W elements and returns
+    how many it processed; the caller finishes the tail with scalar code.
+    Operations mirror vec.c exactly (no FMA), so results are bit-identical.
+*/
+
+#define SOA_CAT_(a, b) a##_##b
+#define SOA_CAT(a, b) SOA_CAT_(a, b)
+#define SOA_FN(name) SOA_CAT(name, SOA_ISA)
+
+
+/* ----- Magnitude ----- */
+
+SOA_TARGET
+static size_t SOA_FN(soa_magnitude2)(const glv_vec2_soa* v, float* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        const SOA_V x = SOA_LOAD(v->x + i), y = SOA_LOAD(v->y + i);
+        SOA_STORE(out + i, SOA_SQRT(SOA_ADD(SOA_MUL(x, x), SOA_MUL(y, y))));
+    }
+    return i;
+}
+
+SOA_TARGET
+static size_t SOA_FN(soa_magnitude3)(const glv_vec3_soa* v, float* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        const SOA_V x = SOA_LOAD(v->x + i), y = SOA_LOAD(v->y + i), z = SOA_LOAD(v->z + i);
+        SOA_V s = SOA_ADD(SOA_MUL(x, x), SOA_MUL(y, y));
+        s = SOA_ADD(s, SOA_MUL(z, z));
+        SOA_STORE(out + i, SOA_SQRT(s));
+    }
+    return i;
+}
+
+SOA_TARGET
+static size_t SOA_FN(soa_magnitude4)(const glv_vec4_soa* v, float* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        const SOA_V x = SOA_LOAD(v->x + i), y = SOA_LOAD(v->y + i);
+        const SOA_V z = SOA_LOAD(v->z + i), w = SOA_LOAD(v->w + i);
+        SOA_V s = SOA_ADD(SOA_MUL(x, x), SOA_MUL(y, y));
+        s = SOA_ADD(s, SOA_MUL(z, z));
+        s = SOA_ADD(s, SOA_MUL(w, w));
+        SOA_STORE(out + i, SOA_SQRT(s));
+    }
+    return i;
+}
+
+
+/* ----- Normalize ----- */
+
+SOA_TARGET
+static size_t SOA_FN(soa_normalize2)(const glv_vec2_soa* v, const glv_vec2_soa* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        const SOA_V x = SOA_LOAD(v->x + i), y = SOA_LOAD(v->y + i);
+        const SOA_V m = SOA_SQRT(SOA_ADD(SOA_MUL(x, x), SOA_MUL(y, y)));
+        SOA_STORE(out->x + i, SOA_DIV(x, m));
+        SOA_STORE(out->y + i, SOA_DIV(y, m));
+    }
+    return i;
+}
+
+SOA_TARGET
+static size_t SOA_FN(soa_normalize3)(const glv_vec3_soa* v, const glv_vec3_soa* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        const SOA_V x = SOA_LOAD(v->x + i), y = SOA_LOAD(v->y + i), z = SOA_LOAD(v->z + i);
+        SOA_V m = SOA_ADD(SOA_MUL(x, x), SOA_MUL(y, y));
+        m = SOA_SQRT(SOA_ADD(m, SOA_MUL(z, z)));
+        SOA_STORE(out->x + i, SOA_DIV(x, m));
+        SOA_STORE(out->y + i, SOA_DIV(y, m));
+        SOA_STORE(out->z + i, SOA_DIV(z, m));
+    }
+    return i;
+}
+
+SOA_TARGET
+static size_t SOA_FN(soa_normalize4)(const glv_vec4_soa* v, const glv_vec4_soa* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        const SOA_V x = SOA_LOAD(v->x + i), y = SOA_LOAD(v->y + i);
+        const SOA_V z = SOA_LOAD(v->z + i), w = SOA_LOAD(v->w + i);
+        SOA_V m = SOA_ADD(SOA_MUL(x, x), SOA_MUL(y, y));
+        m = SOA_ADD(m, SOA_MUL(z, z));
+        m = SOA_SQRT(SOA_ADD(m, SOA_MUL(w, w)));
+        SOA_STORE(out->x + i, SOA_DIV(x, m));
+        SOA_STORE(out->y + i, SOA_DIV(y, m));
+        SOA_STORE(out->z + i, SOA_DIV(z, m));
+        SOA_STORE(out->w + i, SOA_DIV(w, m));
+    }
+    return i;
+}
+
+
+/* ----- Dot product ----- */
+
+SOA_TARGET
+static size_t SOA_FN(soa_dot2)(const glv_vec2_soa* a, const glv_vec2_soa* b, float* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        SOA_V s = SOA_MUL(SOA_LOAD(a->x + i), SOA_LOAD(b->x + i));
+        s = SOA_ADD(s, SOA_MUL(SOA_LOAD(a->y + i), SOA_LOAD(b->y + i)));
+        SOA_STORE(out + i, s);
+    }
+    return i;
+}
+
+SOA_TARGET
+static size_t SOA_FN(soa_dot3)(const glv_vec3_soa* a, const glv_vec3_soa* b, float* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        SOA_V s = SOA_MUL(SOA_LOAD(a->x + i), SOA_LOAD(b->x + i));
+        s = SOA_ADD(s, SOA_MUL(SOA_LOAD(a->y + i), SOA_LOAD(b->y + i)));
+        s = SOA_ADD(s, SOA_MUL(SOA_LOAD(a->z + i), SOA_LOAD(b->z + i)));
+        SOA_STORE(out + i, s);
+    }
+    return i;
+}
+
+SOA_TARGET
+static size_t SOA_FN(soa_dot4)(const glv_vec4_soa* a, const glv_vec4_soa* b, float* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        SOA_V s = SOA_MUL(SOA_LOAD(a->x + i), SOA_LOAD(b->x + i));
+        s = SOA_ADD(s, SOA_MUL(SOA_LOAD(a->y + i), SOA_LOAD(b->y + i)));
+        s = SOA_ADD(s, SOA_MUL(SOA_LOAD(a->z + i), SOA_LOAD(b->z + i)));
+        s = SOA_ADD(s, SOA_MUL(SOA_LOAD(a->w + i), SOA_LOAD(b->w + i)));
+        SOA_STORE(out + i, s);
+    }
+    return i;
+}
+
+
+/* ----- Cross product ----- */
+
+SOA_TARGET
+static size_t SOA_FN(soa_cross3)(const glv_vec3_soa* a, const glv_vec3_soa* b,
+    const glv_vec3_soa* out, size_t n){
+    size_t i;
+    for(i = 0; i + SOA_W <= n; i += SOA_W){
+        const SOA_V ax = SOA_LOAD(a->x + i), ay = SOA_LOAD(a->y + i), az = SOA_LOAD(a->z + i);
+        const SOA_V bx = SOA_LOAD(b->x + i), by = SOA_LOAD(b->y + i), bz = SOA_LOAD(b->z + i);
+        SOA_STORE(out->x + i, SOA_SUB(SOA_MUL(ay, bz), SOA_MUL(az, by)));
+        SOA_STORE(out->y + i, SOA_SUB(SOA_MUL(az, bx), SOA_MUL(ax, bz)));
+        SOA_STORE(out->z + i, SOA_SUB(SOA_MUL(ax, by), SOA_MUL(ay, bx)));
+    }
+    return i;
+}
+
+
+#undef SOA_FN
+#undef SOA_CAT
+#undef SOA_CAT_
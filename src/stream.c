@@ -0,0 +1,157 @@
+#include <errno.h>
+#include "../include/stream.h"
+#include "../include/transform.h"
+#include "../include/pool.h"
+#include "profile_internal.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define STREAM_MMAP 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+#ifdef STREAM_MMAP
+
+#define STREAM_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+/* Descriptors and mappings of one call, -1 and MAP_FAILED when not open */
+typedef struct {
+    int in_fd, out_fd;
+    char* src;
+    char* dst;                  /* equal to src in place */
+    size_t size;
+} stream_files;
+
+static double stream_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Opens and maps both files, returns 0 or an errno. Whatever is open is left in f for stream_close. */
+static int stream_open(stream_files* f, const char* in_path, const char* out_path, size_t vsize){
+    struct stat in_st, out_st;
+    int in_place = out_path == NULL;
+    if(stat(in_path, &in_st) != 0) return errno;
+    if(!in_place && stat(out_path, &out_st) == 0){
+        in_place = out_st.st_dev == in_st.st_dev && out_st.st_ino == in_st.st_ino;
+    }
+    f->in_fd = open(in_path, in_place ? O_RDWR : O_RDONLY);
+    if(f->in_fd < 0) return errno;
+    if(fstat(f->in_fd, &in_st) != 0) return errno;
+    f->size = (size_t)in_st.st_size;
+    if(f->size % vsize != 0) return EINVAL;
+    if(!in_place){
+        // read and write: shared writable mappings need both
+        f->out_fd = open(out_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if(f->out_fd < 0) return errno;
+#ifdef __linux__
+        if(f->size != 0){
+            const int err = posix_fallocate(f->out_fd, 0, (off_t)f->size);
+            if(err != 0) return err;
+        }
+#else
+        if(ftruncate(f->out_fd, (off_t)f->size) != 0) return errno;
+#endif
+    }
+    if(f->size == 0) return 0;
+
+    f->src = mmap(NULL, f->size, in_place ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, f->in_fd, 0);
+    if(f->src == MAP_FAILED) return errno;
+    madvise(f->src, f->size, MADV_SEQUENTIAL);
+    if(in_place){
+        f->dst = f->src;
+        return 0;
+    }
+    f->dst = mmap(NULL, f->size, PROT_READ | PROT_WRITE, MAP_SHARED, f->out_fd, 0);
+    if(f->dst == MAP_FAILED) return errno;
+    madvise(f->dst, f->size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+static void stream_close(stream_files* f){
+    if(f->dst != MAP_FAILED && f->dst != f->src) munmap(f->dst, f->size);
+    if(f->src != MAP_FAILED) munmap(f->src, f->size);
+    if(f->out_fd >= 0) close(f->out_fd);
+    if(f->in_fd >= 0) close(f->in_fd);
+}
+
+/*
+    Transforms the mapping chunk by chunk. Chunks start on page
+    boundaries, so each one can be advised on its own.
+*/
+static void stream_run(const stream_files* f, unsigned int components, size_t chunk, const glv_mat4* m){
+    const size_t vsize = components * sizeof(float);
+    const size_t ahead = GLV_STREAM_PREFETCH * chunk;
+    size_t off;
+    madvise(f->src, STREAM_MIN(chunk + ahead, f->size), MADV_WILLNEED);
+    for(off = 0; off < f->size; off += chunk){
+        const size_t len = STREAM_MIN(chunk, f->size - off);
+        const char* in = f->src + off;
+        char* out = f->dst + off;
+
+        // the chunk GLV_STREAM_PREFETCH ahead is read while this one is transformed
+        if(ahead != 0 && off + chunk + ahead < f->size){
+            madvise(f->src + off + chunk + ahead, STREAM_MIN(chunk, f->size - off - chunk - ahead), MADV_WILLNEED);
+        }
+        if(components == 4){
+            glv_transform_batch_parallel((const glv_vec4*)in, 0, (glv_vec4*)out, 0, len / vsize, m);
+        }
+        else{
+            glv_transform_batch_vec3_parallel((const glv_vec3*)in, 0, (glv_vec3*)out, 0, len / vsize, m);
+        }
+
+        // start writing the results back and drop both chunks from the mappings
+        msync(out, len, MS_ASYNC);
+        madvise(out, len, MADV_DONTNEED);
+        if(f->dst != f->src) madvise(f->src + off, len, MADV_DONTNEED);
+    }
+}
+
+GLV_API int glv_stream_transform_file(const char* in_path, const char* out_path, unsigned int components,
+    const glv_mat4* m, size_t chunk_bytes, glv_stream_stats* stats){
+    GLV_PROFILE_FUNC();
+    const double start = stream_now();
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    stream_files f = {-1, -1, MAP_FAILED, MAP_FAILED, 0};
+    size_t vsize, unit, a, b;
+    int err;
+    if(components != 3 && components != 4) return EINVAL;
+    vsize = components * sizeof(float);
+
+    // whole pages and whole vertices: the least common multiple
+    a = page;
+    b = vsize;
+    while(b != 0){
+        const size_t r = a % b;
+        a = b;
+        b = r;
+    }
+    unit = page / a * vsize;
+    if(chunk_bytes == 0) chunk_bytes = GLV_STREAM_CHUNK_BYTES;
+    chunk_bytes = chunk_bytes < unit ? unit : chunk_bytes / unit * unit;
+
+    err = stream_open(&f, in_path, out_path, vsize);
+    if(err == 0 && f.size != 0) stream_run(&f, components, chunk_bytes, m);
+    stream_close(&f);
+    if(err == 0 && stats){
+        stats->vertices = f.size / vsize;
+        stats->bytes_read = stats->bytes_written = f.size;
+        stats->seconds = stream_now() - start;
+    }
+    return err;
+}
+
+#else
+
+GLV_API int glv_stream_transform_file(const char* in_path, const char* out_path, unsigned int components,
+    const glv_mat4* m, size_t chunk_bytes, glv_stream_stats* stats){
+    GLV_PROFILE_FUNC();
+    (void)in_path; (void)out_path; (void)components; (void)m; (void)chunk_bytes; (void)stats;
+    return ENOSYS;
+}
+
+#endif /* STREAM_MMAP */
@@ -1,16 +1,24 @@
 
 #include <math.h>
-#include "transform.h"
+#include <string.h>
+#include "../include/transform.h"
+#include "../include/fast.h"
+#include "simd_internal.h"
+#include "fast_internal.h"
+#include "mat_internal.h"
+#include "profile_internal.h"
 
 /* ----- Common ------- */
 
 /* Converts degrees to radians */
-float glv_radians(float deg){
+GLV_API float glv_radians(float deg){
+    GLV_PROFILE_FUNC();
     return deg * M_PI / 180.0f;
 }
 
 /* Converts radians to degrees */
-float glv_degrees(float rad){
+GLV_API float glv_degrees(float rad){
+    GLV_PROFILE_FUNC();
     return rad * 180.0f / M_PI;
 }
 
@@ -18,7 +26,8 @@ float glv_degrees(float rad){
 /* ----- Matrix Creation ----- */
 
 /* Returns a 4x4 orthographic projection matrix */
-glv_mat4 glv_ortho2D(float left, float right, float bottom, float top){
+GLV_API glv_mat4 glv_ortho2D(float left, float right, float bottom, float top){
+    GLV_PROFILE_FUNC();
     glv_mat4 m = {0};
     m.data[0][0] = 2.0f/(right-left);
     m.data[1][1] = 2.0f/(top-bottom);
@@ -30,7 +39,8 @@ glv_mat4 glv_ortho2D(float left, float right, float bottom, float top){
     return m;
 }
 
-glv_mat4 glv_ortho(float left, float right, float bottom, float top, float near, float far){
+GLV_API glv_mat4 glv_ortho(float left, float right, float bottom, float top, float near, float far){
+    GLV_PROFILE_FUNC();
     // uses right-handed [-1,1] clip space.
     glv_mat4 m = {0};
     m.data[0][0] = 2.0f/(right-left);
@@ -44,7 +54,8 @@ glv_mat4 glv_ortho(float left, float right, float bottom, float top, float near,
     return m;
 }
 
-glv_mat4 glv_frustum(float left, float right, float bottom, float top, float near, float far){
+GLV_API glv_mat4 glv_frustum(float left, float right, float bottom, float top, float near, float far){
+    GLV_PROFILE_FUNC();
     // uses right-handed [-1,1] clip space.
     glv_mat4 m = {0};
 
@@ -53,29 +64,64 @@ glv_mat4 glv_frustum(float left, float right, float bottom, float top, float nea
     m.data[2][2] = - (far + near) / (far - near);
 
     m.data[0][2] = (right + left) / (right - left);
-    m.data[2][2] = - (far + near) / (far - near);
+    m.data[1][2] = (top + bottom) / (top - bottom);
     m.data[3][2] = -1.0f;
     m.data[2][3] = - 2.0f * far * near / (far - near);
 
     return m;
 }
 
-glv_mat4 glv_perspective(float fovy, float aspect, float near, float far){
+GLV_API glv_mat4 glv_perspective(float fovy, float aspect, float near, float far){
+    GLV_PROFILE_FUNC();
     // uses right-handed [-1,1] clip space.
     #ifdef GLV_USE_DEGREES
-        a = glv_radians(fovy);
+        fovy = glv_radians(fovy);
     #endif
     float h = near * tanf(fovy / 2.0f);
     float w = aspect * h;
     return glv_frustum(-w, w, -h, h, near, far);
 }
 
-glv_mat4 glv_perspective_fov(float fov, float width, float height, float near, float far){
+GLV_API glv_mat4 glv_perspective_fov(float fov, float width, float height, float near, float far){
+    GLV_PROFILE_FUNC();
     return glv_perspective(fov, height / width, near, far);
 }
 
+/* Fast versions (fast.h): reciprocals instead of divisions, polynomial tangent */
+GLV_API glv_mat4 glv_fast_frustum(float left, float right, float bottom, float top, float near, float far){
+    GLV_PROFILE_FUNC();
+    const float rw = fast_rcp(right - left);
+    const float rh = fast_rcp(top - bottom);
+    const float rd = fast_rcp(far - near);
+    glv_mat4 m = {0};
+
+    m.data[0][0] = 2.0f * near * rw;
+    m.data[1][1] = 2.0f * near * rh;
+    m.data[2][2] = - (far + near) * rd;
+
+    m.data[0][2] = (right + left) * rw;
+    m.data[1][2] = (top + bottom) * rh;
+    m.data[3][2] = -1.0f;
+    m.data[2][3] = - 2.0f * far * near * rd;
+
+    return m;
+}
+
+GLV_API glv_mat4 glv_fast_perspective(float fovy, float aspect, float near, float far){
+    GLV_PROFILE_FUNC();
+    #ifdef GLV_USE_DEGREES
+        fovy = glv_radians(fovy);
+    #endif
+    float s, c, h, w;
+    fast_sincos(fovy * 0.5f, &s, &c);
+    h = near * s * fast_rcp(c);
+    w = aspect * h;
+    return glv_fast_frustum(-w, w, -h, h, near, far);
+}
+
 /* View transformation matrix (world to view coords) */
-glv_mat4 glv_lookat(const glv_vec3* eye, const glv_vec3* centre, const glv_vec3* up) {
+GLV_API glv_mat4 glv_lookat(const glv_vec3* eye, const glv_vec3* centre, const glv_vec3* up) {
+    GLV_PROFILE_FUNC();
     // uses right-handed clip space.
     glv_vec3 f, s, u;
     f = glv_vec3_normalize(&(glv_vec3){
@@ -100,21 +146,24 @@ glv_mat4 glv_lookat(const glv_vec3* eye, const glv_vec3* centre, const glv_vec3*
     m.data[2][1] = -f.y;
     m.data[2][2] = -f.z;
 
-    m.data[3][0] = -glv_vec3_dot(&s, eye);
-    m.data[3][1] = -glv_vec3_dot(&u, eye);
-    m.data[3][2] = -glv_vec3_dot(&f, eye);
+    // translation goes in the fourth column, as in glv_translate
+    m.data[0][3] = -glv_vec3_dot(&s, eye);
+    m.data[1][3] = -glv_vec3_dot(&u, eye);
+    m.data[2][3] = glv_vec3_dot(&f, eye);
 
     return m;
 }
 
 /* ----- Matrix Transform ----- */
-glv_mat4 glv_scale(const glv_mat4* m, const glv_vec3* v){
+GLV_API glv_mat4 glv_scale(const glv_mat4* m, const glv_vec3* v){
+    GLV_PROFILE_FUNC();
     // Matrix scaling works by scaling the diagonal elements.
     glv_mat4 s = glv_mat4_diagonal(v->x, v->y, v->z, 1.0f);
     return glv_mat4_multiply(m, &s);
 }
 
-glv_mat4 glv_translate(const glv_mat4* m, const glv_vec3* v){
+GLV_API glv_mat4 glv_translate(const glv_mat4* m, const glv_vec3* v){
+    GLV_PROFILE_FUNC();
     // Matrix translation works by scaling the fourth matrix column. 
     glv_mat4 t = glv_mat4_identity();
     t.data[0][3] = v->x;
@@ -123,17 +172,9 @@ glv_mat4 glv_translate(const glv_mat4* m, const glv_vec3* v){
     return glv_mat4_multiply(m, &t);
 }
 
-/* Creates a rotation transformation matrix */
-glv_mat4 glv_rotate(const glv_mat4* m, float a, const glv_vec3* v){
-
-    #ifdef GLV_USE_DEGREES
-        a = glv_radians(a);
-    #endif
-
-    const float c = cosf(a); // radians
-    const float s = sinf(a); // radians
-    glv_vec3 axis = glv_vec3_normalize(v);
-
+/* Applies the rotation of cosine c and sine s about a unit axis */
+static glv_mat4 rotate_cs(const glv_mat4* m, float c, float s, const glv_vec3* axis_unit){
+    const glv_vec3 axis = *axis_unit;
     glv_vec3 temp = {
         .x = (1.0 - c) * axis.x,
         .y = (1.0 - c) * axis.y,
@@ -164,15 +205,251 @@ glv_mat4 glv_rotate(const glv_mat4* m, float a, const glv_vec3* v){
     return res;
 }
 
+/* Creates a rotation transformation matrix */
+GLV_API glv_mat4 glv_rotate(const glv_mat4* m, float a, const glv_vec3* v){
+    GLV_PROFILE_FUNC();
+
+    #ifdef GLV_USE_DEGREES
+        a = glv_radians(a);
+    #endif
 
-/* Transforms a given vector by a transformation matrix */
-glv_vec4 glv_transform(glv_vec4* v, glv_mat4* m){
-    glv_vec4 t = {0};
+    const float c = cosf(a); // radians
+    const float s = sinf(a); // radians
+    glv_vec3 axis = glv_vec3_normalize(v);
+    return rotate_cs(m, c, s, &axis);
+}
+
+GLV_API glv_mat4 glv_fast_rotate(const glv_mat4* m, float a, const glv_vec3* v){
+    GLV_PROFILE_FUNC();
+
+    #ifdef GLV_USE_DEGREES
+        a = glv_radians(a);
+    #endif
+
+    const float r = fast_rsqrt(v->x*v->x + v->y*v->y + v->z*v->z);
+    const glv_vec3 axis = {.x = v->x * r, .y = v->y * r, .z = v->z * r};
+    float c, s;
+    fast_sincos(a, &s, &c);
+    return rotate_cs(m, c, s, &axis);
+}
+
+
+/* Builds T * R * S without the intermediate products */
+GLV_API glv_mat4 glv_compose_trs(const glv_vec3* t, const glv_quat* r, const glv_vec3* s){
+    GLV_PROFILE_FUNC();
+    const glv_mat3 rot = glv_quat_to_mat3(r);
+    glv_mat4 m;
+    mat4_compose_trs(t, &rot, s, &m);
+    return m;
+}
+
+/*
+    Writes the top three rows of n TRS matrices spaced stride floats
+    apart, and the bottom row too if stride is 16. The SSE2 path reads
+    four instances straight from the streams, repeats the arithmetic of
+    glv_quat_to_mat3 on four lanes and transposes each row into place.
+*/
+static void compose_trs_rows(const glv_vec3_soa* t, const glv_vec4_soa* r,
+    const glv_vec3_soa* s, float* out, size_t stride, size_t n){
+    size_t i = 0;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 last = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+        for(; i + 4 <= n; i += 4){
+            const __m128 x = _mm_loadu_ps(r->x + i), y = _mm_loadu_ps(r->y + i);
+            const __m128 z = _mm_loadu_ps(r->z + i), w = _mm_loadu_ps(r->w + i);
+            const __m128 sx = _mm_loadu_ps(s->x + i), sy = _mm_loadu_ps(s->y + i), sz = _mm_loadu_ps(s->z + i);
+            const __m128 x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z);
+            const __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+            const __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+            const __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+            float* o = out + i * stride;
+            __m128 c0, c1, c2, c3;
+            c0 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+            c1 = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+            c2 = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+            c3 = _mm_loadu_ps(t->x + i);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_storeu_ps(o, c0);
+            _mm_storeu_ps(o + stride, c1);
+            _mm_storeu_ps(o + 2 * stride, c2);
+            _mm_storeu_ps(o + 3 * stride, c3);
+            c0 = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+            c1 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+            c2 = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+            c3 = _mm_loadu_ps(t->y + i);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_storeu_ps(o + 4, c0);
+            _mm_storeu_ps(o + stride + 4, c1);
+            _mm_storeu_ps(o + 2 * stride + 4, c2);
+            _mm_storeu_ps(o + 3 * stride + 4, c3);
+            c0 = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+            c1 = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+            c2 = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+            c3 = _mm_loadu_ps(t->z + i);
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            _mm_storeu_ps(o + 8, c0);
+            _mm_storeu_ps(o + stride + 8, c1);
+            _mm_storeu_ps(o + 2 * stride + 8, c2);
+            _mm_storeu_ps(o + 3 * stride + 8, c3);
+            if(stride == 16){
+                _mm_storeu_ps(o + 12, last);
+                _mm_storeu_ps(o + stride + 12, last);
+                _mm_storeu_ps(o + 2 * stride + 12, last);
+                _mm_storeu_ps(o + 3 * stride + 12, last);
+            }
+        }
+    }
+#endif
+    for(; i != n; ++i){
+        const glv_mat4 m = glv_compose_trs(
+            &(glv_vec3){.x = t->x[i], .y = t->y[i], .z = t->z[i]},
+            &(glv_quat){.x = r->x[i], .y = r->y[i], .z = r->z[i], .w = r->w[i]},
+            &(glv_vec3){.x = s->x[i], .y = s->y[i], .z = s->z[i]});
+        memcpy(out + i * stride, m.data, stride * sizeof(float));
+    }
+}
+
+GLV_API void glv_compose_trs_batch(const glv_vec3_soa* t, const glv_vec4_soa* r,
+    const glv_vec3_soa* s, glv_mat4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    compose_trs_rows(t, r, s, out->data[0], 16, n);
+}
+
+GLV_API void glv_compose_trs_batch_3x4(const glv_vec3_soa* t, const glv_vec4_soa* r,
+    const glv_vec3_soa* s, glv_mat3x4* out, size_t n){
+    GLV_PROFILE_FUNC();
+    compose_trs_rows(t, r, s, out->data[0], 12, n);
+}
+
+GLV_API void glv_decompose_trs(const glv_mat4* m, glv_vec3* t, glv_quat* r, glv_vec3* s){
+    GLV_PROFILE_FUNC();
+    const float (*a)[4] = m->data;
+    float sc[3], det;
+    glv_mat3 rot;
     unsigned int i, j;
-    for(i = 0; i != GLV_MAT4_RANK; ++i){
-        for(j = 0; j != GLV_MAT4_RANK; ++j){
-            t.data[i] += v->data[j] * m->data[i][j];
+
+    // columns of R * S are the rotation axes scaled by s
+    for(j = 0; j != 3; ++j){
+        sc[j] = sqrtf(a[0][j] * a[0][j] + a[1][j] * a[1][j] + a[2][j] * a[2][j]);
+    }
+    det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1])
+        - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0])
+        + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    if(det < 0.0f) sc[0] = -sc[0];
+
+    for(i = 0; i != 3; ++i){
+        for(j = 0; j != 3; ++j){
+            rot.data[i][j] = a[i][j] / sc[j];
         }
     }
+    *r = glv_quat_from_mat3(&rot);
+    *t = (glv_vec3){.x = a[0][3], .y = a[1][3], .z = a[2][3]};
+    *s = (glv_vec3){.x = sc[0], .y = sc[1], .z = sc[2]};
+}
+
+
+/* Transforms a given vector by a transformation matrix */
+GLV_API glv_vec4 glv_transform(glv_vec4* v, glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    // backend chosen at startup, see simd.h
+    glv_vec4 t;
+    glv__simd.transform(v, m, &t);
     return t;
-}
\ No newline at end of file
+}
+
+/* Transforms an array of vectors by the same matrix */
+GLV_API void glv_transform_batch(const glv_vec4* in, size_t in_stride,
+    glv_vec4* out, size_t out_stride, size_t count, const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    if(in_stride == 0) in_stride = sizeof(glv_vec4);
+    if(out_stride == 0) out_stride = sizeof(glv_vec4);
+    glv__simd.transform_batch4(in, in_stride, out, out_stride, count, m);
+}
+
+GLV_API void glv_transform_batch_vec3(const glv_vec3* in, size_t in_stride,
+    glv_vec3* out, size_t out_stride, size_t count, const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    if(in_stride == 0) in_stride = sizeof(glv_vec3);
+    if(out_stride == 0) out_stride = sizeof(glv_vec3);
+    glv__simd.transform_batch3(in, in_stride, out, out_stride, count, m);
+}
+
+
+/*
+    Padded points are loaded and stored whole with aligned instructions.
+    The arithmetic is that of glv_transform_batch_vec3 at each level, so
+    the results are identical to it, and the padding lane is cleared.
+*/
+#ifdef GLV_X86
+GLV_TARGET_SSE2
+static void transform_batch3a_sse2(const glv_vec3a* in, glv_vec3a* out, size_t count, const glv_mat4* m){
+    const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    size_t n;
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    for(n = 0; n != count; ++n){
+        const __m128 v = _mm_load_ps(in[n].data);
+        __m128 acc = _mm_setzero_ps();
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0x00), c0));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0x55), c1));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xAA), c2));
+        acc = _mm_add_ps(acc, c3);
+        _mm_store_ps(out[n].data, _mm_and_ps(acc, xyz));
+    }
+}
+
+/* Two points per iteration; elements are only 16-byte aligned, so each half is loaded on its own */
+GLV_TARGET_AVX2
+static void transform_batch3a_avx2(const glv_vec3a* in, glv_vec3a* out, size_t count, const glv_mat4* m){
+    const __m256 xyz = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, -1, -1, 0, -1, -1, -1));
+    __m128 c0 = _mm_loadu_ps(m->data[0]);
+    __m128 c1 = _mm_loadu_ps(m->data[1]);
+    __m128 c2 = _mm_loadu_ps(m->data[2]);
+    __m128 c3 = _mm_loadu_ps(m->data[3]);
+    size_t n;
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    const __m256 C0 = _mm256_broadcast_ps(&c0);
+    const __m256 C1 = _mm256_broadcast_ps(&c1);
+    const __m256 C2 = _mm256_broadcast_ps(&c2);
+    const __m256 C3 = _mm256_broadcast_ps(&c3);
+    for(n = 0; n + 2 <= count; n += 2){
+        const __m256 v = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(in[n].data)),
+            _mm_load_ps(in[n + 1].data), 1);
+        __m256 acc = _mm256_mul_ps(_mm256_permute_ps(v, 0x00), C0);
+        acc = _mm256_fmadd_ps(_mm256_permute_ps(v, 0x55), C1, acc);
+        acc = _mm256_fmadd_ps(_mm256_permute_ps(v, 0xAA), C2, acc);
+        acc = _mm256_and_ps(_mm256_add_ps(acc, C3), xyz);
+        _mm_store_ps(out[n].data, _mm256_castps256_ps128(acc));
+        _mm_store_ps(out[n + 1].data, _mm256_extractf128_ps(acc, 1));
+    }
+    if(n != count){
+        const __m128 v = _mm_load_ps(in[n].data);
+        __m128 acc = _mm_mul_ps(_mm_permute_ps(v, 0x00), c0);
+        acc = _mm_fmadd_ps(_mm_permute_ps(v, 0x55), c1, acc);
+        acc = _mm_fmadd_ps(_mm_permute_ps(v, 0xAA), c2, acc);
+        _mm_store_ps(out[n].data, _mm_and_ps(_mm_add_ps(acc, c3), _mm256_castps256_ps128(xyz)));
+    }
+}
+#endif /* GLV_X86 */
+
+GLV_API void glv_transform_batch_vec3a(const glv_vec3a* in, glv_vec3a* out, size_t count, const glv_mat4* m){
+    GLV_PROFILE_FUNC();
+    size_t n;
+#ifdef GLV_X86
+    if(glv_simd_get_level() >= GLV_SIMD_AVX2){
+        transform_batch3a_avx2(in, out, count, m);
+        return;
+    }
+    if(glv_simd_get_level() >= GLV_SIMD_SSE2){
+        transform_batch3a_sse2(in, out, count, m);
+        return;
+    }
+#endif
+    glv__simd.transform_batch3(&in->xyz, sizeof(glv_vec3a), &out->xyz, sizeof(glv_vec3a), count, m);
+    for(n = 0; n != count; ++n) out[n].pad = 0.0f;
+}
@@ -0,0 +1,855 @@
+/*
+    Microbenchmarks for every public math function.
+
+    Usage: bin/bench [options]
+        --filter STR      only run benchmarks whose name contains STR
+        --simd LEVEL      scalar, sse2, avx, avx2 or avx512
+        --reps N          timed samples per benchmark (default 15)
+        --json FILE       write the results as JSON
+        --baseline FILE   compare against a JSON file written by --json
+        --threshold PCT   allowed slowdown of the median vs baseline (default 10)
+
+    Each benchmark is warmed up, then timed over N samples of ~2 ms each.
+    Reported are the median, 10th and 90th percentile in ns per call, and
+    the median throughput in items per second (vectors, matrices, ...).
+    Exits with status 1 if any benchmark regressed past the threshold.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "../include/glvmath.h"
+
+/* Stops the compiler from hoisting or discarding benchmarked calls */
+#define CLOBBER(x) __asm__ volatile("" : "+m"(x))
+#define KEEP(x) __asm__ volatile("" : : "m"(x))
+
+#define BATCH 4096
+
+typedef struct {
+    const char* name;
+    size_t items;               /* items processed by one call */
+    void (*run)(size_t iters);
+} bench_case;
+
+typedef struct {
+    const char* name;
+    size_t items;
+    double median, p10, p90;    /* ns per call */
+} bench_result;
+
+
+/* ----- Shared data ----- */
+
+static glv_vec2 v2a, v2b;
+static glv_vec3 v3a, v3b;
+static glv_vec4 v4a, v4b;
+static glv_mat2 m2a, m2b;
+static glv_mat3 m3a, m3b;
+static glv_mat4 m4a, m4b, m4c;
+
+static glv_vec4 arr4[BATCH], out4[BATCH];
+static glv_vec3 arr3[BATCH], out3[BATCH];
+static glv_vec2 arr2[BATCH];
+static glv_mat4a64 marr[BATCH / 16], mout[BATCH / 16];
+static unsigned char mstatus[BATCH / 16];
+static const glv_mat4* mptrs[BATCH / 16];
+/* Padded so that the streams do not alias each other modulo 4 KiB */
+#define STREAM (BATCH + 80)
+static float sx[STREAM], sy[STREAM], sz[STREAM], sw[STREAM];
+static float tx[STREAM], ty[STREAM], tz[STREAM], tw[STREAM];
+static float ux[STREAM], uy[STREAM], uz[STREAM], scal[STREAM];
+static glv_vec2_soa s2, t2;
+static glv_vec3_soa s3, t3, u3;
+static glv_vec4_soa s4, t4;
+static unsigned int hparent[BATCH];
+static glv_vec3 htrans[BATCH], hscale[BATCH];
+static glv_mat3 hrot[BATCH];
+static glv_mat4 hlocal[BATCH], hworld[BATCH];
+static unsigned char hdirty[BATCH];
+static glv_quat qa, qb, qarr[BATCH], qbrr[BATCH], qout[BATCH];
+static glv_mat4 qmat[BATCH];
+static glv_mat3x4 a34, b34, a34arr[BATCH / 16], a34out[BATCH / 16], trs34[BATCH];
+/* Large batches for the worker pool, allocated in setup */
+#define BIG (1 << 20)
+static glv_vec4 *big4, *bigout4;
+/* big4 written to a file, for streaming */
+static const char *stream_in = "/tmp/glv_bench_stream_in.bin", *stream_out = "/tmp/glv_bench_stream_out.bin";
+static glv_mat4 *bigm, *bigmout;
+static glv_vec3_soa bigs, bigt;
+static float* bigr;
+static glv_vec3_soa bige;
+static uint32_t *bigmask, *bigidx;
+static glv_frustum_planes planes;
+static glv_half* bighalf;
+static float* bigfloat;
+static glv_dmat4 d4a, d4b;
+/* Skinning: a 256-bone palette and interleaved vertices */
+#define BONES 256
+typedef struct {
+    glv_vec3 position, normal;
+    uint16_t joints[4];
+    float weights[4];
+} skin_vertex;
+static glv_mat4a64 skworld[BONES], skbind[BONES], skpal[BONES];
+static skin_vertex* skvert;
+static glv_vec3 *skpos, *sknrm;
+static glv_skin_stream skin, skin_big;
+/* Packing: destination and staging buffers for BIG / 16 matrices */
+static float *packdst, *packstage;
+/* Aligned types and a per-frame arena */
+static glv_vec3a arr3a[BATCH], out3a[BATCH];
+static unsigned char framemem[1 << 20] GLV_ALIGNED(64);
+static glv_arena frame;
+/* Camera, still and moving */
+static glv_camera cam;
+static glv_vec3 cam_eye = {.x=3.0f, .y=2.0f, .z=5.0f}, cam_target, cam_up = {.y=1.0f};
+static const glv_vec4 cam_viewport = {.z=1920.0f, .w=1080.0f};
+/* Rays: BATCH triangles and boxes in the unit cube, as vertices and as streams, and a packet of rays */
+static glv_vec3 rtri[BATCH][3];
+static glv_triangle_soa rtris;
+static glv_aabb_soa rboxes;
+static glv_ray ray = {.origin = {.x=0.1f, .y=0.2f, .z=5.0f}, .direction = {.x=-0.02f, .y=-0.04f, .z=-1.0f}};
+static glv_ray_soa rpacket;
+static glv_ray_hit_soa rhits;
+static uint32_t rmask[GLV_RAY_MASK_WORDS(BATCH)];
+static float rtenter[BATCH];
+/* BVH over BVH_N small boxes in the unit cube */
+#define BVH_N (BIG / 8)
+static glv_bvh bvh;
+static uint32_t* bvhlist;
+/* Grid cells of arr3 at 16 per unit, their hashes and Morton codes */
+static glv_ivec3 icells[BATCH];
+static glv_uvec3 ucells[BATCH];
+static uint32_t ihash[BATCH];
+static uint64_t mcodes[BATCH];
+static const glv_vec3 grid_origin = {.x=-1.0f, .y=-1.0f, .z=-1.0f}, grid_scale = {.x=16.0f, .y=16.0f, .z=16.0f};
+static glv_mat3* packm3;
+static glv_hierarchy hier = {BATCH, hparent, htrans, hrot, hscale, hlocal, hworld, hdirty};
+
+static float randf(){
+    return (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static void setup(){
+    unsigned int i, j;
+    srand(2024);
+    v2a = (glv_vec2){.x = randf(), .y = randf()};
+    v2b = (glv_vec2){.x = randf(), .y = randf()};
+    v3a = (glv_vec3){.x = randf(), .y = randf(), .z = randf()};
+    v3b = (glv_vec3){.x = randf(), .y = randf(), .z = randf()};
+    v4a = (glv_vec4){.x = randf(), .y = randf(), .z = randf(), .w = 1.0f};
+    v4b = (glv_vec4){.x = randf(), .y = randf(), .z = randf(), .w = 1.0f};
+    for(i = 0; i != 2; ++i) for(j = 0; j != 2; ++j){
+        m2a.data[i][j] = randf(); m2b.data[i][j] = randf();
+    }
+    for(i = 0; i != 3; ++i) for(j = 0; j != 3; ++j){
+        m3a.data[i][j] = randf(); m3b.data[i][j] = randf();
+    }
+    for(i = 0; i != 4; ++i) for(j = 0; j != 4; ++j){
+        m4a.data[i][j] = randf(); m4b.data[i][j] = randf(); m4c.data[i][j] = randf();
+    }
+    for(i = 0; i != BATCH; ++i){
+        for(j = 0; j != 4; ++j) arr4[i].data[j] = randf();
+        for(j = 0; j != 3; ++j) arr3[i].data[j] = randf();
+        arr3a[i].xyz = arr3[i];
+        for(j = 0; j != 2; ++j) arr2[i].data[j] = randf();
+        sx[i] = randf(); sy[i] = randf(); sz[i] = randf(); sw[i] = randf();
+        tx[i] = randf(); ty[i] = randf(); tz[i] = randf(); tw[i] = randf();
+    }
+    for(i = 0; i != BATCH / 16; ++i){
+        marr[i] = m4a;
+        marr[i].data[0][0] += randf();
+    }
+    for(i = 0; i != BATCH / 16; ++i) mptrs[i] = &marr[(i * 7) % (BATCH / 16)];
+    // wide, shallow tree: node i hangs off node i / 8
+    for(i = 0; i != BATCH; ++i) hparent[i] = i == 0 ? GLV_NODE_ROOT : i / 8;
+    glv_hierarchy_init(&hier);
+    glv_hierarchy_update(&hier);
+    qa = glv_quat_axis_angle(0.7f, &v3a);
+    qb = glv_quat_axis_angle(-0.3f, &v3b);
+    for(i = 0; i != BATCH; ++i){
+        qarr[i] = glv_quat_axis_angle(randf(), &arr3[i]);
+        qbrr[i] = glv_quat_axis_angle(randf(), &arr3[(i + 1) % BATCH]);
+    }
+    a34 = glv_mat3x4_from_mat4(&m4a);
+    b34 = glv_mat3x4_from_mat4(&m4b);
+    glv_mat3x4_from_mat4_batch(marr, a34arr, BATCH / 16);
+    big4 = malloc(BIG * sizeof(glv_vec4));
+    bigout4 = malloc(BIG * sizeof(glv_vec4));
+    bigm = malloc(BIG / 16 * sizeof(glv_mat4));
+    bigmout = malloc(BIG / 16 * sizeof(glv_mat4));
+    bigs = (glv_vec3_soa){malloc(BIG * sizeof(float)), malloc(BIG * sizeof(float)), malloc(BIG * sizeof(float))};
+    bigt = (glv_vec3_soa){malloc(BIG * sizeof(float)), malloc(BIG * sizeof(float)), malloc(BIG * sizeof(float))};
+    for(i = 0; i != BIG; ++i){
+        big4[i] = arr4[i % BATCH];
+        bigs.x[i] = sx[i % BATCH]; bigs.y[i] = sy[i % BATCH]; bigs.z[i] = sz[i % BATCH];
+    }
+    for(i = 0; i != BIG / 16; ++i) bigm[i] = marr[i % (BATCH / 16)];
+    {
+        FILE* f = fopen(stream_in, "wb");
+        if(f){
+            fwrite(big4, sizeof(glv_vec4), BIG, f);
+            fclose(f);
+        }
+    }
+    bigr = malloc(BIG * sizeof(float));
+    bigmask = malloc(GLV_CULL_MASK_WORDS(BIG) * sizeof(uint32_t));
+    bigidx = malloc(BIG * sizeof(uint32_t));
+    for(i = 0; i != BIG; ++i) bigr[i] = 0.05f * fabsf(randf());
+    bige = (glv_vec3_soa){bigr, bigr, bigr};
+    bighalf = malloc(BIG * sizeof(glv_half));
+    bigfloat = malloc(BIG * sizeof(float));
+    glv_half_from_float_array(bigs.x, bighalf, BIG);
+    d4a = glv_mat4_to_dmat4(&m4a);
+    d4b = glv_mat4_to_dmat4(&m4b);
+    {
+        // camera outside the unit cube, so that part of the bounds is visible
+        glv_mat4 proj = glv_perspective(1.0f, 1.0f, 0.1f, 100.0f);
+        glv_mat4 view = glv_lookat(&(glv_vec3){.x = 0.5f, .z = 1.5f}, &(glv_vec3){.z = 0.0f}, &(glv_vec3){.y = 1.0f});
+        glv_mat4 vp = glv_mat4_multiply(&proj, &view);
+        planes = glv_frustum_planes_from_mat4(&vp);
+    }
+    for(i = 0; i != BONES; ++i){
+        skworld[i] = marr[i % (BATCH / 16)];
+        skbind[i] = marr[(i + 3) % (BATCH / 16)];
+    }
+    glv_mat4_multiply_pairs(skworld, skbind, skpal, BONES);
+    skvert = malloc(BIG / 4 * sizeof(skin_vertex));
+    skpos = malloc(BIG / 4 * sizeof(glv_vec3));
+    sknrm = malloc(BIG / 4 * sizeof(glv_vec3));
+    for(i = 0; i != BIG / 4; ++i){
+        skvert[i].position = arr3[i % BATCH];
+        skvert[i].normal = arr3[(i + 1) % BATCH];
+        for(j = 0; j != 4; ++j){
+            skvert[i].joints[j] = (uint16_t)(rand() % BONES);
+            skvert[i].weights[j] = 0.25f;
+        }
+    }
+    skin = (glv_skin_stream){
+        .count = BATCH,
+        .position = &skvert[0].position, .position_stride = sizeof(skin_vertex),
+        .normal = &skvert[0].normal, .normal_stride = sizeof(skin_vertex),
+        .joints = skvert[0].joints, .joints_stride = sizeof(skin_vertex),
+        .weights = skvert[0].weights, .weights_stride = sizeof(skin_vertex),
+        .out_position = skpos, .out_normal = sknrm
+    };
+    skin_big = skin;
+    skin_big.count = BIG / 4;
+    {
+        glv_vec3_soa* streams[7] = {&rtris.v0, &rtris.e1, &rtris.e2, &rboxes.min, &rboxes.max,
+            &rpacket.origin, &rpacket.direction};
+        for(i = 0; i != 7; ++i){
+            *streams[i] = (glv_vec3_soa){malloc(BATCH * sizeof(float)), malloc(BATCH * sizeof(float)),
+                malloc(BATCH * sizeof(float))};
+        }
+        rhits = (glv_ray_hit_soa){malloc(BATCH * sizeof(float)), malloc(BATCH * sizeof(float)),
+            malloc(BATCH * sizeof(float)), malloc(BATCH * sizeof(uint32_t))};
+    }
+    for(i = 0; i != BATCH; ++i){
+        glv_vec3 c = {.x = randf(), .y = randf(), .z = randf()};
+        for(j = 0; j != 3; ++j){
+            rtri[i][j] = (glv_vec3){.x = c.x + 0.05f * randf(), .y = c.y + 0.05f * randf(), .z = c.z + 0.05f * randf()};
+        }
+        glv_triangle_soa_set(&rtris, i, &rtri[i][0], &rtri[i][1], &rtri[i][2]);
+        rboxes.min.x[i] = c.x - 0.03f; rboxes.min.y[i] = c.y - 0.03f; rboxes.min.z[i] = c.z - 0.03f;
+        rboxes.max.x[i] = c.x + 0.03f; rboxes.max.y[i] = c.y + 0.03f; rboxes.max.z[i] = c.z + 0.03f;
+        rpacket.origin.x[i] = randf(); rpacket.origin.y[i] = randf(); rpacket.origin.z[i] = 5.0f;
+        rpacket.direction.x[i] = 0.1f * randf(); rpacket.direction.y[i] = 0.1f * randf(); rpacket.direction.z[i] = -1.0f;
+    }
+    bvh = (glv_bvh){{{malloc(BVH_N * sizeof(float)), malloc(BVH_N * sizeof(float)), malloc(BVH_N * sizeof(float))},
+        {malloc(BVH_N * sizeof(float)), malloc(BVH_N * sizeof(float)), malloc(BVH_N * sizeof(float))}},
+        BVH_N, malloc(GLV_BVH_NODES(BVH_N) * sizeof(glv_bvh_node)), malloc(BVH_N * sizeof(uint32_t)), 0};
+    bvhlist = malloc(BVH_N * sizeof(uint32_t));
+    for(i = 0; i != BVH_N; ++i){
+        glv_vec3 c = {.x = randf(), .y = randf(), .z = randf()};
+        const float e = 0.002f + 0.01f * fabsf(randf());
+        bvh.boxes.min.x[i] = c.x - e; bvh.boxes.min.y[i] = c.y - e; bvh.boxes.min.z[i] = c.z - e;
+        bvh.boxes.max.x[i] = c.x + e; bvh.boxes.max.y[i] = c.y + e; bvh.boxes.max.z[i] = c.z + e;
+    }
+    glv_bvh_build(&bvh, 4);
+    for(i = 0; i != BATCH; ++i){
+        for(j = 0; j != 3; ++j) ucells[i].data[j] = (unsigned int)rand() & 0x1fffff;
+    }
+    glv_vec3_floor_to_ivec3(arr3, &grid_origin, &grid_scale, icells, BATCH);
+    packdst = malloc(BIG / 16 * sizeof(glv_mat4));
+    packstage = malloc(BIG / 16 * sizeof(glv_mat4));
+    packm3 = malloc(BIG / 16 * sizeof(glv_mat3));
+    glv_arena_init(&frame, framemem, sizeof(framemem));
+    glv_camera_init(&cam, &cam_eye, &cam_target, &cam_up, 0.9f, 16.0f / 9.0f, 0.1f, 500.0f);
+    for(i = 0; i != BIG / 16; ++i) for(j = 0; j != 9; ++j) packm3[i].data[j / 3][j % 3] = randf();
+    glv_pool_start(0);
+    s2 = (glv_vec2_soa){sx, sy};
+    t2 = (glv_vec2_soa){tx, ty};
+    s3 = (glv_vec3_soa){sx, sy, sz};
+    t3 = (glv_vec3_soa){tx, ty, tz};
+    u3 = (glv_vec3_soa){ux, uy, uz};
+    s4 = (glv_vec4_soa){sx, sy, sz, sw};
+    t4 = (glv_vec4_soa){tx, ty, tz, tw};
+}
+
+
+/* ----- Benchmarks ----- */
+
+/* Defines bench_NAME running BODY iters times */
+#define BENCH(NAME, BODY)                               \
+static void bench_##NAME(size_t iters){                 \
+    size_t it;                                          \
+    for(it = 0; it != iters; ++it){ BODY }              \
+}
+
+/* vec.h */
+BENCH(vec2_magnitude, CLOBBER(v2a); float r = glv_vec2_magnitude(&v2a); KEEP(r);)
+BENCH(vec3_magnitude, CLOBBER(v3a); float r = glv_vec3_magnitude(&v3a); KEEP(r);)
+BENCH(vec4_magnitude, CLOBBER(v4a); float r = glv_vec4_magnitude(&v4a); KEEP(r);)
+BENCH(vec2_normalize, CLOBBER(v2a); glv_vec2 r = glv_vec2_normalize(&v2a); KEEP(r);)
+BENCH(vec3_normalize, CLOBBER(v3a); glv_vec3 r = glv_vec3_normalize(&v3a); KEEP(r);)
+BENCH(vec4_normalize, CLOBBER(v4a); glv_vec4 r = glv_vec4_normalize(&v4a); KEEP(r);)
+BENCH(vec2_dot, CLOBBER(v2a); float r = glv_vec2_dot(&v2a, &v2b); KEEP(r);)
+BENCH(vec3_dot, CLOBBER(v3a); float r = glv_vec3_dot(&v3a, &v3b); KEEP(r);)
+BENCH(vec4_dot, CLOBBER(v4a); float r = glv_vec4_dot(&v4a, &v4b); KEEP(r);)
+BENCH(vec3_cross, CLOBBER(v3a); glv_vec3 r = glv_vec3_cross(&v3a, &v3b); KEEP(r);)
+
+/* mat.h */
+BENCH(mat4_diagonal, float d = 2.0f; CLOBBER(d); glv_mat4 r = glv_mat4_diagonal(d, d, d, 1.0f); KEEP(r);)
+BENCH(mat4_identity, glv_mat4 r = glv_mat4_identity(); KEEP(r);)
+BENCH(mat2_transpose, CLOBBER(m2a); glv_mat2 r = glv_mat2_transpose(&m2a); KEEP(r);)
+BENCH(mat3_transpose, CLOBBER(m3a); glv_mat3 r = glv_mat3_transpose(&m3a); KEEP(r);)
+BENCH(mat4_transpose, CLOBBER(m4a); glv_mat4 r = glv_mat4_transpose(&m4a); KEEP(r);)
+BENCH(mat3_minor, CLOBBER(m3a); float r = glv_mat3_minor(&m3a, 1, 2); KEEP(r);)
+BENCH(mat4_minor, CLOBBER(m4a); float r = glv_mat4_minor(&m4a, 1, 2); KEEP(r);)
+BENCH(mat2_determinant, CLOBBER(m2a); float r = glv_mat2_determinant(&m2a); KEEP(r);)
+BENCH(mat3_determinant, CLOBBER(m3a); float r = glv_mat3_determinant(&m3a); KEEP(r);)
+BENCH(mat4_determinant, CLOBBER(m4a); float r = glv_mat4_determinant(&m4a); KEEP(r);)
+BENCH(mat3_cofactors, CLOBBER(m3a); glv_mat3 r = glv_mat3_cofactors(&m3a); KEEP(r);)
+BENCH(mat4_cofactors, CLOBBER(m4a); glv_mat4 r = glv_mat4_cofactors(&m4a); KEEP(r);)
+BENCH(mat3_inverse, CLOBBER(m3a); glv_mat3 r = glv_mat3_inverse(&m3a); KEEP(r);)
+BENCH(mat4_inverse, CLOBBER(m4a); glv_mat4 r = glv_mat4_inverse(&m4a); KEEP(r);)
+BENCH(mat4_inverse_status, CLOBBER(m4a); glv_mat4 r; int s = glv_mat4_inverse_status(&m4a, &r); KEEP(r); KEEP(s);)
+BENCH(mat4_inverse_affine, CLOBBER(m4a); glv_mat4 r = glv_mat4_inverse_affine(&m4a); KEEP(r);)
+BENCH(mat4_inverse_batch, size_t s = glv_mat4_inverse_batch(marr, mout, BATCH / 16, mstatus); KEEP(s); KEEP(mout);)
+BENCH(mat2_multiply, CLOBBER(m2a); glv_mat2 r = glv_mat2_multiply(&m2a, &m2b); KEEP(r);)
+BENCH(mat3_multiply, CLOBBER(m3a); glv_mat3 r = glv_mat3_multiply(&m3a, &m3b); KEEP(r);)
+BENCH(mat4_multiply, CLOBBER(m4a); glv_mat4 r = glv_mat4_multiply(&m4a, &m4b); KEEP(r);)
+BENCH(mat2_nmultiply, glv_mat2 a = m2a; CLOBBER(a); glv_mat2 r = glv_mat2_nmultiply(3, &a, &m2b, &m2a); KEEP(r);)
+BENCH(mat3_nmultiply, glv_mat3 a = m3a; CLOBBER(a); glv_mat3 r = glv_mat3_nmultiply(3, &a, &m3b, &m3a); KEEP(r);)
+BENCH(mat4_nmultiply, glv_mat4 a = m4a; CLOBBER(a); glv_mat4 r = glv_mat4_nmultiply(3, &a, &m4b, &m4c); KEEP(r);)
+BENCH(mat4_multiply_chain, glv_mat4 r; glv_mat4_multiply_chain(mptrs, BATCH / 16, &r); KEEP(r);)
+BENCH(mat4_multiply_array, glv_mat4_multiply_array(&m4a, marr, mout, BATCH / 16); KEEP(mout);)
+BENCH(mat4_multiply_array_a64, glv_mat4_multiply_array_a64(&m4a, marr, mout, BATCH / 16); KEEP(mout);)
+BENCH(mat4_multiply_chain_array, glv_mat4 r; glv_mat4_multiply_chain_array(marr, BATCH / 16, &r); KEEP(r);)
+
+/* transform.h */
+BENCH(radians, float a = 45.0f; CLOBBER(a); float r = glv_radians(a); KEEP(r);)
+BENCH(degrees, float a = 0.5f; CLOBBER(a); float r = glv_degrees(a); KEEP(r);)
+BENCH(ortho2D, float a = 1.0f; CLOBBER(a); glv_mat4 r = glv_ortho2D(-a, a, -a, a); KEEP(r);)
+BENCH(ortho, float a = 1.0f; CLOBBER(a); glv_mat4 r = glv_ortho(-a, a, -a, a, 0.1f, 100.0f); KEEP(r);)
+BENCH(frustum, float a = 1.0f; CLOBBER(a); glv_mat4 r = glv_frustum(-a, a, -a, a, 0.1f, 100.0f); KEEP(r);)
+BENCH(perspective, float a = 0.8f; CLOBBER(a); glv_mat4 r = glv_perspective(a, 1.5f, 0.1f, 100.0f); KEEP(r);)
+BENCH(perspective_fov, float a = 0.8f; CLOBBER(a); glv_mat4 r = glv_perspective_fov(a, 800.0f, 600.0f, 0.1f, 100.0f); KEEP(r);)
+BENCH(lookat, CLOBBER(v3a); glv_mat4 r = glv_lookat(&v3a, &v3b, &(glv_vec3){.y = 1.0f}); KEEP(r);)
+BENCH(scale, CLOBBER(m4a); glv_mat4 r = glv_scale(&m4a, &v3a); KEEP(r);)
+BENCH(translate, CLOBBER(m4a); glv_mat4 r = glv_translate(&m4a, &v3a); KEEP(r);)
+BENCH(rotate, CLOBBER(m4a); glv_mat4 r = glv_rotate(&m4a, 0.3f, &v3a); KEEP(r);)
+BENCH(transform, CLOBBER(v4a); glv_vec4 r = glv_transform(&v4a, &m4a); KEEP(r);)
+BENCH(transform_batch, glv_transform_batch(arr4, 0, out4, 0, BATCH, &m4a); KEEP(out4);)
+BENCH(transform_batch_vec3, glv_transform_batch_vec3(arr3, 0, out3, 0, BATCH, &m4a); KEEP(out3);)
+
+/* soa.h */
+BENCH(vec2_to_soa, glv_vec2_to_soa(arr2, BATCH, &t2); KEEP(tx);)
+BENCH(vec3_to_soa, glv_vec3_to_soa(arr3, BATCH, &t3); KEEP(tx);)
+BENCH(vec4_to_soa, glv_vec4_to_soa(arr4, BATCH, &t4); KEEP(tx);)
+BENCH(vec2_from_soa, glv_vec2_from_soa(&s2, BATCH, arr2); KEEP(arr2);)
+BENCH(vec3_from_soa, glv_vec3_from_soa(&s3, BATCH, out3); KEEP(out3);)
+BENCH(vec4_from_soa, glv_vec4_from_soa(&s4, BATCH, out4); KEEP(out4);)
+BENCH(vec2_soa_magnitude, glv_vec2_soa_magnitude(&s2, scal, BATCH); KEEP(scal);)
+BENCH(vec3_soa_magnitude, glv_vec3_soa_magnitude(&s3, scal, BATCH); KEEP(scal);)
+BENCH(vec4_soa_magnitude, glv_vec4_soa_magnitude(&s4, scal, BATCH); KEEP(scal);)
+BENCH(vec2_soa_normalize, glv_vec2_soa_normalize(&s2, &t2, BATCH); KEEP(tx);)
+BENCH(vec3_soa_normalize, glv_vec3_soa_normalize(&s3, &t3, BATCH); KEEP(tx);)
+BENCH(vec4_soa_normalize, glv_vec4_soa_normalize(&s4, &t4, BATCH); KEEP(tx);)
+BENCH(vec2_soa_dot, glv_vec2_soa_dot(&s2, &t2, scal, BATCH); KEEP(scal);)
+BENCH(vec3_soa_dot, glv_vec3_soa_dot(&s3, &t3, scal, BATCH); KEEP(scal);)
+BENCH(vec4_soa_dot, glv_vec4_soa_dot(&s4, &t4, scal, BATCH); KEEP(scal);)
+BENCH(vec3_soa_cross, glv_vec3_soa_cross(&s3, &t3, &u3, BATCH); KEEP(ux);)
+
+/* hierarchy.h */
+BENCH(hierarchy_update_clean, size_t r = glv_hierarchy_update(&hier); KEEP(r);)
+BENCH(hierarchy_update_leaves, size_t k;
+    for(k = BATCH - BATCH / 16; k != BATCH; ++k) glv_hierarchy_set_translation(&hier, k, &v3a);
+    size_t r = glv_hierarchy_update(&hier); KEEP(r);)
+BENCH(hierarchy_update_all, glv_hierarchy_mark_dirty(&hier, 0); size_t r = glv_hierarchy_update(&hier); KEEP(r);)
+
+/* quat.h */
+BENCH(quat_axis_angle, float a = 0.7f; CLOBBER(a); glv_quat r = glv_quat_axis_angle(a, &v3a); KEEP(r);)
+BENCH(quat_from_mat4, CLOBBER(m4a); glv_quat r = glv_quat_from_mat4(&m4a); KEEP(r);)
+BENCH(quat_multiply, CLOBBER(qa); glv_quat r = glv_quat_multiply(&qa, &qb); KEEP(r);)
+BENCH(quat_normalize, CLOBBER(qa); glv_quat r = glv_quat_normalize(&qa); KEEP(r);)
+BENCH(quat_inverse, CLOBBER(qa); glv_quat r = glv_quat_inverse(&qa); KEEP(r);)
+BENCH(quat_rotate, CLOBBER(v3a); glv_vec3 r = glv_quat_rotate(&qa, &v3a); KEEP(r);)
+BENCH(quat_nlerp, float t = 0.3f; CLOBBER(t); glv_quat r = glv_quat_nlerp(&qa, &qb, t); KEEP(r);)
+BENCH(quat_slerp, float t = 0.3f; CLOBBER(t); glv_quat r = glv_quat_slerp(&qa, &qb, t); KEEP(r);)
+BENCH(quat_to_mat4, CLOBBER(qa); glv_mat4 r = glv_quat_to_mat4(&qa); KEEP(r);)
+BENCH(quat_multiply_batch, glv_quat_multiply_batch(qarr, qbrr, qout, BATCH); KEEP(qout);)
+BENCH(quat_normalize_batch, glv_quat_normalize_batch(qarr, qout, BATCH); KEEP(qout);)
+BENCH(quat_to_mat4_batch, glv_quat_to_mat4_batch(qarr, qmat, BATCH); KEEP(qmat);)
+BENCH(quat_rotate_batch, glv_quat_rotate_batch(&qa, arr3, out3, BATCH); KEEP(out3);)
+
+/* affine.h */
+BENCH(mat3x4_from_mat4, CLOBBER(m4a); glv_mat3x4 r = glv_mat3x4_from_mat4(&m4a); KEEP(r);)
+BENCH(mat3x4_to_mat4, CLOBBER(a34); glv_mat4 r = glv_mat3x4_to_mat4(&a34); KEEP(r);)
+BENCH(mat3x4_multiply, CLOBBER(a34); glv_mat3x4 r = glv_mat3x4_multiply(&a34, &b34); KEEP(r);)
+BENCH(mat3x4_inverse, CLOBBER(a34); glv_mat3x4 r = glv_mat3x4_inverse(&a34); KEEP(r);)
+BENCH(mat3x4_transform_point, CLOBBER(v3a); glv_vec3 r = glv_mat3x4_transform_point(&a34, &v3a); KEEP(r);)
+BENCH(mat3x4_transform_dir, CLOBBER(v3a); glv_vec3 r = glv_mat3x4_transform_dir(&a34, &v3a); KEEP(r);)
+BENCH(mat3x4_multiply_array, glv_mat3x4_multiply_array(&a34, a34arr, a34out, BATCH / 16); KEEP(a34out);)
+BENCH(mat3x4_inverse_batch, size_t s = glv_mat3x4_inverse_batch(a34arr, a34out, BATCH / 16, mstatus); KEEP(s); KEEP(a34out);)
+BENCH(mat3x4_transform_points, glv_mat3x4_transform_points(arr3, 0, out3, 0, BATCH, &a34); KEEP(out3);)
+BENCH(mat3x4_transform_dirs, glv_mat3x4_transform_dirs(arr3, 0, out3, 0, BATCH, &a34); KEEP(out3);)
+
+/* transform.h, fused TRS */
+BENCH(compose_trs, CLOBBER(qa); glv_mat4 r = glv_compose_trs(&v3a, &qa, &v3b); KEEP(r);)
+BENCH(compose_trs_chained, CLOBBER(qa); glv_mat4 r = glv_mat4_identity(); glv_mat4 q = glv_quat_to_mat4(&qa);
+    r = glv_translate(&r, &v3a); r = glv_mat4_multiply(&r, &q); r = glv_scale(&r, &v3b); KEEP(r);)
+BENCH(decompose_trs, CLOBBER(m4a); glv_vec3 t; glv_vec3 s; glv_quat q; glv_decompose_trs(&m4a, &t, &q, &s); KEEP(t); KEEP(q); KEEP(s);)
+BENCH(compose_trs_batch, glv_compose_trs_batch(&t3, &s4, &u3, qmat, BATCH); KEEP(qmat);)
+BENCH(compose_trs_batch_3x4, glv_compose_trs_batch_3x4(&t3, &s4, &u3, trs34, BATCH); KEEP(trs34);)
+
+/* cull.h, over one million bounds centred at bigs */
+BENCH(frustum_planes_from_mat4, CLOBBER(m4a); glv_frustum_planes r = glv_frustum_planes_from_mat4(&m4a); KEEP(r);)
+BENCH(frustum_sphere_visible, CLOBBER(v3a); int r = glv_frustum_sphere_visible(&planes, &v3a, 0.1f); KEEP(r);)
+BENCH(frustum_cull_spheres, size_t r = glv_frustum_cull_spheres(&planes, &bigs, bigr, BIG, bigmask); KEEP(r); KEEP(bigmask);)
+BENCH(frustum_cull_spheres_indices, size_t r = glv_frustum_cull_spheres_indices(&planes, &bigs, bigr, BIG, bigidx); KEEP(r); KEEP(bigidx);)
+BENCH(frustum_cull_aabbs, size_t r = glv_frustum_cull_aabbs(&planes, &bigs, &bige, BIG, bigmask); KEEP(r); KEEP(bigmask);)
+BENCH(frustum_cull_aabbs_indices, size_t r = glv_frustum_cull_aabbs_indices(&planes, &bigs, &bige, BIG, bigidx); KEEP(r); KEEP(bigidx);)
+
+/* half.h, one million values each way */
+BENCH(half_from_float, CLOBBER(v3a); glv_half r = glv_half_from_float(v3a.x); KEEP(r);)
+BENCH(half_from_float_array, glv_half_from_float_array(bigs.x, bighalf, BIG); KEEP(bighalf);)
+BENCH(half_to_float_array, glv_half_to_float_array(bighalf, bigfloat, BIG); KEEP(bigfloat);)
+
+/* dmat.h */
+BENCH(dmat4_multiply, CLOBBER(d4a); glv_dmat4 r = glv_dmat4_multiply(&d4a, &d4b); KEEP(r);)
+BENCH(dmat4_inverse, CLOBBER(d4a); glv_dmat4 r = glv_dmat4_inverse(&d4a); KEEP(r);)
+BENCH(dmat4_to_mat4_relative, CLOBBER(d4a); glv_mat4 r = glv_dmat4_to_mat4_relative(&d4a, &(glv_dvec3){.x = 1.0}); KEEP(r);)
+
+/* fast.h, next to their precise versions */
+BENCH(sincos, float a = 2.3f; CLOBBER(a); float s = sinf(a); float c = cosf(a); KEEP(s); KEEP(c);)
+BENCH(fast_sincos, float a = 2.3f; CLOBBER(a); float s; float c; glv_fast_sincos(a, &s, &c); KEEP(s); KEEP(c);)
+BENCH(tan, float a = 0.4f; CLOBBER(a); float r = tanf(a); KEEP(r);)
+BENCH(fast_tan, float a = 0.4f; CLOBBER(a); float r = glv_fast_tan(a); KEEP(r);)
+BENCH(vec3_fast_normalize, CLOBBER(v3a); glv_vec3 r = glv_vec3_fast_normalize(&v3a); KEEP(r);)
+BENCH(fast_rotate, CLOBBER(m4a); glv_mat4 r = glv_fast_rotate(&m4a, 0.3f, &v3a); KEEP(r);)
+BENCH(fast_perspective, float a = 0.8f; CLOBBER(a); glv_mat4 r = glv_fast_perspective(a, 1.5f, 0.1f, 100.0f); KEEP(r);)
+BENCH(vec3_soa_fast_normalize, glv_vec3_soa_fast_normalize(&s3, &t3, BATCH); KEEP(tx);)
+BENCH(sincos_array, for(size_t i = 0; i != BATCH; ++i){ tx[i] = sinf(sx[i]); ty[i] = cosf(sx[i]); } KEEP(tx); KEEP(ty);)
+BENCH(fast_sincos_array, glv_fast_sincos_array(sx, tx, ty, BATCH); KEEP(tx); KEEP(ty);)
+
+/* skin.h, with glv_mat4_multiply in a loop for comparison */
+BENCH(mat4_multiply_loop, for(size_t i = 0; i != BONES; ++i){ skpal[i] = glv_mat4_multiply(&skworld[i], &skbind[i]); } KEEP(skpal);)
+BENCH(mat4_multiply_pairs, glv_mat4_multiply_pairs(skworld, skbind, skpal, BONES); KEEP(skpal);)
+BENCH(mat4_multiply_pairs_a64, glv_mat4_multiply_pairs_a64(skworld, skbind, skpal, BONES); KEEP(skpal);)
+BENCH(skin_vertices, glv_skin_vertices(&skin, skpal); KEEP(skpos); KEEP(sknrm);)
+
+/* pack.h, against glv_mat4_transpose into a staging buffer and a copy */
+#define STAGED(N) for(size_t i = 0; i != N; ++i){ glv_mat4 t = glv_mat4_transpose(&bigm[i]); memcpy(packstage + 16 * i, &t, sizeof(t)); } memcpy(packdst, packstage, N * sizeof(glv_mat4));
+BENCH(mat4_transpose_staged, STAGED(BATCH / 16) KEEP(packdst);)
+BENCH(pack_mat4, glv_pack_mat4(packdst, 0, bigm, BATCH / 16); KEEP(packdst);)
+BENCH(mat4_transpose_staged_big, STAGED(BIG / 16) KEEP(packdst);)
+BENCH(pack_mat4_big, glv_pack_mat4(packdst, 0, bigm, BIG / 16); KEEP(packdst);)
+BENCH(pack_mat3_std140_big, glv_pack_mat3(packdst, 0, packm3, BIG / 16, GLV_LAYOUT_STD140); KEEP(packdst);)
+BENCH(pack_vec3_std430, glv_pack_vec3(packdst, 0, arr3, BATCH, GLV_LAYOUT_STD430); KEEP(packdst);)
+
+/* Padded points, and the allocations of a frame from malloc or an arena */
+BENCH(transform_batch_vec3a, glv_transform_batch_vec3a(arr3a, out3a, BATCH, &m4a); KEEP(out3a);)
+#define FRAME_ALLOCS(ALLOC, M, V, P) void* a[4] = {ALLOC(M, BONES), ALLOC(V, BATCH), ALLOC(P, BATCH), ALLOC(M, BATCH / 16)}; CLOBBER(a);
+#define FRAME_MALLOC(T, N) malloc((N) * sizeof(T))
+#define FRAME_ARENA(F, N) F(&frame, N)
+BENCH(frame_malloc, FRAME_ALLOCS(FRAME_MALLOC, glv_mat4, glv_vec4, glv_vec3a) for(int i = 0; i != 4; ++i) free(a[i]);)
+BENCH(frame_arena, glv_arena_reset(&frame); FRAME_ALLOCS(FRAME_ARENA, glv_arena_mat4, glv_arena_vec4, glv_arena_vec3a))
+
+/* camera.h, against rebuilding every matrix each frame */
+#define CAMERA_FRAME(VP, IVP, F) KEEP(*(VP)); KEEP(*(IVP)); KEEP(*(F));
+BENCH(camera_uncached, CLOBBER(cam_eye); glv_mat4 v = glv_lookat(&cam_eye, &cam_target, &cam_up);
+    glv_mat4 p = glv_perspective(0.9f, 16.0f / 9.0f, 0.1f, 500.0f); glv_mat4 vp = glv_mat4_multiply(&p, &v);
+    glv_mat4 ivp = glv_mat4_inverse(&vp); glv_frustum_planes f = glv_frustum_planes_from_mat4(&vp); CAMERA_FRAME(&vp, &ivp, &f))
+BENCH(camera_still, CLOBBER(cam_eye); glv_camera_set_view(&cam, &cam_eye, &cam_target, &cam_up);
+    CAMERA_FRAME(glv_camera_view_projection(&cam), glv_camera_inverse_view_projection(&cam), glv_camera_frustum(&cam)))
+BENCH(camera_moving, cam_eye.x += 1e-3f; glv_camera_set_view(&cam, &cam_eye, &cam_target, &cam_up);
+    CAMERA_FRAME(glv_camera_view_projection(&cam), glv_camera_inverse_view_projection(&cam), glv_camera_frustum(&cam)))
+BENCH(camera_unproject, glv_camera_unproject(&cam, &cam_viewport, arr3, out3, BATCH); KEEP(out3);)
+
+/* ray.h, against a Moller-Trumbore loop over vertices with glv_vec3_cross and glv_vec3_dot */
+static uint32_t ray_triangles_scalar(const glv_ray* r, const glv_vec3 (*tri)[3], size_t n, float* best){
+#define SUB3(a, b) (glv_vec3){.x = (a).x - (b).x, .y = (a).y - (b).y, .z = (a).z - (b).z}
+    uint32_t hit = GLV_RAY_MISS;
+    size_t i;
+    *best = INFINITY;
+    for(i = 0; i != n; ++i){
+        glv_vec3 e1 = SUB3(tri[i][1], tri[i][0]), e2 = SUB3(tri[i][2], tri[i][0]);
+        glv_vec3 p = glv_vec3_cross(&r->direction, &e2);
+        float det = glv_vec3_dot(&e1, &p);
+        if(det == 0.0f) continue;
+        float inv = 1.0f / det;
+        glv_vec3 s = SUB3(r->origin, tri[i][0]);
+        float u = glv_vec3_dot(&s, &p) * inv;
+        if(u < 0.0f || u > 1.0f) continue;
+        glv_vec3 q = glv_vec3_cross(&s, &e1);
+        float v = glv_vec3_dot(&r->direction, &q) * inv;
+        if(v < 0.0f || u + v > 1.0f) continue;
+        float t = glv_vec3_dot(&e2, &q) * inv;
+        if(t > 0.0f && t < *best){
+            *best = t;
+            hit = (uint32_t)i;
+        }
+    }
+    return hit;
+#undef SUB3
+}
+#define RAY_PACKET_RESET for(int k = 0; k != BATCH; ++k){ rhits.t[k] = INFINITY; rhits.index[k] = GLV_RAY_MISS; }
+BENCH(ray_triangles_loop, CLOBBER(ray); float t; uint32_t r = ray_triangles_scalar(&ray, rtri, BATCH, &t); KEEP(r); KEEP(t);)
+BENCH(ray_triangles_nearest, CLOBBER(ray); glv_ray_hit h; glv_ray_triangles_nearest(&ray, &rtris, BATCH, INFINITY, &h); KEEP(h);)
+BENCH(ray_aabbs, CLOBBER(ray); size_t r = glv_ray_aabbs(&ray, &rboxes, BATCH, INFINITY, rmask, rtenter); KEEP(r); KEEP(rmask);)
+BENCH(ray_aabbs_nearest, CLOBBER(ray); float t; uint32_t r = glv_ray_aabbs_nearest(&ray, &rboxes, BATCH, INFINITY, &t); KEEP(r); KEEP(t);)
+BENCH(rays_triangle, RAY_PACKET_RESET size_t r = glv_rays_triangle(&rpacket, BATCH, &rtri[0][0], &rtri[0][1], &rtri[0][2], 0, &rhits); KEEP(r);)
+BENCH(rays_aabb, size_t r = glv_rays_aabb(&rpacket, BATCH, &(glv_vec3){.x=-0.5f, .y=-0.5f, .z=-0.5f},
+    &(glv_vec3){.x=0.5f, .y=0.5f, .z=0.5f}, NULL, rmask); KEEP(r); KEEP(rmask);)
+
+/* bvh.h, over BVH_N boxes, against linear scans with ray.h */
+static const glv_vec3 bvh_point = {.x = 0.3f, .y = -0.2f, .z = 0.1f};
+BENCH(bvh_build, size_t r = glv_bvh_build(&bvh, 4); KEEP(r);)
+BENCH(bvh_build_parallel, size_t r = glv_bvh_build_parallel(&bvh, 4); KEEP(r);)
+BENCH(bvh_refit, glv_bvh_refit(&bvh); KEEP(bvh.nodes[0]);)
+BENCH(ray_aabbs_nearest_linear, CLOBBER(ray); float t; uint32_t r = glv_ray_aabbs_nearest(&ray, &bvh.boxes, BVH_N, INFINITY, &t); KEEP(r); KEEP(t);)
+BENCH(bvh_ray_nearest, CLOBBER(ray); float t; uint32_t r = glv_bvh_ray_nearest(&bvh, &ray, INFINITY, &t); KEEP(r); KEEP(t);)
+BENCH(bvh_sphere, size_t r = glv_bvh_sphere(&bvh, &bvh_point, 0.05f, bvhlist, BVH_N); KEEP(r);)
+BENCH(bvh_nearest, float d; uint32_t r = glv_bvh_nearest(&bvh, &bvh_point, INFINITY, &d); KEEP(r); KEEP(d);)
+
+/* ivec.h, batches against per-element loops */
+BENCH(floor_to_ivec3_loop,
+    for(int i = 0; i != BATCH; ++i){
+        for(int j = 0; j != 3; ++j) icells[i].data[j] = (int)floorf((arr3[i].data[j] - grid_origin.data[j]) * grid_scale.data[j]);
+    }
+    KEEP(icells);)
+BENCH(vec3_floor_to_ivec3, glv_vec3_floor_to_ivec3(arr3, &grid_origin, &grid_scale, icells, BATCH); KEEP(icells);)
+BENCH(ivec3_hash_loop, for(int i = 0; i != BATCH; ++i) ihash[i] = glv_ivec3_hash(&icells[i]); KEEP(ihash);)
+BENCH(ivec3_hash_batch, glv_ivec3_hash_batch(icells, ihash, BATCH); KEEP(ihash);)
+BENCH(ivec3_clamp_batch, glv_ivec3_clamp_batch(icells, &(glv_ivec3){.x=4, .y=4, .z=4}, &(glv_ivec3){.x=28, .y=28, .z=28},
+    icells, BATCH); KEEP(icells);)
+BENCH(morton3_encode_loop,
+    for(int i = 0; i != BATCH; ++i) mcodes[i] = glv_morton3_encode(ucells[i].x, ucells[i].y, ucells[i].z);
+    KEEP(mcodes);)
+BENCH(uvec3_to_morton, glv_uvec3_to_morton(ucells, mcodes, BATCH); KEEP(mcodes);)
+BENCH(morton_to_uvec3, glv_morton_to_uvec3(mcodes, ucells, BATCH); KEEP(ucells);)
+BENCH(vec3_to_morton, glv_vec3_to_morton(arr3, &grid_origin, &(glv_vec3){.x=1.0f, .y=1.0f, .z=1.0f}, mcodes, BATCH);
+    KEEP(mcodes);)
+
+/* pool.h, serial and parallel over the same large batches */
+BENCH(transform_batch_big, glv_transform_batch(big4, 0, bigout4, 0, BIG, &m4a); KEEP(bigout4);)
+BENCH(transform_batch_parallel, glv_transform_batch_parallel(big4, 0, bigout4, 0, BIG, &m4a); KEEP(bigout4);)
+BENCH(vec3_soa_normalize_big, glv_vec3_soa_normalize(&bigs, &bigt, BIG); KEEP(bigt);)
+BENCH(vec3_soa_normalize_parallel, glv_vec3_soa_normalize_parallel(&bigs, &bigt, BIG); KEEP(bigt);)
+BENCH(mat4_multiply_array_big, glv_mat4_multiply_array(&m4a, bigm, bigmout, BIG / 16); KEEP(bigmout);)
+BENCH(mat4_multiply_array_parallel, glv_mat4_multiply_array_parallel(&m4a, bigm, bigmout, BIG / 16); KEEP(bigmout);)
+BENCH(mat4_multiply_chain_big, glv_mat4 r; glv_mat4_multiply_chain_array(bigm, BIG / 16, &r); KEEP(r);)
+BENCH(mat4_multiply_chain_parallel, glv_mat4 r; glv_mat4_multiply_chain_array_parallel(bigm, BIG / 16, &r); KEEP(r);)
+BENCH(skin_vertices_big, glv_skin_vertices(&skin_big, skpal); KEEP(skpos); KEEP(sknrm);)
+BENCH(skin_vertices_parallel, glv_skin_vertices_parallel(&skin_big, skpal); KEEP(skpos); KEEP(sknrm);)
+
+/* stream.h, big4 through a file (in the page cache), against buffered stdio */
+static void stream_stdio(){
+    FILE *in = fopen(stream_in, "rb"), *out = fopen(stream_out, "wb");
+    size_t n;
+    while((n = fread(bigout4, sizeof(glv_vec4), BIG / 4, in)) != 0){
+        glv_transform_batch(bigout4, 0, bigout4, 0, n, &m4a);
+        fwrite(bigout4, sizeof(glv_vec4), n, out);
+    }
+    fclose(in);
+    fclose(out);
+}
+BENCH(stream_stdio, stream_stdio();)
+BENCH(stream_transform_file, int r = glv_stream_transform_file(stream_in, stream_out, 4, &m4a, 0, NULL); KEEP(r);)
+
+#define CASE(NAME, ITEMS) {#NAME, ITEMS, bench_##NAME}
+
+static const bench_case cases[] = {
+    CASE(vec2_magnitude, 1), CASE(vec3_magnitude, 1), CASE(vec4_magnitude, 1),
+    CASE(vec2_normalize, 1), CASE(vec3_normalize, 1), CASE(vec4_normalize, 1),
+    CASE(vec2_dot, 1), CASE(vec3_dot, 1), CASE(vec4_dot, 1),
+    CASE(vec3_cross, 1),
+
+    CASE(mat4_diagonal, 1), CASE(mat4_identity, 1),
+    CASE(mat2_transpose, 1), CASE(mat3_transpose, 1), CASE(mat4_transpose, 1),
+    CASE(mat3_minor, 1), CASE(mat4_minor, 1),
+    CASE(mat2_determinant, 1), CASE(mat3_determinant, 1), CASE(mat4_determinant, 1),
+    CASE(mat3_cofactors, 1), CASE(mat4_cofactors, 1),
+    CASE(mat3_inverse, 1), CASE(mat4_inverse, 1), CASE(mat4_inverse_status, 1),
+    CASE(mat4_inverse_affine, 1), CASE(mat4_inverse_batch, BATCH / 16),
+    CASE(mat2_multiply, 1), CASE(mat3_multiply, 1), CASE(mat4_multiply, 1),
+    CASE(mat2_nmultiply, 2), CASE(mat3_nmultiply, 2), CASE(mat4_nmultiply, 2),
+    CASE(mat4_multiply_array, BATCH / 16), CASE(mat4_multiply_array_a64, BATCH / 16),
+    CASE(mat4_multiply_chain, BATCH / 16 - 1), CASE(mat4_multiply_chain_array, BATCH / 16 - 1),
+
+    CASE(radians, 1), CASE(degrees, 1),
+    CASE(ortho2D, 1), CASE(ortho, 1), CASE(frustum, 1),
+    CASE(perspective, 1), CASE(perspective_fov, 1), CASE(lookat, 1),
+    CASE(scale, 1), CASE(translate, 1), CASE(rotate, 1),
+    CASE(transform, 1), CASE(transform_batch, BATCH), CASE(transform_batch_vec3, BATCH),
+
+    CASE(vec2_to_soa, BATCH), CASE(vec3_to_soa, BATCH), CASE(vec4_to_soa, BATCH),
+    CASE(vec2_from_soa, BATCH), CASE(vec3_from_soa, BATCH), CASE(vec4_from_soa, BATCH),
+    CASE(vec2_soa_magnitude, BATCH), CASE(vec3_soa_magnitude, BATCH), CASE(vec4_soa_magnitude, BATCH),
+    CASE(vec2_soa_normalize, BATCH), CASE(vec3_soa_normalize, BATCH), CASE(vec4_soa_normalize, BATCH),
+    CASE(vec2_soa_dot, BATCH), CASE(vec3_soa_dot, BATCH), CASE(vec4_soa_dot, BATCH),
+    CASE(vec3_soa_cross, BATCH),
+
+    CASE(hierarchy_update_clean, BATCH), CASE(hierarchy_update_leaves, BATCH / 16),
+    CASE(hierarchy_update_all, BATCH),
+
+    CASE(quat_axis_angle, 1), CASE(quat_from_mat4, 1), CASE(quat_multiply, 1),
+    CASE(quat_normalize, 1), CASE(quat_inverse, 1), CASE(quat_rotate, 1),
+    CASE(quat_nlerp, 1), CASE(quat_slerp, 1), CASE(quat_to_mat4, 1),
+    CASE(quat_multiply_batch, BATCH), CASE(quat_normalize_batch, BATCH),
+    CASE(quat_to_mat4_batch, BATCH), CASE(quat_rotate_batch, BATCH),
+
+    CASE(mat3x4_from_mat4, 1), CASE(mat3x4_to_mat4, 1),
+    CASE(mat3x4_multiply, 1), CASE(mat3x4_inverse, 1),
+    CASE(mat3x4_transform_point, 1), CASE(mat3x4_transform_dir, 1),
+    CASE(mat3x4_multiply_array, BATCH / 16), CASE(mat3x4_inverse_batch, BATCH / 16),
+    CASE(mat3x4_transform_points, BATCH), CASE(mat3x4_transform_dirs, BATCH),
+
+    CASE(compose_trs, 1), CASE(compose_trs_chained, 1), CASE(decompose_trs, 1),
+    CASE(compose_trs_batch, BATCH), CASE(compose_trs_batch_3x4, BATCH),
+
+    CASE(frustum_planes_from_mat4, 1), CASE(frustum_sphere_visible, 1),
+    CASE(frustum_cull_spheres, BIG), CASE(frustum_cull_spheres_indices, BIG),
+    CASE(frustum_cull_aabbs, BIG), CASE(frustum_cull_aabbs_indices, BIG),
+
+    CASE(half_from_float, 1), CASE(half_from_float_array, BIG), CASE(half_to_float_array, BIG),
+    CASE(dmat4_multiply, 1), CASE(dmat4_inverse, 1), CASE(dmat4_to_mat4_relative, 1),
+
+    CASE(sincos, 1), CASE(fast_sincos, 1), CASE(tan, 1), CASE(fast_tan, 1),
+    CASE(vec3_normalize, 1), CASE(vec3_fast_normalize, 1),
+    CASE(rotate, 1), CASE(fast_rotate, 1), CASE(perspective, 1), CASE(fast_perspective, 1),
+    CASE(vec3_soa_normalize, BATCH), CASE(vec3_soa_fast_normalize, BATCH),
+    CASE(sincos_array, BATCH), CASE(fast_sincos_array, BATCH),
+
+    CASE(mat4_multiply_loop, BONES), CASE(mat4_multiply_pairs, BONES), CASE(mat4_multiply_pairs_a64, BONES), CASE(skin_vertices, BATCH),
+
+    CASE(mat4_transpose_staged, BATCH / 16), CASE(pack_mat4, BATCH / 16),
+    CASE(mat4_transpose_staged_big, BIG / 16), CASE(pack_mat4_big, BIG / 16),
+    CASE(pack_mat3_std140_big, BIG / 16), CASE(pack_vec3_std430, BATCH),
+
+    CASE(transform_batch_vec3a, BATCH), CASE(frame_malloc, 4), CASE(frame_arena, 4),
+    CASE(camera_uncached, 1), CASE(camera_still, 1), CASE(camera_moving, 1), CASE(camera_unproject, BATCH),
+
+    CASE(ray_triangles_loop, BATCH), CASE(ray_triangles_nearest, BATCH),
+    CASE(ray_aabbs, BATCH), CASE(ray_aabbs_nearest, BATCH), CASE(rays_triangle, BATCH), CASE(rays_aabb, BATCH),
+    CASE(bvh_build, BVH_N), CASE(bvh_build_parallel, BVH_N), CASE(bvh_refit, BVH_N),
+    CASE(ray_aabbs_nearest_linear, BVH_N), CASE(bvh_ray_nearest, 1), CASE(bvh_sphere, 1), CASE(bvh_nearest, 1),
+    CASE(floor_to_ivec3_loop, BATCH), CASE(vec3_floor_to_ivec3, BATCH),
+    CASE(ivec3_hash_loop, BATCH), CASE(ivec3_hash_batch, BATCH), CASE(ivec3_clamp_batch, BATCH),
+    CASE(morton3_encode_loop, BATCH), CASE(uvec3_to_morton, BATCH), CASE(morton_to_uvec3, BATCH), CASE(vec3_to_morton, BATCH),
+
+    CASE(transform_batch_big, BIG), CASE(transform_batch_parallel, BIG),
+    CASE(vec3_soa_normalize_big, BIG), CASE(vec3_soa_normalize_parallel, BIG),
+    CASE(mat4_multiply_array_big, BIG / 16), CASE(mat4_multiply_array_parallel, BIG / 16),
+    CASE(mat4_multiply_chain_big, BIG / 16 - 1), CASE(mat4_multiply_chain_parallel, BIG / 16 - 1),
+    CASE(skin_vertices_big, BIG / 4), CASE(skin_vertices_parallel, BIG / 4),
+    CASE(stream_stdio, BIG), CASE(stream_transform_file, BIG),
+};
+
+#define NUM_CASES (sizeof(cases) / sizeof(cases[0]))
+
+
+/* ----- Timing ----- */
+
+static double now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int cmp_double(const void* a, const void* b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Percentile of a sorted array, linear interpolation */
+static double percentile(const double* v, unsigned int n, double p){
+    double k = p * (n - 1);
+    unsigned int i = (unsigned int)k;
+    if(i + 1 >= n) return v[n - 1];
+    return v[i] + (v[i + 1] - v[i]) * (k - i);
+}
+
+static bench_result run_case(const bench_case* c, unsigned int reps){
+    const double target = 2e6; // ns per sample
+    double samples[256], t;
+    size_t iters = 1;
+    unsigned int r;
+
+    // calibrate, which also warms up caches and branch predictors
+    for(;;){
+        t = now_ns();
+        c->run(iters);
+        t = now_ns() - t;
+        if(t > target / 4 || iters > ((size_t)1 << 40)) break;
+        iters *= 2;
+    }
+    iters = (size_t)(iters * target / (t > 1 ? t : 1));
+    if(iters == 0) iters = 1;
+    c->run(iters);
+
+    for(r = 0; r != reps; ++r){
+        t = now_ns();
+        c->run(iters);
+        samples[r] = (now_ns() - t) / (double)iters;
+    }
+    qsort(samples, reps, sizeof(double), cmp_double);
+
+    bench_result res = {c->name, c->items,
+        percentile(samples, reps, 0.5),
+        percentile(samples, reps, 0.1),
+        percentile(samples, reps, 0.9)};
+    return res;
+}
+
+
+/* ----- Output ----- */
+
+static const char* mode_name(){
+#ifdef GLV_HEADER_ONLY
+    return "header-only";
+#else
+    return "library";
+#endif
+}
+
+static int write_json(const char* path, const bench_result* res, unsigned int n){
+    FILE* f = fopen(path, "w");
+    unsigned int i;
+    if(!f) return 0;
+    fprintf(f, "{\n  \"mode\": \"%s\",\n  \"simd\": \"%s\",\n  \"results\": [\n",
+        mode_name(), glv_simd_name(glv_simd_get_level()));
+    for(i = 0; i != n; ++i){
+        fprintf(f, "    {\"name\": \"%s\", \"items\": %zu, \"ns_per_op\": %.4f, "
+            "\"p10\": %.4f, \"p90\": %.4f, \"items_per_s\": %.6g}%s\n",
+            res[i].name, res[i].items, res[i].median, res[i].p10, res[i].p90,
+            res[i].items / res[i].median * 1e9, i + 1 == n ? "" : ",");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return 1;
+}
+
+/* Reads a whole file, NULL on failure */
+static char* read_file(const char* path){
+    FILE* f = fopen(path, "rb");
+    char* buf;
+    long len;
+    if(!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buf = malloc(len + 1);
+    if(buf && fread(buf, 1, len, f) != (size_t)len){
+        free(buf);
+        buf = NULL;
+    }
+    if(buf) buf[len] = '\0';
+    fclose(f);
+    return buf;
+}
+
+/* Looks up "ns_per_op" of a benchmark in a JSON file written by write_json */
+static double baseline_ns(const char* json, const char* name){
+    char key[128];
+    const char* p;
+    snprintf(key, sizeof(key), "\"name\": \"%s\"", name);
+    p = strstr(json, key);
+    if(!p) return -1.0;
+    p = strstr(p, "\"ns_per_op\":");
+    if(!p) return -1.0;
+    return atof(p + strlen("\"ns_per_op\":"));
+}
+
+
+int main(int argc, char** argv){
+    const char *filter = NULL, *json = NULL, *baseline = NULL;
+    double threshold = 10.0;
+    unsigned int reps = 15, i, n = 0, regressions = 0;
+    bench_result res[NUM_CASES];
+    char* base = NULL;
+    int a;
+
+    for(a = 1; a < argc; ++a){
+        if(!strcmp(argv[a], "--filter") && a + 1 < argc) filter = argv[++a];
+        else if(!strcmp(argv[a], "--json") && a + 1 < argc) json = argv[++a];
+        else if(!strcmp(argv[a], "--baseline") && a + 1 < argc) baseline = argv[++a];
+        else if(!strcmp(argv[a], "--threshold") && a + 1 < argc) threshold = atof(argv[++a]);
+        else if(!strcmp(argv[a], "--reps") && a + 1 < argc) reps = (unsigned int)atoi(argv[++a]);
+        else if(!strcmp(argv[a], "--simd") && a + 1 < argc){
+            const char* l = argv[++a];
+            glv_simd_level level = GLV_SIMD_SCALAR, k;
+            for(k = GLV_SIMD_SCALAR; k <= GLV_SIMD_AVX512; ++k){
+                const char* name = glv_simd_name(k);
+                size_t len = strlen(l);
+                if(!strncmp(l, name, len) && (name[len] == '\0' || name[len] == '+')) level = k;
+            }
+            glv_simd_set_level(level);
+        }
+        else{
+            fprintf(stderr, "usage: %s [--filter STR] [--simd LEVEL] [--reps N] "
+                "[--json FILE] [--baseline FILE] [--threshold PCT]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(reps < 1) reps = 1;
+    if(reps > 256) reps = 256;
+    if(baseline && !(base = read_file(baseline))){
+        fprintf(stderr, "cannot read baseline '%s'\n", baseline);
+        return 2;
+    }
+
+    setup();
+    printf("glvmath benchmarks (%s, simd %s, %u samples)\n",
+        mode_name(), glv_simd_name(glv_simd_get_level()), reps);
+    printf("%-24s %12s %12s %12s %14s", "name", "ns/op", "p10", "p90", "items/s");
+    printf(base ? " %10s\n" : "\n", "vs base");
+
+    for(i = 0; i != NUM_CASES; ++i){
+        if(filter && !strstr(cases[i].name, filter)) continue;
+        res[n] = run_case(&cases[i], reps);
+        printf("%-24s %12.3f %12.3f %12.3f %14.4g", res[n].name, res[n].median,
+            res[n].p10, res[n].p90, res[n].items / res[n].median * 1e9);
+        if(base){
+            double b = baseline_ns(base, res[n].name);
+            if(b > 0){
+                double change = (res[n].median / b - 1.0) * 100.0;
+                int bad = change > threshold;
+                regressions += bad;
+                printf(" %+9.1f%%%s", change, bad ? "  REGRESSION" : "");
+            }
+        }
+        printf("\n");
+        ++n;
+    }
+
+    remove(stream_in);
+    remove(stream_out);
+
+    if(json && !write_json(json, res, n)){
+        fprintf(stderr, "cannot write '%s'\n", json);
+        return 2;
+    }
+    free(base);
+    if(regressions){
+        printf("%u benchmark(s) regressed by more than %.1f%%\n", regressions, threshold);
+        return 1;
+    }
+    return 0;
+}
@@ -1,7 +1,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <errno.h>
+#include <pthread.h>
 
 #include "../include/glvmath.h"
 
@@ -180,6 +183,1843 @@ void testing_vec(){
 
 }
 
+/* Error of b against a, in ULPs of the largest partial product of the sum */
+float ulp_err(float a, float b, float max_term){
+    return fabsf(a - b) / (nextafterf(max_term, INFINITY) - max_term);
+}
+
+float randf(){
+    return (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+void testing_simd(){
+    printf("\n--- SIMD Backend Testing ---\n");
+    glv_simd_level best = glv_simd_detect(), level, l;
+    printf("Detected: %s, in use: %s\n", glv_simd_name(best), glv_simd_name(glv_simd_get_level()));
+
+    for(l = GLV_SIMD_SSE2; l <= best; ++l){
+        unsigned int t, i, j, k;
+        float mul_ulp = 0, tr_ulp = 0, d, p;
+        srand(1234);
+        for(t = 0; t != 1000; ++t){
+            glv_mat4 a, b, ref, res;
+            glv_vec4 v, vref, vres;
+            for(i = 0; i != 4; ++i){
+                v.data[i] = randf() * 10.0f;
+                for(j = 0; j != 4; ++j){
+                    a.data[i][j] = randf() * 10.0f;
+                    b.data[i][j] = randf() * 10.0f;
+                }
+            }
+            glv_simd_set_level(GLV_SIMD_SCALAR);
+            ref = glv_mat4_multiply(&a, &b);
+            vref = glv_transform(&v, &a);
+            level = glv_simd_set_level(l);
+            res = glv_mat4_multiply(&a, &b);
+            vres = glv_transform(&v, &a);
+            for(i = 0; i != 4; ++i){
+                for(p = 0, k = 0; k != 4; ++k) p = fmaxf(p, fabsf(v.data[k] * a.data[i][k]));
+                d = ulp_err(vref.data[i], vres.data[i], p);
+                if(d > tr_ulp) tr_ulp = d;
+                for(j = 0; j != 4; ++j){
+                    for(p = 0, k = 0; k != 4; ++k) p = fmaxf(p, fabsf(a.data[i][k] * b.data[k][j]));
+                    d = ulp_err(ref.data[i][j], res.data[i][j], p);
+                    if(d > mul_ulp) mul_ulp = d;
+                }
+            }
+        }
+        printf("%-9s max ULP vs scalar: multiply %.2f, transform %.2f\n",
+            glv_simd_name(level), mul_ulp, tr_ulp);
+    }
+    glv_simd_set_level(best);
+}
+
+void testing_batch(){
+    printf("\n--- Batch Transform Testing ---\n");
+    enum { N = 37 };
+    glv_vec4 v4[N], o4[N];
+    glv_vec3 v3[N], o3[N];
+    glv_mat4 m;
+    glv_simd_level best = glv_simd_detect(), l;
+    unsigned int i, j;
+
+    srand(42);
+    for(i = 0; i != 4; ++i){
+        for(j = 0; j != 4; ++j) m.data[i][j] = randf() * 4.0f;
+    }
+    for(i = 0; i != N; ++i){
+        for(j = 0; j != 4; ++j) v4[i].data[j] = randf() * 100.0f;
+        v3[i] = (glv_vec3){.x = v4[i].x, .y = v4[i].y, .z = v4[i].z};
+    }
+
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff4 = 0, diff3 = 0, diffs = 0;
+        glv_simd_set_level(l);
+        glv_transform_batch(v4, 0, o4, 0, N, &m);
+        for(i = 0; i != N; ++i){
+            glv_vec4 r = glv_transform(&v4[i], &m);
+            diff4 += memcmp(&r, &o4[i], sizeof(r)) != 0;
+        }
+        glv_transform_batch_vec3(v3, 0, o3, 0, N, &m);
+        for(i = 0; i != N; ++i){
+            glv_vec4 p = {.x = v3[i].x, .y = v3[i].y, .z = v3[i].z, .w = 1.0f};
+            glv_vec4 r = glv_transform(&p, &m);
+            diff3 += memcmp(&r, &o3[i], sizeof(o3[i])) != 0;
+        }
+        // xyz of each vec4 read as strided vec3, transformed in place
+        memcpy(o4, v4, sizeof(v4));
+        glv_transform_batch_vec3((glv_vec3*)o4, sizeof(glv_vec4), (glv_vec3*)o4, sizeof(glv_vec4), N, &m);
+        for(i = 0; i != N; ++i){
+            glv_vec4 p = {.x = v4[i].x, .y = v4[i].y, .z = v4[i].z, .w = 1.0f};
+            glv_vec4 r = glv_transform(&p, &m);
+            diffs += memcmp(&r, &o4[i], sizeof(glv_vec3)) != 0 || o4[i].w != v4[i].w;
+        }
+        printf("%-9s mismatches vs glv_transform: vec4 %u, vec3 %u, strided vec3 %u\n",
+            glv_simd_name(l), diff4, diff3, diffs);
+    }
+    glv_simd_set_level(best);
+}
+
+void testing_soa(){
+    printf("\n--- SoA Stream Testing ---\n");
+    enum { N = 45 };
+    glv_vec3 a[N], b[N], back[N];
+    glv_vec4 q[N], qback[N];
+    float ax[N], ay[N], az[N], bx[N], by[N], bz[N], cx[N], cy[N], cz[N];
+    float qx[N], qy[N], qz[N], qw[N], dot[N], mag[N];
+    glv_vec3_soa sa = {ax, ay, az}, sb = {bx, by, bz}, sc = {cx, cy, cz};
+    glv_vec4_soa sq = {qx, qy, qz, qw};
+    glv_simd_level best = glv_simd_detect(), l;
+    unsigned int i, j;
+
+    srand(7);
+    for(i = 0; i != N; ++i){
+        for(j = 0; j != 3; ++j){
+            a[i].data[j] = randf() * 10.0f;
+            b[i].data[j] = randf() * 10.0f;
+        }
+        for(j = 0; j != 4; ++j) q[i].data[j] = randf();
+    }
+
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_vec3_to_soa(a, N, &sa);
+        glv_vec3_to_soa(b, N, &sb);
+        glv_vec4_to_soa(q, N, &sq);
+        glv_vec3_from_soa(&sa, N, back);
+        glv_vec4_from_soa(&sq, N, qback);
+        diff += memcmp(a, back, sizeof(a)) != 0;
+        diff += memcmp(q, qback, sizeof(q)) != 0;
+
+        glv_vec3_soa_dot(&sa, &sb, dot, N);
+        glv_vec3_soa_cross(&sa, &sb, &sc, N);
+        glv_vec4_soa_magnitude(&sq, mag, N);
+        for(i = 0; i != N; ++i){
+            glv_vec3 c = glv_vec3_cross(&a[i], &b[i]);
+            diff += dot[i] != glv_vec3_dot(&a[i], &b[i]);
+            diff += cx[i] != c.x || cy[i] != c.y || cz[i] != c.z;
+            diff += mag[i] != glv_vec4_magnitude(&q[i]);
+        }
+        glv_vec3_soa_normalize(&sa, &sa, N);
+        for(i = 0; i != N; ++i){
+            glv_vec3 n = glv_vec3_normalize(&a[i]);
+            diff += ax[i] != n.x || ay[i] != n.y || az[i] != n.z;
+        }
+        printf("%-9s mismatches vs vec.h: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+
+    glv_vec3 x = {.x = 1.0f}, z = {.z = 1.0f};
+    glv_vec3 y = glv_vec3_cross(&z, &x);
+    printf("Z cross X (should be Y) = %f %f %f\n", y.x, y.y, y.z);
+}
+
+void testing_chain(){
+    printf("\n--- Matrix Chain Testing ---\n");
+    enum { N = 9 };
+    glv_mat4 mats[N], copy[N], chain, array, serial;
+    const glv_mat4* ptrs[N];
+    unsigned int i;
+
+    for(i = 0; i != N; ++i){
+        mats[i] = glv_mat4_identity();
+        mats[i] = glv_rotate(&mats[i], 0.1f * i, &(glv_vec3){.x = 1.0f, .y = (float)i, .z = 0.5f});
+        mats[i] = glv_translate(&mats[i], &(glv_vec3){.x = (float)i, .y = 1.0f, .z = -2.0f});
+        ptrs[i] = &mats[i];
+    }
+    memcpy(copy, mats, sizeof(mats));
+
+    serial = mats[0];
+    for(i = 1; i != N; ++i) serial = glv_mat4_multiply(&serial, &mats[i]);
+    glv_mat4_multiply_chain(ptrs, N, &chain);
+    glv_mat4_multiply_chain_array(mats, N, &array);
+    printf("Chain matches serial product: %s, array matches: %s, inputs untouched: %s\n",
+        memcmp(&chain, &serial, sizeof(serial)) == 0 ? "yes" : "no",
+        memcmp(&array, &serial, sizeof(serial)) == 0 ? "yes" : "no",
+        memcmp(copy, mats, sizeof(mats)) == 0 ? "yes" : "no");
+
+    glv_mat4 a = mats[0], p = glv_mat4_nmultiply(3, &a, &mats[1], &mats[2]);
+    printf("nmultiply leaves first operand untouched: %s\n",
+        memcmp(&a, &mats[0], sizeof(a)) == 0 ? "yes" : "no");
+    (void)p;
+
+    // long chain of small rotations, serial and in parallel
+    enum { L = 40000 };
+    glv_mat4* big = malloc(L * sizeof(glv_mat4));
+    const glv_mat4** bigp = malloc(L * sizeof(glv_mat4*));
+    glv_mat4 step = glv_mat4_identity(), par, par1, parp;
+    step = glv_rotate(&step, 1e-4f, &(glv_vec3){.x = 0.0f, .y = 0.0f, .z = 1.0f});
+    for(i = 0; i != L; ++i){
+        big[i] = step;
+        bigp[i] = &big[i];
+    }
+    glv_mat4_multiply_chain_array(big, L, &chain);
+    printf("%d rotations of 1e-4 rad: cos %f (expected %f)\n", L, chain.data[0][0], cosf(L * 1e-4f));
+    // the parallel result depends only on the input, not on the threads
+    glv_mat4_multiply_chain_array_parallel(big, L, &par1);
+    glv_pool_start(4);
+    glv_pool_set_min_items(1);
+    glv_mat4_multiply_chain_array_parallel(big, L, &par);
+    glv_mat4_multiply_chain_parallel(bigp, L, &parp);
+    glv_mat4_multiply_chain_parallel(bigp, 1000, &array);
+    glv_pool_stop();
+    glv_pool_set_min_items(GLV_POOL_MIN_ITEMS);
+    glv_mat4_multiply_chain(bigp, 1000, &serial);
+    printf("Parallel chain: same without the pool %s, pointers match %s, cos %f, short chain matches serial %s\n",
+        memcmp(&par, &par1, sizeof(par)) == 0 ? "yes" : "no", memcmp(&par, &parp, sizeof(par)) == 0 ? "yes" : "no",
+        par.data[0][0], memcmp(&array, &serial, sizeof(serial)) == 0 ? "yes" : "no");
+    free(big);
+    free(bigp);
+}
+
+void testing_inverse(){
+    printf("\n--- Inverse Testing ---\n");
+    glv_mat4 trs = glv_mat4_identity(), inv, aff, idn;
+    trs = glv_translate(&trs, &(glv_vec3){.x = 3.0f, .y = -2.0f, .z = 5.0f});
+    trs = glv_rotate(&trs, 0.7f, &(glv_vec3){.x = 1.0f, .y = 2.0f, .z = 0.5f});
+    trs = glv_scale(&trs, &(glv_vec3){.x = 2.0f, .y = 0.5f, .z = 1.5f});
+
+    inv = glv_mat4_inverse(&trs);
+    aff = glv_mat4_inverse_affine(&trs);
+    printf("TRS x Inverse: Identity\n");
+    idn = glv_mat4_multiply(&trs, &inv);
+    mat4print(&idn);
+    printf("TRS x Affine inverse: Identity\n");
+    idn = glv_mat4_multiply(&trs, &aff);
+    mat4print(&idn);
+
+    glv_mat3 m3 = {.data={{2.0,0.0,1.0},{1.0,3.0,0.0},{0.0,1.0,4.0}}};
+    glv_mat3 i3 = glv_mat3_inverse(&m3);
+    glv_mat3 p3 = glv_mat3_multiply(&m3, &i3);
+    printf("3x3 x Inverse: Identity\n");
+    mat3print(&p3);
+
+    glv_mat4 batch[3] = {trs, glv_mat4_diagonal(1.0f, 0.0f, 1.0f, 1.0f), glv_mat4_identity()};
+    unsigned char status[3];
+    size_t singular = glv_mat4_inverse_batch(batch, batch, 3, status);
+    printf("Batch: %zu singular, status %d %d %d, first matches single: %s\n",
+        singular, status[0], status[1], status[2],
+        memcmp(&batch[0], &inv, sizeof(inv)) == 0 ? "yes" : "no");
+}
+
+void testing_hierarchy(){
+    printf("\n--- Transform Hierarchy Testing ---\n");
+    enum { N = 64 };
+    unsigned int parent[N];
+    glv_vec3 t[N], s[N];
+    glv_mat3 r[N];
+    glv_mat4 local[N], world[N], ref[N];
+    unsigned char dirty[N];
+    glv_hierarchy h = {N, parent, t, r, s, local, world, dirty};
+    unsigned int i, diff;
+    size_t first, again, moved;
+
+    srand(99);
+    for(i = 0; i != N; ++i) parent[i] = i == 0 ? GLV_NODE_ROOT : (unsigned int)rand() % i;
+    glv_hierarchy_init(&h);
+    for(i = 0; i != N; ++i){
+        glv_hierarchy_set_translation(&h, i, &(glv_vec3){.x = randf(), .y = randf(), .z = randf()});
+        glv_hierarchy_set_rotation_axis(&h, i, randf(), &(glv_vec3){.x = randf(), .y = randf(), .z = 1.0f});
+        glv_hierarchy_set_scale(&h, i, &(glv_vec3){.x = 1.5f, .y = 1.0f, .z = 0.5f});
+    }
+    first = glv_hierarchy_update(&h);
+    again = glv_hierarchy_update(&h);
+
+    // same matrices built with the chained builders
+    for(i = 0; i != N; ++i){
+        glv_mat4 m = glv_mat4_identity(), rot = glv_mat4_identity();
+        unsigned int j;
+        for(j = 0; j != 3; ++j){
+            rot.data[j][0] = r[i].data[j][0];
+            rot.data[j][1] = r[i].data[j][1];
+            rot.data[j][2] = r[i].data[j][2];
+        }
+        m = glv_translate(&m, &t[i]);
+        m = glv_mat4_multiply(&m, &rot);
+        m = glv_scale(&m, &s[i]);
+        ref[i] = parent[i] == GLV_NODE_ROOT ? m : glv_mat4_multiply(&ref[parent[i]], &m);
+    }
+    for(diff = 0, i = 0; i != N; ++i) diff += memcmp(&ref[i], &world[i], sizeof(glv_mat4)) != 0;
+    printf("Sorted: %d, first update %zu nodes, second %zu, mismatches vs builders: %u\n",
+        glv_hierarchy_is_sorted(&h), first, again, diff);
+
+    // moving node 1 only updates its subtree
+    size_t subtree = 0;
+    unsigned char in[N] = {0};
+    for(i = 1; i != N; ++i){
+        in[i] = i == 1 || (parent[i] != GLV_NODE_ROOT && in[parent[i]]);
+        subtree += in[i];
+    }
+    glv_hierarchy_set_translation(&h, 1, &(glv_vec3){.x = 10.0f, .y = 0.0f, .z = 0.0f});
+    moved = glv_hierarchy_update(&h);
+    for(i = 0; i != N; ++i) ref[i] = parent[i] == GLV_NODE_ROOT ? local[i] : glv_mat4_multiply(&ref[parent[i]], &local[i]);
+    for(diff = 0, i = 0; i != N; ++i) diff += memcmp(&ref[i], &world[i], sizeof(glv_mat4)) != 0;
+    printf("Moved node 1: %zu nodes updated (subtree size %zu), mismatches: %u\n", moved, subtree, diff);
+}
+
+void testing_pool(){
+    printf("\n--- Worker Pool Testing ---\n");
+    enum { N = 100003, M = 5001 };
+    glv_vec4* v4 = malloc(N * sizeof(glv_vec4));
+    glv_vec4* o4 = malloc(N * sizeof(glv_vec4));
+    glv_vec4* p4 = malloc(N * sizeof(glv_vec4));
+    glv_vec3* v3 = malloc(N * sizeof(glv_vec3));
+    glv_vec3* o3 = malloc(N * sizeof(glv_vec3));
+    glv_vec3* p3 = malloc(N * sizeof(glv_vec3));
+    float* f = malloc(9 * N * sizeof(float));
+    glv_mat4* ma = malloc(M * sizeof(glv_mat4));
+    glv_mat4* mo = malloc(M * sizeof(glv_mat4));
+    glv_mat4* mp = malloc(M * sizeof(glv_mat4));
+    glv_vec3_soa s = {f, f + N, f + 2 * N}, a = {f + 3 * N, f + 4 * N, f + 5 * N};
+    glv_vec3_soa b = {f + 6 * N, f + 7 * N, f + 8 * N};
+    glv_mat4 m;
+    unsigned int i, j, threads, diff = 0;
+
+    srand(3);
+    for(i = 0; i != 4; ++i){
+        for(j = 0; j != 4; ++j) m.data[i][j] = randf();
+    }
+    for(i = 0; i != N; ++i){
+        for(j = 0; j != 4; ++j) v4[i].data[j] = randf() * 10.0f;
+        v3[i] = (glv_vec3){.x = v4[i].x, .y = v4[i].y, .z = v4[i].z};
+        s.x[i] = v4[i].x; s.y[i] = v4[i].y; s.z[i] = v4[i].z;
+    }
+    for(i = 0; i != M; ++i){
+        for(j = 0; j != 16; ++j) ma[i].data[j / 4][j % 4] = randf();
+    }
+
+    glv_transform_batch(v4, 0, o4, 0, N, &m);
+    glv_transform_batch_vec3(v3, 0, o3, 0, N, &m);
+    glv_vec3_soa_normalize(&s, &a, N);
+    glv_mat4_multiply_array(&m, ma, mo, M);
+
+    threads = glv_pool_start(4);
+    glv_pool_set_min_items(1);
+    glv_transform_batch_parallel(v4, 0, p4, 0, N, &m);
+    glv_transform_batch_vec3_parallel(v3, 0, p3, 0, N, &m);
+    glv_vec3_soa_normalize_parallel(&s, &b, N);
+    glv_mat4_multiply_array_parallel(&m, ma, mp, M);
+    diff += memcmp(o4, p4, N * sizeof(glv_vec4)) != 0;
+    diff += memcmp(o3, p3, N * sizeof(glv_vec3)) != 0;
+    diff += memcmp(a.x, b.x, 3 * N * sizeof(float)) != 0;
+    diff += memcmp(mo, mp, M * sizeof(glv_mat4)) != 0;
+
+    // in place, repeated to exercise job hand-over
+    memcpy(p4, v4, N * sizeof(glv_vec4));
+    for(i = 0; i != 20; ++i) glv_transform_batch_parallel(p4, 0, p4, 0, N / 20, &m);
+    for(i = 0; i != N / 20; ++i){
+        glv_vec4 r = v4[i];
+        for(j = 0; j != 20; ++j) r = glv_transform(&r, &m);
+        diff += memcmp(&r, &p4[i], sizeof(r)) != 0;
+    }
+    glv_pool_stop();
+    glv_pool_set_min_items(GLV_POOL_MIN_ITEMS);
+
+    printf("Threads: %u, mismatches vs serial: %u, threads after stop: %u\n",
+        threads, diff, glv_pool_threads());
+    free(v4); free(o4); free(p4); free(v3); free(o3); free(p3);
+    free(f); free(ma); free(mo); free(mp);
+}
+
+void testing_quat(){
+    printf("\n--- Quaternion Testing ---\n");
+    enum { N = 23 };
+    const glv_vec3 axis = {.x = 0.3f, .y = -1.0f, .z = 0.6f}, v = {.x = 1.0f, .y = 2.0f, .z = 3.0f};
+    glv_quat q = glv_quat_axis_angle(0.9f, &axis), p, back;
+    glv_mat4 rq = glv_quat_to_mat4(&q), rm = glv_mat4_identity();
+    float err = 0.0f;
+    unsigned int i, j;
+
+    rm = glv_rotate(&rm, 0.9f, &axis);
+    for(i = 0; i != 4; ++i){
+        for(j = 0; j != 4; ++j) err = fmaxf(err, fabsf(rq.data[i][j] - rm.data[i][j]));
+    }
+    printf("Matrix vs glv_rotate: max error %.2e\n", err);
+
+    glv_vec3 a = glv_quat_rotate(&q, &v);
+    glv_vec4 b = glv_transform(&(glv_vec4){.x = v.x, .y = v.y, .z = v.z, .w = 1.0f}, &rm);
+    printf("Rotated vector: %f %f %f (glv_rotate: %f %f %f)\n", a.x, a.y, a.z, b.x, b.y, b.z);
+
+    back = glv_quat_from_mat4(&rm);
+    printf("From matrix: %f %f %f %f (original %f %f %f %f)\n",
+        back.x, back.y, back.z, back.w, q.x, q.y, q.z, q.w);
+
+    // composing as quaternions and as matrices
+    p = glv_quat_axis_angle(-0.4f, &(glv_vec3){.x = 1.0f, .y = 0.0f, .z = 0.0f});
+    glv_quat pq = glv_quat_multiply(&p, &q);
+    glv_mat4 rp = glv_quat_to_mat4(&p), rpq = glv_quat_to_mat4(&pq), prod = glv_mat4_multiply(&rp, &rq);
+    for(err = 0.0f, i = 0; i != 4; ++i){
+        for(j = 0; j != 4; ++j) err = fmaxf(err, fabsf(rpq.data[i][j] - prod.data[i][j]));
+    }
+    glv_quat inv = glv_quat_inverse(&q), one = glv_quat_multiply(&q, &inv);
+    printf("Composition vs matrix product: max error %.2e, q x q^-1 = %f %f %f %f\n",
+        err, one.x, one.y, one.z, one.w);
+
+    glv_quat s0 = glv_quat_slerp(&p, &q, 0.0f), s1 = glv_quat_slerp(&p, &q, 1.0f);
+    glv_quat h = glv_quat_slerp(&p, &q, 0.5f), n = glv_quat_nlerp(&p, &q, 0.5f);
+    printf("Slerp ends match: %s, midpoint slerp %f %f %f %f, nlerp %f %f %f %f\n",
+        fabsf(glv_quat_dot(&s0, &p)) > 0.9999f && fabsf(glv_quat_dot(&s1, &q)) > 0.9999f ? "yes" : "no",
+        h.x, h.y, h.z, h.w, n.x, n.y, n.z, n.w);
+
+    glv_quat qa[N], qb[N], qo[N], qn[N];
+    glv_mat4 mo[N];
+    glv_vec3 vi[N], vo[N];
+    glv_simd_level best = glv_simd_detect(), l;
+    srand(11);
+    for(i = 0; i != N; ++i){
+        for(j = 0; j != 4; ++j){
+            qa[i].data[j] = randf();
+            qb[i].data[j] = randf();
+        }
+        vi[i] = (glv_vec3){.x = randf(), .y = randf(), .z = randf()};
+    }
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_quat_multiply_batch(qa, qb, qo, N);
+        glv_quat_normalize_batch(qa, qn, N);
+        glv_quat_to_mat4_batch(qn, mo, N);
+        for(i = 0; i != N; ++i){
+            glv_quat r = glv_quat_multiply(&qa[i], &qb[i]), u = glv_quat_normalize(&qa[i]);
+            glv_mat4 m = glv_quat_to_mat4(&u);
+            diff += memcmp(&r, &qo[i], sizeof(r)) != 0;
+            diff += memcmp(&u, &qn[i], sizeof(u)) != 0;
+            diff += memcmp(&m, &mo[i], sizeof(m)) != 0;
+        }
+        glv_quat_rotate_batch(&q, vi, vo, N);
+        for(i = 0; i != N; ++i){
+            glv_vec3 r = glv_quat_rotate(&q, &vi[i]);
+            diff += fabsf(r.x - vo[i].x) + fabsf(r.y - vo[i].y) + fabsf(r.z - vo[i].z) > 1e-5f;
+        }
+        printf("%-9s batch mismatches: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+}
+
+void testing_affine(){
+    printf("\n--- Affine 3x4 Testing ---\n");
+    enum { N = 17 };
+    glv_mat4 a4 = glv_mat4_identity(), b4 = glv_mat4_identity(), p4, i4, back;
+    glv_mat3x4 a, b, p, inv, arr[N], out[N];
+    glv_vec3 v = {.x = 1.0f, .y = -2.0f, .z = 0.5f}, pts[N], res[N];
+    float err = 0.0f;
+    unsigned int i, j;
+
+    a4 = glv_translate(&a4, &(glv_vec3){.x = 3.0f, .y = -2.0f, .z = 5.0f});
+    a4 = glv_rotate(&a4, 0.7f, &(glv_vec3){.x = 1.0f, .y = 2.0f, .z = 0.5f});
+    a4 = glv_scale(&a4, &(glv_vec3){.x = 2.0f, .y = 0.5f, .z = 1.5f});
+    b4 = glv_rotate(&b4, -1.1f, &(glv_vec3){.x = 0.0f, .y = 1.0f, .z = 1.0f});
+    b4 = glv_translate(&b4, &(glv_vec3){.x = -1.0f, .y = 4.0f, .z = 0.0f});
+    a = glv_mat3x4_from_mat4(&a4);
+    b = glv_mat3x4_from_mat4(&b4);
+    back = glv_mat3x4_to_mat4(&a);
+    printf("Round trip through mat3x4 lossless: %s, size %zu bytes\n",
+        memcmp(&back, &a4, sizeof(a4)) == 0 ? "yes" : "no", sizeof(glv_mat3x4));
+
+    p = glv_mat3x4_multiply(&a, &b);
+    p4 = glv_mat4_multiply(&a4, &b4);
+    inv = glv_mat3x4_inverse(&a);
+    i4 = glv_mat4_inverse_affine(&a4);
+    for(i = 0; i != 3; ++i){
+        for(j = 0; j != 4; ++j){
+            err = fmaxf(err, fabsf(p.data[i][j] - p4.data[i][j]));
+            err = fmaxf(err, fabsf(inv.data[i][j] - i4.data[i][j]));
+        }
+    }
+    glv_vec3 tp = glv_mat3x4_transform_point(&a, &v), td = glv_mat3x4_transform_dir(&a, &v);
+    glv_vec4 rp = glv_transform(&(glv_vec4){.x = v.x, .y = v.y, .z = v.z, .w = 1.0f}, &a4);
+    glv_vec4 rd = glv_transform(&(glv_vec4){.x = v.x, .y = v.y, .z = v.z, .w = 0.0f}, &a4);
+    err = fmaxf(err, fabsf(tp.x - rp.x) + fabsf(tp.y - rp.y) + fabsf(tp.z - rp.z));
+    err = fmaxf(err, fabsf(td.x - rd.x) + fabsf(td.y - rd.y) + fabsf(td.z - rd.z));
+    printf("Multiply, inverse and transforms vs mat4: max error %.2e\n", err);
+
+    glv_simd_level best = glv_simd_detect(), l;
+    srand(5);
+    for(i = 0; i != N; ++i){
+        for(j = 0; j != 12; ++j) arr[i].data[j / 4][j % 4] = randf();
+        pts[i] = (glv_vec3){.x = randf(), .y = randf(), .z = randf()};
+    }
+    arr[3] = (glv_mat3x4){0};
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        unsigned char status[N];
+        size_t singular;
+        glv_simd_set_level(l);
+        glv_mat3x4_multiply_array(&a, arr, out, N);
+        for(i = 0; i != N; ++i){
+            glv_mat3x4 r = glv_mat3x4_multiply(&a, &arr[i]);
+            diff += memcmp(&r, &out[i], sizeof(r)) != 0;
+        }
+        singular = glv_mat3x4_inverse_batch(arr, out, N, status);
+        diff += singular != 1 || status[3] != 0;
+        glv_mat3x4_transform_points(pts, 0, res, 0, N, &a);
+        for(i = 0; i != N; ++i){
+            glv_vec3 r = glv_mat3x4_transform_point(&a, &pts[i]);
+            diff += fabsf(r.x - res[i].x) + fabsf(r.y - res[i].y) + fabsf(r.z - res[i].z) > 1e-5f;
+        }
+        glv_mat3x4_transform_dirs(pts, 0, res, 0, N, &a);
+        for(i = 0; i != N; ++i){
+            glv_vec3 r = glv_mat3x4_transform_dir(&a, &pts[i]);
+            diff += fabsf(r.x - res[i].x) + fabsf(r.y - res[i].y) + fabsf(r.z - res[i].z) > 1e-5f;
+        }
+        printf("%-9s batch mismatches: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+}
+
+void testing_trs(){
+    printf("\n--- TRS Compose Testing ---\n");
+    enum { N = 19 };
+    float tx[N], ty[N], tz[N], qx[N], qy[N], qz[N], qw[N], sx[N], sy[N], sz[N];
+    glv_vec3_soa st = {tx, ty, tz}, ss = {sx, sy, sz};
+    glv_vec4_soa sr = {qx, qy, qz, qw};
+    glv_vec3 t = {.x = 3.0f, .y = -2.0f, .z = 5.0f}, s = {.x = 2.0f, .y = 0.5f, .z = 1.5f};
+    glv_vec3 dt, ds;
+    glv_quat r = glv_quat_axis_angle(0.7f, &(glv_vec3){.x = 1.0f, .y = 2.0f, .z = 0.5f}), dr;
+    glv_mat4 m, chain, rm, out[N];
+    glv_mat3x4 out34[N];
+    float err = 0.0f;
+    unsigned int i;
+
+    m = glv_compose_trs(&t, &r, &s);
+    chain = glv_mat4_identity();
+    chain = glv_translate(&chain, &t);
+    rm = glv_quat_to_mat4(&r);
+    chain = glv_mat4_multiply(&chain, &rm);
+    chain = glv_scale(&chain, &s);
+    printf("Compose identical to translate * rotate * scale: %s\n",
+        memcmp(&m, &chain, sizeof(m)) == 0 ? "yes" : "no");
+
+    // mirrored scale comes back on the x axis
+    s.y = -s.y;
+    m = glv_compose_trs(&t, &r, &s);
+    glv_decompose_trs(&m, &dt, &dr, &ds);
+    chain = glv_compose_trs(&dt, &dr, &ds);
+    for(i = 0; i != 16; ++i){
+        err = fmaxf(err, fabsf(m.data[i / 4][i % 4] - chain.data[i / 4][i % 4]));
+    }
+    printf("Decompose and recompose: max error %.2e, x scale %.2f\n", err, ds.x);
+
+    glv_simd_level best = glv_simd_detect(), l;
+    srand(6);
+    for(i = 0; i != N; ++i){
+        glv_quat q = glv_quat_axis_angle(randf() * 3.0f, &(glv_vec3){.x = randf(), .y = randf(), .z = randf()});
+        tx[i] = randf(); ty[i] = randf(); tz[i] = randf();
+        sx[i] = randf(); sy[i] = randf(); sz[i] = randf();
+        qx[i] = q.x; qy[i] = q.y; qz[i] = q.z; qw[i] = q.w;
+    }
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_compose_trs_batch(&st, &sr, &ss, out, N);
+        glv_compose_trs_batch_3x4(&st, &sr, &ss, out34, N);
+        for(i = 0; i != N; ++i){
+            glv_mat4 e = glv_compose_trs(&(glv_vec3){.x = tx[i], .y = ty[i], .z = tz[i]},
+                &(glv_quat){.x = qx[i], .y = qy[i], .z = qz[i], .w = qw[i]},
+                &(glv_vec3){.x = sx[i], .y = sy[i], .z = sz[i]});
+            diff += memcmp(&e, &out[i], sizeof(e)) != 0;
+            diff += memcmp(e.data, out34[i].data, sizeof(out34[i])) != 0;
+        }
+        printf("%-9s batch mismatches: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+}
+
+void testing_cull(){
+    printf("\n--- Frustum Culling Testing ---\n");
+    enum { N = 1029 };
+    static float cx[N], cy[N], cz[N], rad[N], ex[N], ey[N], ez[N];
+    static uint32_t mask[GLV_CULL_MASK_WORDS(N)], idx[N];
+    glv_vec3_soa c = {cx, cy, cz}, e = {ex, ey, ez};
+    glv_mat4 proj = glv_perspective(1.0f, 1.0f, 0.1f, 100.0f);
+    glv_mat4 view = glv_lookat(&(glv_vec3){.z = 5.0f}, &(glv_vec3){.z = 0.0f}, &(glv_vec3){.y = 1.0f});
+    glv_mat4 vp = glv_mat4_multiply(&proj, &view);
+    glv_frustum_planes f = glv_frustum_planes_from_mat4(&vp);
+    unsigned int i, clip_diff = 0;
+
+    printf("Visible: origin %d, behind %d, past far %d, off to the side %d, box across near %d\n",
+        glv_frustum_sphere_visible(&f, &(glv_vec3){.z = 0.0f}, 1.0f),
+        glv_frustum_sphere_visible(&f, &(glv_vec3){.z = 10.0f}, 1.0f),
+        glv_frustum_sphere_visible(&f, &(glv_vec3){.z = -200.0f}, 1.0f),
+        glv_frustum_sphere_visible(&f, &(glv_vec3){.x = 50.0f}, 1.0f),
+        glv_frustum_aabb_visible(&f, &(glv_vec3){.z = 5.0f}, &(glv_vec3){.x = 1.0f, .y = 1.0f, .z = 1.0f}));
+
+    // points against the clip space definition of the frustum
+    srand(7);
+    for(i = 0; i != N; ++i){
+        glv_vec4 p = {.x = randf() * 60.0f, .y = randf() * 60.0f, .z = randf() * 60.0f, .w = 1.0f};
+        glv_vec4 q = glv_transform(&p, &vp);
+        int inside = fabsf(q.x) <= q.w && fabsf(q.y) <= q.w && fabsf(q.z) <= q.w;
+        clip_diff += inside != glv_frustum_sphere_visible(&f, &(glv_vec3){.x = p.x, .y = p.y, .z = p.z}, 0.0f);
+        cx[i] = p.x; cy[i] = p.y; cz[i] = p.z;
+        rad[i] = fabsf(randf()) * 5.0f;
+        ex[i] = fabsf(randf()) * 5.0f; ey[i] = fabsf(randf()) * 5.0f; ez[i] = fabsf(randf()) * 5.0f;
+    }
+    printf("Points disagreeing with clip space: %u\n", clip_diff);
+
+    glv_simd_level best = glv_simd_detect(), l;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0, k;
+        size_t count, listed, visible = 0;
+        glv_simd_set_level(l);
+        count = glv_frustum_cull_spheres(&f, &c, rad, N, mask);
+        listed = glv_frustum_cull_spheres_indices(&f, &c, rad, N, idx);
+        for(i = 0, k = 0; i != N; ++i){
+            int v = glv_frustum_sphere_visible(&f, &(glv_vec3){.x = cx[i], .y = cy[i], .z = cz[i]}, rad[i]);
+            visible += v;
+            diff += v != (int)((mask[i / 32] >> (i % 32)) & 1);
+            if(v) diff += k >= listed || idx[k++] != i;
+        }
+        diff += count != visible || listed != visible;
+        count = glv_frustum_cull_aabbs(&f, &c, &e, N, mask);
+        listed = glv_frustum_cull_aabbs_indices(&f, &c, &e, N, idx);
+        for(i = 0, k = 0, visible = 0; i != N; ++i){
+            int v = glv_frustum_aabb_visible(&f, &(glv_vec3){.x = cx[i], .y = cy[i], .z = cz[i]},
+                &(glv_vec3){.x = ex[i], .y = ey[i], .z = ez[i]});
+            visible += v;
+            diff += v != (int)((mask[i / 32] >> (i % 32)) & 1);
+            if(v) diff += k >= listed || idx[k++] != i;
+        }
+        diff += count != visible || listed != visible;
+        diff += (mask[N / 32] >> (N % 32)) != 0;
+        printf("%-9s batch mismatches: %u (%zu boxes visible)\n", glv_simd_name(l), diff, count);
+    }
+    glv_simd_set_level(best);
+}
+
+void testing_half(){
+    printf("\n--- Half Precision Testing ---\n");
+    enum { N = 4099 };
+    static glv_half all[65536], back[N];
+    static float f[65536], g[N];
+    unsigned int i, diff = 0;
+
+    // every half value through the scalar conversions and back
+    for(i = 0; i != 65536; ++i){
+        glv_half h = (glv_half)i;
+        float v = glv_half_to_float(h);
+        all[i] = h;
+        if(v == v) diff += glv_half_from_float(v) != h;
+        else diff += glv_half_from_float(v) != (h | 0x200);
+    }
+    printf("Round trip of all 65536 halves, mismatches: %u\n", diff);
+    printf("65504 -> %.1f, 65520 -> %.1f, 2^-24 -> %.3g, 1/3 -> %.6f\n",
+        glv_half_to_float(glv_half_from_float(65504.0f)), glv_half_to_float(glv_half_from_float(65520.0f)),
+        glv_half_to_float(glv_half_from_float(5.9604645e-8f)), glv_half_to_float(glv_half_from_float(1.0f / 3.0f)));
+
+    glv_simd_level best = glv_simd_detect(), l;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        glv_vec3 v[3], vb[3];
+        glv_hvec3 hv[3];
+        glv_simd_set_level(l);
+        diff = 0;
+        glv_half_to_float_array(all, f, 65536);
+        for(i = 0; i != 65536; ++i){
+            float e = glv_half_to_float(all[i]);
+            diff += memcmp(&e, &f[i], sizeof(e)) != 0;
+        }
+        // random bit patterns, including NaNs, subnormals and overflows
+        srand(8);
+        for(i = 0; i != N; ++i){
+            uint32_t x = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+            memcpy(&g[i], &x, sizeof(x));
+        }
+        glv_half_from_float_array(g, back, N);
+        for(i = 0; i != N; ++i) diff += back[i] != glv_half_from_float(g[i]);
+        for(i = 0; i != 3; ++i) v[i] = (glv_vec3){.x = randf(), .y = randf(), .z = randf()};
+        glv_vec3_to_hvec3(v, hv, 3);
+        glv_hvec3_to_vec3(hv, vb, 3);
+        for(i = 0; i != 3; ++i) diff += fabsf(v[i].x - vb[i].x) > 1e-3f || hv[i].z != glv_half_from_float(v[i].z);
+        printf("%-9s batch mismatches: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+}
+
+void testing_double(){
+    printf("\n--- Double Precision Testing ---\n");
+    glv_dmat4 a = glv_dmat4_identity(), b, p, inv;
+    glv_dvec3 far = {.x = 1.0e7 + 0.123, .y = -2.0e7 + 0.456, .z = 0.5};
+    glv_dvec3 eye = {.x = 1.0e7, .y = -2.0e7, .z = 0.0};
+    glv_vec3 rel;
+    double err = 0.0;
+    unsigned int i, j;
+
+    a = glv_dtranslate(&a, &far);
+    a = glv_drotate(&a, 0.7, &(glv_dvec3){.x = 1.0, .y = 2.0, .z = 0.5});
+    a = glv_dscale(&a, &(glv_dvec3){.x = 2.0, .y = 0.5, .z = 1.5});
+    inv = glv_dmat4_inverse(&a);
+    p = glv_dmat4_multiply(&a, &inv);
+    for(i = 0; i != 4; ++i){
+        for(j = 0; j != 4; ++j) err = fmax(err, fabs(p.data[i][j] - (i == j)));
+    }
+    inv = glv_dmat4_inverse_affine(&a);
+    p = glv_dmat4_multiply(&inv, &a);
+    for(i = 0; i != 4; ++i){
+        for(j = 0; j != 4; ++j) err = fmax(err, fabs(p.data[i][j] - (i == j)));
+    }
+    printf("M * inverse(M) at 1e7 from the origin: max error %.2e, det %.4f\n", err, glv_dmat4_determinant(&a));
+
+    // camera-relative conversion keeps the sub-millimetre part
+    glv_mat4 f = glv_dmat4_to_mat4_relative(&a, &eye);
+    glv_dvec3_to_vec3_relative(&far, &eye, &rel, 1);
+    printf("Relative translation %.4f %.4f %.4f, position %.4f %.4f %.4f\n",
+        f.data[0][3], f.data[1][3], f.data[2][3], rel.x, rel.y, rel.z);
+
+    glv_simd_level best = glv_simd_detect(), l;
+    srand(9);
+    for(i = 0; i != 16; ++i) b.data[i / 4][i % 4] = randf() * 1.0e6;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        glv_dmat4 r;
+        glv_simd_set_level(l);
+        r = glv_dmat4_multiply(&a, &b);
+        if(l == GLV_SIMD_SCALAR) p = r;
+        printf("%-9s multiply mismatches vs scalar: %d\n", glv_simd_name(l), memcmp(&r, &p, sizeof(r)) != 0);
+    }
+    glv_simd_set_level(best);
+
+    // same results as the float versions, up to float rounding
+    glv_vec3 fe = {.x = 3.0f, .y = 2.0f, .z = 5.0f}, fc = {.x = 0.0f, .y = 0.5f, .z = -1.0f}, fu = {.x = 0.0f, .y = 1.0f, .z = 0.0f};
+    glv_dvec3 de = {.x = fe.x, .y = fe.y, .z = fe.z}, dc = {.x = fc.x, .y = fc.y, .z = fc.z}, du = {.x = fu.x, .y = fu.y, .z = fu.z};
+    glv_mat4 fm[7], fb = glv_dmat4_to_mat4(&b);
+    glv_dmat4 dm[7], db = glv_mat4_to_dmat4(&fb);
+    fm[0] = glv_lookat(&fe, &fc, &fu);                 dm[0] = glv_dlookat(&de, &dc, &du);
+    fm[1] = glv_ortho(-2.0f, 3.0f, -1.0f, 1.5f, 0.125f, 50.0f);
+    dm[1] = glv_dortho(-2.0, 3.0, -1.0, 1.5, 0.125, 50.0);
+    fm[2] = glv_frustum(-1.0f, 2.0f, -0.5f, 1.0f, 0.125f, 50.0f);
+    dm[2] = glv_dfrustum(-1.0, 2.0, -0.5, 1.0, 0.125, 50.0);
+    fm[3] = glv_perspective(0.875f, 1.5f, 0.125f, 100.0f); dm[3] = glv_dperspective(0.875, 1.5, 0.125, 100.0);
+    fm[4] = glv_ortho2D(-2.0f, 3.0f, -1.0f, 1.5f);     dm[4] = glv_dortho2D(-2.0, 3.0, -1.0, 1.5);
+    fm[5] = glv_mat4_cofactors(&fm[0]);                dm[5] = glv_dmat4_cofactors(&dm[0]);
+    fm[6] = glv_mat4_nmultiply(3, &fm[3], &fm[0], &fm[1]);
+    dm[6] = glv_dmat4_nmultiply(3, &dm[3], &dm[0], &dm[1]);
+    err = 0.0;
+    for(i = 0; i != 7; ++i){
+        for(j = 0; j != 16; ++j){
+            err = fmax(err, fabs(fm[i].data[j / 4][j % 4] - dm[i].data[j / 4][j % 4]) / fmax(1.0, fabs(dm[i].data[j / 4][j % 4])));
+        }
+    }
+    for(j = 0; j != 16; ++j){
+        err = fmax(err, fabs(glv_mat4_minor(&fm[0], j / 4, j % 4) - glv_dmat4_minor(&dm[0], j / 4, j % 4)));
+    }
+    p = glv_dmat4_nmultiply(3, &dm[3], &dm[0], &dm[1]);
+    inv = glv_dmat4_multiply(&dm[3], &dm[0]);
+    inv = glv_dmat4_multiply(&inv, &dm[1]);
+    glv_dmat4 dt = glv_dmat4_transpose(&db);
+    glv_mat4 ft = glv_mat4_transpose(&fb), fr = glv_dmat4_to_mat4(&dt);
+    printf("Builders, minors, cofactors and nmultiply vs float: max error %.1e, nmultiply exact %d, transpose exact %d\n",
+        err, !memcmp(&p, &inv, sizeof(p)), !memcmp(&ft, &fr, sizeof(ft)));
+
+    glv_vec4 fv = {.x = 0.3f, .y = -1.2f, .z = 2.5f, .w = 1.0f}, fw = {.x = -0.7f, .y = 0.4f, .z = 1.1f, .w = 0.5f};
+    glv_dvec4 dv = {.x = fv.x, .y = fv.y, .z = fv.z, .w = fv.w}, dw = {.x = fw.x, .y = fw.y, .z = fw.z, .w = fw.w};
+    glv_vec4 ftv = glv_transform(&fv, &fm[0]), fn4 = glv_vec4_normalize(&fv);
+    glv_dvec4 dtv = glv_dtransform(&dv, &dm[0]), dn4 = glv_dvec4_normalize(&dv);
+    glv_vec3 fv3 = {.x = fv.x, .y = fv.y, .z = fv.z}, fw3 = {.x = fw.x, .y = fw.y, .z = fw.z};
+    glv_dvec3 dv3 = {.x = dv.x, .y = dv.y, .z = dv.z}, dw3 = {.x = dw.x, .y = dw.y, .z = dw.z};
+    glv_vec3 fx = glv_vec3_cross(&fv3, &fw3), fn3 = glv_vec3_normalize(&fv3);
+    glv_dvec3 dx = glv_dvec3_cross(&dv3, &dw3), dn3 = glv_dvec3_normalize(&dv3);
+    glv_vec2 fv2 = {.x = fv.x, .y = fv.y}, fw2 = {.x = fw.x, .y = fw.y}, fn2 = glv_vec2_normalize(&fv2);
+    glv_dvec2 dv2 = {.x = dv.x, .y = dv.y}, dw2 = {.x = dw.x, .y = dw.y}, dn2 = glv_dvec2_normalize(&dv2);
+    const double pairs[][2] = {
+        {ftv.x, dtv.x}, {ftv.y, dtv.y}, {ftv.z, dtv.z}, {ftv.w, dtv.w},
+        {glv_vec2_magnitude(&fv2), glv_dvec2_magnitude(&dv2)}, {glv_vec3_magnitude(&fv3), glv_dvec3_magnitude(&dv3)},
+        {glv_vec4_magnitude(&fv), glv_dvec4_magnitude(&dv)},
+        {fn2.x, dn2.x}, {fn2.y, dn2.y}, {fn3.x, dn3.x}, {fn3.y, dn3.y}, {fn3.z, dn3.z},
+        {fn4.x, dn4.x}, {fn4.y, dn4.y}, {fn4.z, dn4.z}, {fn4.w, dn4.w},
+        {glv_vec2_dot(&fv2, &fw2), glv_dvec2_dot(&dv2, &dw2)}, {glv_vec3_dot(&fv3, &fw3), glv_dvec3_dot(&dv3, &dw3)},
+        {glv_vec4_dot(&fv, &fw), glv_dvec4_dot(&dv, &dw)}, {fx.x, dx.x}, {fx.y, dx.y}, {fx.z, dx.z},
+    };
+    err = 0.0;
+    for(i = 0; i != sizeof(pairs) / sizeof(pairs[0]); ++i) err = fmax(err, fabs(pairs[i][0] - pairs[i][1]));
+    printf("Transform and vector functions vs float: max error %.1e\n", err);
+}
+
+void testing_fast(){
+    printf("\n--- Fast Approximate Math Testing ---\n");
+    enum { N = 1003, SAMPLES = 200000 };
+    static float x[N], y[N], z[N], ox[N], oy[N], oz[N];
+    glv_vec3_soa v = {x, y, z}, o = {ox, oy, oz};
+    double e_rsqrt = 0, e_rcp = 0, e_sin = 0, e_cos = 0, e_tan = 0, e_norm = 0, e_mat = 0;
+    unsigned int i, j;
+
+    srand(10);
+    for(i = 0; i != SAMPLES; ++i){
+        // positive floats over the whole exponent range but the extremes
+        float a = ldexpf(1.0f + fabsf(randf()), (int)(i % 240) - 120);
+        float t = randf() * GLV_FAST_TRIG_RANGE, q = randf() * 1.5f;
+        e_rsqrt = fmax(e_rsqrt, fabs(glv_fast_rsqrt(a) * sqrt((double)a) - 1.0));
+        e_rcp = fmax(e_rcp, fabs(glv_fast_rcp(a) * (double)a - 1.0));
+        e_sin = fmax(e_sin, fabs(glv_fast_sin(t) - sin((double)t)));
+        e_cos = fmax(e_cos, fabs(glv_fast_cos(t) - cos((double)t)));
+        e_tan = fmax(e_tan, fabs(glv_fast_tan(q) / tan((double)q) - 1.0));
+        glv_vec3 w = {.x = randf(), .y = randf(), .z = randf()};
+        w = glv_vec3_fast_normalize(&w);
+        e_norm = fmax(e_norm, fabs(sqrt((double)w.x * w.x + (double)w.y * w.y + (double)w.z * w.z) - 1.0));
+    }
+    printf("Max error: rsqrt %.1e, rcp %.1e, sin %.1e, cos %.1e, tan %.1e, normalize %.1e\n",
+        e_rsqrt, e_rcp, e_sin, e_cos, e_tan, e_norm);
+    printf("Within documented bounds: %s\n", e_rsqrt <= 4e-7 && e_rcp <= 4e-7 && e_sin <= 2e-7
+        && e_cos <= 2e-7 && e_tan <= 4e-7 && e_norm <= 4e-7 ? "yes" : "no");
+
+    glv_mat4 id = glv_mat4_identity();
+    glv_vec3 axis = {.x = 1.0f, .y = 2.0f, .z = 0.5f};
+    glv_mat4 r1 = glv_rotate(&id, 2.5f, &axis), r2 = glv_fast_rotate(&id, 2.5f, &axis);
+    glv_mat4 p1 = glv_perspective(1.0f, 1.5f, 0.1f, 100.0f), p2 = glv_fast_perspective(1.0f, 1.5f, 0.1f, 100.0f);
+    glv_mat4 f1 = glv_frustum(-1.0f, 2.0f, -0.5f, 1.0f, 0.1f, 50.0f), f2 = glv_fast_frustum(-1.0f, 2.0f, -0.5f, 1.0f, 0.1f, 50.0f);
+    for(i = 0; i != 4; ++i){
+        for(j = 0; j != 4; ++j){
+            e_mat = fmax(e_mat, fabs(r1.data[i][j] - r2.data[i][j]));
+            e_mat = fmax(e_mat, fabs(p1.data[i][j] - p2.data[i][j]) / fmax(1.0, fabs(p1.data[i][j])));
+            e_mat = fmax(e_mat, fabs(f1.data[i][j] - f2.data[i][j]) / fmax(1.0, fabs(f1.data[i][j])));
+        }
+    }
+    printf("Rotate, perspective and frustum vs precise: max error %.1e\n", e_mat);
+
+    glv_simd_level best = glv_simd_detect(), l;
+    for(i = 0; i != N; ++i){
+        x[i] = randf() * 10.0f; y[i] = randf(); z[i] = randf() * 0.1f;
+    }
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_vec3_soa_fast_normalize(&v, &o, N);
+        for(i = 0; i != N; ++i){
+            glv_vec3 e = glv_vec3_fast_normalize(&(glv_vec3){.x = x[i], .y = y[i], .z = z[i]});
+            diff += e.x != ox[i] || e.y != oy[i] || e.z != oz[i];
+        }
+        printf("%-9s batch mismatches: %u\n", glv_simd_name(l), diff);
+    }
+    for(i = 0; i != N; ++i){
+        x[i] = randf() * GLV_FAST_TRIG_RANGE;
+    }
+    x[0] = 0.0f; x[1] = -0.0f; x[2] = 0.78539816f; x[3] = -2.3561945f;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_fast_sincos_array(x, ox, oy, N);
+        for(i = 0; i != N; ++i){
+            float s, c;
+            glv_fast_sincos(x[i], &s, &c);
+            diff += memcmp(&s, &ox[i], sizeof(s)) != 0 || memcmp(&c, &oy[i], sizeof(c)) != 0;
+        }
+        printf("%-9s sincos array mismatches: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+}
+
+/* Interleaved vertex as a mesh loader would produce it */
+typedef struct {
+    glv_vec3 position, normal;
+    uint16_t joints[4];
+    float weights[4];
+} skin_vertex;
+
+void testing_skin(){
+    printf("\n--- Skinning Testing ---\n");
+    enum { BONES = 64, N = 1001 };
+    static glv_mat4 world[BONES], bind[BONES], palette[BONES], pairs[BONES];
+    static skin_vertex vert[N];
+    static glv_vec3 pos[N], nrm[N], ref_pos[N], ref_nrm[N];
+    glv_skin_stream st = {
+        .count = N,
+        .position = &vert[0].position, .position_stride = sizeof(skin_vertex),
+        .normal = &vert[0].normal, .normal_stride = sizeof(skin_vertex),
+        .joints = vert[0].joints, .joints_stride = sizeof(skin_vertex),
+        .weights = vert[0].weights, .weights_stride = sizeof(skin_vertex),
+        .out_position = pos, .out_normal = nrm
+    };
+    double err = 0.0;
+    unsigned int i, j, k, q;
+
+    srand(17);
+    for(i = 0; i != BONES; ++i){
+        glv_vec3 t = {.x = randf(), .y = randf(), .z = randf()};
+        glv_vec3 axis = {.x = randf(), .y = randf(), .z = 1.0f};
+        glv_mat4 id = glv_mat4_identity();
+        world[i] = glv_translate(&id, &t);
+        world[i] = glv_rotate(&world[i], randf() * 3.0f, &axis);
+        bind[i] = glv_translate(&id, &(glv_vec3){.x = -t.y, .y = t.z, .z = t.x});
+    }
+    for(i = 0; i != N; ++i){
+        float w[4] = {fabsf(randf()), fabsf(randf()), fabsf(randf()), 0.0f}, sum;
+        if(i % 3 == 0) w[3] = fabsf(randf());
+        sum = w[0] + w[1] + w[2] + w[3];
+        vert[i].position = (glv_vec3){.x = randf() * 2.0f, .y = randf() * 2.0f, .z = randf() * 2.0f};
+        vert[i].normal = glv_vec3_normalize(&(glv_vec3){.x = randf(), .y = randf(), .z = 1.0f});
+        for(k = 0; k != 4; ++k){
+            vert[i].joints[k] = (uint16_t)(rand() % BONES);
+            vert[i].weights[k] = w[k] / sum;
+        }
+    }
+
+    // palette, checked against single products at every level
+    glv_simd_level best = glv_simd_detect(), l;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_mat4_multiply_pairs(world, bind, palette, BONES);
+        memcpy(pairs, world, sizeof(pairs));
+        glv_mat4_multiply_pairs(pairs, bind, pairs, BONES);
+        for(i = 0; i != BONES; ++i){
+            glv_mat4 p = glv_mat4_multiply(&world[i], &bind[i]);
+            diff += memcmp(&p, &palette[i], sizeof(p)) != 0;
+            diff += memcmp(&p, &pairs[i], sizeof(p)) != 0;
+        }
+        printf("%-9s palette mismatches vs glv_mat4_multiply: %u\n", glv_simd_name(l), diff);
+    }
+
+    // double-precision reference
+    for(i = 0; i != N; ++i){
+        double rp[3] = {0}, rn[3] = {0};
+        for(q = 0; q != 4; ++q){
+            const glv_mat4* m = &palette[vert[i].joints[q]];
+            for(j = 0; j != 3; ++j){
+                rp[j] += vert[i].weights[q] * ((double)m->data[j][0] * vert[i].position.x
+                    + (double)m->data[j][1] * vert[i].position.y + (double)m->data[j][2] * vert[i].position.z + m->data[j][3]);
+                rn[j] += vert[i].weights[q] * ((double)m->data[j][0] * vert[i].normal.x
+                    + (double)m->data[j][1] * vert[i].normal.y + (double)m->data[j][2] * vert[i].normal.z);
+            }
+        }
+        ref_pos[i] = (glv_vec3){.x = rp[0], .y = rp[1], .z = rp[2]};
+        ref_nrm[i] = (glv_vec3){.x = rn[0], .y = rn[1], .z = rn[2]};
+    }
+
+    glv_vec3 first_pos[N], first_nrm[N];
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_skin_vertices(&st, palette);
+        if(l == GLV_SIMD_SCALAR){
+            memcpy(first_pos, pos, sizeof(pos));
+            memcpy(first_nrm, nrm, sizeof(nrm));
+            for(i = 0; i != N; ++i){
+                for(j = 0; j != 3; ++j){
+                    err = fmax(err, fabs(pos[i].data[j] - ref_pos[i].data[j]));
+                    err = fmax(err, fabs(nrm[i].data[j] - ref_nrm[i].data[j]));
+                }
+            }
+        }
+        diff += memcmp(first_pos, pos, sizeof(pos)) != 0;
+        diff += memcmp(first_nrm, nrm, sizeof(nrm)) != 0;
+        printf("%-9s skinning mismatches vs scalar: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+    printf("Max error vs double: %.1e\n", err);
+
+    // in place over the interleaved buffer, positions only, serial then parallel
+    unsigned int diff = 0, threads;
+    for(i = 0; i != N; ++i) ref_pos[i] = vert[i].position;
+    st.normal = NULL;
+    st.out_normal = NULL;
+    st.out_position = &vert[0].position;
+    st.out_position_stride = sizeof(skin_vertex);
+    glv_skin_vertices(&st, palette);
+    for(i = 0; i != N; ++i){
+        diff += memcmp(&vert[i].position, &first_pos[i], sizeof(glv_vec3)) != 0;
+        vert[i].position = ref_pos[i];
+    }
+    printf("In place mismatches: %u\n", diff);
+
+    threads = glv_pool_start(4);
+    glv_pool_set_min_items(1);
+    glv_skin_vertices_parallel(&st, palette);
+    glv_pool_stop();
+    glv_pool_set_min_items(GLV_POOL_MIN_ITEMS);
+    diff = 0;
+    for(i = 0; i != N; ++i) diff += memcmp(&vert[i].position, &first_pos[i], sizeof(glv_vec3)) != 0;
+    printf("Threads: %u, parallel mismatches vs serial: %u\n", threads, diff);
+}
+
+/* Reference column-major writer, cs floats per written column */
+static void pack_reference(float* dst, const float* src, size_t count, unsigned int n, unsigned int c, unsigned int cs){
+    size_t i;
+    unsigned int row, col;
+    for(i = 0; i != count; ++i, src += n * c, dst += c * cs){
+        for(col = 0; col != c; ++col){
+            for(row = 0; row != cs; ++row) dst[col * cs + row] = row < n ? src[row * c + col] : 0.0f;
+        }
+    }
+}
+
+void testing_pack(){
+    printf("\n--- Buffer Packing Testing ---\n");
+    // large enough for the non-temporal path
+    enum { N = 8192 };
+    glv_mat4* m4 = malloc(N * sizeof(glv_mat4));
+    glv_mat3* m3 = malloc(N * sizeof(glv_mat3));
+    glv_mat2* m2 = malloc(N * sizeof(glv_mat2));
+    glv_vec3* v3 = malloc(N * sizeof(glv_vec3));
+    glv_vec2* v2 = malloc(N * sizeof(glv_vec2));
+    float* f = malloc(N * sizeof(float));
+    float* out = malloc(N * 128);
+    float* ref = malloc(N * 64);
+    const char* names[] = {"packed", "std140", "std430"};
+    unsigned int i, diff;
+    glv_layout lay;
+
+    srand(18);
+    for(i = 0; i != N * 16; ++i) m4[i / 16].data[i % 16 / 4][i % 4] = randf();
+    for(i = 0; i != N * 9; ++i) m3[i / 9].data[i % 9 / 3][i % 3] = randf();
+    for(i = 0; i != N * 4; ++i) m2[i / 4].data[i % 4 / 2][i % 2] = randf();
+    for(i = 0; i != N * 3; ++i) v3[i / 3].data[i % 3] = randf();
+    for(i = 0; i != N * 2; ++i) v2[i / 2].data[i % 2] = randf();
+    for(i = 0; i != N; ++i) f[i] = randf();
+
+    for(lay = GLV_LAYOUT_PACKED; lay <= GLV_LAYOUT_STD430; ++lay){
+        printf("%s strides: float %zu, vec2 %zu, vec3 %zu, mat2 %zu, mat3 %zu, mat4 %zu\n", names[lay],
+            glv_pack_stride(1, 1, lay), glv_pack_stride(2, 1, lay), glv_pack_stride(3, 1, lay),
+            glv_pack_stride(2, 2, lay), glv_pack_stride(3, 3, lay), glv_pack_stride(4, 4, lay));
+    }
+
+    glv_simd_level best = glv_simd_detect(), l;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        glv_simd_set_level(l);
+        diff = 0;
+        // a short array writes through the cache, the whole one streams
+        size_t counts[2] = {5, N}, k;
+        for(k = 0; k != 2; ++k){
+            const size_t n = counts[k];
+            glv_pack_mat4(out, 0, m4, n);
+            pack_reference(ref, m4->data[0], n, 4, 4, 4);
+            diff += memcmp(out, ref, n * 64) != 0;
+            for(lay = GLV_LAYOUT_PACKED; lay <= GLV_LAYOUT_STD430; ++lay){
+                size_t st;
+                st = glv_pack_mat3(out, 0, m3, n, lay);
+                pack_reference(ref, m3->data[0], n, 3, 3, (unsigned int)(st / 12));
+                diff += memcmp(out, ref, n * st) != 0;
+                st = glv_pack_mat2(out, 0, m2, n, lay);
+                pack_reference(ref, m2->data[0], n, 2, 2, (unsigned int)(st / 8));
+                diff += memcmp(out, ref, n * st) != 0;
+                st = glv_pack_vec3(out, 0, v3, n, lay);
+                pack_reference(ref, v3->data, n, 3, 1, (unsigned int)(st / 4));
+                diff += memcmp(out, ref, n * st) != 0;
+                st = glv_pack_vec2(out, 0, v2, n, lay);
+                pack_reference(ref, v2->data, n, 2, 1, (unsigned int)(st / 4));
+                diff += memcmp(out, ref, n * st) != 0;
+                st = glv_pack_float(out, 0, f, n, lay);
+                pack_reference(ref, f, n, 1, 1, (unsigned int)(st / 4));
+                diff += memcmp(out, ref, n * st) != 0;
+            }
+        }
+        printf("%-9s mismatches vs reference: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+
+    // members of a per-instance struct, the bytes between them untouched
+    typedef struct { float model[16]; float normal[12]; float tint[4]; } instance;
+    instance* inst = (instance*)out;
+    memset(out, 0xAB, N * sizeof(instance));
+    glv_pack_mat4(inst->model, sizeof(instance), m4, N);
+    glv_pack_mat3(inst->normal, sizeof(instance), m3, N, GLV_LAYOUT_STD140);
+    diff = 0;
+    for(i = 0; i != N; ++i){
+        float col[16], nrm[12];
+        unsigned char sentinel[16];
+        memset(sentinel, 0xAB, sizeof(sentinel));
+        pack_reference(col, m4[i].data[0], 1, 4, 4, 4);
+        pack_reference(nrm, m3[i].data[0], 1, 3, 3, 4);
+        diff += memcmp(inst[i].model, col, sizeof(col)) != 0;
+        diff += memcmp(inst[i].normal, nrm, sizeof(nrm)) != 0;
+        diff += memcmp(inst[i].tint, sentinel, sizeof(sentinel)) != 0;
+    }
+    printf("Strided into structs, mismatches: %u\n", diff);
+    free(m4); free(m3); free(m2); free(v3); free(v2); free(f); free(out); free(ref);
+}
+
+static void* profile_worker(void* arg){
+    glv_vec3 v = {.x=1.0f, .y=2.0f, .z=3.0f};
+    float sum = 0.0f;
+    int i;
+    for(i = 0; i != 1000; ++i) sum += glv_vec3_magnitude(&v);
+    *(float*)arg = sum;
+    return NULL;
+}
+
+static uint64_t profile_calls(const glv_profile_snapshot* s, const char* name){
+    size_t i;
+    for(i = 0; i != s->count; ++i){
+        if(strcmp(s->entries[i].name, name) == 0) return s->entries[i].calls;
+    }
+    return 0;
+}
+
+void testing_profile(){
+    printf("\n--- Profile Testing ---\n");
+    printf("profiling built in: %d\n", glv_profile_enabled());
+    if(!glv_profile_enabled()) return;
+
+    static glv_profile_snapshot snap;
+    glv_mat4 m = glv_rotate(&(glv_mat4){0}, 0.5f, &(glv_vec3){.x=0.0f, .y=1.0f, .z=0.0f});
+    m.data[3][3] = 1.0f;
+    int i;
+    glv_profile_reset();
+    glv_profile_set_timing(1);
+    for(i = 0; i != 100; ++i) m = glv_mat4_multiply(&m, &m);
+    for(i = 0; i != 10; ++i) m = glv_mat4_inverse(&m);
+
+    // each thread counts into its own block, summed by the snapshot
+    pthread_t threads[4];
+    float sums[4];
+    for(i = 0; i != 4; ++i) pthread_create(&threads[i], NULL, profile_worker, &sums[i]);
+    for(i = 0; i != 4; ++i) pthread_join(threads[i], NULL);
+    glv_profile_set_timing(0);
+
+    glv_profile_take(&snap);
+    printf("calls: glv_mat4_multiply %llu, glv_mat4_inverse %llu, glv_vec3_magnitude over 4 threads %llu\n",
+        (unsigned long long)profile_calls(&snap, "glv_mat4_multiply"),
+        (unsigned long long)profile_calls(&snap, "glv_mat4_inverse"),
+        (unsigned long long)profile_calls(&snap, "glv_vec3_magnitude"));
+    printf("timed: %d\n", snap.count > 0 && snap.entries[0].ticks > 0 && snap.ticks_per_second > 0.0);
+    glv_profile_write(&snap, stdout, GLV_PROFILE_TEXT);
+    glv_profile_write(&snap, stdout, GLV_PROFILE_JSON);
+
+    glv_profile_reset();
+    glv_profile_take(&snap);
+    printf("after reset: %zu functions\n", snap.count);
+}
+
+void testing_arena(){
+    printf("\n--- Arena and Aligned Types Testing ---\n");
+    printf("sizes: glv_vec3a %zu, glv_mat4a64 %zu; alignments %zu %zu %zu %zu\n",
+        sizeof(glv_vec3a), sizeof(glv_mat4a64), _Alignof(glv_vec3a),
+        _Alignof(glv_mat4a16), _Alignof(glv_mat4a32), _Alignof(glv_mat4a64));
+
+    // a buffer that is itself misaligned
+    static unsigned char memory[4096 + 8] GLV_ALIGNED(64);
+    glv_arena a;
+    glv_arena_init(&a, memory + 8, 4096);
+    glv_mat4a64* m = glv_arena_mat4(&a, 10);
+    glv_vec3a* p = glv_arena_vec3a(&a, 7);
+    float* f = glv_arena_float(&a, 3);
+    glv_vec4* v = glv_arena_vec4(&a, 5);
+    printf("aligned to %d: %d %d %d %d\n", GLV_ARENA_ALIGN, (int)((uintptr_t)m % GLV_ARENA_ALIGN),
+        (int)((uintptr_t)p % GLV_ARENA_ALIGN), (int)((uintptr_t)f % GLV_ARENA_ALIGN), (int)((uintptr_t)v % GLV_ARENA_ALIGN));
+    size_t used = a.used;
+    void* big = glv_arena_alloc(&a, 4096, 16);
+    void* huge = glv_arena_mat4(&a, SIZE_MAX / 2);
+    printf("too large: %s %s, used unchanged: %d\n", big ? "ok" : "NULL", huge ? "ok" : "NULL", a.used == used);
+    void* any = glv_arena_alloc(&a, 1, 0);
+    void* odd = glv_arena_alloc(&a, 1, 24);
+    printf("align 0: %s, align 24: %s\n", any == memory + 8 + used ? "at the cursor" : "moved", odd ? "ok" : "NULL");
+    glv_arena_release(&a, used);
+    size_t mark = glv_arena_mark(&a);
+    glv_vec3a* q = glv_arena_vec3a(&a, 16);
+    glv_arena_release(&a, mark);
+    printf("release returns the memory: %d\n", glv_arena_vec3a(&a, 16) == q);
+    glv_arena_reset(&a);
+    used = a.used;
+    printf("after reset: used %zu, peak %zu, first allocation reused %d\n", used, a.peak, glv_arena_mat4(&a, 1) == m);
+
+    // padded points give the same results as glv_transform_batch_vec3
+    enum { N = 1001 };
+    static glv_vec3 pts[N], ref[N];
+    static glv_vec3a in[N], out[N];
+    glv_mat4 t = glv_rotate(&(glv_mat4){0}, 0.7f, &(glv_vec3){.x=0.6f, .y=0.0f, .z=0.8f});
+    t.data[0][3] = 1.5f; t.data[1][3] = -2.0f; t.data[2][3] = 0.25f; t.data[3][3] = 1.0f;
+    unsigned int i;
+    srand(20);
+    for(i = 0; i != N; ++i){
+        pts[i] = (glv_vec3){.x = randf(), .y = randf(), .z = randf()};
+        in[i] = (glv_vec3a){.xyz = pts[i], .pad = 7.0f};
+    }
+    glv_simd_level best = glv_simd_get_level(), l;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_transform_batch_vec3(pts, 0, ref, 0, N, &t);
+        glv_transform_batch_vec3a(in, out, N, &t);
+        for(i = 0; i != N; ++i) diff += memcmp(&out[i].xyz, &ref[i], sizeof(glv_vec3)) != 0 || out[i].pad != 0.0f;
+        memcpy(out, in, sizeof(in));
+        glv_transform_batch_vec3a(out, out, N, &t);
+        for(i = 0; i != N; ++i) diff += memcmp(&out[i].xyz, &ref[i], sizeof(glv_vec3)) != 0;
+        printf("%-9s vec3a mismatches: %u\n", glv_simd_name(l), diff);
+    }
+
+    // aligned matrix batches give the same products as glv_mat4_multiply
+    enum { M = 13 };
+    glv_arena_reset(&a);
+    glv_mat4a64* ma = glv_arena_mat4(&a, M);
+    glv_mat4a64* mb = glv_arena_mat4(&a, M);
+    glv_mat4a64* mo = glv_arena_mat4(&a, M);
+    unsigned int j, k;
+    for(i = 0; i != M; ++i){
+        for(j = 0; j != GLV_MAT4_RANK; ++j){
+            for(k = 0; k != GLV_MAT4_RANK; ++k){
+                ma[i].data[j][k] = randf();
+                mb[i].data[j][k] = randf();
+            }
+        }
+    }
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+        glv_mat4_multiply_pairs_a64(ma, mb, mo, M);
+        for(i = 0; i != M; ++i){
+            glv_mat4 r = glv_mat4_multiply(&ma[i], &mb[i]);
+            diff += memcmp(&r, &mo[i], sizeof(r)) != 0;
+        }
+        glv_mat4_multiply_array_a64(&t, mb, mo, M);
+        for(i = 0; i != M; ++i){
+            glv_mat4 r = glv_mat4_multiply(&t, &mb[i]);
+            diff += memcmp(&r, &mo[i], sizeof(r)) != 0;
+        }
+        memcpy(mo, mb, M * sizeof(glv_mat4));
+        glv_mat4_multiply_pairs_a64(ma, mo, mo, M);
+        for(i = 0; i != M; ++i){
+            glv_mat4 r = glv_mat4_multiply(&ma[i], &mb[i]);
+            diff += memcmp(&r, &mo[i], sizeof(r)) != 0;
+        }
+        printf("%-9s mat4a64 batch mismatches: %u\n", glv_simd_name(l), diff);
+    }
+    glv_simd_set_level(best);
+}
+
+void testing_camera(){
+    printf("\n--- Camera Testing ---\n");
+    glv_vec3 eye = {.x=3.0f, .y=2.0f, .z=5.0f}, target = {.x=0.0f, .y=0.5f, .z=0.0f}, up = {.x=0.0f, .y=1.0f, .z=0.0f};
+    glv_camera cam;
+    glv_camera_init(&cam, &eye, &target, &up, 0.9f, 1.5f, 0.1f, 100.0f);
+
+    // results match the functions they replace
+    glv_mat4 view = glv_lookat(&eye, &target, &up);
+    glv_mat4 proj = glv_perspective(0.9f, 1.5f, 0.1f, 100.0f);
+    glv_mat4 vp = glv_mat4_multiply(&proj, &view);
+    glv_frustum_planes f = glv_frustum_planes_from_mat4(&vp);
+    printf("view, projection, view-projection, frustum match: %d %d %d %d\n",
+        !memcmp(glv_camera_view(&cam), &view, sizeof(view)), !memcmp(glv_camera_projection(&cam), &proj, sizeof(proj)),
+        !memcmp(glv_camera_view_projection(&cam), &vp, sizeof(vp)), !memcmp(glv_camera_frustum(&cam), &f, sizeof(f)));
+    const glv_mat4* inverses[3] = {glv_camera_inverse_view(&cam), glv_camera_inverse_projection(&cam),
+        glv_camera_inverse_view_projection(&cam)};
+    const glv_mat4* forward[3] = {&view, &proj, &vp};
+    float err = 0.0f;
+    int i, j, k;
+    for(k = 0; k != 3; ++k){
+        glv_mat4 id = glv_mat4_multiply(inverses[k], forward[k]);
+        for(i = 0; i != 4; ++i) for(j = 0; j != 4; ++j) err = fmaxf(err, fabsf(id.data[i][j] - (i == j)));
+    }
+    printf("inverse * matrix, max difference from identity: %.1e\n", err);
+
+    // setters only invalidate what depends on a changed value
+    printf("stale after getters: %#x\n", cam.stale);
+    glv_camera_set_view(&cam, &eye, &target, &up);
+    glv_camera_set_aspect(&cam, 1.5f);
+    printf("stale after unchanged setters: %#x\n", cam.stale);
+    eye.x = 4.0f;
+    glv_camera_set_view(&cam, &eye, &target, &up);
+    printf("stale after moving: %#x (projection kept: %d)\n", cam.stale,
+        !(cam.stale & (GLV_CAMERA_PROJECTION | GLV_CAMERA_INVERSE_PROJECTION)));
+    glv_camera_set_aspect(&cam, 2.0f);
+    printf("stale after resizing: %#x\n", cam.stale);
+
+    // window points back to the world points they came from
+    enum { N = 100 };
+    const glv_vec4 viewport = {.x=10.0f, .y=20.0f, .z=800.0f, .w=400.0f};
+    glv_vec3 world[N], win[N], back[N];
+    vp = *glv_camera_view_projection(&cam);
+    srand(21);
+    for(i = 0; i != N; ++i){
+        world[i] = (glv_vec3){.x = randf() * 2.0f, .y = randf() * 2.0f, .z = randf() * 2.0f};
+        glv_vec4 p = {.x = world[i].x, .y = world[i].y, .z = world[i].z, .w = 1.0f};
+        glv_vec4 c = glv_transform(&p, &vp);
+        win[i] = (glv_vec3){.x = viewport.x + (c.x / c.w + 1.0f) * 0.5f * viewport.z,
+            .y = viewport.y + (c.y / c.w + 1.0f) * 0.5f * viewport.w, .z = (c.z / c.w + 1.0f) * 0.5f};
+    }
+    glv_camera_unproject(&cam, &viewport, win, back, N);
+    err = 0.0f;
+    for(i = 0; i != N; ++i) for(j = 0; j != 3; ++j) err = fmaxf(err, fabsf(back[i].data[j] - world[i].data[j]));
+    printf("unproject round trip, max error: %.1e\n", err);
+    glv_camera_unproject(&cam, &viewport, win, win, N);
+    printf("in place matches: %d\n", !memcmp(win, back, sizeof(back)));
+}
+
+void testing_ray(){
+    printf("\n--- Ray Testing ---\n");
+    enum { N = 1037, R = 203 };
+    static float v0x[N], v0y[N], v0z[N], e1x[N], e1y[N], e1z[N], e2x[N], e2y[N], e2z[N];
+    static float lox[N], loy[N], loz[N], hix[N], hiy[N], hiz[N], te[N], te_ref[N];
+    static float ox[R], oy[R], oz[R], dx[R], dy[R], dz[R], tm[R];
+    static float ht[R], hu[R], hv[R], ht_ref[R], hu_ref[R], hv_ref[R];
+    static uint32_t hi_[R], hi_ref[R], mask[GLV_RAY_MASK_WORDS(N)], mask_ref[GLV_RAY_MASK_WORDS(N)];
+    glv_triangle_soa tris = {{v0x, v0y, v0z}, {e1x, e1y, e1z}, {e2x, e2y, e2z}};
+    glv_aabb_soa boxes = {{lox, loy, loz}, {hix, hiy, hiz}};
+    glv_ray_soa rays = {{ox, oy, oz}, {dx, dy, dz}};
+    glv_ray_hit_soa hits = {ht, hu, hv, hi_}, hits_ref = {ht_ref, hu_ref, hv_ref, hi_ref};
+    glv_vec3 a = {.x=-1.0f, .y=-1.0f, .z=0.0f}, b = {.x=1.0f, .y=-1.0f, .z=0.0f}, c = {.x=-1.0f, .y=1.0f, .z=0.0f};
+    glv_ray r = {.origin = {.x=-0.5f, .y=-0.25f, .z=5.0f}, .direction = {.x=0.0f, .y=0.0f, .z=-2.0f}};
+    glv_ray_hit hit;
+    float t;
+    int i;
+
+    // single triangle: hit point, barycentrics, back face, behind and past t_max
+    glv_triangle_soa_set(&tris, 0, &a, &b, &c);
+    i = glv_ray_triangles_nearest(&r, &tris, 1, INFINITY, &hit);
+    printf("hit %d at t %.3f, u %.3f, v %.3f\n", i, hit.t, hit.u, hit.v);
+    r.origin.z = -5.0f; r.direction.z = 2.0f;
+    printf("back face hit %d, ", glv_ray_triangles_nearest(&r, &tris, 1, INFINITY, &hit));
+    r.direction.z = -2.0f;
+    printf("behind hit %d, ", glv_ray_triangles_nearest(&r, &tris, 1, INFINITY, &hit));
+    r.origin.z = 5.0f;
+    i = glv_ray_triangles_nearest(&r, &tris, 1, 2.0f, &hit);
+    printf("past t_max hit %d (index %u, t %.1f)\n", i, (unsigned int)hit.index, hit.t);
+
+    // the same triangle at several indices: the lowest one wins
+    for(i = 0; i != 40; ++i){
+        glv_vec3 far_a = {.x=a.x, .y=a.y, .z=-3.0f}, far_b = {.x=b.x, .y=b.y, .z=-3.0f}, far_c = {.x=c.x, .y=c.y, .z=-3.0f};
+        if(i % 13 == 5) glv_triangle_soa_set(&tris, (size_t)i, &a, &b, &c);
+        else glv_triangle_soa_set(&tris, (size_t)i, &far_a, &far_b, &far_c);
+    }
+    glv_ray_triangles_nearest(&r, &tris, 40, INFINITY, &hit);
+    printf("tie goes to index %u\n", (unsigned int)hit.index);
+
+    // boxes: inside, entered, missed
+    glv_vec3 lo = {.x=-1.0f, .y=-1.0f, .z=-1.0f}, hi = {.x=1.0f, .y=1.0f, .z=1.0f};
+    glv_ray_soa one = {{&r.origin.x, &r.origin.y, &r.origin.z}, {&r.direction.x, &r.direction.y, &r.direction.z}};
+    lox[0] = lo.x; loy[0] = lo.y; loz[0] = lo.z; hix[0] = hi.x; hiy[0] = hi.y; hiz[0] = hi.z;
+    glv_ray_aabbs(&r, &boxes, 1, INFINITY, mask, te);
+    printf("box entered %u at t %.3f, ", (unsigned int)mask[0], te[0]);
+    r.origin.z = 0.0f;
+    glv_ray_aabbs(&r, &boxes, 1, INFINITY, mask, te);
+    printf("inside %u at t %.3f, ", (unsigned int)mask[0], te[0]);
+    r.origin.x = 3.0f;
+    printf("missed %u (%zu)\n", (unsigned int)glv_ray_aabbs(&r, &boxes, 1, INFINITY, mask, te),
+        glv_rays_aabb(&one, 1, &lo, &hi, NULL, mask));
+
+    // random scenes, every level against the scalar code
+    srand(17);
+    for(i = 0; i != N; ++i){
+        glv_vec3 p = {.x = randf() * 20.0f, .y = randf() * 20.0f, .z = randf() * 20.0f};
+        glv_vec3 q = {.x = p.x + randf() * 4.0f, .y = p.y + randf() * 4.0f, .z = p.z + randf() * 4.0f};
+        glv_vec3 s = {.x = p.x + randf() * 4.0f, .y = p.y + randf() * 4.0f, .z = p.z + randf() * 4.0f};
+        glv_vec3 e = {.x = fabsf(randf()) * 3.0f, .y = fabsf(randf()) * 3.0f, .z = fabsf(randf()) * 3.0f};
+        glv_triangle_soa_set(&tris, (size_t)i, &p, &q, &s);
+        lox[i] = p.x - e.x; loy[i] = p.y - e.y; loz[i] = p.z - e.z;
+        hix[i] = p.x + e.x; hiy[i] = p.y + e.y; hiz[i] = p.z + e.z;
+    }
+    for(i = 0; i != R; ++i){
+        ox[i] = randf() * 25.0f; oy[i] = randf() * 25.0f; oz[i] = randf() * 25.0f;
+        dx[i] = -ox[i] + randf() * 10.0f; dy[i] = -oy[i] + randf() * 10.0f; dz[i] = -oz[i] + randf() * 10.0f;
+        tm[i] = 0.5f + fabsf(randf());
+    }
+    dx[3] = 0.0f; dy[7] = 0.0f; dz[7] = 0.0f;   // rays parallel to the slabs
+
+    glv_simd_level best = glv_simd_detect(), l;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0, hits_seen = 0, boxes_seen = 0;
+        int k;
+        glv_simd_set_level(l);
+        for(k = 0; k != R; ++k){
+            glv_ray rk = {.origin = {.x=ox[k], .y=oy[k], .z=oz[k]}, .direction = {.x=dx[k], .y=dy[k], .z=dz[k]}};
+            glv_ray_hit h, h_ref = {INFINITY, 0.0f, 0.0f, GLV_RAY_MISS};
+            uint32_t nearest;
+            size_t count;
+            glv_ray_triangles_nearest(&rk, &tris, N, INFINITY, &h);
+            glv_simd_set_level(GLV_SIMD_SCALAR);
+            glv_ray_triangles_nearest(&rk, &tris, N, INFINITY, &h_ref);
+            count = glv_ray_aabbs(&rk, &boxes, N, 40.0f, mask_ref, te_ref);
+            glv_simd_set_level(l);
+            diff += memcmp(&h, &h_ref, sizeof(h)) != 0;
+            hits_seen += h.index != GLV_RAY_MISS;
+            diff += glv_ray_aabbs(&rk, &boxes, N, 40.0f, mask, te) != count;
+            diff += memcmp(mask, mask_ref, sizeof(mask)) != 0 || memcmp(te, te_ref, sizeof(te)) != 0;
+            boxes_seen += (unsigned int)count;
+            nearest = glv_ray_aabbs_nearest(&rk, &boxes, N, 40.0f, &t);
+            for(i = 0; i != N; ++i){
+                if(te_ref[i] < te_ref[nearest == GLV_RAY_MISS ? 0 : nearest]) ++diff;
+            }
+            if(nearest != GLV_RAY_MISS) diff += t != te_ref[nearest];
+            else diff += count != 0;
+        }
+
+        // packets: every triangle in turn, then every box
+        for(k = 0; k != R; ++k){
+            ht[k] = ht_ref[k] = tm[k] * 40.0f;
+            hu[k] = hv[k] = hu_ref[k] = hv_ref[k] = 0.0f;
+            hi_[k] = hi_ref[k] = GLV_RAY_MISS;
+        }
+        for(i = 0; i != N; ++i){
+            glv_vec3 p = {.x=v0x[i], .y=v0y[i], .z=v0z[i]};
+            glv_vec3 q = {.x=v0x[i] + e1x[i], .y=v0y[i] + e1y[i], .z=v0z[i] + e1z[i]};
+            glv_vec3 s = {.x=v0x[i] + e2x[i], .y=v0y[i] + e2y[i], .z=v0z[i] + e2z[i]};
+            size_t count = glv_rays_triangle(&rays, R, &p, &q, &s, (uint32_t)i, &hits);
+            glv_simd_set_level(GLV_SIMD_SCALAR);
+            diff += glv_rays_triangle(&rays, R, &p, &q, &s, (uint32_t)i, &hits_ref) != count;
+            count = glv_rays_aabb(&rays, R, &(glv_vec3){.x=lox[i], .y=loy[i], .z=loz[i]},
+                &(glv_vec3){.x=hix[i], .y=hiy[i], .z=hiz[i]}, i % 2 ? tm : NULL, mask_ref);
+            glv_simd_set_level(l);
+            diff += glv_rays_aabb(&rays, R, &(glv_vec3){.x=lox[i], .y=loy[i], .z=loz[i]},
+                &(glv_vec3){.x=hix[i], .y=hiy[i], .z=hiz[i]}, i % 2 ? tm : NULL, mask) != count;
+            diff += memcmp(mask, mask_ref, GLV_RAY_MASK_WORDS(R) * sizeof(uint32_t)) != 0;
+        }
+        diff += memcmp(ht, ht_ref, sizeof(ht)) != 0 || memcmp(hu, hu_ref, sizeof(hu)) != 0
+            || memcmp(hv, hv_ref, sizeof(hv)) != 0 || memcmp(hi_, hi_ref, sizeof(hi_)) != 0;
+        printf("%-9s batch mismatches: %u (%u rays hit a triangle, %u box hits)\n",
+            glv_simd_name(l), diff, hits_seen, boxes_seen);
+    }
+    glv_simd_set_level(best);
+}
+
+/* Nodes that do not enclose their children or primitives, plus primitives not in exactly one leaf */
+static unsigned int bvh_problems(const glv_bvh* b){
+    unsigned char* seen = calloc(b->count, 1);
+    unsigned int bad = 0, a;
+    size_t i, k;
+    for(i = 0; i != b->node_count; ++i){
+        const glv_bvh_node* n = &b->nodes[i];
+        if(n->count == 0){
+            const glv_bvh_node* c[2] = {n + 1, &b->nodes[n->index]};
+            bad += n->index <= i + 1 || n->index >= b->node_count;
+            for(k = 0; k != 2; ++k) for(a = 0; a != 3; ++a) bad += c[k]->min[a] < n->min[a] || c[k]->max[a] > n->max[a];
+            continue;
+        }
+        for(k = n->index; k != n->index + n->count; ++k){
+            const uint32_t p = b->indices[k];
+            const float lo[3] = {b->boxes.min.x[p], b->boxes.min.y[p], b->boxes.min.z[p]};
+            const float hi[3] = {b->boxes.max.x[p], b->boxes.max.y[p], b->boxes.max.z[p]};
+            for(a = 0; a != 3; ++a) bad += lo[a] < n->min[a] || hi[a] > n->max[a];
+            bad += seen[p]++ != 0;
+        }
+    }
+    for(i = 0; i != b->count; ++i) bad += seen[i] != 1;
+    free(seen);
+    return bad;
+}
+
+static int by_index(const void* a, const void* b){
+    const uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+void testing_bvh(){
+    printf("\n--- BVH Testing ---\n");
+    enum { N = 20011, Q = 300 };
+    float* f = malloc(15 * N * sizeof(float));
+    glv_aabb_soa local = {{f, f + N, f + 2 * N}, {f + 3 * N, f + 4 * N, f + 5 * N}};
+    glv_aabb_soa world = {{f + 6 * N, f + 7 * N, f + 8 * N}, {f + 9 * N, f + 10 * N, f + 11 * N}};
+    glv_vec3_soa tmp = {f + 12 * N, f + 13 * N, f + 14 * N};
+    glv_mat4* m = malloc(N * sizeof(glv_mat4));
+    glv_bvh_node* nodes = malloc(GLV_BVH_NODES(N) * sizeof(glv_bvh_node));
+    glv_bvh_node* pnodes = malloc(GLV_BVH_NODES(N) * sizeof(glv_bvh_node));
+    uint32_t* indices = malloc(N * sizeof(uint32_t));
+    uint32_t* pindices = malloc(N * sizeof(uint32_t));
+    uint32_t* list = malloc(N * sizeof(uint32_t));
+    uint32_t* brute = malloc(N * sizeof(uint32_t));
+    uint32_t* mask = malloc(GLV_RAY_MASK_WORDS(N) * sizeof(uint32_t));
+    float* te = malloc(N * sizeof(float));
+    glv_bvh bvh = {world, N, nodes, indices, 0};
+    unsigned int i, k, a, loose = 0, diff = 0, pass;
+    size_t found, total = 0;
+
+    // unit boxes scaled, rotated and moved about a 100-unit cube
+    srand(31);
+    for(i = 0; i != N; ++i){
+        glv_vec3 t = {.x = randf() * 50.0f, .y = randf() * 50.0f, .z = randf() * 50.0f};
+        glv_vec3 s = {.x = 0.2f + fabsf(randf()), .y = 0.2f + fabsf(randf()), .z = 0.2f + fabsf(randf())};
+        glv_vec3 axis = glv_vec3_normalize(&(glv_vec3){.x = randf(), .y = randf(), .z = 1.0f});
+        glv_quat q = glv_quat_axis_angle(randf() * 3.0f, &axis);
+        m[i] = glv_compose_trs(&t, &q, &s);
+        local.min.x[i] = local.min.y[i] = local.min.z[i] = -1.0f;
+        local.max.x[i] = local.max.y[i] = local.max.z[i] = 1.0f;
+    }
+    glv_aabbs_transform(&local, m, N, &world);
+    for(i = 0; i != N; ++i){
+        // every corner inside, and some corner on each face
+        float mn[3] = {INFINITY, INFINITY, INFINITY}, mx[3] = {-INFINITY, -INFINITY, -INFINITY};
+        for(k = 0; k != 8; ++k){
+            glv_vec4 c = {.x = k & 1 ? 1.0f : -1.0f, .y = k & 2 ? 1.0f : -1.0f, .z = k & 4 ? 1.0f : -1.0f, .w = 1.0f};
+            c = glv_transform(&c, &m[i]);
+            for(a = 0; a != 3; ++a){
+                mn[a] = fminf(mn[a], c.data[a]);
+                mx[a] = fmaxf(mx[a], c.data[a]);
+            }
+        }
+        const float lo[3] = {world.min.x[i], world.min.y[i], world.min.z[i]};
+        const float hi[3] = {world.max.x[i], world.max.y[i], world.max.z[i]};
+        for(a = 0; a != 3; ++a) loose += fabsf(mn[a] - lo[a]) > 1e-4f || fabsf(mx[a] - hi[a]) > 1e-4f;
+    }
+    printf("transformed bounds off the corners: %u\n", loose);
+
+    glv_bvh_build(&bvh, 4);
+    printf("nodes: %zu for %d boxes, problems: %u\n", bvh.node_count, N, bvh_problems(&bvh));
+
+    // queries against brute force, before and after moving everything and refitting
+    for(pass = 0; pass != 2; ++pass){
+        unsigned int rays = 0, hits = 0;
+        srand(37 + pass);
+        for(i = 0; i != Q; ++i){
+            glv_ray r = {.origin = {.x = randf() * 80.0f, .y = randf() * 80.0f, .z = randf() * 80.0f},
+                .direction = {.x = randf(), .y = randf(), .z = randf()}};
+            glv_vec3 c = {.x = randf() * 50.0f, .y = randf() * 50.0f, .z = randf() * 50.0f};
+            glv_vec3 e = {.x = fabsf(randf()) * 5.0f, .y = fabsf(randf()) * 5.0f, .z = fabsf(randf()) * 5.0f};
+            glv_vec3 lo = {.x = c.x - e.x, .y = c.y - e.y, .z = c.z - e.z}, hi = {.x = c.x + e.x, .y = c.y + e.y, .z = c.z + e.z};
+            const float radius = fabsf(randf()) * 4.0f, t_max = i % 3 ? INFINITY : 40.0f;
+            float t, t_ref, d, d_ref = INFINITY;
+            uint32_t best, best_ref = GLV_RAY_MISS;
+            size_t n;
+            if(i == 0) r.direction.y = r.direction.z = 0.0f;
+
+            // rays: every box entered, and the first
+            found = glv_bvh_ray(&bvh, &r, t_max, list, N);
+            glv_ray_aabbs(&r, &world, N, t_max, mask, te);
+            for(k = 0, n = 0; k != N; ++k) if(mask[k / 32] >> (k % 32) & 1) brute[n++] = k;
+            qsort(list, found < N ? found : N, sizeof(uint32_t), by_index);
+            diff += found != n || memcmp(list, brute, n * sizeof(uint32_t)) != 0;
+            best = glv_bvh_ray_nearest(&bvh, &r, t_max, &t);
+            best_ref = glv_ray_aabbs_nearest(&r, &world, N, t_max, &t_ref);
+            diff += best != best_ref || t != t_ref;
+            rays += found != 0;
+            hits += best != GLV_RAY_MISS;
+            total += found;
+
+            // boxes overlapping a box
+            found = glv_bvh_overlap(&bvh, &lo, &hi, list, N);
+            for(k = 0, n = 0; k != N; ++k){
+                if(world.min.x[k] <= hi.x && world.min.y[k] <= hi.y && world.min.z[k] <= hi.z
+                    && lo.x <= world.max.x[k] && lo.y <= world.max.y[k] && lo.z <= world.max.z[k]) brute[n++] = k;
+            }
+            qsort(list, found < N ? found : N, sizeof(uint32_t), by_index);
+            diff += found != n || memcmp(list, brute, n * sizeof(uint32_t)) != 0;
+
+            // boxes near a point, and the nearest
+            found = glv_bvh_sphere(&bvh, &c, radius, list, N);
+            for(k = 0, n = 0, best_ref = GLV_RAY_MISS; k != N; ++k){
+                float d2 = 0.0f, dx;
+                dx = fmaxf(fmaxf(world.min.x[k] - c.x, c.x - world.max.x[k]), 0.0f); d2 += dx * dx;
+                dx = fmaxf(fmaxf(world.min.y[k] - c.y, c.y - world.max.y[k]), 0.0f); d2 += dx * dx;
+                dx = fmaxf(fmaxf(world.min.z[k] - c.z, c.z - world.max.z[k]), 0.0f); d2 += dx * dx;
+                if(d2 <= radius * radius) brute[n++] = k;
+                if(d2 < d_ref){
+                    d_ref = d2;
+                    best_ref = k;
+                }
+            }
+            qsort(list, found < N ? found : N, sizeof(uint32_t), by_index);
+            diff += found != n || memcmp(list, brute, n * sizeof(uint32_t)) != 0;
+            best = glv_bvh_nearest(&bvh, &c, INFINITY, &d);
+            diff += best != best_ref || d != sqrtf(d_ref);
+            diff += glv_bvh_nearest(&bvh, &c, 1e-3f, &d) != (d_ref < 1e-6f ? best_ref : GLV_RAY_MISS);
+        }
+        printf("%s: query mismatches %u (%u of %d rays hit, %zu boxes listed)\n",
+            pass ? "after refit" : "built", diff, hits, Q, total);
+        if(pass) break;
+
+        // move every object a little, refit and recheck
+        for(i = 0; i != N; ++i){
+            m[i].data[0][3] += randf() * 2.0f;
+            m[i].data[1][3] += randf() * 2.0f;
+        }
+        glv_aabbs_transform(&local, m, N, &world);
+        glv_bvh_refit(&bvh);
+        printf("problems after refit: %u\n", bvh_problems(&bvh));
+        diff = 0;
+        total = 0;
+    }
+
+    // triangles, one per box, against ray.h over all of them
+    glv_triangle_soa tris = {{f, f + N, f + 2 * N}, {f + 3 * N, f + 4 * N, f + 5 * N}, {tmp.x, tmp.y, tmp.z}};
+    glv_aabb_soa tri_boxes = {{f + 6 * N, f + 7 * N, f + 8 * N}, {f + 9 * N, f + 10 * N, f + 11 * N}};
+    for(i = 0; i != N; ++i){
+        glv_vec3 v[3];
+        for(k = 0; k != 3; ++k){
+            v[k] = (glv_vec3){.x = randf() * 50.0f, .y = randf() * 50.0f, .z = randf() * 50.0f};
+            if(k) v[k] = (glv_vec3){.x = v[0].x + randf() * 2.0f, .y = v[0].y + randf() * 2.0f, .z = v[0].z + randf() * 2.0f};
+        }
+        glv_triangle_soa_set(&tris, i, &v[0], &v[1], &v[2]);
+        tri_boxes.min.x[i] = fminf(v[0].x, fminf(v[1].x, v[2].x)); tri_boxes.max.x[i] = fmaxf(v[0].x, fmaxf(v[1].x, v[2].x));
+        tri_boxes.min.y[i] = fminf(v[0].y, fminf(v[1].y, v[2].y)); tri_boxes.max.y[i] = fmaxf(v[0].y, fmaxf(v[1].y, v[2].y));
+        tri_boxes.min.z[i] = fminf(v[0].z, fminf(v[1].z, v[2].z)); tri_boxes.max.z[i] = fmaxf(v[0].z, fmaxf(v[1].z, v[2].z));
+    }
+    glv_bvh mesh = {tri_boxes, N, nodes, indices, 0};
+    glv_bvh_build(&mesh, 4);
+    diff = 0;
+    unsigned int hits = 0;
+    for(i = 0; i != Q; ++i){
+        glv_ray r = {.origin = {.x = randf() * 80.0f, .y = randf() * 80.0f, .z = randf() * 80.0f}};
+        glv_ray_hit h, h_ref;
+        r.direction = (glv_vec3){.x = randf() * 25.0f - r.origin.x, .y = randf() * 25.0f - r.origin.y, .z = randf() * 25.0f - r.origin.z};
+        glv_bvh_ray_triangles(&mesh, &r, &tris, INFINITY, &h);
+        glv_ray_triangles_nearest(&r, &tris, N, INFINITY, &h_ref);
+        diff += memcmp(&h, &h_ref, sizeof(h)) != 0;
+        hits += h.index != GLV_RAY_MISS;
+    }
+    printf("triangle picks differing from a linear scan: %u (%u of %d hit)\n", diff, hits, Q);
+
+    // the parallel build gives the same tree
+    glv_bvh par = {tri_boxes, N, pnodes, pindices, 0};
+    glv_pool_start(4);
+    glv_pool_set_min_items(1);
+    glv_bvh_build_parallel(&par, 4);
+    glv_pool_stop();
+    glv_pool_set_min_items(GLV_POOL_MIN_ITEMS);
+    printf("parallel build matches: %d\n", par.node_count == mesh.node_count
+        && !memcmp(pnodes, nodes, mesh.node_count * sizeof(glv_bvh_node)) && !memcmp(pindices, indices, N * sizeof(uint32_t)));
+
+    // identical boxes with leaves as large as the input: the root is the only node
+    float* corners[6] = {tri_boxes.min.x, tri_boxes.min.y, tri_boxes.min.z, tri_boxes.max.x, tri_boxes.max.y, tri_boxes.max.z};
+    for(a = 0; a != 6; ++a){
+        for(i = 0; i != N; ++i) corners[a][i] = a < 3 ? 0.0f : 1.0f;
+    }
+    glv_bvh_build(&mesh, N);
+    glv_pool_start(4);
+    glv_pool_set_min_items(1);
+    glv_bvh_build_parallel(&par, N);
+    glv_pool_stop();
+    glv_pool_set_min_items(GLV_POOL_MIN_ITEMS);
+    printf("all-leaf parallel build: %zu node(s), serial %zu\n", par.node_count, mesh.node_count);
+
+    free(f); free(m); free(nodes); free(pnodes); free(indices); free(pindices);
+    free(list); free(brute); free(mask); free(te);
+}
+
+/* Bit by bit interleaving, for checking the Morton codes */
+static uint64_t morton_naive(const uint32_t* c, unsigned int axes, unsigned int bits){
+    uint64_t code = 0;
+    unsigned int b, a;
+    for(b = 0; b != bits; ++b){
+        for(a = 0; a != axes; ++a){
+            code |= (uint64_t)((c[a] >> b) & 1u) << (b * axes + a);
+        }
+    }
+    return code;
+}
+
+void testing_ivec(){
+    printf("\n--- Integer Vector Testing ---\n");
+    enum { N = 1037 };
+    static int a[4 * N], b[4 * N], r[4 * N], r_ref[4 * N];
+    static float f[4 * N];
+    static uint32_t h[N], h_ref[N], c2[N];
+    static uint64_t c3[N], c3_ref[N];
+    static glv_uvec3 u3[N];
+    static glv_uvec2 u2[N];
+    glv_vec4 origin = {.x=-3.0f, .y=0.5f, .z=100.0f, .w=0.0f}, scale = {.x=0.25f, .y=4.0f, .z=1.0f, .w=1e-3f};
+    glv_ivec4 lo = {.x=-50, .y=-7, .z=0, .w=-1000}, hi = {.x=50, .y=7, .z=1000, .w=-999};
+    glv_uvec4 ulo = {.x=0, .y=1000, .z=0x7fff0000u, .w=0xfffffff0u}, uhi = {.x=50, .y=0x80000000u, .z=0x80000010u, .w=0xffffffffu};
+    glv_ivec3 cell = {.x=1, .y=2, .z=3};
+    int i;
+
+    // cells: negatives round down, NaN and out of range values saturate
+    glv_vec2 p[3] = {{.x=-0.5f, .y=1.5f}, {.x=NAN, .y=-1e20f}, {.x=1e20f, .y=-2.0f}};
+    glv_vec2 zero = {.x=0.0f, .y=0.0f}, one = {.x=1.0f, .y=1.0f};
+    glv_ivec2 q[3];
+    glv_vec2_floor_to_ivec2(p, &zero, &one, q, 3);
+    printf("cells %d %d, %d %d, %d %d\n", q[0].x, q[0].y, q[1].x, q[1].y, q[2].x, q[2].y);
+    printf("hash of (1, 2, 3): %08x\n", (unsigned int)glv_ivec3_hash(&cell));
+    printf("morton (1, 2): %u, (1, 1, 1): %llu, top: %llx\n", (unsigned int)glv_morton2_encode(1, 2),
+        (unsigned long long)glv_morton3_encode(1, 1, 1), (unsigned long long)glv_morton3_encode(0x1fffff, 0x1fffff, 0x1fffff));
+
+    srand(23);
+    for(i = 0; i != 4 * N; ++i){
+        a[i] = (int)((unsigned int)rand() * (i % 7 ? 1u : 65537u) * (rand() % 2 ? 1u : ~0u));
+        b[i] = rand() % 2000 - 1000;
+        f[i] = randf() * 300.0f;
+    }
+    f[5] = NAN; f[6] = 1e30f; f[7] = -1e30f; f[9] = -3.0f;
+    for(i = 0; i != N; ++i){
+        u3[i] = (glv_uvec3){.x = (unsigned int)rand() ^ ((unsigned int)rand() << 16), .y = (unsigned int)rand(), .z = (unsigned int)rand() << 3};
+        u2[i] = (glv_uvec2){.x = u3[i].y, .y = u3[i].z};
+    }
+
+    glv_simd_level best = glv_simd_detect(), l;
+    for(l = GLV_SIMD_SCALAR; l <= best; ++l){
+        unsigned int diff = 0;
+        glv_simd_set_level(l);
+
+        // element-wise, against plain loops
+        glv_ivec3_add_batch((glv_ivec3*)a, (glv_ivec3*)b, (glv_ivec3*)r, N);
+        for(i = 0; i != 3 * N; ++i) diff += r[i] != (int)((unsigned int)a[i] + (unsigned int)b[i]);
+        glv_ivec4_min_batch((glv_ivec4*)a, (glv_ivec4*)b, (glv_ivec4*)r, N);
+        for(i = 0; i != 4 * N; ++i) diff += r[i] != (a[i] < b[i] ? a[i] : b[i]);
+        glv_uvec2_max_batch((glv_uvec2*)a, (glv_uvec2*)b, (glv_uvec2*)r, N);
+        for(i = 0; i != 2 * N; ++i) diff += (unsigned int)r[i] != ((unsigned int)a[i] > (unsigned int)b[i] ? (unsigned int)a[i] : (unsigned int)b[i]);
+        glv_uvec4_min_batch((glv_uvec4*)a, (glv_uvec4*)b, (glv_uvec4*)r, N);
+        for(i = 0; i != 4 * N; ++i) diff += (unsigned int)r[i] != ((unsigned int)a[i] < (unsigned int)b[i] ? (unsigned int)a[i] : (unsigned int)b[i]);
+        glv_ivec3_clamp_batch((glv_ivec3*)a, (glv_ivec3*)lo.data, (glv_ivec3*)hi.data, (glv_ivec3*)r, N);
+        for(i = 0; i != 3 * N; ++i){
+            diff += r[i] != (a[i] < lo.data[i % 3] ? lo.data[i % 3] : a[i] > hi.data[i % 3] ? hi.data[i % 3] : a[i]);
+        }
+        glv_uvec4_clamp_batch((glv_uvec4*)a, &ulo, &uhi, (glv_uvec4*)r, N);
+        for(i = 0; i != 4 * N; ++i){
+            const unsigned int x = (unsigned int)a[i], l_ = ulo.data[i % 4], h_ = uhi.data[i % 4];
+            diff += (unsigned int)r[i] != (x < l_ ? l_ : x > h_ ? h_ : x);
+        }
+
+        // cells and hashes, against the scalar level
+        glv_vec4_floor_to_ivec4((glv_vec4*)f, &origin, &scale, (glv_ivec4*)r, N);
+        glv_vec3_floor_to_ivec3((glv_vec3*)f, (glv_vec3*)origin.data, (glv_vec3*)scale.data, (glv_ivec3*)a, N);
+        glv_ivec3_hash_batch((glv_ivec3*)a, h, N);
+        for(i = 0; i != N; ++i) diff += h[i] != glv_ivec3_hash((glv_ivec3*)a + i);
+        glv_ivec2_hash_batch((glv_ivec2*)b, h, N);
+        for(i = 0; i != N; ++i) diff += h[i] != glv_ivec2_hash((glv_ivec2*)b + i);
+        glv_simd_set_level(GLV_SIMD_SCALAR);
+        glv_vec4_floor_to_ivec4((glv_vec4*)f, &origin, &scale, (glv_ivec4*)r_ref, N);
+        glv_vec3_floor_to_ivec3((glv_vec3*)f, (glv_vec3*)origin.data, (glv_vec3*)scale.data, (glv_ivec3*)b, N);
+        glv_ivec3_hash_batch((glv_ivec3*)b, h_ref, N);
+        glv_simd_set_level(l);
+        diff += memcmp(r, r_ref, sizeof(r)) != 0 || memcmp(a, b, 3 * N * sizeof(int)) != 0;
+        for(i = 0; i != 4 * N; ++i) diff += r_ref[i] != (int)floorf(fmaxf(fminf((f[i] - origin.data[i % 4]) * scale.data[i % 4], 2e9f), -2e9f))
+            && fabsf((f[i] - origin.data[i % 4]) * scale.data[i % 4]) < 2e9f;
+
+        // Morton codes, against bit by bit interleaving, and back
+        glv_uvec3_to_morton(u3, c3, N);
+        glv_uvec2_to_morton(u2, c2, N);
+        for(i = 0; i != N; ++i){
+            diff += c3[i] != morton_naive(u3[i].data, 3, 21) || c3[i] != glv_morton3_encode(u3[i].x, u3[i].y, u3[i].z);
+            diff += c2[i] != morton_naive(u2[i].data, 2, 16) || c2[i] != glv_morton2_encode(u2[i].x, u2[i].y);
+        }
+        glv_morton_to_uvec3(c3, (glv_uvec3*)r, N);
+        glv_morton_to_uvec2(c2, (glv_uvec2*)r_ref, N);
+        for(i = 0; i != N; ++i){
+            glv_uvec3 d3 = glv_morton3_decode(c3[i]);
+            glv_uvec2 d2 = glv_morton2_decode(c2[i]);
+            diff += (unsigned int)r[3 * i] != (u3[i].x & 0x1fffff) || (unsigned int)r[3 * i + 1] != (u3[i].y & 0x1fffff)
+                || (unsigned int)r[3 * i + 2] != (u3[i].z & 0x1fffff) || memcmp(&d3, (glv_uvec3*)r + i, sizeof(d3));
+            diff += (unsigned int)r_ref[2 * i] != (u2[i].x & 0xffff) || (unsigned int)r_ref[2 * i + 1] != (u2[i].y & 0xffff)
+                || memcmp(&d2, (glv_uvec2*)r_ref + i, sizeof(d2));
+        }
+        glv_vec3_to_morton((glv_vec3*)f, (glv_vec3*)origin.data, &(glv_vec3){.x=50.0f, .y=50.0f, .z=50.0f}, c3, N);
+        glv_simd_set_level(GLV_SIMD_SCALAR);
+        glv_vec3_to_morton((glv_vec3*)f, (glv_vec3*)origin.data, &(glv_vec3){.x=50.0f, .y=50.0f, .z=50.0f}, c3_ref, N);
+        glv_simd_set_level(l);
+        diff += memcmp(c3, c3_ref, sizeof(c3)) != 0;
+        printf("%-9s batch mismatches: %u\n", glv_simd_name(l), diff);
+
+        // restore the inputs overwritten above
+        srand(23);
+        for(i = 0; i != 4 * N; ++i){
+            a[i] = (int)((unsigned int)rand() * (i % 7 ? 1u : 65537u) * (rand() % 2 ? 1u : ~0u));
+            b[i] = rand() % 2000 - 1000;
+            (void)randf();
+        }
+    }
+
+    // points sorted by code: neighbours in the order are close in space
+    glv_vec3 box_min = {.x=0.0f, .y=0.0f, .z=0.0f}, box_max = {.x=1.0f, .y=1.0f, .z=1.0f};
+    glv_vec3 corner[2] = {{.x=0.0f, .y=0.0f, .z=0.0f}, {.x=1.0f, .y=2.0f, .z=1.0f}};
+    glv_vec3_to_morton(corner, &box_min, &box_max, c3, 2);
+    printf("box corners: %llx %llx\n", (unsigned long long)c3[0], (unsigned long long)c3[1]);
+}
+
+/* Writes n floats to path, returns 0 on success */
+static int write_floats(const char* path, const float* f, size_t n){
+    FILE* fp = fopen(path, "wb");
+    if(!fp) return -1;
+    if(fwrite(f, sizeof(float), n, fp) != n){
+        fclose(fp);
+        return -1;
+    }
+    return fclose(fp);
+}
+
+/* 1 if path holds exactly the n floats f */
+static int file_equals(const char* path, const float* f, size_t n){
+    FILE* fp = fopen(path, "rb");
+    float* buf = malloc((n + 1) * sizeof(float));
+    size_t got;
+    if(!fp){
+        free(buf);
+        return 0;
+    }
+    got = fread(buf, sizeof(float), n + 1, fp);
+    fclose(fp);
+    got = got == n && !memcmp(buf, f, n * sizeof(float));
+    free(buf);
+    return (int)got;
+}
+
+void testing_stream(){
+    printf("\n--- File Stream Testing ---\n");
+    enum { N = 100003 };
+    const char *in = "/tmp/glv_test_stream_in.bin", *out = "/tmp/glv_test_stream_out.bin";
+    float* f = malloc(4 * N * sizeof(float));
+    float* ref = malloc(4 * N * sizeof(float));
+    glv_mat4 id = glv_mat4_identity(), m;
+    glv_stream_stats st;
+    int i, err;
+
+    m = glv_rotate(&id, 37.0f, &(glv_vec3){.x=0.3f, .y=1.0f, .z=-0.2f});
+    m = glv_translate(&m, &(glv_vec3){.x=5.0f, .y=-2.0f, .z=0.5f});
+    srand(29);
+    for(i = 0; i != 4 * N; ++i) f[i] = randf() * 100.0f;
+
+    // points and vec4s, with the smallest chunks and the default, against the batch transform
+    glv_transform_batch_vec3((const glv_vec3*)f, 0, (glv_vec3*)ref, 0, N, &m);
+    write_floats(in, f, 3 * N);
+    err = glv_stream_transform_file(in, out, 3, &m, 1, &st);
+    printf("vec3: error %d, %zu vertices, %zu bytes, matches %d, ", err, st.vertices, st.bytes_written, file_equals(out, ref, 3 * N));
+    err = glv_stream_transform_file(in, out, 3, &m, 0, NULL);
+    printf("default chunks %d\n", err == 0 && file_equals(out, ref, 3 * N));
+    glv_transform_batch((const glv_vec4*)f, 0, (glv_vec4*)ref, 0, N, &m);
+    write_floats(in, f, 4 * N);
+    glv_pool_start(4);
+    glv_pool_set_min_items(1);
+    err = glv_stream_transform_file(in, out, 4, &m, 100000, &st);
+    glv_pool_stop();
+    glv_pool_set_min_items(GLV_POOL_MIN_ITEMS);
+    printf("vec4 on the pool: error %d, matches %d\n", err, file_equals(out, ref, 4 * N));
+
+    // in place, without an output and with the input named twice
+    err = glv_stream_transform_file(in, NULL, 4, &m, 0, NULL);
+    printf("in place: error %d, matches %d, ", err, file_equals(in, ref, 4 * N));
+    write_floats(in, f, 4 * N);
+    err = glv_stream_transform_file(in, in, 4, &m, 0, NULL);
+    printf("same path: error %d, matches %d\n", err, file_equals(in, ref, 4 * N));
+
+    // errors leave the stats alone; an empty input gives an empty output
+    st.vertices = 7;
+    write_floats(in, f, 5);
+    printf("partial vertex %d, ", glv_stream_transform_file(in, out, 4, &m, 0, &st) == EINVAL);
+    printf("5 components %d, ", glv_stream_transform_file(in, out, 5, &m, 0, &st) == EINVAL);
+    remove(in);
+    printf("missing input %d, stats kept %d, ", glv_stream_transform_file(in, out, 3, &m, 0, &st) == ENOENT, st.vertices == 7);
+    write_floats(in, f, 0);
+    err = glv_stream_transform_file(in, out, 3, &m, 0, &st);
+    printf("empty: error %d, %zu vertices, output empty %d\n", err, st.vertices, file_equals(out, f, 0));
+
+    // the tool, when built ('make tools'): rotating (1, 0, 0) 90 degrees about y gives (0, 0, -1)
+    FILE* fp = fopen("bin/glvxform", "rb");
+    if(fp){
+        const float x[3] = {1.0f, 0.0f, 0.0f};
+        float r[3] = {NAN, NAN, NAN};
+        char cmd[256];
+        fclose(fp);
+        write_floats(in, x, 3);
+        snprintf(cmd, sizeof(cmd), "bin/glvxform -j 1 -r 90 0 1 0 %s %s > /dev/null", in, out);
+        err = system(cmd);
+        fp = fopen(out, "rb");
+        if(fp){
+            if(fread(r, sizeof(float), 3, fp) != 3) r[0] = NAN;
+            fclose(fp);
+        }
+        printf("glvxform -r 90 0 1 0: status %d, (%.3f, %.3f, %.3f)\n", err, fabsf(r[0]), r[1], r[2]);
+    }
+    else printf("glvxform: not built\n");
+
+    remove(in);
+    remove(out);
+    free(f);
+    free(ref);
+}
+
 int main(){
     
     testing_vec();
@@ -187,6 +2027,29 @@ int main(){
     testing_mat4();
     testing_mat3();
     testing_mat2();
+    testing_inverse();
+    testing_chain();
+    testing_simd();
+    testing_batch();
+    testing_soa();
+    testing_hierarchy();
+    testing_pool();
+    testing_quat();
+    testing_affine();
+    testing_trs();
+    testing_cull();
+    testing_half();
+    testing_double();
+    testing_fast();
+    testing_skin();
+    testing_pack();
+    testing_profile();
+    testing_arena();
+    testing_camera();
+    testing_ray();
+    testing_bvh();
+    testing_ivec();
+    testing_stream();
 
     return 0;
 }
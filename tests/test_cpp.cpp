@@ -0,0 +1,101 @@
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "../include/glvmath.hpp"
+
+static float randf(){
+    return (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static glv::mat4 random_mat4(){
+    glv::mat4 m;
+    for(int i = 0; i != 4; ++i){
+        for(int j = 0; j != 4; ++j) m(i, j) = randf();
+    }
+    return m;
+}
+
+/* Evaluated at compile time */
+constexpr glv::mat4 cidentity = glv::mat4::identity();
+constexpr glv::mat4 cortho = glv::ortho(-2.0f, 2.0f, -1.0f, 1.0f, 0.1f, 50.0f);
+constexpr glv::mat4 cpersp = glv::perspective(0.8f, 1.5f, 0.1f, 100.0f);
+constexpr glv::vec4 cpoint = cpersp * cortho * glv::vec4(1.0f, 2.0f, 3.0f, 1.0f);
+static_assert(cidentity(2, 2) == 1.0f && cidentity(2, 3) == 0.0f, "constexpr identity");
+static_assert(cpersp(3, 2) == -1.0f, "constexpr perspective");
+
+void testing_builders(){
+    printf("\n--- C++ Builders Testing ---\n");
+    glv_mat4 o = glv_ortho(-2.0f, 2.0f, -1.0f, 1.0f, 0.1f, 50.0f);
+    glv_mat4 p = glv_perspective(0.8f, 1.5f, 0.1f, 100.0f);
+    glv_mat4 f = glv_frustum(-1.0f, 2.0f, -0.5f, 1.0f, 0.1f, 50.0f);
+    glv::mat4 cf = glv::frustum(-1.0f, 2.0f, -0.5f, 1.0f, 0.1f, 50.0f);
+    glv_mat4 id = glv_mat4_identity();
+    printf("identity, ortho, frustum match C: %d %d %d\n", !memcmp(&cidentity, &id, sizeof(id)),
+        !memcmp(&cortho, &o, sizeof(o)), !memcmp(&cf, &f, sizeof(f)));
+
+    // constexpr tangent against tanf over the usual field-of-view range
+    float err = 0.0f;
+    for(int i = 1; i != 3000; ++i){
+        float fovy = (float)i * 0.001f;
+        glv::mat4 a = glv::perspective(fovy, 1.5f, 0.1f, 100.0f);
+        glv_mat4 b = glv_perspective(fovy, 1.5f, 0.1f, 100.0f);
+        for(int j = 0; j != 4; ++j){
+            for(int k = 0; k != 4; ++k) err = fmaxf(err, fabsf(a(j, k) - b.data[j][k]) / fmaxf(1.0f, fabsf(b.data[j][k])));
+        }
+    }
+    printf("perspective matches C: %d, max relative difference over 3000 angles: %.1e\n",
+        !memcmp(&cpersp, &p, sizeof(p)), err);
+    printf("compile-time point: %.4f %.4f %.4f %.4f\n", cpoint[0], cpoint[1], cpoint[2], cpoint[3]);
+}
+
+void testing_expressions(){
+    printf("\n--- C++ Expression Testing ---\n");
+    glv_simd_level best = glv_simd_detect();
+    glv_simd_set_level(GLV_SIMD_SCALAR);
+    srand(16);
+    glv::mat4 a = random_mat4(), b = random_mat4(), c = random_mat4(), d = random_mat4();
+    glv::vec4 v(randf(), randf(), randf(), 1.0f), w(randf(), randf(), randf(), 0.0f);
+
+    // C functions take the C++ types directly
+    glv_mat4 n = glv_mat4_nmultiply(4, &a, &b, &c, &d);
+    glv::mat4 m = a * b * c * d, grouped = (a * b) * (c * d), nested = a * (b * (c * d));
+    printf("a*b*c*d matches glv_mat4_nmultiply: %d %d %d\n", !memcmp(&m, &n, sizeof(n)),
+        !memcmp(&grouped, &n, sizeof(n)), !memcmp(&nested, &n, sizeof(n)));
+
+    // vector chains run right to left, as nested glv_transform calls
+    glv_vec4 t = glv_transform(&v.c, &c);
+    t = glv_transform(&t, &b);
+    t = glv_transform(&t, &a);
+    glv::vec4 r1 = a * b * c * v, r2 = (a * b) * (c * v), r3 = a * (b * (c * v));
+    printf("a*b*c*v matches nested glv_transform: %d %d %d\n", !memcmp(&r1, &t, sizeof(t)),
+        !memcmp(&r2, &t, sizeof(t)), !memcmp(&r3, &t, sizeof(t)));
+
+    glv_mat4 abc = glv_mat4_nmultiply(3, &a, &b, &c);
+    glv_vec4 u = glv_transform(&v.c, &abc);
+    float err = 0.0f;
+    for(int i = 0; i != 4; ++i) err = fmaxf(err, fabsf(u.data[i] - r1[i]));
+    printf("vs product first: max difference %.1e\n", err);
+
+    // element-wise operations
+    glv::vec4 s = 2.0f * (a * v) - w + v * 0.5f;
+    glv::vec4 e = a * v;
+    err = 0.0f;
+    for(int i = 0; i != 4; ++i) err = fmaxf(err, fabsf(s[i] - (2.0f * e[i] - w[i] + v[i] * 0.5f)));
+    printf("2*(a*v) - w + v*0.5: max difference %.1e\n", err);
+
+    // temporaries are kept by value
+    glv::vec4 q = glv::mat4::identity() * (glv::perspective(0.8f, 1.5f, 0.1f, 100.0f) * glv::vec4(0.0f, 0.0f, -1.0f, 1.0f));
+    printf("identity * perspective * (0,0,-1,1): %.4f %.4f %.4f %.4f\n", q.c.x, q.c.y, q.c.z, q.c.w);
+    glv_simd_set_level(best);
+}
+
+int main(){
+
+    testing_builders();
+    testing_expressions();
+
+    return 0;
+}
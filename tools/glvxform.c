@@ -0,0 +1,139 @@
+/*
+    glvxform: transforms every vertex of a raw float file, streamed
+    through memory mappings (stream.h), and reports the throughput.
+
+    usage: glvxform [options] in [out]
+        -4              four floats per vertex (default three, w = 1)
+        -t X Y Z        translate
+        -r DEG X Y Z    rotate DEG degrees about the axis (X, Y, Z)
+        -s X Y Z        scale
+        -c MIB          chunk size in MiB (default 8)
+        -j N            threads, 1 for serial (default one per core)
+        -g N            first write N random vertices to in
+
+    Transforms apply to the vertices in the order given. Without out,
+    in is transformed in place.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glvmath.h"
+
+static void usage(void){
+    fprintf(stderr,
+        "usage: glvxform [options] in [out]\n"
+        "  -4            four floats per vertex (default three, w = 1)\n"
+        "  -t X Y Z      translate\n"
+        "  -r DEG X Y Z  rotate DEG degrees about the axis (X, Y, Z)\n"
+        "  -s X Y Z      scale\n"
+        "  -c MIB        chunk size in MiB (default 8)\n"
+        "  -j N          threads, 1 for serial (default one per core)\n"
+        "  -g N          first write N random vertices to in\n");
+    exit(2);
+}
+
+/* Reads count numbers following argv[*i] */
+static void read_floats(int argc, char** argv, int* i, float* out, int count){
+    int k;
+    for(k = 0; k != count; ++k){
+        char* end;
+        if(++*i >= argc) usage();
+        out[k] = strtof(argv[*i], &end);
+        if(*end != '\0') usage();
+    }
+}
+
+/* Writes n vertices of random coordinates in [-100, 100] */
+static int generate(const char* path, size_t n, unsigned int components){
+    static float block[3 * 4 * 4096];
+    FILE* f = fopen(path, "wb");
+    size_t left = n * components, i;
+    if(!f) return -1;
+    while(left != 0){
+        const size_t len = left < sizeof(block) / sizeof(float) ? left : sizeof(block) / sizeof(float);
+        for(i = 0; i != len; ++i) block[i] = (float)rand() / (float)RAND_MAX * 200.0f - 100.0f;
+        if(fwrite(block, sizeof(float), len, f) != len){
+            fclose(f);
+            return -1;
+        }
+        left -= len;
+    }
+    return fclose(f);
+}
+
+int main(int argc, char** argv){
+    glv_mat4 m = glv_mat4_identity(), id = glv_mat4_identity(), op;
+    const char *in = NULL, *out = NULL;
+    unsigned int components = 3, threads = 0;
+    size_t chunk = 0, gen = 0;
+    glv_stream_stats st;
+    float v[4];
+    int i, err;
+
+    for(i = 1; i != argc; ++i){
+        const char* a = argv[i];
+        if(a[0] != '-' || a[1] == '\0' || a[2] != '\0'){
+            if(!in) in = a;
+            else if(!out) out = a;
+            else usage();
+            continue;
+        }
+        switch(a[1]){
+        case '4':
+            components = 4;
+            break;
+        case 't':
+            read_floats(argc, argv, &i, v, 3);
+            op = glv_translate(&id, &(glv_vec3){.x=v[0], .y=v[1], .z=v[2]});
+            m = glv_mat4_multiply(&op, &m);
+            break;
+        case 'r':
+            read_floats(argc, argv, &i, v, 4);
+        #ifndef GLV_USE_DEGREES
+            v[0] = glv_radians(v[0]);
+        #endif
+            op = glv_rotate(&id, v[0], &(glv_vec3){.x=v[1], .y=v[2], .z=v[3]});
+            m = glv_mat4_multiply(&op, &m);
+            break;
+        case 's':
+            read_floats(argc, argv, &i, v, 3);
+            op = glv_scale(&id, &(glv_vec3){.x=v[0], .y=v[1], .z=v[2]});
+            m = glv_mat4_multiply(&op, &m);
+            break;
+        case 'c':
+            read_floats(argc, argv, &i, v, 1);
+            if(v[0] <= 0.0f) usage();
+            chunk = (size_t)(v[0] * 1024.0f * 1024.0f);
+            break;
+        case 'j':
+            if(++i >= argc) usage();
+            threads = (unsigned int)strtoul(argv[i], NULL, 10);
+            if(threads == 0) usage();
+            break;
+        case 'g':
+            if(++i >= argc) usage();
+            gen = (size_t)strtoull(argv[i], NULL, 10);
+            break;
+        default:
+            usage();
+        }
+    }
+    if(!in) usage();
+
+    if(gen != 0 && generate(in, gen, components) != 0){
+        perror(in);
+        return 1;
+    }
+    glv_pool_start(threads);
+    err = glv_stream_transform_file(in, out, components, &m, chunk, &st);
+    glv_pool_stop();
+    if(err != 0){
+        fprintf(stderr, "glvxform: %s: %s\n", in, strerror(err));
+        return 1;
+    }
+    printf("%zu vertices, %.3f GB read, %.3f GB written in %.3f s: %.2f GB/s\n", st.vertices,
+        (double)st.bytes_read * 1e-9, (double)st.bytes_written * 1e-9, st.seconds,
+        (double)(st.bytes_read + st.bytes_written) * 1e-9 / st.seconds);
+    return 0;
+}